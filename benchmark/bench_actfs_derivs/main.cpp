@@ -10,15 +10,17 @@ using namespace std;
 
 void run_single_benchmark(const string &label, const string &actf_id, const double * const xdata, const int neval, const int nruns, const bool flag_d1, const bool flag_d2, const bool flag_d3, const bool flag_fad)
 {
-    pair<double, double> result;
     const double time_scale = 1000000000.; //nanoseconds
 
-    result = sample_benchmark(benchmark_actf_derivs, nruns, std_actf::provideActivationFunction(actf_id), xdata, neval, flag_d1, flag_d2, flag_d3, flag_fad);
-    cout << label << ":" << setw(max(1, 11 - static_cast<int>(label.length()))) << setfill(' ') << " " << result.first/neval*time_scale << " +- " << result.second/neval*time_scale << " nanoseconds" << endl;
+    const BenchStats result = sample_benchmark_stats(benchmark_actf_derivs, 1, nruns, std_actf::provideActivationFunction(actf_id), xdata, neval, flag_d1, flag_d2, flag_d3, flag_fad).scaled(time_scale/neval);
+    bench_report().add(label, result, "nanoseconds");
+    cout << label << ":" << setw(max(1, 11 - static_cast<int>(label.length()))) << setfill(' ') << " " << result.mean << " +- " << result.sem << " nanoseconds" << endl;
 }
 
-int main()
+int main(int argc, char * argv[])
 {
+    bench_report().setName("bench_actfs_derivs");
+
     const int neval = 100000;
     const int nruns = 10;
 
@@ -43,6 +45,7 @@ int main()
         cout << "ACTF derivative benchmark with " << nruns << " runs of " << neval << " evaluations for " << actf_id << " activation function." << endl;
         cout << "===========================================================================================" << endl << endl;
         for (bool flag_fad : {false, true}) {
+            bench_report().setGroup(actf_id + (flag_fad ? " fad" : " individual"));
             if (flag_fad) {
                 cout << "Time per evaluation using fad function call:" << endl;
             }
@@ -65,6 +68,6 @@ int main()
     }
 
     delete[] xdata;
-    return 0;
+    return finish_report(argc, argv);
 }
 
@@ -1,9 +1,23 @@
 #include <iomanip>
 #include <iostream>
 #include <random>
+#include <memory>
+#include <algorithm>
 
 #include "qnets/poly/actf/ActivationFunctionManager.hpp"
 #include "qnets/poly/io/PrintUtilities.hpp"
+#include "qnets/templ/TemplNet.hpp"
+#include "qnets/actf/NoOp.hpp"
+#include "qnets/actf/Sigmoid.hpp"
+#include "qnets/actf/SRLU.hpp"
+#include "qnets/actf/TanSig.hpp"
+#include "qnets/actf/Sine.hpp"
+#include "qnets/actf/Exp.hpp"
+#include "qnets/actf/FastSigmoid.hpp"
+#include "qnets/actf/FastSRLU.hpp"
+#include "qnets/actf/FastTanSig.hpp"
+#include "qnets/actf/FastSine.hpp"
+#include "qnets/actf/FastExp.hpp"
 
 #include "FFNNBenchmarks.hpp"
 
@@ -11,15 +25,91 @@ using namespace std;
 
 void run_single_benchmark(const string &label, FeedForwardNeuralNetwork * const ffnn, const double * const xdata, const int neval, const int nruns)
 {
-    pair<double, double> result;
     const double time_scale = 1000000.; //microseconds
 
-    result = sample_benchmark(benchmark_FFPropagate, nruns, ffnn, xdata, neval);
-    cout << label << ":" << setw(max(1, 20 - static_cast<int>(label.length()))) << setfill(' ') << " " << result.first/neval*time_scale << " +- " << result.second/neval*time_scale << " microseconds" << endl;
+    const BenchStats result = sample_benchmark_stats(benchmark_FFPropagate, 1, nruns, ffnn, xdata, neval).scaled(time_scale/neval);
+    bench_report().add(label, result, "microseconds");
+    cout << label << ":" << setw(max(1, 20 - static_cast<int>(label.length()))) << setfill(' ') << " " << result.mean << " +- " << result.sem << " microseconds" << endl;
 }
 
-int main()
+template <class TemplNet>
+void run_single_benchmark(const string &label, TemplNet &tnet, const double xdata[], const int neval, const int nruns)
 {
+    const double time_scale = 1000000.; //microseconds
+
+    const BenchStats result = sample_benchmark_stats(benchmark_TemplProp<TemplNet>, 1, nruns, tnet, xdata, neval).scaled(time_scale/neval);
+    bench_report().add(label, result, "microseconds");
+    cout << label << ":" << setw(max(1, 20 - static_cast<int>(label.length()))) << setfill(' ') << " " << result.mean << " +- " << result.sem << " microseconds" << endl;
+}
+
+template <class TNet, class RefNet>
+void report_accuracy(TNet &tnet, RefNet &refnet, const double xdata[], const int neval)
+{   // max. deviation of the results of tnet from refnet (same betas, but exact actfs), relative to max(1, |exact|)
+    double dev_f = 0., dev_d1 = 0., dev_d2 = 0., dev_vd1 = 0.;
+    const auto maxdev = [](double dev, const auto &arr1, const auto &arr2) {
+        for (size_t i = 0; i < arr1.size(); ++i) { dev = max(dev, fabs(arr1[i] - arr2[i])/max(1., fabs(arr2[i]))); }
+        return dev;
+    };
+    tnet.dflags.set(templ::DerivConfig::D12_VD1);
+    refnet.dflags.set(templ::DerivConfig::D12_VD1);
+    for (int i = 0; i < neval; ++i) {
+        tnet.Propagate(xdata + i*TNet::ninput);
+        refnet.Propagate(xdata + i*TNet::ninput);
+        dev_f = maxdev(dev_f, tnet.getOutput(), refnet.getOutput());
+        dev_d1 = maxdev(dev_d1, tnet.getD1(), refnet.getD1());
+        dev_d2 = maxdev(dev_d2, tnet.getD2(), refnet.getD2());
+        dev_vd1 = maxdev(dev_vd1, tnet.getVD1(), refnet.getVD1());
+    }
+    cout << "max. deviation from exact actf: f " << dev_f << ", d1 " << dev_d1 << ", d2 " << dev_d2 << ", vd1 " << dev_vd1 << endl;
+}
+
+template <class ACTF, class RefACTF = ACTF>
+void run_templ_benchmark(const string &actf_id, const double xdata[], const int neval, const int nruns)
+{
+    using namespace templ;
+    constexpr int xndim = 4, yndim = 1;
+    constexpr auto dconf = DerivConfig::D12_VD1;
+    using NetType = TemplNet<double, dconf, xndim, xndim, LayerConfig<8, ACTF>, LayerConfig<4, ACTF>, LayerConfig<yndim, actf::NoOp>>;
+    using RefNetType = TemplNet<double, dconf, xndim, xndim, LayerConfig<8, RefACTF>, LayerConfig<4, RefACTF>, LayerConfig<yndim, actf::NoOp>>;
+    auto tnet_ptr = std::make_unique<NetType>();
+    auto refnet_ptr = std::make_unique<RefNetType>();
+
+    // fixed weights
+    mt19937_64 rgen;
+    rgen.seed(18984687);
+    uniform_real_distribution<double> rd(-1., 1.);
+    for (int i = 0; i < NetType::nbeta; ++i) {
+        tnet_ptr->setBeta(i, rd(rgen));
+        refnet_ptr->setBeta(i, tnet_ptr->getBeta(i));
+    }
+
+    cout << "FFPropagate benchmark with " << nruns << " runs of " << neval << " FF-Propagations for " << actf_id << " activation function." << endl;
+    cout << "=========================================================================================" << endl << endl;
+    cout << "TemplNet of shape " << NetType::getNInput() << "x" << NetType::getNUnit(0) << "x" << NetType::getNUnit(1) << "x" << NetType::getNOutput() << endl;
+    report_accuracy(*tnet_ptr, *refnet_ptr, xdata, neval);
+    cout << endl;
+    cout << "Benchmark results (time per propagation):" << endl;
+    bench_report().setGroup(actf_id);
+
+    tnet_ptr->dflags.set(DerivConfig::OFF);
+    run_single_benchmark("f", *tnet_ptr, xdata, neval, nruns);
+
+    tnet_ptr->dflags.set(DerivConfig::D1);
+    run_single_benchmark("f+d1", *tnet_ptr, xdata, neval, nruns);
+
+    tnet_ptr->dflags.set(DerivConfig::D12);
+    run_single_benchmark("f+d1+d2", *tnet_ptr, xdata, neval, nruns);
+
+    tnet_ptr->dflags.set(DerivConfig::D12_VD1);
+    run_single_benchmark("f+d1+d2+vd1", *tnet_ptr, xdata, neval, nruns);
+
+    cout << "=========================================================================================" << endl << endl << endl;
+}
+
+int main(int argc, char * argv[])
+{
+    bench_report().setName("bench_actfs_ffprop");
+
     const int neval = 1000;
     const int nruns = 5;
 
@@ -71,6 +161,7 @@ int main()
         printFFNNStructure(ffnn, true, 0);
         cout << endl;
         cout << "Benchmark results (time per propagation):" << endl;
+        bench_report().setGroup(actf_id);
 
         run_single_benchmark("f", ffnn, xdata, neval, nruns);
 
@@ -94,7 +185,19 @@ int main()
         delete ffnn;
     }
 
+    // Templ FFPropagate benchmark (exact and fast actfs), IDs prefixed with "templ:"
+    run_templ_benchmark<actf::Sigmoid>("templ:Sigmoid", xdata, neval, nruns);
+    run_templ_benchmark<actf::FastSigmoid, actf::Sigmoid>("templ:FastSigmoid", xdata, neval, nruns);
+    run_templ_benchmark<actf::TanSig>("templ:TanSig", xdata, neval, nruns);
+    run_templ_benchmark<actf::FastTanSig, actf::TanSig>("templ:FastTanSig", xdata, neval, nruns);
+    run_templ_benchmark<actf::Sine>("templ:Sine", xdata, neval, nruns);
+    run_templ_benchmark<actf::FastSine, actf::Sine>("templ:FastSine", xdata, neval, nruns);
+    run_templ_benchmark<actf::SRLU>("templ:SRLU", xdata, neval, nruns);
+    run_templ_benchmark<actf::FastSRLU, actf::SRLU>("templ:FastSRLU", xdata, neval, nruns);
+    run_templ_benchmark<actf::Exp>("templ:Exp", xdata, neval, nruns);
+    run_templ_benchmark<actf::FastExp, actf::Exp>("templ:FastExp", xdata, neval, nruns);
+
     delete[] xdata;
-    return 0;
+    return finish_report(argc, argv);
 }
 
@@ -30,19 +30,24 @@ class benchmark_actf_ffprop:
         self.data[actf_name] = actf_data # store last actf's data
 
 
-def plot_compare_actfs(benchmark_list, **kwargs):
+def plot_compare_actfs(benchmark_list, templ = False, **kwargs):
     nbm = len(benchmark_list)
-    xlabels = benchmark_list[0].data['LGS'].keys()
+    is_templ = lambda actf: actf.startswith('templ:') # templ actfs are prefixed and have different derivative rows
+    actf_list = [actf for actf in benchmark_list[0].data.keys() if is_templ(actf) == templ]
+    if not actf_list:
+        return None
+    xlabels = benchmark_list[0].data[actf_list[0]].keys()
 
     fig = figure()
-    fig.suptitle('FFPropagate benchmark, comparing all activation functions',fontsize=14)
+    fig.suptitle('FFPropagate benchmark, comparing all ' + ('templ ' if templ else '') + 'activation functions',fontsize=14)
 
     itp=0
     for benchmark in benchmark_list:
 
         itp+=1
         ax = fig.add_subplot(nbm, 1, itp)
-        for actf in benchmark.data.keys():
+        actfs = [actf for actf in benchmark.data.keys() if is_templ(actf) == templ]
+        for actf in actfs:
             values = [v[0] for v in benchmark.data[actf].values()]
             errors = [v[1] for v in benchmark.data[actf].values()]
             ax.errorbar(xlabels, values, xerr=None, yerr=errors, **kwargs)
@@ -50,7 +55,7 @@ def plot_compare_actfs(benchmark_list, **kwargs):
         ax.set_yscale('log')
         ax.set_title(benchmark.label + ' version')
         ax.set_ylabel('Time per propagation [$\mu s$]')
-        ax.legend(benchmark.data.keys())
+        ax.legend(actfs)
 
     return fig
 
@@ -109,6 +114,7 @@ if len(benchmark_list)<1:
     print("Error: Not even one benchmark loaded!")
 else:
     fig1 = plot_compare_actfs(benchmark_list, fmt='o--')
+    fig3 = plot_compare_actfs(benchmark_list, templ=True, fmt='o--')
     if len(benchmark_list)>1:
         fig2 = plot_compare_runs(benchmark_list, ['TANS', 'GSS', 'RELU'])
 
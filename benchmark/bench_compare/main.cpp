@@ -0,0 +1,236 @@
+#include <cctype>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// Compare two JSON benchmark result files (as written by the benchmarks with --json <file>)
+// and flag regressions, i.e. results where the chosen statistic of the new file exceeds the
+// old one by more than the relative threshold. Exits with 1 if any regression was found.
+//
+// Usage: bench_compare old.json new.json [--threshold 0.05] [--stat median]
+
+using namespace std;
+
+// --- Minimal JSON reader (objects, arrays, strings, numbers, true/false/null)
+
+struct JValue
+{
+    enum class Type { Null, Bool, Number, String, Array, Object } type = Type::Null;
+    double num = 0.;
+    string str;
+    vector<JValue> arr;
+    map<string, JValue> obj;
+
+    const JValue &at(const string &key) const
+    {
+        const auto it = obj.find(key);
+        if (type != Type::Object || it == obj.end()) {
+            throw runtime_error("JSON key \"" + key + "\" not found");
+        }
+        return it->second;
+    }
+};
+
+class JReader
+{
+private:
+    const string &_s;
+    size_t _pos = 0;
+
+    void _skipWS()
+    {
+        while (_pos < _s.size() && isspace(static_cast<unsigned char>(_s[_pos]))) { ++_pos; }
+    }
+
+    char _peek()
+    {
+        _skipWS();
+        if (_pos >= _s.size()) { throw runtime_error("unexpected end of JSON"); }
+        return _s[_pos];
+    }
+
+    void _expect(const char c)
+    {
+        if (_peek() != c) { throw runtime_error(string("expected '") + c + "' at position " + to_string(_pos)); }
+        ++_pos;
+    }
+
+    string _readString()
+    {
+        _expect('"');
+        string out;
+        while (_pos < _s.size() && _s[_pos] != '"') {
+            if (_s[_pos] == '\\' && _pos + 1 < _s.size()) {
+                ++_pos;
+                out += (_s[_pos] == 'n') ? '\n' : _s[_pos];
+            }
+            else {
+                out += _s[_pos];
+            }
+            ++_pos;
+        }
+        _expect('"');
+        return out;
+    }
+
+public:
+    explicit JReader(const string &s): _s(s) {}
+
+    JValue read()
+    {
+        JValue v;
+        const char c = _peek();
+        if (c == '{') {
+            v.type = JValue::Type::Object;
+            ++_pos;
+            if (_peek() == '}') {
+                ++_pos;
+                return v;
+            }
+            while (true) {
+                const string key = _readString();
+                _expect(':');
+                v.obj[key] = read();
+                if (_peek() == ',') {
+                    ++_pos;
+                    continue;
+                }
+                _expect('}');
+                return v;
+            }
+        }
+        if (c == '[') {
+            v.type = JValue::Type::Array;
+            ++_pos;
+            if (_peek() == ']') {
+                ++_pos;
+                return v;
+            }
+            while (true) {
+                v.arr.push_back(read());
+                if (_peek() == ',') {
+                    ++_pos;
+                    continue;
+                }
+                _expect(']');
+                return v;
+            }
+        }
+        if (c == '"') {
+            v.type = JValue::Type::String;
+            v.str = _readString();
+            return v;
+        }
+        for (const string lit : {"true", "false", "null"}) {
+            if (_s.compare(_pos, lit.size(), lit) == 0) {
+                _pos += lit.size();
+                v.type = (lit == "null") ? JValue::Type::Null : JValue::Type::Bool;
+                v.num = (lit == "true") ? 1. : 0.;
+                return v;
+            }
+        }
+        size_t len = 0;
+        v.type = JValue::Type::Number;
+        v.num = stod(_s.substr(_pos), &len); // throws on invalid input
+        _pos += len;
+        return v;
+    }
+};
+
+JValue readJSONFile(const string &filename)
+{
+    ifstream file(filename);
+    if (!file.is_open()) {
+        throw runtime_error("could not open " + filename);
+    }
+    stringstream ss;
+    ss << file.rdbuf();
+    const string content = ss.str();
+    return JReader(content).read();
+}
+
+// map "group/label" -> value of stat
+map<string, double> readResults(const string &filename, const string &stat, string &bench_name)
+{
+    const JValue root = readJSONFile(filename);
+    bench_name = root.at("benchmark").str;
+    map<string, double> results;
+    for (const JValue &entry : root.at("results").arr) {
+        results[entry.at("group").str + "/" + entry.at("label").str] = entry.at(stat).num;
+    }
+    return results;
+}
+
+
+int main(int argc, char * argv[])
+{
+    vector<string> files;
+    double threshold = 0.05;
+    string stat = "median";
+    for (int i = 1; i < argc; ++i) {
+        const string arg(argv[i]);
+        if (arg == "--threshold" && i + 1 < argc) {
+            threshold = atof(argv[++i]);
+        }
+        else if (arg == "--stat" && i + 1 < argc) {
+            stat = argv[++i];
+        }
+        else {
+            files.push_back(arg);
+        }
+    }
+    if (files.size() != 2) {
+        cerr << "Usage: " << argv[0] << " old.json new.json [--threshold 0.05] [--stat median]" << endl;
+        return 2;
+    }
+
+    map<string, double> old_res, new_res;
+    string old_name, new_name;
+    try {
+        old_res = readResults(files[0], stat, old_name);
+        new_res = readResults(files[1], stat, new_name);
+    }
+    catch (const exception &e) {
+        cerr << "Error: " << e.what() << endl;
+        return 2;
+    }
+    if (old_name != new_name) {
+        cerr << "Warning: Comparing different benchmarks (" << old_name << " vs " << new_name << ")." << endl;
+    }
+
+    int nregress = 0, nimprove = 0;
+    cout << "Comparing " << stat << " of " << files[1] << " against " << files[0] << " (threshold " << 100.*threshold << "%)" << endl << endl;
+    for (const auto &nr : new_res) {
+        const auto it = old_res.find(nr.first);
+        if (it == old_res.end()) {
+            cout << "  new        " << nr.first << endl;
+            continue;
+        }
+        const double rel = (it->second > 0.) ? nr.second/it->second - 1. : 0.;
+        string flag = "  ok        ";
+        if (rel > threshold) {
+            flag = "  REGRESSED ";
+            ++nregress;
+        }
+        else if (rel < -threshold) {
+            flag = "  improved  ";
+            ++nimprove;
+        }
+        cout << flag << nr.first << ": " << it->second << " -> " << nr.second << " (" << showpos << fixed << setprecision(1) << 100.*rel << "%)" << noshowpos << defaultfloat << setprecision(6) << endl;
+    }
+    for (const auto &orr : old_res) {
+        if (new_res.find(orr.first) == new_res.end()) {
+            cout << "  missing    " << orr.first << endl;
+        }
+    }
+
+    cout << endl << nregress << " regression(s), " << nimprove << " improvement(s)." << endl;
+    return nregress > 0 ? 1 : 0;
+}
@@ -10,15 +10,17 @@ using namespace std;
 
 void run_single_benchmark(const string &label, FeedForwardNeuralNetwork * const ffnn, const double * const xdata, const int neval, const int nruns)
 {
-    pair<double, double> result;
     const double time_scale = 1000000.; //microseconds
 
-    result = sample_benchmark(benchmark_FFPropagate, nruns, ffnn, xdata, neval);
-    cout << label << ":" << setw(max(1, 20 - static_cast<int>(label.length()))) << setfill(' ') << " " << result.first/neval*time_scale << " +- " << result.second/neval*time_scale << " microseconds" << endl;
+    const BenchStats result = sample_benchmark_stats(benchmark_FFPropagate, 1, nruns, ffnn, xdata, neval).scaled(time_scale/neval);
+    bench_report().add(label, result, "microseconds");
+    cout << label << ":" << setw(max(1, 20 - static_cast<int>(label.length()))) << setfill(' ') << " " << result.mean << " +- " << result.sem << " microseconds" << endl;
 }
 
-int main()
+int main(int argc, char * argv[])
 {
+    bench_report().setName("bench_nunits_ffprop");
+
     const int neval[3] = {50000, 1000, 20};
     const int nruns = 5;
 
@@ -60,6 +62,7 @@ int main()
         printFFNNStructure(ffnn, true, 0);
         cout << endl;
         cout << "Benchmark results (time per propagation):" << endl;
+        bench_report().setGroup(to_string(xndim[inet]) + "x" + to_string(nhu1[inet]) + "x" + to_string(nhu2[inet]) + "x" + to_string(yndim));
 
         run_single_benchmark("f", ffnn, xdata + xoffset, neval[inet], nruns);
 
@@ -72,7 +75,7 @@ int main()
         ffnn->addVariationalFirstDerivativeSubstrate();
         run_single_benchmark("f+d1+d2+vd1", ffnn, xdata + xoffset, neval[inet], nruns);
 
-        /* these currently kill 16GB+ of memory on the largest nets */
+        /* these currently kill 16GB+ of memory on the largest nets (see bench_substrate_memory) */
         //ffnn->addCrossFirstDerivativeSubstrate();
         //run_single_benchmark("f+d1+d2+vd1+cd1", ffnn, xdata+xoffset, neval[inet], nruns);
 
@@ -86,6 +89,6 @@ int main()
     }
 
     delete[] xdata;
-    return 0;
+    return finish_report(argc, argv);
 }
 
@@ -0,0 +1,147 @@
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#ifdef OPENMP
+#include <omp.h>
+#endif
+
+#include "qnets/poly/layer/FedLayer.hpp"
+
+#include "FFNNBenchmarks.hpp"
+
+using namespace std;
+
+// Thread scaling of the OpenMP parallelized FFPropagate, for nets with hidden layers of
+// uniform width and different substrate sets. For every width the speedup and efficiency
+// versus one thread are reported, and from these a FedLayer::setOMPMinNUnits threshold
+// is recommended (the smallest layer size that profits from parallel computation).
+
+constexpr int xndim = 8, yndim = 1, nhl = 2;
+constexpr double min_speedup = 1.1; // a layer size "profits" if the best speedup reaches this
+
+struct SubstrateSet
+{
+    string label;
+    bool d1, d2, vd1;
+};
+
+int get_max_threads()
+{
+#ifdef OPENMP
+    return omp_get_max_threads(); // respects OMP_NUM_THREADS
+#else
+    return 1;
+#endif
+}
+
+void set_num_threads(const int nthreads)
+{
+#ifdef OPENMP
+    omp_set_num_threads(nthreads);
+#else
+    (void) nthreads;
+#endif
+}
+
+// 1, 2, 4, ... and max
+vector<int> thread_counts(const int max_threads)
+{
+    vector<int> counts;
+    for (int n = 1; n < max_threads; n *= 2) {
+        counts.push_back(n);
+    }
+    counts.push_back(max_threads);
+    return counts;
+}
+
+// returns the best speedup versus one thread
+double run_width_benchmark(const int width, const SubstrateSet &sset, const vector<int> &nthreads, const double * const xdata, const int nruns)
+{
+    const double time_scale = 1000000.; //microseconds
+    const int neval = max(5, 1000000/(width*width*(sset.vd1 ? max(1, width/8) : 1))); // vd1 cost grows with the number of betas
+
+    auto * ffnn = new FeedForwardNeuralNetwork(xndim + 1, width + 1, yndim + 1);
+    for (int i = 1; i < nhl; ++i) {
+        ffnn->pushHiddenLayer(width + 1);
+    }
+    ffnn->connectFFNN();
+    ffnn->assignVariationalParameters();
+    ffnn->addSubstrates(sset.d1, sset.d2, sset.vd1, false, false);
+
+    double time_1 = 0., best_speedup = 1.;
+    for (const int nt : nthreads) {
+        set_num_threads(nt);
+        const BenchStats result = sample_benchmark_stats(benchmark_FFPropagate, 1, nruns, ffnn, xdata, neval).scaled(time_scale/neval);
+        if (nt == 1) { time_1 = result.median; }
+        const double speedup = time_1/result.median;
+        best_speedup = max(best_speedup, speedup);
+
+        const string label = "w" + to_string(width) + " t" + to_string(nt);
+        bench_report().add(label, result, "microseconds");
+        cout << label << ":" << setw(max(1, 12 - static_cast<int>(label.length()))) << setfill(' ') << " " << setw(12) << result.median << " microseconds, speedup "
+             << setw(6) << setprecision(3) << speedup << ", efficiency " << setw(6) << speedup/nt << setprecision(6) << endl;
+    }
+
+    delete ffnn;
+    return best_speedup;
+}
+
+int main(int argc, char * argv[])
+{
+    bench_report().setName("bench_omp_scaling");
+
+    const int nruns = 5;
+    const vector<int> widths = {4, 8, 16, 32, 64, 128, 256};
+    const vector<SubstrateSet> ssets = {{"f", false, false, false},
+                                        {"f+d1+d2", true, true, false},
+                                        {"f+d1+d2+vd1", true, true, true}};
+
+    const int max_threads = get_max_threads();
+    const vector<int> nthreads = thread_counts(max_threads);
+#ifndef OPENMP
+    cout << "NOTE: The library and benchmark were built without OpenMP (USE_OPENMP), so only a single thread is used." << endl << endl;
+#endif
+
+    // random input with variance 1
+    const int neval_max = 1000000/(widths[0]*widths[0]);
+    vector<double> xdata(static_cast<size_t>(neval_max)*xndim);
+    mt19937_64 rgen;
+    rgen.seed(18984687);
+    uniform_real_distribution<double> rd(-sqrt(3.), sqrt(3.));
+    for (double &x : xdata) {
+        x = rd(rgen);
+    }
+
+    vector<int> recommended(ssets.size(), -1);
+    for (size_t is = 0; is < ssets.size(); ++is) {
+        cout << "FFPropagate thread scaling (" << ssets[is].label << "), " << nhl << " hidden layers of width w, up to " << max_threads << " threads:" << endl;
+        cout << "=========================================================================================" << endl << endl;
+        bench_report().setGroup(ssets[is].label);
+        for (const int width : widths) {
+            const double speedup = run_width_benchmark(width, ssets[is], nthreads, xdata.data(), nruns);
+            if (recommended[is] < 0 && speedup >= min_speedup) {
+                recommended[is] = width + 1; // units incl. offset
+            }
+            cout << endl;
+        }
+        cout << "=========================================================================================" << endl << endl << endl;
+    }
+
+#ifdef OPENMP
+    cout << "Recommended FedLayer::setOMPMinNUnits thresholds (current: " << FedLayer::getOMPMinNUnits() << "):" << endl;
+    for (size_t is = 0; is < ssets.size(); ++is) {
+        cout << "  " << ssets[is].label << ": ";
+        if (recommended[is] > 0) {
+            cout << recommended[is] << endl;
+        }
+        else {
+            cout << "none (no speedup >= " << min_speedup << " found, better don't use OpenMP)" << endl;
+        }
+    }
+#endif
+
+    return finish_report(argc, argv);
+}
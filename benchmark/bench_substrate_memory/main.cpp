@@ -0,0 +1,226 @@
+#include <cstdio>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <new>
+#include <string>
+
+#include <fcntl.h>
+#include <sys/resource.h>
+#include <unistd.h>
+
+#include "qnets/poly/FeedForwardNeuralNetwork.hpp"
+#include "qnets/templ/TemplNet.hpp"
+#include "qnets/actf/Sigmoid.hpp"
+
+#include "BenchHarness.hpp"
+
+using namespace std;
+
+// Memory footprint of the derivative substrates (poly) and derivative configs (TemplNet).
+// Heap allocations are counted by replacing the global operator new/delete, the resident
+// set size is read from /proc/self/statm (current) and getrusage (peak).
+
+
+// --- Allocation counting
+
+namespace
+{
+size_t g_nalloc = 0; // number of allocations
+size_t g_live_bytes = 0; // currently allocated bytes
+constexpr size_t alloc_header = 16; // keeps the default new alignment
+
+void * counted_alloc(const size_t size)
+{
+    void * const p = malloc(size + alloc_header);
+    if (p == nullptr) { throw std::bad_alloc(); }
+    *static_cast<size_t *>(p) = size;
+    ++g_nalloc;
+    g_live_bytes += size;
+    return static_cast<char *>(p) + alloc_header;
+}
+
+void counted_free(void * const ptr)
+{
+    if (ptr == nullptr) { return; }
+    void * const p = static_cast<char *>(ptr) - alloc_header;
+    g_live_bytes -= *static_cast<size_t *>(p);
+    free(p);
+}
+} // namespace
+
+void * operator new(size_t size) { return counted_alloc(size); }
+void * operator new[](size_t size) { return counted_alloc(size); }
+void operator delete(void * ptr) noexcept { counted_free(ptr); }
+void operator delete[](void * ptr) noexcept { counted_free(ptr); }
+void operator delete(void * ptr, size_t) noexcept { counted_free(ptr); }
+void operator delete[](void * ptr, size_t) noexcept { counted_free(ptr); }
+
+
+// --- Memory probes
+
+struct MemProbe
+{
+    size_t nalloc, live_bytes;
+    double rss_kb, peak_rss_kb;
+};
+
+double current_rss_kb() // reads /proc/self/statm without heap allocations
+{
+    char buf[128] = {};
+    const int fd = open("/proc/self/statm", O_RDONLY);
+    if (fd < 0) { return 0.; }
+    const ssize_t nread = read(fd, buf, sizeof(buf) - 1);
+    close(fd);
+    long npages = 0, nresident = 0;
+    if (nread <= 0 || sscanf(buf, "%ld %ld", &npages, &nresident) != 2) { return 0.; }
+    return static_cast<double>(nresident)*sysconf(_SC_PAGESIZE)/1024.;
+}
+
+double peak_rss_kb()
+{
+    struct rusage usage{};
+    getrusage(RUSAGE_SELF, &usage);
+    return static_cast<double>(usage.ru_maxrss); // kB on Linux
+}
+
+MemProbe probe()
+{
+    return MemProbe{g_nalloc, g_live_bytes, current_rss_kb(), peak_rss_kb()};
+}
+
+// record the difference of two probes (allocations and bytes) and the absolute RSS values
+void report_step(const string &label, const MemProbe &before, const MemProbe &after)
+{
+    const size_t nalloc = after.nalloc - before.nalloc;
+    const double kbytes = (static_cast<double>(after.live_bytes) - static_cast<double>(before.live_bytes))/1024.;
+    bench_report().add(label + " allocs", compute_stats({static_cast<double>(nalloc)}), "count", 0);
+    bench_report().add(label + " heap", compute_stats({kbytes}), "kB", 0);
+    bench_report().add(label + " rss", compute_stats({after.rss_kb}), "kB", 0);
+    bench_report().add(label + " peak_rss", compute_stats({after.peak_rss_kb}), "kB", 0);
+    cout << label << ":" << setw(max(1, 24 - static_cast<int>(label.length()))) << setfill(' ') << " " << setw(10) << nalloc << " allocations, " << setw(12) << kbytes << " kB heap, "
+         << setw(10) << after.rss_kb << " kB RSS, " << setw(10) << after.peak_rss_kb << " kB peak RSS" << endl;
+}
+
+
+// --- Poly network
+
+constexpr int nnets = 3;
+constexpr int yndim = 1;
+constexpr int xndim[nnets] = {6, 24, 96}, nhu1[nnets] = {12, 48, 192}, nhu2[nnets] = {6, 24, 96};
+constexpr double max_cross_gb = 4.; // skip cross derivative substrates estimated to need more
+
+string shape_string(const int inet)
+{
+    return to_string(xndim[inet]) + "x" + to_string(nhu1[inet]) + "x" + to_string(nhu2[inet]) + "x" + to_string(yndim);
+}
+
+// estimated size of one cross derivative substrate (about xndim*nvp values per unit)
+double estimate_cross_gb(const FeedForwardNeuralNetwork * const ffnn)
+{
+    int nunits = 0;
+    for (int i = 0; i < ffnn->getNLayers(); ++i) {
+        nunits += ffnn->getLayerSize(i);
+    }
+    return 1.*nunits*ffnn->getNInput()*ffnn->getNVariationalParameters()*sizeof(double)/(1024.*1024.*1024.);
+}
+
+void run_poly_benchmark(const int inet)
+{
+    cout << "Poly FFNN of shape " << shape_string(inet) << ", substrates added step by step:" << endl;
+    bench_report().setGroup("poly " + shape_string(inet));
+
+    const MemProbe p0 = probe();
+    auto * ffnn = new FeedForwardNeuralNetwork(xndim[inet] + 1, nhu1[inet] + 1, yndim + 1);
+    ffnn->pushHiddenLayer(nhu2[inet] + 1);
+    ffnn->connectFFNN();
+    ffnn->assignVariationalParameters();
+    MemProbe p1 = probe();
+    report_step("f", p0, p1);
+
+    ffnn->addFirstDerivativeSubstrate();
+    MemProbe p2 = probe();
+    report_step("+d1", p1, p2);
+
+    ffnn->addSecondDerivativeSubstrate();
+    p1 = probe();
+    report_step("+d2", p2, p1);
+
+    ffnn->addVariationalFirstDerivativeSubstrate();
+    p2 = probe();
+    report_step("+vd1", p1, p2);
+
+    const double cross_gb = estimate_cross_gb(ffnn);
+    if (cross_gb <= max_cross_gb) {
+        ffnn->addCrossFirstDerivativeSubstrate();
+        p1 = probe();
+        report_step("+cd1", p2, p1);
+
+        ffnn->addCrossSecondDerivativeSubstrate();
+        p2 = probe();
+        report_step("+cd2", p1, p2);
+    }
+    else {
+        cout << "+cd1, +cd2: skipped, estimated " << cross_gb << " GB each (limit " << max_cross_gb << " GB)" << endl;
+    }
+
+    delete ffnn;
+    cout << endl;
+}
+
+
+// --- TemplNet
+
+template <templ::DerivConfig DCONF, int XNDIM, int NHU1, int NHU2>
+void run_templ_single(const string &label)
+{
+    using namespace templ;
+    using Net = TemplNet<double, DCONF, XNDIM, XNDIM, LayerConfig<NHU1, actf::Sigmoid>, LayerConfig<NHU2, actf::Sigmoid>, LayerConfig<yndim, actf::Sigmoid>>;
+
+    const MemProbe before = probe();
+    auto tnet = std::make_unique<Net>(); // heap allocated (large nets don't fit on the stack)
+    tnet->Propagate(std::array<double, XNDIM>{}); // touch the state
+    const MemProbe after = probe();
+    report_step(label, before, after);
+    bench_report().add(label + " sizeof(State)", compute_stats({sizeof(typename Net::State)/1024.}), "kB", 0);
+}
+
+template <int I>
+void run_templ_benchmark()
+{
+    using namespace templ;
+    constexpr int X = xndim[I], H1 = nhu1[I], H2 = nhu2[I];
+    cout << "TemplNet of shape " << shape_string(I) << " (double), per DerivConfig:" << endl;
+    bench_report().setGroup("templ " + shape_string(I));
+
+    run_templ_single<DerivConfig::OFF, X, H1, H2>("OFF");
+    run_templ_single<DerivConfig::D1, X, H1, H2>("D1");
+    run_templ_single<DerivConfig::VD1, X, H1, H2>("VD1");
+    run_templ_single<DerivConfig::D1_VD1, X, H1, H2>("D1_VD1");
+    run_templ_single<DerivConfig::D12, X, H1, H2>("D12");
+    run_templ_single<DerivConfig::D12_VD1, X, H1, H2>("D12_VD1");
+    run_templ_single<DerivConfig::D12_VD12, X, H1, H2>("D12_VD12");
+    cout << endl;
+}
+
+
+int main(int argc, char * argv[])
+{
+    bench_report().setName("bench_substrate_memory");
+
+    cout << "Memory footprint benchmark (heap allocations and size per step, absolute current and peak RSS)." << endl;
+    cout << "=========================================================================================" << endl << endl;
+
+    // TemplNet first, because the peak RSS only grows
+    run_templ_benchmark<0>();
+    run_templ_benchmark<1>();
+    run_templ_benchmark<2>();
+
+    for (int inet = 0; inet < nnets; ++inet) {
+        run_poly_benchmark(inet);
+    }
+    cout << "=========================================================================================" << endl << endl << endl;
+
+    return finish_report(argc, argv);
+}
@@ -2,6 +2,7 @@
 #include <iostream>
 #include <random>
 #include <memory>
+#include <vector>
 
 #include "qnets/templ/TemplNet.hpp"
 #include "qnets/actf/Sigmoid.hpp"
@@ -11,25 +12,26 @@
 using namespace std;
 
 template <class TemplNet>
-void run_single_benchmark(const string &label, TemplNet &tnet, const double xdata[], const int neval, const int nruns)
+void run_single_benchmark(const string &label, TemplNet &tnet, const typename TemplNet::ValueT xdata[], const int neval, const int nruns)
 {
-    pair<double, double> result;
     const double time_scale = 1000000.; //microseconds
 
-    result = sample_benchmark(benchmark_TemplProp<TemplNet>, nruns, tnet, xdata, neval);
-    cout << label << ":" << setw(max(1, 20 - static_cast<int>(label.length()))) << setfill(' ') << " " << result.first/neval*time_scale << " +- " << result.second/neval*time_scale << " microseconds" << endl;
+    const BenchStats result = sample_benchmark_stats(benchmark_TemplProp<TemplNet>, 1, nruns, tnet, xdata, neval).scaled(time_scale/neval);
+    bench_report().add(label, result, "microseconds");
+    cout << label << ":" << setw(max(1, 20 - static_cast<int>(label.length()))) << setfill(' ') << " " << result.mean << " +- " << result.sem << " microseconds" << endl;
 }
 
-template <int I>
-void run_benchmark_netpack(const double xdata[], const int ndata[], const int xoffset, const int neval[], const int nruns) {}
+template <int I, typename DataT>
+void run_benchmark_netpack(const string &prec_label, const DataT xdata[], const int ndata[], const int xoffset, const int neval[], const int nruns) {}
 
-template <int I, class TNet, class ... Args>
-void run_benchmark_netpack(const double xdata[], const int ndata[], const int xoffset, const int neval[], const int nruns, TNet &tnet, Args& ... tnets)
+template <int I, typename DataT, class TNet, class ... Args>
+void run_benchmark_netpack(const string &prec_label, const DataT xdata[], const int ndata[], const int xoffset, const int neval[], const int nruns, TNet &tnet, Args& ... tnets)
 {
     using namespace templ;
-    cout << "FFPropagate benchmark with " << nruns << " runs of " << neval[I] << " FF-Propagations, for a FFNN of shape " << TNet::getNInput() << "x" << TNet::getNUnit(0) << "x" << TNet::getNUnit(1) << "x" << TNet::getNOutput() << " ." << endl;
+    cout << "FFPropagate benchmark with " << nruns << " runs of " << neval[I] << " FF-Propagations, for a FFNN of shape " << TNet::getNInput() << "x" << TNet::getNUnit(0) << "x" << TNet::getNUnit(1) << "x" << TNet::getNOutput() << " (" << prec_label << ")." << endl;
     cout << "=========================================================================================" << endl << endl;
     cout << "Benchmark results (time per propagation):" << endl;
+    bench_report().setGroup(to_string(TNet::getNInput()) + "x" + to_string(TNet::getNUnit(0)) + "x" + to_string(TNet::getNUnit(1)) + "x" + to_string(TNet::getNOutput()) + " " + prec_label);
 
     tnet.dflags.set(DerivConfig::OFF);
     run_single_benchmark("f", tnet, xdata + xoffset, neval[I], nruns);
@@ -54,28 +56,25 @@ void run_benchmark_netpack(const double xdata[], const int ndata[], const int xo
 
     cout << "=========================================================================================" << endl << endl << endl;
 
-    run_benchmark_netpack<I + 1, Args...>(xdata, ndata, xoffset + ndata[I], neval, nruns, tnets...);
+    run_benchmark_netpack<I + 1, DataT, Args...>(prec_label, xdata, ndata, xoffset + ndata[I], neval, nruns, tnets...);
 }
 
-int main()
+constexpr int yndim = 1;
+constexpr int xndim[3] = {6, 24, 96}, nhu1[3] = {12, 48, 192}, nhu2[3] = {6, 24, 96};
+
+template <typename PrecT>
+void run_precision_benchmark(const string &prec_label, const vector<double> &xdata_d, const vector<double> betas_d[3], const int ndata[], const int neval[], const int nruns)
 {
     using namespace templ;
-
-    const int neval[3] = {200000, 20000, 1000};
-    const int nruns = 5;
-
-    const int yndim = 1;
-    constexpr int xndim[3] = {6, 24, 96}, nhu1[3] = {12, 48, 192}, nhu2[3] = {6, 24, 96};
+    using ValueT = value_t<PrecT>;
 
     constexpr auto dconf = DerivConfig::D12_VD12; // "allocate" for all derivatives
 
-    using RealT = double;
-
     // Small Net
     using L1Type_s = LayerConfig<nhu1[0], actf::Sigmoid>;
     using L2Type_s = LayerConfig<nhu2[0], actf::Sigmoid>;
     using L3Type_s = LayerConfig<yndim, actf::Sigmoid>;
-    using NetType_s = TemplNet<RealT, dconf, xndim[0], xndim[0], L1Type_s, L2Type_s, L3Type_s>;
+    using NetType_s = TemplNet<PrecT, dconf, xndim[0], xndim[0], L1Type_s, L2Type_s, L3Type_s>;
     auto tnet_s_ptr = std::make_unique<NetType_s>();
     auto &tnet_s = *tnet_s_ptr;
 
@@ -83,7 +82,7 @@ int main()
     using L1Type_m = LayerConfig<nhu1[1], actf::Sigmoid>;
     using L2Type_m = LayerConfig<nhu2[1], actf::Sigmoid>;
     using L3Type_m = LayerConfig<yndim, actf::Sigmoid>;
-    using NetType_m = TemplNet<RealT, dconf, xndim[1], xndim[1], L1Type_m, L2Type_m, L3Type_m>;
+    using NetType_m = TemplNet<PrecT, dconf, xndim[1], xndim[1], L1Type_m, L2Type_m, L3Type_m>;
     auto tnet_m_ptr = std::make_unique<NetType_m>();
     auto &tnet_m = *tnet_m_ptr;
 
@@ -91,17 +90,42 @@ int main()
     using L1Type_l = LayerConfig<nhu1[2], actf::Sigmoid>;
     using L2Type_l = LayerConfig<nhu2[2], actf::Sigmoid>;
     using L3Type_l = LayerConfig<yndim, actf::Sigmoid>;
-    using NetType_l = TemplNet<RealT, dconf, xndim[2], xndim[2], L1Type_l, L2Type_l, L3Type_l>;
+    using NetType_l = TemplNet<PrecT, dconf, xndim[2], xndim[2], L1Type_l, L2Type_l, L3Type_l>;
     auto tnet_l_ptr = std::make_unique<NetType_l>();
     auto &tnet_l = *tnet_l_ptr;
 
+    // same data and weights for all precisions
+    const vector<ValueT> xdata(xdata_d.begin(), xdata_d.end());
+    for (int i=0; i<tnet_s.getNBeta(); ++i) {
+        tnet_s.setBeta(i, static_cast<ValueT>(betas_d[0][i]));
+    }
+    for (int i=0; i<tnet_m.getNBeta(); ++i) {
+        tnet_m.setBeta(i, static_cast<ValueT>(betas_d[1][i]));
+    }
+    for (int i=0; i<tnet_l.getNBeta(); ++i) {
+        tnet_l.setBeta(i, static_cast<ValueT>(betas_d[2][i]));
+    }
+
+    // FFPropagate benchmark
+    run_benchmark_netpack<0>(prec_label, xdata.data(), ndata, 0, neval, nruns, tnet_s, tnet_m, tnet_l);
+}
+
+int main(int argc, char * argv[])
+{
+    bench_report().setName("bench_templ_ffprop");
+
+    using namespace templ;
+
+    const int neval[3] = {200000, 20000, 1000};
+    const int nruns = 5;
+
     // Data
     int ndata[3], ndata_full = 0;
     for (int i = 0; i < 3; ++i) {
         ndata[i] = neval[i]*xndim[i];
         ndata_full += ndata[i];
     }
-    auto * xdata = new double[ndata_full]; // xndim input data for propagate bench
+    vector<double> xdata(ndata_full); // xndim input data for propagate bench
 
     // generate some random input
     random_device rdev;
@@ -114,21 +138,17 @@ int main()
         xdata[i] = rd(rgen);
     }
 
-    for (int i=0; i<tnet_s.getNBeta(); ++i) {
-        tnet_s.setBeta(i, rd(rgen));
-    }
-    for (int i=0; i<tnet_m.getNBeta(); ++i) {
-        tnet_m.setBeta(i, rd(rgen));
-    }
-    for (int i=0; i<tnet_l.getNBeta(); ++i) {
-        tnet_l.setBeta(i, rd(rgen));
+    // generate the weights (count for each net)
+    vector<double> betas[3];
+    for (int i = 0; i < 3; ++i) {
+        const int nbeta = (xndim[i] + 1)*nhu1[i] + (nhu1[i] + 1)*nhu2[i] + (nhu2[i] + 1)*yndim;
+        betas[i].resize(nbeta);
+        for (auto &b : betas[i]) { b = rd(rgen); }
     }
 
-    // FFPropagate benchmark
-    run_benchmark_netpack<0>(xdata, ndata, 0, neval, nruns, tnet_s, tnet_m, tnet_l);
-
-    delete[] xdata;
+    run_precision_benchmark<double>("double", xdata, betas, ndata, neval, nruns);
+    run_precision_benchmark<float>("float", xdata, betas, ndata, neval, nruns);
+    run_precision_benchmark<MixedPrec<float, double>>("mixed float/double", xdata, betas, ndata, neval, nruns);
 
-    return 0;
+    return finish_report(argc, argv);
 }
-
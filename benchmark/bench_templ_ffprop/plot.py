@@ -20,6 +20,8 @@ class benchmark_nunits_ffprop:
                         self.data[net_shape] = net_data # store previous net's data
 
                     net_shape = lsplit[13]
+                    if len(lsplit) > 14: # precision label, e.g. (float).
+                        net_shape += ' ' + ' '.join(lsplit[14:]).strip('().')
                     net_data = {}
                     bnew = False
                     continue
@@ -110,6 +112,6 @@ if not benchmark_list:
 else:
     fig1 = plot_compare_nets(benchmark_list, fmt='o--')
     if benchmark_list:
-        fig2 = plot_compare_runs(benchmark_list, ['6x12x6x1', '24x48x24x1', '96x192x96x1'])
+        fig2 = plot_compare_runs(benchmark_list, list(benchmark_list[0].data.keys()))
 
 show()
@@ -0,0 +1,261 @@
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <sys/resource.h>
+
+#ifdef OPENMP
+#include <omp.h>
+#endif
+
+#include <gsl/gsl_matrix.h>
+#include <gsl/gsl_vector.h>
+
+#include "qnets/poly/FeedForwardNeuralNetwork.hpp"
+#include "qnets/poly/train/NNTrainerGSL.hpp"
+
+#include "Timer.hpp"
+#include "BenchHarness.hpp"
+
+using namespace std;
+using namespace nn_trainer_gsl_details; // to time the residual functions directly
+
+// Training throughput of NNTrainerGSL: residual (ffnn_f) and Jacobian (ffnn_df) evaluations
+// and full findFit / bestFit runs, for several net sizes, data counts and lambda settings.
+
+struct NetShape
+{
+    int xndim, nhu1, nhu2; // nhu2 = 0 means only one hidden layer
+};
+
+struct LambdaConfig
+{
+    string label;
+    double lambda_r, lambda_d1, lambda_d2;
+};
+
+// peak resident set size of the whole process lifetime in kB (Linux reports ru_maxrss in kB)
+double process_peak_rss_kb()
+{
+    struct rusage usage{};
+    getrusage(RUSAGE_SELF, &usage);
+    return static_cast<double>(usage.ru_maxrss);
+}
+
+// read a "Name:   value kB" entry of /proc/self/status, returns -1 if not available
+double proc_status_kb(const string &name)
+{
+    ifstream status("/proc/self/status");
+    string key;
+    double value;
+    while (status >> key) {
+        if (key == name + ":" && status >> value) {
+            return value;
+        }
+        status.ignore(256, '\n');
+    }
+    return -1.;
+}
+
+// reset the peak RSS (VmHWM) to the current RSS (Linux >= 4.0), returns false if not supported
+bool reset_peak_rss()
+{
+    ofstream clear_refs("/proc/self/clear_refs");
+    clear_refs << "5" << flush;
+    return static_cast<bool>(clear_refs) && proc_status_kb("VmHWM") >= 0.;
+}
+
+string shape_string(const NetShape &shape)
+{
+    return to_string(shape.xndim) + "x" + to_string(shape.nhu1) + (shape.nhu2 > 0 ? "x" + to_string(shape.nhu2) : "") + "x1";
+}
+
+FeedForwardNeuralNetwork * create_ffnn(const NetShape &shape)
+{
+    auto * ffnn = new FeedForwardNeuralNetwork(shape.xndim + 1, shape.nhu1 + 1, 2);
+    if (shape.nhu2 > 0) {
+        ffnn->pushHiddenLayer(shape.nhu2 + 1);
+    }
+    ffnn->connectFFNN();
+    ffnn->assignVariationalParameters();
+    return ffnn;
+}
+
+// gaussian target exp(-|x|^2) with exact first and second derivatives
+void generate_data(NNTrainingData &tdata, mt19937_64 &rgen)
+{
+    uniform_real_distribution<double> rd(-2., 2.);
+    for (int i = 0; i < tdata.ndata; ++i) {
+        double r2 = 0.;
+        for (int k = 0; k < tdata.xndim; ++k) {
+            tdata.x[i][k] = rd(rgen);
+            r2 += tdata.x[i][k]*tdata.x[i][k];
+        }
+        const double y = exp(-r2);
+        tdata.y[i][0] = y;
+        tdata.w[i][0] = 1.;
+        for (int k = 0; k < tdata.xndim; ++k) {
+            tdata.yd1[i][0][k] = -2.*tdata.x[i][k]*y;
+            tdata.yd2[i][0][k] = (4.*tdata.x[i][k]*tdata.x[i][k] - 2.)*y;
+        }
+    }
+}
+
+inline double benchmark_ffnn_f(const gsl_vector * betas, training_workspace * tws, gsl_vector * f, const bool flag_r, const bool flag_d, const int neval)
+{
+    Timer timer(1.);
+    for (int i = 0; i < neval; ++i) {
+        tws->invalidateCache(); // time the full propagation
+        ffnn_f(betas, tws, f, flag_r, flag_d);
+    }
+    return timer.elapsed();
+}
+
+inline double benchmark_ffnn_df(const gsl_vector * betas, training_workspace * tws, gsl_matrix * J, const bool flag_r, const bool flag_d, const int neval)
+{
+    Timer timer(1.);
+    for (int i = 0; i < neval; ++i) {
+        tws->invalidateCache(); // time the full propagation
+        ffnn_df(betas, tws, J, flag_r, flag_d);
+    }
+    return timer.elapsed();
+}
+
+inline double benchmark_findFit(const NNTrainingData &tdata, const NNTrainingConfig &tconfig, FeedForwardNeuralNetwork * ffnn, const double * initial_betas)
+{
+    const int npar = ffnn->getNVariationalParameters();
+    vector<double> fit(npar), err(npar);
+    ffnn->setVariationalParameter(initial_betas); // every run starts from the same betas
+    NNTrainerGSL trainer(tdata, tconfig);
+    Timer timer(1.);
+    trainer.findFit(ffnn, fit.data(), err.data());
+    return timer.elapsed();
+}
+
+inline double benchmark_bestFit(const NNTrainingData &tdata, const NNTrainingConfig &tconfig, FeedForwardNeuralNetwork * ffnn, const int nfits)
+{
+    NNTrainerGSL trainer(tdata, tconfig);
+    Timer timer(1.);
+    trainer.bestFit(ffnn, nfits);
+    return timer.elapsed();
+}
+
+void report_result(const string &label, const BenchStats &result, const string &unit)
+{
+    bench_report().add(label, result, unit);
+    cout << label << ":" << setw(max(1, 20 - static_cast<int>(label.length()))) << setfill(' ') << " " << result.mean << " +- " << result.sem << " " << unit << endl;
+}
+
+void run_config(const NetShape &shape, const int ndata, const LambdaConfig &lconf, mt19937_64 &rgen)
+{
+    // per config peak memory: VmHWM above the RSS at this point, if the peak can be reset
+    const bool flag_rss_reset = reset_peak_rss();
+    const double rss_start = flag_rss_reset ? proc_status_kb("VmRSS") : 0.;
+
+    const double time_scale = 1000000.; //microseconds
+    const int nruns = 5, nruns_fit = 3, nfits = 2;
+    const int neval_f = max(1, 200000/(ndata*shape.nhu1)), neval_df = max(1, neval_f/10);
+
+    // data split: half training, quarter validation, quarter testing
+    NNTrainingData tdata = {ndata, ndata/2, ndata/4, shape.xndim, 1, nullptr, nullptr, nullptr, nullptr, nullptr};
+    NNTrainingConfig tconfig = {lconf.lambda_r, lconf.lambda_d1, lconf.lambda_d2, 10, 5}; // limit the number of LM steps per fit
+    tdata.allocate(true, true);
+    generate_data(tdata, rgen);
+
+    FeedForwardNeuralNetwork * ffnn = create_ffnn(shape);
+    const int npar = ffnn->getNVariationalParameters();
+    vector<double> initial_betas(npar);
+    ffnn->getVariationalParameter(initial_betas.data());
+
+    // workspace as configured by NNTrainerGSL::findFit (the same substrates, training data only)
+    training_workspace tws;
+    tws.copyDatConf(tdata, tconfig);
+    tws.nvalidation = 0;
+    const bool flag_r = tws.flag_r, flag_d = tws.flag_d1 || tws.flag_d2;
+    ffnn->addSubstrates(flag_d, tws.flag_d2, false, false, false);
+    auto * ffnn_vderiv = new FeedForwardNeuralNetwork(ffnn);
+    ffnn_vderiv->addSubstrates(flag_d, tws.flag_d2, true, flag_d, tws.flag_d2);
+    tws.ffnn = ffnn;
+    tws.ffnn_vderiv = ffnn_vderiv;
+#ifdef OPENMP
+    tws.createReplicas(omp_get_max_threads()); // data-parallel ffnn_f/ffnn_df, as in findFit
+#endif
+
+    const int nresi = calcNData(tws.ntraining, tws.yndim, flag_r ? npar : 0, flag_d ? tws.xndim : 0);
+    gsl_vector * betas = gsl_vector_alloc(npar);
+    gsl_vector * f = gsl_vector_alloc(nresi);
+    gsl_matrix * J = gsl_matrix_alloc(nresi, npar);
+    for (int i = 0; i < npar; ++i) {
+        gsl_vector_set(betas, i, initial_betas[i]);
+    }
+
+    cout << "NN shape " << shape_string(shape) << " (" << npar << " betas), " << ndata << " data points, " << lconf.label << " (lambda_r = " << lconf.lambda_r
+         << ", lambda_d1 = " << lconf.lambda_d1 << ", lambda_d2 = " << lconf.lambda_d2 << "), " << nresi << " residual rows:" << endl;
+    bench_report().setGroup(shape_string(shape) + "/" + to_string(ndata) + "/" + lconf.label);
+
+    const BenchStats res_f = sample_benchmark_stats(benchmark_ffnn_f, 1, nruns, betas, &tws, f, flag_r, flag_d, neval_f);
+    report_result("ffnn_f", res_f.scaled(time_scale/neval_f), "microseconds");
+    cout << "  -> " << neval_f/res_f.median << " residual evaluations/s" << endl;
+
+    const BenchStats res_df = sample_benchmark_stats(benchmark_ffnn_df, 1, nruns, betas, &tws, J, flag_r, flag_d, neval_df);
+    report_result("ffnn_df/row", res_df.scaled(time_scale/(static_cast<double>(neval_df)*nresi)), "microseconds");
+    cout << "  -> " << static_cast<double>(neval_df)*nresi/res_df.median << " Jacobian rows/s" << endl;
+
+    const BenchStats res_fit = sample_benchmark_stats(benchmark_findFit, 0, nruns_fit, tdata, tconfig, ffnn, initial_betas.data());
+    report_result("findFit", res_fit.scaled(time_scale), "microseconds");
+
+    const BenchStats res_best = sample_benchmark_stats(benchmark_bestFit, 0, nruns_fit, tdata, tconfig, ffnn, nfits);
+    report_result("bestFit(" + to_string(nfits) + ")", res_best.scaled(time_scale), "microseconds");
+
+    if (flag_rss_reset) {
+        const double rss = proc_status_kb("VmHWM") - rss_start;
+        bench_report().add("peak_rss_delta", compute_stats({rss}), "kB", 0);
+        cout << "peak RSS increase:" << setw(3) << setfill(' ') << " " << rss << " kB" << endl << endl;
+    }
+    else { // cumulative over all configs run so far
+        const double rss = process_peak_rss_kb();
+        bench_report().add("peak_rss_process", compute_stats({rss}), "kB", 0);
+        cout << "process peak RSS:" << setw(4) << setfill(' ') << " " << rss << " kB" << endl << endl;
+    }
+
+    gsl_matrix_free(J);
+    gsl_vector_free(f);
+    gsl_vector_free(betas);
+    tws.deleteReplicas();
+    delete ffnn_vderiv;
+    delete ffnn;
+    tdata.deallocate();
+}
+
+int main(int argc, char * argv[])
+{
+    bench_report().setName("bench_train_gsl");
+
+    const vector<NetShape> shapes = {{1, 8, 0}, {3, 12, 6}};
+    const vector<int> ndatas = {200, 1000};
+    const vector<LambdaConfig> lconfs = {{"pure", 0., 0., 0.},
+                                         {"reg", 1.e-4, 0., 0.},
+                                         {"d1", 0., 0.1, 0.},
+                                         {"d1d2", 0., 0.1, 0.1},
+                                         {"d1d2+reg", 1.e-4, 0.1, 0.1}};
+
+    mt19937_64 rgen;
+    rgen.seed(18984687);
+
+    cout << "NNTrainerGSL training benchmark (ffnn_f/ffnn_df: time per call/row, findFit/bestFit: time per fit with <=10 LM steps)." << endl;
+    cout << "=========================================================================================" << endl << endl;
+    for (const NetShape &shape : shapes) {
+        for (const int ndata : ndatas) {
+            for (const LambdaConfig &lconf : lconfs) {
+                run_config(shape, ndata, lconf, rgen);
+            }
+        }
+    }
+    cout << "=========================================================================================" << endl << endl << endl;
+
+    return finish_report(argc, argv);
+}
@@ -0,0 +1,238 @@
+#include <array>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "qnets/templ/TemplNet.hpp"
+#include "qnets/actf/Sigmoid.hpp"
+#include "qnets/actf/NoOp.hpp"
+
+#include "FFNNBenchmarks.hpp"
+
+using namespace std;
+
+// VMC-like workload: a Metropolis random walk of npart particles in ndim dimensions, sampling
+// |psi|^2 with log(psi) = NN(x) - |x|^2/2 (network times gaussian envelope). Every step moves a single particle and evaluates value,
+// gradient and Laplacian (d1/d2) of the proposal, followed by accept/reject. Every nvd1 steps a
+// sample for the optimizer is taken, i.e. the local energy (harmonic potential) is computed and
+// the variational derivatives (vd1) at the current position are evaluated.
+
+struct WalkConfig
+{
+    int npart, ndim;
+    int nsteps; // Metropolis steps per walk
+    int nvd1; // steps between optimizer samples
+    double step; // max displacement per coordinate
+};
+
+struct WalkResult
+{
+    int naccepted = 0;
+    int nsamples = 0;
+    double eloc = 0.; // mean local energy
+    double vd1_sum = 0.; // sum over all vd1 samples (checksum)
+};
+
+// --- Engines (propagate returns log(psi), fills d1/d2 of it)
+
+class PolyEngine
+{
+private:
+    FeedForwardNeuralNetwork * const _ffnn; // d1+d2
+    FeedForwardNeuralNetwork * const _ffnn_vd1; // d1+d2+vd1 copy, for optimizer samples
+
+public:
+    explicit PolyEngine(FeedForwardNeuralNetwork * const ffnn): _ffnn(ffnn), _ffnn_vd1(new FeedForwardNeuralNetwork(ffnn))
+    {
+        _ffnn->addSubstrates(true, true, false, false, false);
+        _ffnn_vd1->addSubstrates(true, true, true, false, false);
+    }
+    ~PolyEngine() { delete _ffnn_vd1; }
+
+    int getNBeta() const { return _ffnn->getNVariationalParameters(); } // all betas are variational
+
+    double propagate(const double x[], double d1[], double d2[])
+    {
+        _ffnn->setInput(x);
+        _ffnn->FFPropagate();
+        _ffnn->getFirstDerivative(0, d1);
+        _ffnn->getSecondDerivative(0, d2);
+        return _ffnn->getOutput(0);
+    }
+
+    void propagateVD1(const double x[], double vd1[])
+    {
+        _ffnn_vd1->setInput(x);
+        _ffnn_vd1->FFPropagate();
+        _ffnn_vd1->getVariationalFirstDerivative(0, vd1);
+    }
+};
+
+template <class NetT>
+class TemplEngine
+{
+private:
+    const NetT &_net;
+    typename NetT::State _state{templ::DynamicDFlags{templ::DerivConfig::D12}};
+    typename NetT::State _state_vd1{templ::DynamicDFlags{templ::DerivConfig::VD1}};
+    std::array<double, NetT::ninput> _input{};
+
+public:
+    explicit TemplEngine(const NetT &net): _net(net) {}
+
+    int getNBeta() const { return NetT::nbeta; }
+
+    double propagate(const double x[], double d1[], double d2[])
+    {
+        std::copy(x, x + NetT::ninput, _input.begin());
+        _net.Propagate(_state, _input);
+        std::copy(_state.getD1().begin(), _state.getD1().end(), d1);
+        std::copy(_state.getD2().begin(), _state.getD2().end(), d2);
+        return _state.getOutput(0);
+    }
+
+    void propagateVD1(const double x[], double vd1[])
+    {
+        std::copy(x, x + NetT::ninput, _input.begin());
+        _net.Propagate(_state_vd1, _input);
+        std::copy(_state_vd1.getVD1().begin(), _state_vd1.getVD1().end(), vd1);
+    }
+};
+
+
+// --- Benchmark
+
+inline double envelope(const vector<double> &x) // log of the gaussian envelope
+{
+    double r2 = 0.;
+    for (const double xi : x) {
+        r2 += xi*xi;
+    }
+    return -0.5*r2;
+}
+
+template <class Engine>
+double benchmark_vmc_walk(Engine &engine, const WalkConfig &conf, WalkResult &result)
+{
+    const int n = conf.npart*conf.ndim;
+    vector<double> x(n), xnew(n), d1(n), d2(n), d1new(n), d2new(n), vd1(engine.getNBeta());
+
+    mt19937_64 rgen;
+    rgen.seed(1337); // the same walk for every run and engine
+    uniform_real_distribution<double> rd(-1., 1.), ru(0., 1.);
+    for (double &xi : x) {
+        xi = rd(rgen);
+    }
+    double lpsi = engine.propagate(x.data(), d1.data(), d2.data()) + envelope(x);
+
+    result = WalkResult{};
+    Timer timer(1.);
+    for (int istep = 0; istep < conf.nsteps; ++istep) {
+        // single particle move
+        const int ip = istep%conf.npart;
+        xnew = x;
+        for (int k = ip*conf.ndim; k < (ip + 1)*conf.ndim; ++k) {
+            xnew[k] += conf.step*rd(rgen);
+        }
+        const double lpsi_new = engine.propagate(xnew.data(), d1new.data(), d2new.data()) + envelope(xnew);
+
+        if (ru(rgen) < exp(2.*(lpsi_new - lpsi))) {
+            x.swap(xnew);
+            d1.swap(d1new);
+            d2.swap(d2new);
+            lpsi = lpsi_new;
+            ++result.naccepted;
+        }
+
+        if ((istep + 1)%conf.nvd1 == 0) { // optimizer sample
+            double eloc = 0.;
+            for (int k = 0; k < n; ++k) {
+                const double g = d1[k] - x[k]; // gradient and laplacian of log(psi) incl. envelope
+                eloc += -0.5*(d2[k] - 1. + g*g) + 0.5*x[k]*x[k];
+            }
+            result.eloc += eloc;
+            engine.propagateVD1(x.data(), vd1.data());
+            for (const double v : vd1) {
+                result.vd1_sum += v;
+            }
+            ++result.nsamples;
+        }
+    }
+    const double elapsed = timer.elapsed();
+    result.eloc /= max(1, result.nsamples);
+    return elapsed;
+}
+
+template <class Engine>
+WalkResult run_single_benchmark(const string &label, Engine &engine, const WalkConfig &conf, const int nruns)
+{
+    const double time_scale = 1000000.; //microseconds
+
+    WalkResult result;
+    const BenchStats stats = sample_benchmark_stats(benchmark_vmc_walk<Engine>, 1, nruns, engine, conf, result);
+    const BenchStats per_accepted = stats.scaled(time_scale/max(1, result.naccepted));
+    bench_report().add(label, per_accepted, "microseconds");
+    cout << label << ":" << setw(max(1, 20 - static_cast<int>(label.length()))) << setfill(' ') << " " << per_accepted.mean << " +- " << per_accepted.sem << " microseconds per accepted step, "
+         << result.naccepted/stats.median << " accepted steps/s, " << conf.nsteps/stats.median << " proposals/s" << endl;
+    return result;
+}
+
+template <int NPART, int NDIM, int NHU1, int NHU2>
+void run_workload_benchmark(const int nsteps, const int nruns)
+{
+    using namespace templ;
+    constexpr int xndim = NPART*NDIM;
+    using Net = TemplNet<double, DerivConfig::D12_VD1, xndim, xndim, LayerConfig<NHU1, actf::Sigmoid>, LayerConfig<NHU2, actf::Sigmoid>, LayerConfig<1, actf::NoOp>>;
+    const WalkConfig conf{NPART, NDIM, nsteps, 10, 1.};
+
+    // poly network of the same shape and weights
+    auto * ffnn = new FeedForwardNeuralNetwork(xndim + 1, NHU1 + 1, 2);
+    ffnn->pushHiddenLayer(NHU2 + 1);
+    for (int l = 0; l < ffnn->getNNeuralLayers(); ++l) {
+        for (int i = 0; i < ffnn->getNNLayer(l)->getNNeuralUnits(); ++i) {
+            ffnn->getNNLayer(l)->getNNUnit(i)->setActivationFunction(std_actf::provideActivationFunction(l < 2 ? "LGS" : "ID"));
+        }
+    }
+    ffnn->connectFFNN();
+    ffnn->assignVariationalParameters();
+    if (ffnn->getNBeta() != Net::nbeta) {
+        throw std::runtime_error("[bench_vmc_walk] Poly and templ networks have different shapes.");
+    }
+    auto tnet_ptr = std::make_unique<Net>();
+    for (int i = 0; i < Net::nbeta; ++i) {
+        ffnn->setBeta(i, 0.5*ffnn->getBeta(i)); // keep log(psi) moderate
+        tnet_ptr->setBeta(i, ffnn->getBeta(i));
+    }
+
+    const string shape = to_string(NPART) + "x" + to_string(NDIM) + " particles, " + to_string(xndim) + "x" + to_string(NHU1) + "x" + to_string(NHU2) + "x1";
+    cout << "VMC walk benchmark with " << nruns << " runs of " << nsteps << " Metropolis steps (d1+d2 per proposal, vd1 every " << conf.nvd1 << " steps), " << shape << "." << endl;
+    cout << "=========================================================================================" << endl << endl;
+    bench_report().setGroup(shape);
+
+    PolyEngine poly(ffnn);
+    const WalkResult res_poly = run_single_benchmark("poly", poly, conf, nruns);
+
+    TemplEngine<Net> templ(*tnet_ptr);
+    const WalkResult res_templ = run_single_benchmark("templ", templ, conf, nruns);
+
+    cout << endl << "acceptance rate: " << static_cast<double>(res_poly.naccepted)/nsteps << ", mean local energy: " << res_poly.eloc << " (poly) " << res_templ.eloc << " (templ)" << endl;
+    cout << "=========================================================================================" << endl << endl << endl;
+
+    delete ffnn;
+}
+
+int main(int argc, char * argv[])
+{
+    bench_report().setName("bench_vmc_walk");
+    const int nruns = 5;
+
+    run_workload_benchmark<2, 3, 12, 6>(20000, nruns);
+    run_workload_benchmark<8, 3, 48, 24>(2000, nruns);
+
+    return finish_report(argc, argv);
+}
@@ -0,0 +1,179 @@
+#ifndef BENCHMARK_COMMON_BENCHHARNESS_HPP
+#define BENCHMARK_COMMON_BENCHHARNESS_HPP
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <ostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// --- Common benchmark harness
+//
+// Runs a benchmark function several times (after some warmup runs), computes robust
+// statistics of the run times and collects the results of a benchmark program into a
+// report, which can be written as JSON (pass --json <file> to the benchmark programs).
+// Two JSON result files can be compared with the bench_compare tool.
+
+struct BenchStats
+{
+    int nruns = 0;
+    double mean = 0., sem = 0.; // mean and standard error of the mean
+    double min = 0., p10 = 0., median = 0., p90 = 0., max = 0.;
+
+    BenchStats scaled(double fac) const // e.g. convert total time to time per operation
+    {
+        BenchStats s = *this;
+        s.mean *= fac;
+        s.sem *= fac;
+        s.min *= fac;
+        s.p10 *= fac;
+        s.median *= fac;
+        s.p90 *= fac;
+        s.max *= fac;
+        return s;
+    }
+};
+
+// linear interpolation percentile of sorted data, q in [0, 1]
+inline double percentile_sorted(const std::vector<double> &sorted, const double q)
+{
+    const double pos = q*(sorted.size() - 1);
+    const auto lo = static_cast<size_t>(std::floor(pos));
+    const size_t hi = std::min(lo + 1, sorted.size() - 1);
+    return sorted[lo] + (pos - lo)*(sorted[hi] - sorted[lo]);
+}
+
+inline BenchStats compute_stats(std::vector<double> times)
+{
+    BenchStats stats;
+    stats.nruns = static_cast<int>(times.size());
+    if (times.empty()) { return stats; }
+
+    for (const double t : times) { stats.mean += t; }
+    stats.mean /= times.size();
+    if (times.size() > 1) {
+        for (const double t : times) { stats.sem += (t - stats.mean)*(t - stats.mean); }
+        stats.sem = std::sqrt(stats.sem/((times.size() - 1)*times.size())); // standard error of the mean
+    }
+
+    std::sort(times.begin(), times.end());
+    stats.min = times.front();
+    stats.max = times.back();
+    stats.p10 = percentile_sorted(times, 0.1);
+    stats.median = percentile_sorted(times, 0.5);
+    stats.p90 = percentile_sorted(times, 0.9);
+    return stats;
+}
+
+// run bench(args...) nwarmup times without and nruns times with recording its returned time
+template <class BenchT, class ... Args>
+inline BenchStats sample_benchmark_stats(BenchT bench, const int nwarmup, const int nruns, Args &&... args)
+{
+    for (int i = 0; i < nwarmup; ++i) {
+        bench(args...);
+    }
+    std::vector<double> times(nruns);
+    for (int i = 0; i < nruns; ++i) {
+        times[i] = bench(args...);
+    }
+    return compute_stats(times);
+}
+
+
+// --- Collect results of a benchmark program
+
+class BenchReport
+{
+private:
+    struct Entry
+    {
+        std::string group, label, unit;
+        int nwarmup;
+        BenchStats stats;
+    };
+
+    std::string _name;
+    std::string _group;
+    std::vector<Entry> _entries;
+
+    static std::string _escape(const std::string &str)
+    {
+        std::string out;
+        for (const char c : str) {
+            if (c == '"' || c == '\\') { out += '\\'; }
+            if (c == '\n') {
+                out += "\\n";
+                continue;
+            }
+            out += c;
+        }
+        return out;
+    }
+
+public:
+    void setName(const std::string &name) { _name = name; }
+    void setGroup(const std::string &group) { _group = group; } // e.g. net shape or actf, applies to following entries
+
+    void add(const std::string &label, const BenchStats &stats, const std::string &unit, const int nwarmup = 1)
+    {
+        _entries.push_back(Entry{_group, label, unit, nwarmup, stats});
+    }
+
+    void writeJSON(std::ostream &os) const
+    {
+        os << std::setprecision(std::numeric_limits<double>::max_digits10);
+        os << "{\n  \"benchmark\": \"" << _escape(_name) << "\",\n  \"results\": [";
+        for (size_t i = 0; i < _entries.size(); ++i) {
+            const Entry &e = _entries[i];
+            os << (i > 0 ? ",\n" : "\n") << "    {\"group\": \"" << _escape(e.group) << "\", \"label\": \"" << _escape(e.label) << "\", \"unit\": \"" << _escape(e.unit) << "\", "
+               << "\"nwarmup\": " << e.nwarmup << ", \"nruns\": " << e.stats.nruns << ", "
+               << "\"mean\": " << e.stats.mean << ", \"sem\": " << e.stats.sem << ", \"min\": " << e.stats.min << ", \"p10\": " << e.stats.p10 << ", "
+               << "\"median\": " << e.stats.median << ", \"p90\": " << e.stats.p90 << ", \"max\": " << e.stats.max << "}";
+        }
+        os << "\n  ]\n}\n";
+    }
+
+    bool writeJSON(const std::string &filename) const
+    {
+        std::ofstream file(filename);
+        if (!file.is_open()) { return false; }
+        this->writeJSON(file);
+        return static_cast<bool>(file);
+    }
+};
+
+// the report of the running benchmark program
+inline BenchReport &bench_report()
+{
+    static BenchReport report;
+    return report;
+}
+
+// returns the file name given via --json <file> (or --json=<file>), empty if not present
+inline std::string parse_json_arg(const int argc, const char * const argv[])
+{
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg(argv[i]);
+        if (arg == "--json" && i + 1 < argc) { return argv[i + 1]; }
+        if (arg.compare(0, 7, "--json=") == 0) { return arg.substr(7); }
+    }
+    return "";
+}
+
+// write the report if requested by the command line, returns main's exit code
+inline int finish_report(const int argc, const char * const argv[])
+{
+    const std::string json_file = parse_json_arg(argc, argv);
+    if (!json_file.empty() && !bench_report().writeJSON(json_file)) {
+        std::cerr << "Error: Could not write JSON results to " << json_file << std::endl;
+        return 1;
+    }
+    return 0;
+}
+
+#endif
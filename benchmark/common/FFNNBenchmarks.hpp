@@ -1,8 +1,10 @@
 #include <cmath>
 #include <iostream>
 #include <tuple>
+#include <utility>
 
 #include "Timer.hpp"
+#include "BenchHarness.hpp"
 #include "qnets/poly/FeedForwardNeuralNetwork.hpp"
 
 inline double benchmark_FFPropagate(FeedForwardNeuralNetwork * const ffnn, const double * const xdata, const int neval)
@@ -20,7 +22,7 @@ inline double benchmark_FFPropagate(FeedForwardNeuralNetwork * const ffnn, const
 }
 
 template <class TemplNet>
-inline double benchmark_TemplProp(TemplNet &tnet, const double xdata[], const int neval)
+inline double benchmark_TemplProp(TemplNet &tnet, const typename TemplNet::ValueT xdata[], const int neval)
 {
     Timer timer(1.);
     const int ninput = tnet.getNInput();
@@ -57,23 +59,10 @@ inline double benchmark_actf_derivs(ActivationFunctionInterface * const actf, co
     return timer.elapsed();
 }
 
+// mean and standard error of the mean of nruns runs (after one warmup run)
 template <class BenchT, class ... Args>
 inline std::pair<double, double> sample_benchmark(BenchT bench, const int nruns, Args&& ... args)
 {
-    double times[nruns];
-    double mean = 0., err = 0.;
-
-    for (int i = 0; i < nruns; ++i) {
-        times[i] = bench(args...);
-        mean += times[i];
-    }
-    mean /= nruns;
-    for (int i = 0; i < nruns; ++i) {
-        err += pow(times[i] - mean, 2);
-    }
-    err /= (nruns - 1)*nruns; // variance of the mean
-    err = sqrt(err); // standard error of the mean
-
-    const std::pair<double, double> result(mean, err);
-    return result;
+    const BenchStats stats = sample_benchmark_stats(bench, 1, nruns, std::forward<Args>(args)...);
+    return std::pair<double, double>(stats.mean, stats.sem);
 }
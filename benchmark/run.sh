@@ -5,10 +5,11 @@ if [ "$1" = "" ]; then
 else
   bench=${1%"/"} # remove any trailing /
   outfile="$(pwd)/${bench}/benchmark_new.out"
+  jsonfile="$(pwd)/${bench}/benchmark_new.json"
   cd ../build/benchmark/
   echo
   echo "Running benchmark ${bench}..."
-  ./${bench} > ${outfile}
+  ./${bench} --json ${jsonfile} > ${outfile}
   cat ${outfile}
   echo
 fi
@@ -1,6 +1,9 @@
 #!/bin/sh
 
 for bench in bench_*; do
+    if [ "$bench" = "bench_compare" ]; then
+        continue # not a benchmark, but the comparison tool
+    fi
     echo "Running ${bench} ..."
     ./run.sh $bench
 done
@@ -0,0 +1,71 @@
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "qnets/templ/CodeGen.hpp"
+#include "qnets/templ/DynNet.hpp"
+
+
+/*
+  Example/Tool: Generate a TemplNet header from a stored FFNN
+
+  Usage: ex_codegen.exe [ffnn_file] [header_file] [net_name]
+
+  Reads a (connected) FFNN file, as written by FeedForwardNeuralNetwork::storeOnFile(), into a DynNet
+  and emits a C++ header with the matching TemplNet type and the weights as constexpr array
+  (copied into the net by initNet() at runtime).
+  Input shift/scale are folded into the first layer's weights and, if the output activation function
+  is linear, the output shift/scale into the last layer's weights.
+
+  The generated header can then be used like:
+
+      #include "GeneratedNet.hpp"
+      GeneratedNet::Net net;
+      GeneratedNet::initNet(net);
+      net.Propagate(x);
+      double y0 = GeneratedNet::getOutput(net, 0);
+      double d00 = GeneratedNet::getD1(net, 0, 0); // if the net was generated with D1 enabled
+*/
+
+int main(int argc, char ** argv)
+{
+    using namespace std;
+
+    const string ffnn_file = argc > 1 ? argv[1] : "stored_ffnn_wbetas.txt";
+    const string header_file = argc > 2 ? argv[2] : "GeneratedNet.hpp";
+    const string net_name = argc > 3 ? argv[3] : "GeneratedNet";
+
+    cout << "Reading the FFNN from '" << ffnn_file << "' into a DynNet..." << endl;
+    templ::DynNet dnet(ffnn_file);
+
+    cout << "The net has " << dnet.getNInput() << " inputs, " << dnet.getNLayer() << " layers with units ";
+    for (int i = 0; i < dnet.getNLayer(); ++i) {
+        cout << dnet.getNUnit(i) << " (" << templ::actfTypeName(dnet.getACTF(i)) << ") ";
+    }
+    cout << "and " << dnet.getNBeta() << " weights." << endl;
+
+    // write the header
+    ofstream header(header_file);
+    if (!header.is_open()) {
+        cout << "Could not open '" << header_file << "' for writing." << endl;
+        return 1;
+    }
+    templ::writeTemplNetHeader(header, dnet, net_name);
+    header.close();
+    cout << "Wrote TemplNet header '" << header_file << "' (namespace " << net_name << ")." << endl;
+
+    // show the equivalence for an example input
+    vector<double> x(dnet.getNInput());
+    for (int i = 0; i < dnet.getNInput(); ++i) { x[i] = 0.1*(i + 1); }
+    dnet.dflags.set(templ::DerivConfig::OFF);
+    dnet.Propagate(x.data());
+    cout << endl << "For the input x_i = 0.1*(i+1), the stored net yields the outputs:" << endl;
+    for (int i = 0; i < dnet.getNOutput(); ++i) {
+        cout << "y_" << i << " = " << dnet.getOutput(i) << endl;
+    }
+    cout << "which the generated " << net_name << "::getOutput(net, i) reproduces." << endl;
+
+    cout << endl << endl;
+    return 0;
+}
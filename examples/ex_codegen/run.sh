@@ -0,0 +1,4 @@
+#!/bin/sh
+cp stored_ffnn_wbetas.txt ../../build/examples/
+cd ../../build/examples
+./ex_codegen.exe stored_ffnn_wbetas.txt GeneratedNet.hpp GeneratedNet
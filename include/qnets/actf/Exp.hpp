@@ -12,7 +12,7 @@ public:
     constexpr void f(ValueT begin[], const ValueT * end)
     {
         for (; begin < end; ++begin) {
-            *begin = exp(*begin);
+            *begin = std::exp(*begin);
         }
     }
 
@@ -20,7 +20,7 @@ public:
     constexpr void fd1(ValueT begin[], const ValueT * end, ValueT d1[])
     {
         for (; begin < end; ++begin, ++d1) {
-            *begin = exp(*begin);
+            *begin = std::exp(*begin);
             *d1 = *begin;
         }
     }
@@ -29,7 +29,7 @@ public:
     constexpr void fd12(ValueT begin[], const ValueT * end, ValueT d1[], ValueT d2[])
     {
         for (; begin < end; ++begin, ++d1, ++d2) {
-            *begin = exp(*begin);
+            *begin = std::exp(*begin);
             *d1 = *begin;
             *d2 = *begin;
         }
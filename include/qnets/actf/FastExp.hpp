@@ -0,0 +1,40 @@
+#ifndef QNETS_ACTF_FASTEXP_HPP
+#define QNETS_ACTF_FASTEXP_HPP
+
+#include "qnets/tool/FastMath.hpp"
+
+namespace actf
+{
+class FastExp // Exponential Activation Function, vectorizable approximation (see FastMath.hpp)
+{
+public:
+    template <typename ValueT>
+    constexpr void f(ValueT begin[], const ValueT * end)
+    {
+        for (; begin < end; ++begin) {
+            *begin = fmath::exp(*begin);
+        }
+    }
+
+    template <typename ValueT>
+    constexpr void fd1(ValueT begin[], const ValueT * end, ValueT d1[])
+    {
+        for (; begin < end; ++begin, ++d1) {
+            *begin = fmath::exp(*begin);
+            *d1 = *begin;
+        }
+    }
+
+    template <typename ValueT>
+    constexpr void fd12(ValueT begin[], const ValueT * end, ValueT d1[], ValueT d2[])
+    {
+        for (; begin < end; ++begin, ++d1, ++d2) {
+            *begin = fmath::exp(*begin);
+            *d1 = *begin;
+            *d2 = *begin;
+        }
+    }
+};
+} // actf
+
+#endif
@@ -0,0 +1,53 @@
+#ifndef QNETS_ACTF_FASTSRLU_HPP
+#define QNETS_ACTF_FASTSRLU_HPP
+
+#include "qnets/tool/FastMath.hpp"
+
+#include <cmath>
+
+namespace actf
+{
+class FastSRLU // Smooth Rectified Linear Unit (Softplus), vectorizable approximation (see FastMath.hpp)
+{
+    // We use log(1+e^x) = max(x, 0) + log(1+e^-|x|), which also does not overflow for large x,
+    // and compute the derivatives from the same e^-|x| (exploiting the symmetry of the sigmoid).
+public:
+    template <typename ValueT>
+    constexpr void f(ValueT begin[], const ValueT * end)
+    {
+        for (; begin < end; ++begin) {
+            const ValueT x = *begin;
+            *begin = fmath::relu(x) + fmath::log1p(fmath::exp(-std::abs(x)));
+        }
+    }
+
+    template <typename ValueT>
+    constexpr void fd1(ValueT begin[], const ValueT * end, ValueT d1[])
+    {
+        constexpr ValueT one = 1;
+        for (; begin < end; ++begin, ++d1) {
+            const ValueT x = *begin;
+            const ValueT emabsx = fmath::exp(-std::abs(x));
+            const ValueT inv1pe = one/(one + emabsx);
+            *begin = fmath::relu(x) + fmath::log1p(emabsx); // log(1+e^x)
+            *d1 = fmath::selectNeg(x, emabsx*inv1pe, inv1pe); // 1 / (1+e^-x)
+        }
+    }
+
+    template <typename ValueT>
+    constexpr void fd12(ValueT begin[], const ValueT * end, ValueT d1[], ValueT d2[])
+    {
+        constexpr ValueT one = 1;
+        for (; begin < end; ++begin, ++d1, ++d2) {
+            const ValueT x = *begin;
+            const ValueT emabsx = fmath::exp(-std::abs(x));
+            const ValueT inv1pe = one/(one + emabsx);
+            *begin = fmath::relu(x) + fmath::log1p(emabsx); // log(1+e^x)
+            *d1 = fmath::selectNeg(x, emabsx*inv1pe, inv1pe); // 1 / (1+e^-x)
+            *d2 = emabsx*inv1pe*inv1pe; // e^-x/(1+e^-x)^2
+        }
+    }
+};
+} // actf
+
+#endif
@@ -0,0 +1,43 @@
+#ifndef QNETS_ACTF_FASTSIGMOID_HPP
+#define QNETS_ACTF_FASTSIGMOID_HPP
+
+#include "qnets/tool/FastMath.hpp"
+
+namespace actf
+{
+class FastSigmoid // Sigmoid Activation Function, vectorizable approximation (see FastMath.hpp)
+{
+public:
+    template <typename ValueT>
+    constexpr void f(ValueT begin[], const ValueT * end)
+    {
+        constexpr ValueT one = 1;
+        for (; begin < end; ++begin) {
+            *begin = one/(one + fmath::exp(-(*begin)));
+        }
+    }
+
+    template <typename ValueT>
+    constexpr void fd1(ValueT begin[], const ValueT * end, ValueT d1[])
+    {
+        constexpr ValueT one = 1;
+        for (; begin < end; ++begin, ++d1) {
+            *begin = one/(one + fmath::exp(-(*begin))); // f
+            *d1 = *begin*(one - *begin); // fd1
+        }
+    }
+
+    template <typename ValueT>
+    constexpr void fd12(ValueT begin[], const ValueT * end, ValueT d1[], ValueT d2[])
+    {
+        constexpr ValueT one = 1, two = 2;
+        for (; begin < end; ++begin, ++d1, ++d2) {
+            *begin = one/(one + fmath::exp(-(*begin))); // f
+            *d1 = *begin*(one - *begin); // fd1
+            *d2 = *d1*(one - two*(*begin)); // fd2
+        }
+    }
+};
+} // actf
+
+#endif
@@ -0,0 +1,40 @@
+#ifndef QNETS_ACTF_FASTSINE_HPP
+#define QNETS_ACTF_FASTSINE_HPP
+
+#include "qnets/tool/FastMath.hpp"
+
+namespace actf
+{
+class FastSine // Sine Activation Function, vectorizable approximation (see FastMath.hpp)
+{
+public:
+    template <typename ValueT>
+    constexpr void f(ValueT begin[], const ValueT * end)
+    {
+        for (; begin < end; ++begin) {
+            *begin = fmath::sin(*begin);
+        }
+    }
+
+    template <typename ValueT>
+    constexpr void fd1(ValueT begin[], const ValueT * end, ValueT d1[])
+    {
+        for (; begin < end; ++begin, ++d1) {
+            *d1 = fmath::cos(*begin);
+            *begin = fmath::sin(*begin);
+        }
+    }
+
+    template <typename ValueT>
+    constexpr void fd12(ValueT begin[], const ValueT * end, ValueT d1[], ValueT d2[])
+    {
+        for (; begin < end; ++begin, ++d1, ++d2) {
+            *d1 = fmath::cos(*begin);
+            *begin = fmath::sin(*begin);
+            *d2 = -(*begin);
+        }
+    }
+};
+} // actf
+
+#endif
@@ -0,0 +1,47 @@
+#ifndef QNETS_ACTF_FASTTANSIG_HPP
+#define QNETS_ACTF_FASTTANSIG_HPP
+
+#include "qnets/tool/FastMath.hpp"
+
+namespace actf
+{
+class FastTanSig // Tangens Sigmoid (tanh) Activation Function, vectorizable approximation (see FastMath.hpp)
+{
+public:
+    template <typename ValueT>
+    constexpr void f(ValueT begin[], const ValueT * end)
+    {
+        for (; begin < end; ++begin) {
+            *begin = fmath::tanh(*begin);
+        }
+    }
+
+    // the derivatives are computed from the same tanh value t, so that they are consistent with f
+
+    template <typename ValueT>
+    constexpr void fd1(ValueT begin[], const ValueT * end, ValueT d1[])
+    {
+        constexpr ValueT one = 1;
+        for (; begin < end; ++begin, ++d1) {
+            const ValueT t = fmath::tanh(*begin);
+            *begin = t; // f
+            *d1 = one - t*t; // d1 = 1 - tanh^2
+        }
+    }
+
+    template <typename ValueT>
+    constexpr void fd12(ValueT begin[], const ValueT * end, ValueT d1[], ValueT d2[])
+    {
+        constexpr ValueT one = 1, two = 2;
+        for (; begin < end; ++begin, ++d1, ++d2) {
+            const ValueT t = fmath::tanh(*begin);
+            const ValueT dt = one - t*t;
+            *begin = t; // f
+            *d1 = dt; // d1
+            *d2 = -two*t*dt; // d2 = -2 * tanh * (1 - tanh^2)
+        }
+    }
+};
+} // actf
+
+#endif
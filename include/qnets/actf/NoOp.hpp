@@ -15,14 +15,14 @@ public:
     template <typename ValueT>
     constexpr void fd1(ValueT begin[], const ValueT * end, ValueT d1[])
     {
-        std::fill(d1, d1 + (end - begin), 1.);
+        std::fill(d1, d1 + (end - begin), static_cast<ValueT>(1.));
     }
 
     template <typename ValueT>
     constexpr void fd12(ValueT begin[], const ValueT * end, ValueT d1[], ValueT d2[])
     {
-        std::fill(d1, d1 + (end - begin), 1.);
-        std::fill(d2, d2 + (end - begin), 0.);
+        std::fill(d1, d1 + (end - begin), static_cast<ValueT>(1.));
+        std::fill(d2, d2 + (end - begin), static_cast<ValueT>(0.));
     }
 };
 } // actf
@@ -12,8 +12,8 @@ public:
     constexpr void f(ValueT begin[], const ValueT * end)
     {
         for (; begin < end; ++begin) {
-            if (*begin < 0.) {
-                *begin = 0.;
+            if (*begin < 0) {
+                *begin = 0;
             }
         }
     }
@@ -22,12 +22,12 @@ public:
     constexpr void fd1(ValueT begin[], const ValueT * end, ValueT d1[])
     {
         for (; begin < end; ++begin, ++d1) {
-            if (*begin > 0.) {
-                *d1 = 1.;
+            if (*begin > 0) {
+                *d1 = 1;
             }
             else {
-                *begin = 0.;
-                *d1 = 0.;
+                *begin = 0;
+                *d1 = 0;
             }
         }
     }
@@ -36,14 +36,14 @@ public:
     constexpr void fd12(ValueT begin[], const ValueT * end, ValueT d1[], ValueT d2[])
     {
         for (; begin < end; ++begin, ++d1, ++d2) {
-            if (*begin > 0.) {
-                *d1 = 1.;
+            if (*begin > 0) {
+                *d1 = 1;
             }
             else {
-                *begin = 0.;
-                *d1 = 0.;
+                *begin = 0;
+                *d1 = 0;
             }
-            *d2 = 0.;
+            *d2 = 0;
         }
     }
 };
@@ -12,27 +12,29 @@ public:
     constexpr void f(ValueT begin[], const ValueT * end)
     {
         for (; begin < end; ++begin) {
-            *begin = log1p(exp(*begin)); // log(1+e^x)
+            *begin = std::log1p(std::exp(*begin)); // log(1+e^x)
         }
     }
 
     template <typename ValueT>
     constexpr void fd1(ValueT begin[], const ValueT * end, ValueT d1[])
     {
+        constexpr ValueT one = 1;
         for (; begin < end; ++begin, ++d1) {
-            *d1 = 1./(1. + exp(-(*begin))); // 1 / (1+e^-x)
-            *begin = log1p(exp(*begin)); // log(1+e^x)
+            *d1 = one/(one + std::exp(-(*begin))); // 1 / (1+e^-x)
+            *begin = std::log1p(std::exp(*begin)); // log(1+e^x)
         }
     }
 
     template <typename ValueT>
     constexpr void fd12(ValueT begin[], const ValueT * end, ValueT d1[], ValueT d2[])
     {
+        constexpr ValueT one = 1;
         for (; begin < end; ++begin, ++d1, ++d2) {
-            const double etimesmx = exp(-(*begin));
-            const double etimesmx1 = etimesmx + 1.;
-            *begin = log1p(exp(*begin)); // log(1+e^x)
-            *d1 = 1./etimesmx1; // 1 / (1+e^-x)
+            const ValueT etimesmx = std::exp(-(*begin));
+            const ValueT etimesmx1 = etimesmx + one;
+            *begin = std::log1p(std::exp(*begin)); // log(1+e^x)
+            *d1 = one/etimesmx1; // 1 / (1+e^-x)
             *d2 = etimesmx / (etimesmx1*etimesmx1); // e^-x/(1+e^-x)^2
         }
     }
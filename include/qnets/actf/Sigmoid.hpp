@@ -11,27 +11,30 @@ public:
     template <typename ValueT>
     constexpr void f(ValueT begin[], const ValueT * end)
     {
+        constexpr ValueT one = 1;
         for (; begin < end; ++begin) {
-            *begin = 1./(1. + exp(-(*begin)));
+            *begin = one/(one + std::exp(-(*begin)));
         }
     }
 
     template <typename ValueT>
     constexpr void fd1(ValueT begin[], const ValueT * end, ValueT d1[])
     {
+        constexpr ValueT one = 1;
         for (; begin < end; ++begin, ++d1) {
-            *begin = 1./(1. + exp(-(*begin))); // f
-            *d1 = *begin*(1. - *begin); // fd1
+            *begin = one/(one + std::exp(-(*begin))); // f
+            *d1 = *begin*(one - *begin); // fd1
         }
     }
 
     template <typename ValueT>
     constexpr void fd12(ValueT begin[], const ValueT * end, ValueT d1[], ValueT d2[])
     {
+        constexpr ValueT one = 1, two = 2;
         for (; begin < end; ++begin, ++d1, ++d2) {
-            *begin = 1./(1. + exp(-(*begin))); // f
-            *d1 = *begin*(1. - *begin); // fd1
-            *d2 = *d1*(1. - 2.*(*begin)); // fd2
+            *begin = one/(one + std::exp(-(*begin))); // f
+            *d1 = *begin*(one - *begin); // fd1
+            *d2 = *d1*(one - two*(*begin)); // fd2
         }
     }
 };
@@ -12,7 +12,7 @@ public:
     constexpr void f(ValueT begin[], const ValueT * end)
     {
         for (; begin < end; ++begin) {
-            *begin = sin(*begin);
+            *begin = std::sin(*begin);
         }
     }
 
@@ -20,8 +20,8 @@ public:
     constexpr void fd1(ValueT begin[], const ValueT * end, ValueT d1[])
     {
         for (; begin < end; ++begin, ++d1) {
-            *d1 = cos(*begin);
-            *begin = sin(*begin);
+            *d1 = std::cos(*begin);
+            *begin = std::sin(*begin);
         }
     }
 
@@ -29,9 +29,9 @@ public:
     constexpr void fd12(ValueT begin[], const ValueT * end, ValueT d1[], ValueT d2[])
     {
         for (; begin < end; ++begin, ++d1, ++d2) {
-            *d1 = cos(*begin);
-            *d2 = -sin(*begin);
-            *begin = sin(*begin);
+            *d1 = std::cos(*begin);
+            *d2 = -std::sin(*begin);
+            *begin = std::sin(*begin);
         }
     }
 };
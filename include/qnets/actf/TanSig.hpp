@@ -11,18 +11,20 @@ public:
     template <typename ValueT>
     constexpr void f(ValueT begin[], const ValueT * end)
     {
+        constexpr ValueT one = 1, two = 2;
         for (; begin < end; ++begin) {
-            *begin = 2.0/(1.0 + exp(-2.0*(*begin))) - 1.0;
+            *begin = two/(one + std::exp(-two*(*begin))) - one;
         }
     }
 
     template <typename ValueT>
     constexpr void fd1(ValueT begin[], const ValueT * end, ValueT d1[])
     {
+        constexpr ValueT one = 1, two = 2;
         for (; begin < end; ++begin, ++d1) {
-            const double expf = exp(-2.0*(*begin));
-            const double quot = 2.0/(1.0 + expf);
-            *begin = quot - 1.; // f
+            const ValueT expf = std::exp(-two*(*begin));
+            const ValueT quot = two/(one + expf);
+            *begin = quot - one; // f
             *d1 = expf * quot * quot; // d1 = 4 * exp(-2*in) / (1 + exp(-2*in))^2
         }
     }
@@ -30,13 +32,14 @@ public:
     template <typename ValueT>
     constexpr void fd12(ValueT begin[], const ValueT * end, ValueT d1[], ValueT d2[])
     {
+        constexpr ValueT one = 1, two = 2;
         for (; begin < end; ++begin, ++d1, ++d2) {
-            const double expf = exp(-2.0*(*begin));
-            const double quot = 2.0/(1.0 + expf);
-            const double prod = expf*quot;
-            *begin = quot - 1.; // f
+            const ValueT expf = std::exp(-two*(*begin));
+            const ValueT quot = two/(one + expf);
+            const ValueT prod = expf*quot;
+            *begin = quot - one; // f
             *d1 = expf * quot * quot; // d1
-            *d2 = 2.0*prod*quot*(prod - 1.0);  // d2 = 8 * exp(-2*in) / (1 + exp(-2*in))^2 * (2 * exp(-2*in) / (1 + exp(-2*in)) - 1)
+            *d2 = two*prod*quot*(prod - one);  // d2 = 8 * exp(-2*in) / (1 + exp(-2*in))^2 * (2 * exp(-2*in) / (1 + exp(-2*in)) - 1)
         }
     }
 };
@@ -11,6 +11,7 @@
 #include "qnets/poly/unit/NetworkUnit.hpp"
 
 #include <cstddef>
+#include <random>
 #include <string>
 #include <vector>
 
@@ -89,6 +90,7 @@ public:
     void setBeta(const int &ib, const double &beta);
     void setBeta(const double * beta);
     void randomizeBetas(); // has to be changed maybe if we add beta that are not "normal" weights
+    void randomizeBetas(std::mt19937_64 &rgen); // same, but reproducible for a given generator state
 
     // --- Manage the variational parameters (which may contain a subset of beta and/or non-beta parameters),
     //     which exist only after that they are assigned to actual parameters in the network (e.g. betas)
@@ -157,6 +159,12 @@ public:
 
     // --- Store FFNN on file
     void storeOnFile(const char * filename, bool store_betas = true) const;
+
+    // --- Store/load only the betas in the versioned binary weight format (see qnets/templ/BinaryWeights.hpp),
+    //     exchangeable with TemplNet. Requires a connected FFNN of INL, NNL and OUTL layers (no feature maps),
+    //     with one activation function per layer. Loading checks the stored shape.
+    void storeBetasOnBinaryFile(const char * filename) const;
+    void loadBetasFromBinaryFile(const char * filename);
 };
 
 
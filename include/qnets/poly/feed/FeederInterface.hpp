@@ -3,6 +3,7 @@
 
 #include "qnets/poly/serial/SerializableComponent.hpp"
 
+#include <random>
 #include <stdexcept>
 #include <string>
 #include <vector>
@@ -84,6 +85,7 @@ public:
 
     // Randomizers
     virtual void randomizeBeta() {}; // randomize beta intensities, do nothing since we default to no betas
+    virtual void randomizeBeta(std::mt19937_64 & /*rgen*/) {}; // same, but drawing from the passed generator (reproducible)
     virtual void randomizeParams() {}; // randomize extra parameters, again do nothing by default
     virtual void randomizeVP() {}; // randomize all assigned variational parameters
 };
@@ -33,6 +33,7 @@ public:
 
     // randomizer implementations
     void randomizeBeta() final;
+    void randomizeBeta(std::mt19937_64 &rgen) final;
 };
 
 #endif
@@ -50,6 +50,7 @@ public:
     // Randomizers
     // (we don't need any of them, since we don't have any auto-adjustable variables)
     void randomizeBeta() override {}
+    void randomizeBeta(std::mt19937_64 & /*rgen*/) override {}
     void randomizeParams() override {}
     void randomizeVP() override {}
 };
@@ -11,6 +11,8 @@ class FedLayer: public NetworkLayer
 protected:
     std::vector<FedUnit *> _U_fed; // stores pointers to all units with feeder
 
+    static int _omp_min_nunits; // layers with at least this many units (incl. offset) are computed in parallel (if compiled with OPENMP)
+
     void _registerUnit(NetworkUnit * newUnit); // check if newUnit is a/derived from FedUnit and register
 
 public:
@@ -49,6 +51,10 @@ public:
 
     // --- Computation 
     void computeValues() override; // overriding to add OMP pragma
+
+    // set the layer size threshold of the OMP parallel computation (global, default 3; see bench_omp_scaling)
+    static void setOMPMinNUnits(const int &nunits) { _omp_min_nunits = nunits; }
+    static int getOMPMinNUnits() { return _omp_min_nunits; }
 };
 
 #endif
@@ -0,0 +1,83 @@
+#ifndef FFNN_TRAIN_NNOPTIMIZER_HPP
+#define FFNN_TRAIN_NNOPTIMIZER_HPP
+
+#include <cmath>
+#include <stdexcept>
+#include <vector>
+
+// Gradient based optimizer steps, shared by the mini-batch trainers (NNTrainerSGD and templ::TemplTrainer)
+
+enum class OptMethod { SGD, Momentum, Adam };
+
+struct OptimizerConfig
+{
+    OptMethod method = OptMethod::Adam;
+    double learning_rate = 1.e-3;
+    double momentum = 0.9; // momentum factor (Momentum)
+    double beta1 = 0.9, beta2 = 0.999, epsilon = 1.e-8; // moment decay rates and denominator offset (Adam)
+    int batch_size = 32; // mini-batch size (<= 0 or > ntraining -> full batch)
+    int nworkers = 0; // number of gradient workers, i.e. per-thread buffers/replicas (0 -> number of OpenMP threads)
+    unsigned long seed = 1337; // seed for the mini-batch shuffling
+};
+
+// Applies the update steps of OptimizerConfig::method and holds the optimizer state (moments and step count)
+class NNOptimizer
+{
+private:
+    const OptimizerConfig _oconfig;
+    std::vector<double> _mom1, _mom2;
+    long _nsteps = 0;
+
+public:
+    explicit NNOptimizer(const OptimizerConfig &oconfig): _oconfig(oconfig) {}
+
+    const OptimizerConfig &getConfig() const { return _oconfig; }
+    long getNSteps() const { return _nsteps; }
+
+    // reset the moments, the next step is a first step again
+    void reset()
+    {
+        _mom1.clear();
+        _mom2.clear();
+        _nsteps = 0;
+    }
+
+    // apply one step with the loss gradient grad[0..n) to betas[0..n) (n must not change until reset)
+    template <typename T>
+    void step(const double grad[], T betas[], const int n)
+    {
+        if (_nsteps == 0) {
+            _mom1.assign(n, 0.);
+            _mom2.assign(n, 0.);
+        }
+        else if (static_cast<int>(_mom1.size()) != n) {
+            throw std::invalid_argument("[NNOptimizer::step] Number of parameters changed without reset.");
+        }
+        ++_nsteps;
+        const double lr = _oconfig.learning_rate;
+        switch (_oconfig.method) {
+        case OptMethod::SGD:
+            for (int k = 0; k < n; ++k) {
+                betas[k] = static_cast<T>(betas[k] - lr*grad[k]);
+            }
+            break;
+        case OptMethod::Momentum:
+            for (int k = 0; k < n; ++k) {
+                _mom1[k] = _oconfig.momentum*_mom1[k] + grad[k];
+                betas[k] = static_cast<T>(betas[k] - lr*_mom1[k]);
+            }
+            break;
+        case OptMethod::Adam:
+            const double bc1 = 1. - std::pow(_oconfig.beta1, static_cast<double>(_nsteps));
+            const double bc2 = 1. - std::pow(_oconfig.beta2, static_cast<double>(_nsteps));
+            for (int k = 0; k < n; ++k) {
+                _mom1[k] = _oconfig.beta1*_mom1[k] + (1. - _oconfig.beta1)*grad[k];
+                _mom2[k] = _oconfig.beta2*_mom2[k] + (1. - _oconfig.beta2)*grad[k]*grad[k];
+                betas[k] = static_cast<T>(betas[k] - lr*(_mom1[k]/bc1)/(std::sqrt(_mom2[k]/bc2) + _oconfig.epsilon));
+            }
+            break;
+        }
+    }
+};
+
+#endif
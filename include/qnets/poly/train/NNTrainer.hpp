@@ -6,7 +6,36 @@
 #include "qnets/poly/train/NNTrainingConfig.hpp"
 #include "qnets/poly/train/NNTrainingData.hpp"
 #include <cstddef> // NULL
+#include <random>
 #include <sstream>
+#include <vector>
+
+// expose the reduction helpers in details namespace, for testing
+namespace nn_trainer_details
+{
+// Data points per chunk of the reductions over the data. The chunks are fixed and their partial results are
+// merged in chunk order, so the results don't depend on the number of threads.
+constexpr int reduction_chunk = 256;
+
+// Minimum number of chunks per thread in computeResidual, where every additional thread propagates a copy of
+// the network. Below, the copies would cost more than they save, so fewer threads (or none) are used.
+constexpr int residual_min_chunks = 4;
+
+// single-pass statistics of the columns of data rows: moments (Welford) and bounds
+struct column_stats
+{
+    int n = 0; // number of rows
+    std::vector<double> mean, m2, lbound, ubound; // per column: mean, sum of squared deviations, min and max
+
+    explicit column_stats(int ncols = 0);
+    void add(const double * row); // add a row
+    void merge(const column_stats &other); // add the rows of other (Chan et al.)
+    double sigma(int icol) const; // sample standard deviation
+};
+
+// statistics of the columns [0, ncols) of the rows array[ifirst..ilast), threaded over chunks with OPENMP
+column_stats computeColumnStats(const double * const * array, int ifirst, int ilast, int ncols);
+} // namespace nn_trainer_details
 
 
 class NNTrainer
@@ -20,6 +49,9 @@ protected:
     const bool _flag_d1; // lambda_d1 > 0 ?
     const bool _flag_d2; // lambda_d2 > 0 ?
 
+    bool _flag_seed = false; // use _seed for bestFit (else a random seed per bestFit call)
+    std::mt19937_64::result_type _seed = 0; // fit ifit of bestFit draws initial betas from a generator seeded with _seed + ifit
+
     // return a copy of ffnn with enabled vderiv substrates
     FeedForwardNeuralNetwork * _createVDerivFFNN(FeedForwardNeuralNetwork * ffnn);
 
@@ -38,12 +70,23 @@ public:
     void setNormalization(FeedForwardNeuralNetwork * ffnn);
 
     // compute testing residual of ffnn vs testing data in _tdata (vs training+validation if no testing present)
+    // (with OPENMP the data points are evaluated in parallel on copies of ffnn, with a fixed reduction order,
+    // if there are at least residual_min_chunks chunks of data points per thread)
     double computeResidual(FeedForwardNeuralNetwork * ffnn, const bool &flag_r = false, const bool &flag_d = false);
 
     // find individual fit, to be implemented by child
     virtual void findFit(FeedForwardNeuralNetwork * ffnn, double * fit, double * err, const int &verbose = 0) = 0;
 
+    // set the seed of the bestFit restarts, making the initial betas (except smart betas) reproducible
+    void setSeed(std::mt19937_64::result_type seed)
+    {
+        _seed = seed;
+        _flag_seed = true;
+    }
+
     // find best fit from a number of nfits fits
+    // (with OPENMP the fits run concurrently on copies of ffnn. The best fit is the one of lowest
+    // unregularized residual, lowest index on ties, among the fits up to the first one meeting resi_target)
     void bestFit(FeedForwardNeuralNetwork * ffnn, double * bestfit, double * bestfit_err, const int &nfits, const double &resi_target = 0., const int &verbose = 0, const bool &flag_smart_beta = false); // fits NN and provides best betas with errors in bestfit(_err)
     void bestFit(FeedForwardNeuralNetwork * ffnn, const int &nfits, const double &resi_target = 0., const int &verbose = 0, const bool &flag_smart_beta = false); // fits NN and uses internal bestfit(_err) arrays
 
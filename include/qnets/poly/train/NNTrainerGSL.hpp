@@ -8,6 +8,9 @@
 
 #include <gsl/gsl_multifit_nlinear.h>
 
+#include <future>
+#include <vector>
+
 // expose the numerous hidden functions in details namespace, for testing
 namespace nn_trainer_gsl_details
 {
@@ -17,9 +20,27 @@ struct training_workspace: public NNTrainingData, public NNTrainingConfig
     FeedForwardNeuralNetwork * ffnn = nullptr; // Storing a pointer to the to-be-trained FFNN
     FeedForwardNeuralNetwork * ffnn_vderiv = nullptr; // Storing a pointer to the to-be-trained FFNN with vderivs
 
-    // validation residuals
+    // network replicas for the additional threads of the data-parallel residual evaluation
+    // (thread 0 uses ffnn/ffnn_vderiv, thread i > 0 the replicas [i - 1])
+    std::vector<FeedForwardNeuralNetwork *> ffnn_replicas;
+    std::vector<FeedForwardNeuralNetwork *> ffnn_vderiv_replicas;
+
+    // validation residuals (written by ffnn_f only if set, findFit computes them via calcFVali instead)
     gsl_vector * fvali = nullptr;
 
+    // validation schedule of the drivers: evaluate the validation residual every vali_interval-th accepted iteration,
+    // in a background thread with the (otherwise unused) network copy ffnn_vali, if set
+    int vali_interval = 1;
+    FeedForwardNeuralNetwork * ffnn_vali = nullptr;
+
+    // propagation cache of the values (O(ndata) memory), keyed on the betas, so that ffnn_f calls at the betas of the
+    // previous ffnn_f/ffnn_df call don't propagate again (ffnn_df fills it for free, but always propagates itself)
+    std::vector<double> cache_betas; // betas of the cached values (empty if invalid)
+    int cache_nvalues = 0; // number of data points with cached values (training first, then validation)
+    std::vector<double> cache_values; // per data point: yndim outputs, yndim*xndim d1, yndim*xndim d2
+
+    int nblock_entries = 1 << 20; // normal equation mode: max. number of Jacobian entries per block (at least one data point per thread)
+
     // residual flags
     bool flag_r{};
     bool flag_d1{};
@@ -28,6 +49,19 @@ struct training_workspace: public NNTrainingData, public NNTrainingConfig
     void copyData(const NNTrainingData &tdata);
     void copyConfig(const NNTrainingConfig &tconfig);
     void copyDatConf(const NNTrainingData &tdata, const NNTrainingConfig &tconfig);
+
+    // create/delete the replicas (copies of ffnn/ffnn_vderiv), for evaluation with nthreads threads
+    void createReplicas(int nthreads);
+    void deleteReplicas();
+
+    // values per data point in the cache, vderivs per data point (see storeValues/storeVDerivs)
+    int getCacheValueStride() const { return yndim*(1 + 2*xndim); }
+    int getVDerivStride() const { return yndim*ffnn_vderiv->getNVariationalParameters()*(1 + 2*xndim); }
+    void invalidateCache(); // call if the networks were changed in other ways than via ffnn_f/ffnn_df
+
+    int getNThreads() const { return 1 + static_cast<int>(ffnn_replicas.size()); }
+    FeedForwardNeuralNetwork * getFFNN(int ithread) const { return ithread > 0 ? ffnn_replicas[ithread - 1] : ffnn; }
+    FeedForwardNeuralNetwork * getFFNNVDeriv(int ithread) const { return ithread > 0 ? ffnn_vderiv_replicas[ithread - 1] : ffnn_vderiv; }
 };
 
 // helpers
@@ -38,7 +72,29 @@ void calcCosts(const gsl_vector * f, double &chi, double &chisq, const gsl_vecto
 void calcCosts(gsl_multifit_nlinear_workspace * w, double &chi, double &chisq, const gsl_vector * fvali, double &chi_vali, double &chisq_vali);
 void calcFitErr(gsl_multifit_nlinear_workspace * w, double * fit, double * err, const int &ndata, const int &npar, const double &chisq);
 
-// common residual functions
+// store output/d1/d2 (getCacheValueStride() values) and vd1/cd1/cd2 (getVDerivStride() values) of a propagated ffnn
+void storeValues(FeedForwardNeuralNetwork * ffnn, const training_workspace * tws, double * values);
+void storeVDerivs(FeedForwardNeuralNetwork * ffnn, const training_workspace * tws, int npar, double * vderivs);
+
+// propagate the data points which are not yet cached for betas and cache the results
+// (if the workspace has replicas, the data points are split into getNThreads() contiguous chunks,
+// which are evaluated in parallel when compiled with OPENMP)
+void cacheValues(const gsl_vector * betas, training_workspace * tws, int npoints);
+
+// residual rows (f) and Jacobian rows (J, row-major with npar columns and leading dimension ldj) of the data point i,
+// computed from its stored values/vderivs (see storeValues/storeVDerivs). Both write calcNData(1, yndim, 0, flag_d ? xndim : 0) rows.
+void calcPointResiduals(const training_workspace * tws, int i, const double * values, double scale, bool flag_d, double * f);
+void calcPointJacobian(const training_workspace * tws, int i, const double * vderivs, double scale, bool flag_d, int ldj, double * J);
+
+// validation residual rows of the drivers: calcFVali writes the rows of fvali like ffnn_f (incl. regularization if flag_r),
+// evalValiResidual returns the unregularized |fvali|, either from the cache or propagated with ffnn (the cache is untouched)
+void calcFVali(const gsl_vector * betas, training_workspace * tws, gsl_vector * fvali, bool flag_r, bool flag_d);
+double evalValiResidual(const gsl_vector * betas, training_workspace * tws, bool flag_d);
+double evalValiResidual(const std::vector<double> &betas, const training_workspace * tws, FeedForwardNeuralNetwork * ffnn, bool flag_d);
+
+// common residual functions (ffnn_f computed from the value cache, ffnn_df writes the Jacobian rows directly
+// from the propagating threads). Afterwards tws->ffnn holds the betas, even if ffnn_f was served from the cache
+// (the state of ffnn_vderiv and of the replicas is unspecified).
 int ffnn_f(const gsl_vector * betas, training_workspace * tws, gsl_vector * f, bool flag_r, bool flag_d);
 int ffnn_df(const gsl_vector * betas, training_workspace * tws, gsl_matrix * J, bool flag_r, bool flag_d);
 
@@ -52,9 +108,47 @@ int ffnn_df_pure_reg(const gsl_vector * betas, void * tws, gsl_matrix * J);
 int ffnn_f_deriv_reg(const gsl_vector * betas, void * tws, gsl_vector * f);
 int ffnn_df_deriv_reg(const gsl_vector * betas, void * tws, gsl_matrix * J);
 
+// Validation residuals for the early stopping of the drivers, evaluated every tws->vali_interval-th accepted iteration
+// (so trial steps never pay for them). With tws->ffnn_vali set, the evaluation runs in a background thread while the
+// driver continues, and its result is returned at the next scheduled iteration instead (i.e. it lags one interval).
+class validation_scheduler
+{
+private:
+    training_workspace * const _tws;
+    const bool _flag_d;
+    std::vector<double> _betas; // betas of the pending background evaluation
+    std::future<double> _pending;
+
+public:
+    validation_scheduler(training_workspace * tws, bool flag_d): _tws(tws), _flag_d(flag_d) {}
+    ~validation_scheduler() { wait(); }
+
+    // call after every accepted iteration iter (counting from 1) at betas, returns true if resi_vali holds a new result
+    bool update(const gsl_vector * betas, int iter, double &resi_vali);
+    void wait(); // wait for a pending background evaluation (its result is dropped)
+};
+
 // driver routines
-void printStepInfo(const gsl_multifit_nlinear_workspace * w, const training_workspace * tws, const int &status);
-void earlyStopDriver(gsl_multifit_nlinear_workspace * w, const training_workspace * tws, const int &verbose, int &status, int &info);
+void printStepInfo(const gsl_multifit_nlinear_workspace * w, double resi_vali, const int &status); // resi_vali < 0: not evaluated
+bool checkEarlyStop(double resi_vali, const training_workspace * tws, const int &verbose, double &bestvali, int &count_novali, int &info); // true if we should stop
+void earlyStopDriver(gsl_multifit_nlinear_workspace * w, training_workspace * tws, const int &verbose, int &status, int &info);
+
+// native dense linear algebra of the normal equation mode (row-major matrices with leading dimension ld*, lower triangles,
+// threaded with OPENMP, results independent of the number of threads)
+void syrkLowerT(const double * JT, int npar, int nrow, int ldj, double * A, int lda); // A += JT JT^T, JT is npar x nrow
+void gemvT(const double * JT, int npar, int nrow, int ldj, const double * f, double * JTf); // JTf += JT f
+bool choleskyDecomp(double * A, int n, int lda); // blocked, in place A = L L^T, false if not positive definite
+void choleskySolve(const double * L, int n, int lda, const double * b, double * x); // solve L L^T x = b
+void choleskyInverseDiag(const double * L, int n, int lda, double * diag); // diagonal of (L L^T)^-1
+
+// normal equation mode: instead of the ntrain x npar Jacobian, only J^T J and J^T f are stored (npar x npar),
+// accumulated over blocks of training points (of at most tws->nblock_entries Jacobian entries)
+double calcChisq(const gsl_vector * betas, training_workspace * tws, bool flag_r, bool flag_d, double &resi_vali); // returns training chisq, resi_vali is w/o regularization
+double calcChisq(const gsl_vector * betas, training_workspace * tws, bool flag_r, bool flag_d); // training chisq only (trial steps)
+double accumulateNormalEq(const gsl_vector * betas, training_workspace * tws, gsl_matrix * JTJ, gsl_vector * JTf, bool flag_r, bool flag_d); // lower triangle of JTJ, returns chisq
+void normalEqDriver(gsl_vector * x, training_workspace * tws, gsl_matrix * JTJ, const int &verbose, int &status, int &info, double &chisq); // LM with early stopping, JTJ and tws->ffnn at final x
+bool calcNormalEqFitErr(gsl_matrix * JTJ, double * err, const int &ndata, const double &chisq); // fit errors from lower triangle of JTJ (overwritten), false if singular
+void normalEqFit(training_workspace * tws, double * fit, double * err, const int &verbose); // the normal equation equivalent of findFit
 } // namespace nn_trainer_gsl_details
 
 // actual class
@@ -62,11 +156,28 @@ class NNTrainerGSL: public NNTrainer
 {
 protected:
     const gsl_multifit_nlinear_parameters _gsl_params; // to fine tune the gsl multifit algorithm, defaults to gsl default
+    bool _flag_normal_eq = false; // use the normal equation mode instead of GSL's multifit solver
+    int _vali_interval = 1; // evaluate the validation residual every _vali_interval-th iteration
+    bool _flag_vali_async = false; // ... in a background thread
 public:
     NNTrainerGSL(const NNTrainingData &tdata, const NNTrainingConfig &tconfig, const gsl_multifit_nlinear_parameters &gsl_params = gsl_multifit_nlinear_default_parameters()):
             NNTrainer(tdata, tconfig), _gsl_params(gsl_params) {}
     ~NNTrainerGSL() override = default;
 
+    // Enable the normal equation mode, a native Levenberg-Marquardt solver which accumulates J^T J and J^T f blockwise,
+    // i.e. needs memory ~npar^2 instead of ~ndata*npar (for large data sets and nets). It uses its own threaded linear
+    // algebra (no GSL calls in the inner loop) and reports the same fit statistics. _gsl_params are not used then.
+    void setNormalEquationMode(bool flag_normal_eq) { _flag_normal_eq = flag_normal_eq; }
+    bool hasNormalEquationMode() const { return _flag_normal_eq; }
+
+    // Evaluate the validation residual (for early stopping) only every vali_interval-th iteration, optionally in a
+    // background thread with its own network copy. Then the early stopping acts on the result of the previous
+    // evaluation, i.e. up to one interval late. Note that tconfig.maxn_novali counts validation evaluations.
+    // With OPENMP the background thread evaluates serially (one OpenMP thread), to not compete with the fit.
+    void setValidationInterval(int vali_interval, bool flag_async = false);
+    int getValidationInterval() const { return _vali_interval; }
+    bool hasAsyncValidation() const { return _flag_vali_async; }
+
     // we implement findFit
     void findFit(FeedForwardNeuralNetwork * ffnn, double * fit, double * err, const int &verbose = 0) override;
 };
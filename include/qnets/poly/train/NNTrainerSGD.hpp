@@ -0,0 +1,55 @@
+#ifndef FFNN_TRAIN_NNTRAINERSGD_HPP
+#define FFNN_TRAIN_NNTRAINERSGD_HPP
+
+#include "qnets/poly/FeedForwardNeuralNetwork.hpp"
+#include "qnets/poly/train/NNTrainer.hpp"
+#include "qnets/poly/train/NNTrainerGSL.hpp"
+#include "qnets/poly/train/NNOptimizer.hpp"
+#include "qnets/poly/train/NNTrainingConfig.hpp"
+#include "qnets/poly/train/NNTrainingData.hpp"
+
+#include <vector>
+
+// expose the hidden functions in details namespace, for testing
+namespace nn_trainer_sgd_details
+{
+using nn_trainer_gsl_details::training_workspace;
+
+// Loss gradient (2 J^T f, incl. regularization) over the training points idx[0..nb), for the variational
+// parameters betas. The residual rows are the ones of NNTrainerGSL, scaled by 1/sqrt(nb), i.e. the returned
+// loss (chisq) is an estimate of the full training chisq. If the workspace has replicas, the points are split
+// into getNThreads() contiguous chunks, reduced in thread order. grad_buf holds the per-thread gradients and
+// scratch rows, it is sized on the first call and may be reused for all batches.
+double calcBatchGradient(const double * betas, training_workspace * tws, const int * idx, int nb, bool flag_d, std::vector<double> &grad_buf, double * grad);
+
+// chisq w/o regularization over the data points [ifirst, ifirst + n), with the residual rows of NNTrainerGSL scaled
+// by 1/sqrt(n). The points are streamed through the replicas (resi_buf holds the per-thread sums and scratch rows).
+double calcRangeChisq(const double * betas, training_workspace * tws, int ifirst, int n, bool flag_d, std::vector<double> &resi_buf);
+
+// unregularized validation residual (as in NNTrainerGSL) for the variational parameters betas
+double calcValiResidual(const double * betas, training_workspace * tws, bool flag_d, std::vector<double> &resi_buf);
+} // namespace nn_trainer_sgd_details
+
+// Mini-batch stochastic trainer (SGD, momentum SGD or Adam, see NNOptimizer), minimizing the same cost as NNTrainerGSL
+// (incl. derivative and regularization terms). Every step of tconfig.maxn_steps is an epoch over the shuffled
+// training data (the incomplete last batch is dropped), followed by the validation based early stopping of
+// NNTrainerGSL. The returned fit is the one with the lowest validation residual (the last one without validation).
+// All data points are streamed, so the memory doesn't depend on the number of data points. The final fit
+// errors are computed from the normal equations, accumulated in blocks (memory ~npar^2).
+class NNTrainerSGD: public NNTrainer
+{
+protected:
+    const OptimizerConfig _oconfig;
+public:
+    NNTrainerSGD(const NNTrainingData &tdata, const NNTrainingConfig &tconfig, const OptimizerConfig &oconfig = OptimizerConfig{}):
+            NNTrainer(tdata, tconfig), _oconfig(oconfig) {}
+    ~NNTrainerSGD() override = default;
+
+    const OptimizerConfig &getOptimizerConfig() const { return _oconfig; }
+
+    // we implement findFit
+    void findFit(FeedForwardNeuralNetwork * ffnn, double * fit, double * err, const int &verbose = 0) override;
+};
+
+
+#endif
@@ -2,6 +2,7 @@
 #define FFNN_TRAIN_NNTRAININGDATA_HPP
 
 #include <cstddef> // NULL
+#include <cstdint>
 
 // holds the required information for cost function and gradient calculation
 struct NNTrainingData
@@ -17,65 +18,143 @@ struct NNTrainingData
     double *** yd2; // second derivative data, shape (ndata, yndim, xndim)
     double ** w; // sqrt of y data weights, i.e. 1/e_i , where e_i is the error on ith data !!! NOT 1/e_i^2 !!!
 
+    // Contiguous storage behind the views above, if allocated by allocate(). Every array is a single
+    // row-major block (e.g. x[i][k] == xdata[i*xndim + k]), starting at a cache line boundary, so the
+    // data can be filled/streamed with memcpy and residual loops walk through memory linearly.
+    double * storage = nullptr; // the owned allocation (nullptr if the arrays were allocated by the user)
+    double * xdata = nullptr; // shape (ndata, xndim)
+    double * ydata = nullptr; // shape (ndata, yndim)
+    double * yd1data = nullptr; // shape (ndata, yndim, xndim), nullptr if not allocated
+    double * yd2data = nullptr; // shape (ndata, yndim, xndim), nullptr if not allocated
+    double * wdata = nullptr; // shape (ndata, yndim)
+
+    static constexpr int ALIGN_NDOUBLE = 8; // alignment of the blocks (in doubles, i.e. 64 bytes)
+
     void allocate(const bool flag_d1 = false, const bool flag_d2 = false) // allocate data arrays
     {
         deallocate(); // prevent user from producing memleaks
 
-        x = new double * [ndata];
-        y = new double * [ndata];
-        w = new double * [ndata];
+        // sizes of the blocks, rounded up to the alignment
+        const size_t nx = alignedSize(static_cast<size_t>(ndata)*xndim);
+        const size_t ny = alignedSize(static_cast<size_t>(ndata)*yndim);
+        const size_t nyd = alignedSize(static_cast<size_t>(ndata)*yndim*xndim);
+        storage = new double[nx + 2*ny + (flag_d1 ? nyd : 0) + (flag_d2 ? nyd : 0) + ALIGN_NDOUBLE - 1]();
+
+        double * next = _alignPointer(storage);
+        xdata = next;
+        next += nx;
+        ydata = next;
+        next += ny;
+        wdata = next;
+        next += ny;
         if (flag_d1) {
-            yd1 = new double ** [ndata];
+            yd1data = next;
+            next += nyd;
         }
         if (flag_d2) {
-            yd2 = new double ** [ndata];
+            yd2data = next;
         }
-        for (int i = 0; i < ndata; ++i) {
-            x[i] = new double[xndim];
-            y[i] = new double[yndim];
-            w[i] = new double[yndim];
-            if (flag_d1) {
-                yd1[i] = new double * [yndim];
-            }
-            if (flag_d2) {
-                yd2[i] = new double * [yndim];
-            }
-            for (int j = 0; j < yndim; ++j) {
-                if (flag_d1) {
-                    yd1[i][j] = new double[xndim];
-                }
-                if (flag_d2) {
-                    yd2[i][j] = new double[xndim];
+
+        createViews(flag_d1, flag_d2);
+    }
+
+    void deallocate() // deallocate data arrays
+    {
+        if (storage != nullptr) { // views into our contiguous storage
+            deleteViews();
+            delete[] storage;
+        }
+        else { // arrays allocated per row (e.g. by the user)
+            for (int i = 0; i < ndata; ++i) {
+                if (x != nullptr) { delete[] x[i]; }
+                if (y != nullptr) { delete[] y[i]; }
+                if (w != nullptr) { delete[] w[i]; }
+                for (int j = 0; j < yndim; ++j) {
+                    if (yd1 != nullptr) { delete[] yd1[i][j]; }
+                    if (yd2 != nullptr) { delete[] yd2[i][j]; }
                 }
+                if (yd1 != nullptr) { delete[] yd1[i]; }
+                if (yd2 != nullptr) { delete[] yd2[i]; }
             }
         }
+        delete[] x;
+        delete[] y;
+        delete[] w;
+        delete[] yd1;
+        delete[] yd2;
+
+        x = nullptr;
+        y = nullptr;
+        w = nullptr;
+        yd1 = nullptr;
+        yd2 = nullptr;
+        storage = nullptr;
+        xdata = nullptr;
+        ydata = nullptr;
+        yd1data = nullptr;
+        yd2data = nullptr;
+        wdata = nullptr;
     }
 
-    void deallocate() // deallocate data arrays
+    // create the pointer views x, y, w (and yd1/yd2 if flagged) into the blocks xdata, ydata, wdata (yd1data/yd2data),
+    // which may also point to external memory (e.g. a memory mapped file, see NNTrainingDataFile.hpp)
+    void createViews(const bool flag_d1 = false, const bool flag_d2 = false)
     {
+        x = new double * [ndata];
+        y = new double * [ndata];
+        w = new double * [ndata];
+        if (flag_d1) {
+            yd1 = _createDerivView(yd1data);
+        }
+        if (flag_d2) {
+            yd2 = _createDerivView(yd2data);
+        }
         for (int i = 0; i < ndata; ++i) {
-            if (x != nullptr) { delete[] x[i]; }
-            if (y != nullptr) { delete[] y[i]; }
-            if (w != nullptr) { delete[] w[i]; }
-            for (int j = 0; j < yndim; ++j) {
-                if (yd1 != nullptr) { delete[] yd1[i][j]; }
-                if (yd2 != nullptr) { delete[] yd2[i][j]; }
-            }
-            if (yd1 != nullptr) { delete[] yd1[i]; }
-            if (yd2 != nullptr) { delete[] yd2[i]; }
+            x[i] = xdata + static_cast<size_t>(i)*xndim;
+            y[i] = ydata + static_cast<size_t>(i)*yndim;
+            w[i] = wdata + static_cast<size_t>(i)*yndim;
         }
+    }
+
+    void deleteViews() // delete views created by createViews (but not the blocks)
+    {
+        if (yd1 != nullptr && ndata > 0) { delete[] yd1[0]; }
+        if (yd2 != nullptr && ndata > 0) { delete[] yd2[0]; }
         delete[] x;
         delete[] y;
         delete[] w;
         delete[] yd1;
         delete[] yd2;
-
         x = nullptr;
         y = nullptr;
         w = nullptr;
         yd1 = nullptr;
         yd2 = nullptr;
     }
+
+    static size_t alignedSize(const size_t n) { return ((n + ALIGN_NDOUBLE - 1)/ALIGN_NDOUBLE)*ALIGN_NDOUBLE; } // n rounded up to the block alignment
+
+private:
+    static double * _alignPointer(double * const ptr)
+    {
+        const auto addr = reinterpret_cast<std::uintptr_t>(ptr);
+        const std::uintptr_t align = ALIGN_NDOUBLE*sizeof(double);
+        return reinterpret_cast<double *>(((addr + align - 1)/align)*align);
+    }
+
+    double *** _createDerivView(double * const block) const // (ndata, yndim) pointer view into a derivative block
+    {
+        auto *** const view = new double ** [ndata];
+        if (ndata < 1) { return view; }
+        auto ** const rows = new double * [static_cast<size_t>(ndata)*yndim]; // deleted via view[0]
+        for (int i = 0; i < ndata; ++i) {
+            view[i] = rows + static_cast<size_t>(i)*yndim;
+            for (int j = 0; j < yndim; ++j) {
+                view[i][j] = block + (static_cast<size_t>(i)*yndim + j)*xndim;
+            }
+        }
+        return view;
+    }
 };
 
 #endif
@@ -0,0 +1,65 @@
+#ifndef FFNN_TRAIN_NNTRAININGDATAFILE_HPP
+#define FFNN_TRAIN_NNTRAININGDATAFILE_HPP
+
+#include "qnets/poly/train/NNTrainingData.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// --- Binary training data files
+//
+// On-disk format of NNTrainingData, which mirrors its contiguous blocks. Because every block starts
+// at a 64 byte aligned file offset, the file can be memory mapped and used in place (MappedTrainingData),
+// so no parsing happens at start-up and only the pages which are touched by the trainers are read.
+// The kernel streams the data blocks in and out of the page cache, i.e. data sets larger than the RAM
+// can be used (pair it with NNTrainerGSL::setNormalEquationMode, to avoid a full Jacobian in memory).
+//
+// Layout (native little endian):
+//   char[8]   magic "QNETSTD"
+//   uint32    version, uint32 endianness marker 0x01020304
+//   int32     ndata, ntraining, nvalidation, xndim, yndim, flags (bit 0: yd1 block, bit 1: yd2 block)
+//   zero padding up to 64 bytes
+//   double    x (ndata, xndim), y (ndata, yndim), w (ndata, yndim), [yd1 (ndata, yndim, xndim)], [yd2 (ndata, yndim, xndim)]
+// where every block is zero padded to a multiple of NNTrainingData::ALIGN_NDOUBLE doubles.
+
+constexpr uint32_t training_data_file_version = 1;
+
+// write tdata to file (tdata may be allocated by NNTrainingData::allocate or per row by the user,
+// yd1/yd2 blocks are written if the respective arrays are present). Throws std::invalid_argument,
+// without writing, if the data counts are invalid (e.g. ntraining + nvalidation > ndata).
+void storeTrainingData(const std::string &filename, const NNTrainingData &tdata);
+
+// read a file written by storeTrainingData into tdata, which is (re)allocated
+// (the blocks are read directly into the contiguous storage of tdata). Throws std::invalid_argument,
+// leaving tdata untouched, if the header is invalid or doesn't match the file size.
+void loadTrainingData(const std::string &filename, NNTrainingData &tdata);
+
+// Read-only memory mapped training data file, usable in place of an allocated NNTrainingData.
+// The pointer views of getData() point into the mapping, so they are valid as long as the
+// MappedTrainingData object exists. The data is only accessible as const (it must not be modified
+// or deallocated), only the data split can be changed via setDataSplit().
+class MappedTrainingData
+{
+private:
+    void * _map = nullptr;
+    size_t _size = 0;
+    NNTrainingData _tdata{};
+
+public:
+    explicit MappedTrainingData(const std::string &filename);
+    ~MappedTrainingData();
+
+    MappedTrainingData(const MappedTrainingData &) = delete;
+    MappedTrainingData &operator=(const MappedTrainingData &) = delete;
+
+    const NNTrainingData &getData() const { return _tdata; }
+
+    // change the data split, before the data is passed to a trainer (throws std::invalid_argument if ntraining + nvalidation > ndata)
+    void setDataSplit(int ntraining, int nvalidation);
+
+    bool hasFirstDerivatives() const { return _tdata.yd1 != nullptr; }
+    bool hasSecondDerivatives() const { return _tdata.yd2 != nullptr; }
+};
+
+#endif
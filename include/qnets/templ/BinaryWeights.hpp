@@ -0,0 +1,124 @@
+#ifndef QNETS_TEMPL_BINARYWEIGHTS_HPP
+#define QNETS_TEMPL_BINARYWEIGHTS_HPP
+
+#include "qnets/actf/NoOp.hpp"
+#include "qnets/actf/Sigmoid.hpp"
+#include "qnets/actf/FastSigmoid.hpp"
+#include "qnets/actf/TanSig.hpp"
+#include "qnets/actf/FastTanSig.hpp"
+#include "qnets/actf/Sine.hpp"
+#include "qnets/actf/FastSine.hpp"
+#include "qnets/actf/ReLU.hpp"
+#include "qnets/actf/SRLU.hpp"
+#include "qnets/actf/FastSRLU.hpp"
+#include "qnets/actf/Exp.hpp"
+#include "qnets/actf/FastExp.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <istream>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace templ
+{
+// --- Versioned binary weight format
+//
+// Compiler independent storage of the weights of plain feed forward networks (TemplNet,
+// DynNet-like shapes and poly FeedForwardNeuralNetworks made of INL, NNL and OUTL layers).
+// The file contains an explicit shape descriptor (ninput, units and poly activation function
+// id per layer), the weights as doubles (in the common beta order, i.e. layer by layer, unit
+// by unit, offset weight first) and a checksum. Derivative configuration, precision and
+// shift/scale parameters are not part of the format.
+//
+// Layout (native little endian, every field 8 byte aligned):
+//   char[8]   magic "QNETSBW"
+//   uint32    version, uint32 endianness marker 0x01020304
+//   uint32    ninput, uint32 nlayer
+//   nlayer x  { uint32 nunits, char[12] actf id (zero padded) }
+//   uint64    nbeta
+//   uint64    checksum (64 bit FNV-1a over all header bytes before it and the weight bytes)
+//   double[nbeta] weights
+// Because the weights start 8 byte aligned, a memory mapped file can be read in place.
+// Readers reject files with more than binary_weights_max_nlayer layers or more than INT_MAX weights.
+
+constexpr uint32_t binary_weights_version = 1;
+constexpr uint32_t binary_weights_max_nlayer = 1024;
+
+struct WeightShape
+{
+    int ninput = 0;
+    std::vector<int> nunits; // units per layer (without offset units)
+    std::vector<std::string> actf_ids; // poly activation function id per layer (e.g. "LGS")
+
+    int getNLayer() const { return static_cast<int>(nunits.size()); }
+    int getNBeta() const; // throws std::invalid_argument if the count doesn't fit into int
+
+    bool operator==(const WeightShape &other) const { return ninput == other.ninput && nunits == other.nunits && actf_ids == other.actf_ids; }
+    bool operator!=(const WeightShape &other) const { return !(*this == other); }
+};
+
+// Map array activation functions to the poly activation function id
+// (the Fast variants are approximations of the same function and share the id)
+template <class ACTF>
+struct ActfPolyId;
+
+template <>
+struct ActfPolyId<actf::NoOp> { static std::string id() { return "ID"; } };
+template <>
+struct ActfPolyId<actf::Sigmoid> { static std::string id() { return "LGS"; } };
+template <>
+struct ActfPolyId<actf::FastSigmoid> { static std::string id() { return "LGS"; } };
+template <>
+struct ActfPolyId<actf::TanSig> { static std::string id() { return "TANS"; } };
+template <>
+struct ActfPolyId<actf::FastTanSig> { static std::string id() { return "TANS"; } };
+template <>
+struct ActfPolyId<actf::Sine> { static std::string id() { return "SIN"; } };
+template <>
+struct ActfPolyId<actf::FastSine> { static std::string id() { return "SIN"; } };
+template <>
+struct ActfPolyId<actf::ReLU> { static std::string id() { return "RELU"; } };
+template <>
+struct ActfPolyId<actf::SRLU> { static std::string id() { return "SRLU"; } };
+template <>
+struct ActfPolyId<actf::FastSRLU> { static std::string id() { return "SRLU"; } };
+template <>
+struct ActfPolyId<actf::Exp> { static std::string id() { return "EXP"; } };
+template <>
+struct ActfPolyId<actf::FastExp> { static std::string id() { return "EXP"; } };
+
+
+// 64 bit FNV-1a hash, continuing from hash
+uint64_t fnv1aHash(const void * data, size_t nbytes, uint64_t hash = 14695981039346656037ULL);
+
+// write/read the full format to/from stream (read throws on invalid header, version or checksum)
+void writeBinaryWeights(std::ostream &os, const WeightShape &shape, const double betas[]);
+WeightShape readBinaryWeights(std::istream &is, std::vector<double> &betas);
+
+void storeBinaryWeights(const std::string &filename, const WeightShape &shape, const double betas[]);
+
+// Read-only memory mapped weight file (the checksum is verified on construction)
+class MappedBinaryWeights
+{
+private:
+    void * _map = nullptr;
+    size_t _size = 0;
+    WeightShape _shape;
+    const double * _betas = nullptr;
+
+public:
+    explicit MappedBinaryWeights(const std::string &filename);
+    ~MappedBinaryWeights();
+
+    MappedBinaryWeights(const MappedBinaryWeights &) = delete;
+    MappedBinaryWeights &operator=(const MappedBinaryWeights &) = delete;
+
+    const WeightShape &getShape() const { return _shape; }
+    int getNBeta() const { return _shape.getNBeta(); }
+    const double * getBetas() const { return _betas; } // points into the mapping
+};
+} // templ
+
+#endif
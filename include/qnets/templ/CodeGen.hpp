@@ -0,0 +1,33 @@
+#ifndef QNETS_TEMPL_CODEGEN_HPP
+#define QNETS_TEMPL_CODEGEN_HPP
+
+#include "qnets/templ/DynNet.hpp"
+#include "qnets/templ/DerivConfig.hpp"
+
+#include <ostream>
+#include <string>
+
+namespace templ
+{
+// --- TemplNet code generation
+//
+// Emit a self-contained C++ header for the given (runtime) DynNet, which contains
+// inside of namespace net_name:
+//   - the matching TemplNet type (Net), with double precision and derivative config dconf
+//   - the weights as constexpr array (betas), with the input shift/scale folded into the first layer
+//   - constexpr output shift/scale arrays (folded into the last layer if the output actf
+//     is linear, in which case output_folded == true and the arrays are identity)
+//   - initNet(net) to set the weights and getOutput(net_or_state, i) to get the final output, with
+//     getD1/getD2/getVD1(net_or_state, i, j) for its derivatives (the net's own getters are not scaled)
+// NOTE: TemplNet owns its weights, so initNet copies the constexpr array into the net at runtime
+// (the propagation itself is not evaluated at compile time). The original DynNet is not changed.
+
+// map DynACTF/DerivConfig to the C++ source code name of the corresponding type/enum value
+std::string actfTypeName(DynACTF actf); // e.g. "actf::Sigmoid"
+std::string actfHeaderName(DynACTF actf); // e.g. "qnets/actf/Sigmoid.hpp"
+std::string derivConfigName(DerivConfig dconf); // e.g. "templ::DerivConfig::D12_VD1"
+
+void writeTemplNetHeader(std::ostream &os, const DynNet &dnet, const std::string &net_name, DerivConfig dconf = DerivConfig::OFF);
+} // templ
+
+#endif
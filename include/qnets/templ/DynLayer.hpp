@@ -0,0 +1,324 @@
+#ifndef QNETS_TEMPL_DYNLAYER_HPP
+#define QNETS_TEMPL_DYNLAYER_HPP
+
+#include "qnets/templ/DerivConfig.hpp"
+#include "qnets/actf/NoOp.hpp"
+#include "qnets/actf/Sigmoid.hpp"
+#include "qnets/actf/TanSig.hpp"
+#include "qnets/actf/Sine.hpp"
+#include "qnets/actf/ReLU.hpp"
+#include "qnets/actf/SRLU.hpp"
+#include "qnets/actf/Exp.hpp"
+
+#include <vector>
+#include <algorithm>
+#include <numeric>
+#include <string>
+#include <stdexcept>
+
+namespace templ
+{
+// --- DynNet Layers
+//
+// Runtime-sized counterpart of TemplLayer (see TemplLayer.hpp), used by DynNet.
+// The algorithms are the same as in TemplLayer, but all sizes are runtime values,
+// the activation function is selected at runtime (DynACTF) and the derivative
+// buffers are allocated according to a runtime "allocation" DynamicDFlags
+// (corresponding to the static DCONF of TemplLayer).
+// Like TemplLayer, the weights are not owned by the layer but passed in.
+
+// Enumeration of the supported array activation functions
+enum class DynACTF { NoOp, Sigmoid, TanSig, Sine, ReLU, SRLU, Exp };
+
+// Map poly activation function identifiers (as used in storeOnFile) to DynACTF
+inline DynACTF dynACTFFromPolyId(const std::string &actf_id)
+{
+    if (actf_id == "ID") { return DynACTF::NoOp; }
+    if (actf_id == "LGS") { return DynACTF::Sigmoid; }
+    if (actf_id == "TANS") { return DynACTF::TanSig; }
+    if (actf_id == "SIN") { return DynACTF::Sine; }
+    if (actf_id == "RELU") { return DynACTF::ReLU; }
+    if (actf_id == "SRLU") { return DynACTF::SRLU; }
+    if (actf_id == "EXP") { return DynACTF::Exp; }
+    throw std::invalid_argument("[dynACTFFromPolyId] Activation function \"" + actf_id + "\" has no array implementation.");
+}
+
+
+class DynLayer
+{
+private:
+    // sizes
+    int _orig_nin; // number of original net inputs
+    int _nin; // number of layer inputs
+    int _nout; // number of layer units
+    int _net_nout; // number of net outputs
+    DynamicDFlags _dconf; // allocated derivatives (like the static DCONF of TemplLayer)
+    DynACTF _actf;
+
+    // arrays
+    std::vector<double> _out;
+    std::vector<double> _d1, _d2; // forward-accumulated input derivatives
+    std::vector<double> _bd1, _bd2; // backprop values
+    std::vector<double> _ad1, _ad2; // activation function derivatives
+
+    // activation function dispatch
+    template <class ACTF>
+    void _activate(bool flag_ad1, bool flag_ad2)
+    {
+        ACTF actf{};
+        if (flag_ad2 && !_ad2.empty()) {
+            actf.fd12(_out.data(), _out.data() + _nout, _ad1.data(), _ad2.data());
+        }
+        else if (flag_ad1 && !_ad1.empty()) {
+            actf.fd1(_out.data(), _out.data() + _nout, _ad1.data());
+        }
+        else {
+            actf.f(_out.data(), _out.data() + _nout);
+        }
+    }
+
+    void _computeActivation(bool flag_ad1, bool flag_ad2 /*is overriding*/)
+    {
+        switch (_actf) {
+        case DynACTF::NoOp:
+            return _activate<actf::NoOp>(flag_ad1, flag_ad2);
+        case DynACTF::Sigmoid:
+            return _activate<actf::Sigmoid>(flag_ad1, flag_ad2);
+        case DynACTF::TanSig:
+            return _activate<actf::TanSig>(flag_ad1, flag_ad2);
+        case DynACTF::Sine:
+            return _activate<actf::Sine>(flag_ad1, flag_ad2);
+        case DynACTF::ReLU:
+            return _activate<actf::ReLU>(flag_ad1, flag_ad2);
+        case DynACTF::SRLU:
+            return _activate<actf::SRLU>(flag_ad1, flag_ad2);
+        case DynACTF::Exp:
+            return _activate<actf::Exp>(flag_ad1, flag_ad2);
+        }
+    }
+
+    void _computeFeed(const double input[], const double beta[])
+    {
+        int beta_i0 = 1; // increments through the indices of the first non-offset beta per unit
+        for (int i = 0; i < _nout; ++i, beta_i0 += _nin + 1) {
+            _out[i] = std::inner_product(input, input + _nin, beta + beta_i0, beta[beta_i0 - 1]/*bias weight*/);
+        }
+    }
+
+    void _computeOutput(const double input[], const double beta[], DynamicDFlags dflags)
+    {
+        this->_computeFeed(input, beta);
+        this->_computeActivation(dflags.needsAny(), dflags.d2() || dflags.vd2());
+    }
+
+    // forward-accumulate second order input derivatives from a layer
+    void _computeD2_Layer(const double in_d1[], const double in_d2[], const double beta[])
+    {
+        std::fill(_d1.begin(), _d1.end(), 0.);
+        std::fill(_d2.begin(), _d2.end(), 0.);
+        for (int i = 0; i < _nout; ++i) {
+            for (int j = 0; j < _nin; ++j) {
+                const double bij = beta[1 + i*(_nin + 1) + j];
+                for (int k = 0; k < _orig_nin; ++k) {
+                    _d1[i*_orig_nin + k] += bij*in_d1[j*_orig_nin + k];
+                    _d2[i*_orig_nin + k] += bij*in_d2[j*_orig_nin + k];
+                }
+            }
+            for (int l = i*_orig_nin; l < (i + 1)*_orig_nin; ++l) {
+                _d2[l] = _ad1[i]*_d2[l] + _ad2[i]*_d1[l]*_d1[l];
+                _d1[l] *= _ad1[i];
+            }
+        }
+    }
+
+    // forward-accumulate second order deriv when the inputs correspond to the true network inputs
+    void _computeD2_Input(const double beta[])
+    {
+        for (int i = 0; i < _nout; ++i) {
+            for (int j = 0; j < _nin; ++j) {
+                const double bij = beta[1 + i*(_nin + 1) + j];
+                _d1[i*_nin + j] = _ad1[i]*bij;
+                _d2[i*_nin + j] = _ad2[i]*bij*bij;
+            }
+        }
+    }
+
+    // continue backprop coming from a layer (first order version)
+    void _backwardLayerBD1(const double bd1_next[], const double beta_next[], int nout_next)
+    {
+        for (int i = 0; i < _net_nout; ++i) {
+            for (int j = 0; j < nout_next; ++j) {
+                const int beta_i0 = 1 + j*(_nout + 1);
+                for (int k = 0; k < _nout; ++k) {
+                    _bd1[i*_nout + k] += beta_next[beta_i0 + k]*bd1_next[i*nout_next + j];
+                }
+            }
+            for (int k = 0; k < _nout; ++k) {
+                _bd1[i*_nout + k] *= _ad1[k];
+            }
+        }
+    }
+
+    // continue backprop coming from a layer (first + second order version)
+    void _backwardLayerBD12(const double bd1_next[], const double bd2_next[], const double beta_next[], int nout_next)
+    {
+        for (int i = 0; i < _net_nout; ++i) {
+            const int d_i0 = i*_nout;
+            for (int j = 0; j < nout_next; ++j) {
+                for (int k = 0; k < _nout; ++k) {
+                    const double bjk = beta_next[1 + j*(_nout + 1) + k];
+                    _bd1[d_i0 + k] += bjk*bd1_next[i*nout_next + j];
+                    _bd2[d_i0 + k] += bjk*bjk*bd2_next[i*nout_next + j];
+                }
+            }
+            for (int k = 0; k < _nout; ++k) {
+                _bd2[d_i0 + k] = _ad1[k]*_ad1[k]*_bd2[d_i0 + k] + _ad2[k]*_bd1[d_i0 + k];
+                _bd1[d_i0 + k] *= _ad1[k];
+            }
+        }
+    }
+
+public:
+    DynLayer(int orig_nin, int nin, int nout, int net_nout, DynACTF actf, DynamicDFlags dconf):
+            _orig_nin(orig_nin), _nin(nin), _nout(nout), _net_nout(net_nout), _dconf(dconf), _actf(actf),
+            _out(nout),
+            _d1(dconf.d2() ? orig_nin*nout : 0), _d2(dconf.d2() ? orig_nin*nout : 0),
+            _bd1(dconf.needsBD1() ? net_nout*nout : 0), _bd2(dconf.needsBD2() ? net_nout*nout : 0),
+            _ad1(dconf.needsAny() ? nout : 0), _ad2((dconf.d2() || dconf.vd2()) ? nout : 0)
+    {
+        if (nin < 1 || nout < 1) {
+            throw std::invalid_argument("[DynLayer] Layers must have at least one input and one unit.");
+        }
+    }
+
+    // --- sizes and config
+    int ninput() const { return _nin; }
+    int noutput() const { return _nout; }
+    int size() const { return _nout; }
+    int nbeta() const { return (_nin + 1)*_nout; }
+    DynACTF getACTF() const { return _actf; }
+    void setACTF(DynACTF actf) { _actf = actf; }
+
+    // public const output references
+    const std::vector<double> &out() const { return _out; }
+    const std::vector<double> &d1() const { return _d1; }
+    const std::vector<double> &d2() const { return _d2; }
+    const std::vector<double> &bd1() const { return _bd1; }
+    const std::vector<double> &bd2() const { return _bd2; }
+    const std::vector<double> &ad1() const { return _ad1; }
+    const std::vector<double> &ad2() const { return _ad2; }
+
+
+    // --- Propagation of original input data (not layer)
+    void ForwardInput(const double input[], const double beta[], DynamicDFlags dflags)
+    {
+        if (_nin != _orig_nin) {
+            throw std::runtime_error("[DynLayer::ForwardInput] ninput != orig_ninput");
+        }
+        dflags = dflags.AND(_dconf); // AND allocated and dynamic conf
+        this->_computeOutput(input, beta, dflags);
+
+        // fill diagonal d1,d2
+        if (dflags.d2()) {
+            this->_computeD2_Input(beta);
+        }
+    }
+
+    // --- Forward Propagation of layer data or external source
+    void ForwardLayer(const double input[], const double in_d1[], const double in_d2[], const double beta[], DynamicDFlags dflags)
+    {
+        dflags = dflags.AND(_dconf);
+        this->_computeOutput(input, beta, dflags);
+
+        // input derivs
+        if (dflags.d2()) {
+            this->_computeD2_Layer(in_d1, in_d2, beta);
+        }
+    }
+
+    // --- Backward Propagation for an output layer
+    void BackwardOutput(DynamicDFlags dflags)
+    {
+        if (_nout != _net_nout) {
+            throw std::runtime_error("[DynLayer::BackwardOutput] noutput != net_noutput");
+        }
+        dflags = dflags.AND(_dconf);
+        std::fill(_bd1.begin(), _bd1.end(), 0.);
+        std::fill(_bd2.begin(), _bd2.end(), 0.);
+
+        // set the diagonal elements
+        if (!dflags.needsBD1()) { return; }
+        for (int i = 0; i < _net_nout; ++i) {
+            _bd1[i*_net_nout + i] = _ad1[i];
+        }
+        if (!dflags.needsBD2()) { return; }
+        for (int i = 0; i < _net_nout; ++i) {
+            _bd2[i*_net_nout + i] = _ad2[i];
+        }
+    }
+
+    // --- Backward Propagation for a hidden layer (nout_next is the number of units of the next layer)
+    void BackwardLayer(const double bd1_next[], const double bd2_next[], const double beta_next[], int nout_next, DynamicDFlags dflags)
+    {
+        dflags = dflags.AND(_dconf);
+        std::fill(_bd1.begin(), _bd1.end(), 0.);
+        std::fill(_bd2.begin(), _bd2.end(), 0.);
+        if (!dflags.needsBD1()) { return; }
+        if (dflags.needsBD2()) {
+            _backwardLayerBD12(bd1_next, bd2_next, beta_next, nout_next);
+        }
+        else {
+            _backwardLayerBD1(bd1_next, beta_next, nout_next);
+        }
+    }
+
+    // --- Calculate weight gradient block of output unit iout with respect to this layers' weights
+    void storeLayerVD1(const double input[], double vd1_block[], int iout, DynamicDFlags dflags) const
+    {
+        dflags = dflags.AND(_dconf);
+        if (!dflags.vd1()) { return; }
+        const double * const BD1_iout = _bd1.data() + iout*_nout;
+
+        for (int j = 0; j < _nout; ++j) {
+            *vd1_block++ = BD1_iout[j]; // bias weight gradient
+            for (int k = 0; k < _nin; ++k, ++vd1_block) {
+                *vd1_block = input[k]*BD1_iout[j];
+            }
+        }
+    }
+
+    void storeLayerVD2(const double input[], double vd2_block[], int iout, DynamicDFlags dflags) const
+    {
+        dflags = dflags.AND(_dconf);
+        if (!dflags.vd2()) { return; }
+        const double * const BD2_iout = _bd2.data() + iout*_nout;
+
+        for (int j = 0; j < _nout; ++j) {
+            *vd2_block++ = BD2_iout[j]; // bias weight gradient
+            for (int k = 0; k < _nin; ++k, ++vd2_block) {
+                *vd2_block = input[k]*input[k]*BD2_iout[j];
+            }
+        }
+    }
+
+    // --- Calculate input gradient block of output units with respect to this layers inputs
+    void storeInputD1(double d1_out[], const double beta[], DynamicDFlags dflags) const
+    {
+        dflags = dflags.AND(_dconf);
+        if (!dflags.d1()) { return; }
+        std::fill(d1_out, d1_out + _net_nout*_nin, 0.);
+
+        for (int i = 0; i < _net_nout; ++i) {
+            for (int j = 0; j < _nout; ++j) {
+                const double bdj = _bd1[i*_nout + j];
+                for (int k = 0; k < _nin; ++k) {
+                    const double bjk = beta[1 + j*(_nin + 1) + k];
+                    d1_out[i*_nin + k] += bjk*bdj;
+                }
+            }
+        }
+    }
+};
+} // templ
+
+#endif
@@ -0,0 +1,188 @@
+#ifndef QNETS_TEMPL_DYNNET_HPP
+#define QNETS_TEMPL_DYNNET_HPP
+
+#include "qnets/templ/DynLayer.hpp"
+#include "qnets/templ/DynNetState.hpp"
+#include "qnets/templ/DerivConfig.hpp"
+
+#include <vector>
+#include <string>
+#include <memory>
+
+namespace templ
+{
+// --- The runtime-sized DynNet FFNN
+//
+// Counterpart of TemplNet for network shapes which are only known at runtime
+// (e.g. loaded from file): The layer sizes and activation functions are runtime
+// parameters, but the propagation uses the same (backprop based) algorithms as
+// TemplNet. All weights are stored in one contiguous array (layer by layer,
+// unit by unit, with the bias weight first, i.e. in the same order as TemplNet).
+// The allocated derivatives are set at construction (dconf), while the computed
+// ones can be switched off at runtime via dflags, like for TemplNet.
+//
+// In addition to TemplNet, DynNet supports an input and output shift/scale, i.e.
+// input x_i enters as (x_i + shift_i)*scale_i and output y_i leaves as (y_i + shift_i)*scale_i.
+// A DynNet can be loaded from files written by FeedForwardNeuralNetwork::storeOnFile
+// (without feature maps), reproducing the poly net's propagation results.
+//
+// Like for TemplNet, the propagation methods taking an explicit State are const
+// and can be called concurrently, as long as every thread uses its own State.
+
+class DynNet
+{
+public:
+    using State = DynNetState;
+
+private:
+    // shape
+    int _ninput;
+    std::vector<int> _nunits; // units per layer (excluding offset units)
+    std::vector<DynACTF> _actfs; // activation function per layer
+    std::vector<int> _beta_offsets; // offset of the layers' weights in _beta
+    int _nbeta;
+    DynamicDFlags _dconf; // allocated derivatives
+
+    // weights and input/output normalization
+    std::vector<double> _beta;
+    std::vector<double> _in_shift, _in_scale;
+    std::vector<double> _out_shift, _out_scale;
+
+    // The default state, used by propagate calls without explicit state
+    std::unique_ptr<State> _state;
+
+    void _setupShape(int ninput, const std::vector<int> &nunits, const std::vector<DynACTF> &actfs, DerivConfig dconf);
+    void _loadPolyFile(const std::string &filename, DerivConfig dconf);
+
+public:
+    // dynamic (opt-out) derivative config of the default state
+    DynamicDFlags dflags;
+
+    // Create a net of ninput inputs and nunits.size() layers (the last one being the output layer)
+    DynNet(int ninput, const std::vector<int> &nunits, const std::vector<DynACTF> &actfs, DerivConfig dconf = DerivConfig::D12_VD1);
+
+    // Load from a file written by FeedForwardNeuralNetwork::storeOnFile (incl. weights)
+    explicit DynNet(const std::string &filename, DerivConfig dconf = DerivConfig::D12_VD1);
+
+    // copies shape, weights and dflags (the default state is fresh)
+    DynNet(const DynNet &other);
+    DynNet &operator=(const DynNet &) = delete;
+    ~DynNet() = default;
+
+    // --- Get information about the NN structure
+    int getNLayer() const { return static_cast<int>(_nunits.size()); }
+    int getNInput() const { return _ninput; }
+    int getNOutput() const { return _nunits.back(); }
+    int getNUnit() const;
+    int getNUnit(int i) const { return _nunits[i]; }
+    const std::vector<int> &getUnitShape() const { return _nunits; }
+    DynACTF getACTF(int i) const { return _actfs[i]; }
+
+    // Read access to the default state / its layers
+    const State &getState() const { return *_state; }
+    const std::vector<DynLayer> &getLayers() const { return _state->getLayers(); }
+    const DynLayer &getLayer(int i) const { return _state->getLayer(i); }
+
+    // --- const get Value Arrays/Elements (of default state)
+    const std::vector<double> &getOutput() const { return _state->getOutput(); }
+    double getOutput(int i) const { return _state->getOutput(i); }
+    const std::vector<double> &getD1() const { return _state->getD1(); }
+    double getD1(int i, int j) const { return _state->getD1(i, j); }
+    const std::vector<double> &getD2() const { return _state->getD2(); }
+    double getD2(int i, int j) const { return _state->getD2(i, j); }
+    const std::vector<double> &getVD1() const { return _state->getVD1(); }
+    double getVD1(int i, int j) const { return _state->getVD1(i, j); }
+    const std::vector<double> &getVD2() const { return _state->getVD2(); }
+    double getVD2(int i, int j) const { return _state->getVD2(i, j); }
+
+    // --- check derivative setup
+    DynamicDFlags getDConf() const { return _dconf; }
+    bool allowsD1() const { return _dconf.d1(); }
+    bool allowsD2() const { return _dconf.d2(); }
+    bool allowsVD1() const { return _dconf.vd1(); }
+    bool allowsVD2() const { return _dconf.vd2(); }
+
+    bool hasD1() const { return _dconf.d1() && dflags.d1(); }
+    bool hasD2() const { return _dconf.d2() && dflags.d2(); }
+    bool hasVD1() const { return _dconf.vd1() && dflags.vd1(); }
+    bool hasVD2() const { return _dconf.vd2() && dflags.vd2(); }
+
+    // --- Access Network Weights (Betas)
+    int getNBeta() const { return _nbeta; }
+    int getNBeta(int i) const { return (i == 0 ? _ninput + 1 : _nunits[i - 1] + 1)*_nunits[i]; }
+    int getBetaOffset(int i) const { return _beta_offsets[i]; }
+
+    const std::vector<double> &getBetas() const { return _beta; } // the full contiguous weight array
+    double getBeta(int i) const { return _beta[i]; }
+    void setBeta(int i, double beta) { _beta[i] = beta; }
+
+    template <class IterT>
+    void getBetas(IterT begin, const IterT end) const { std::copy(_beta.begin(), _beta.begin() + (end - begin), begin); }
+    template <class IterT>
+    void setBetas(IterT begin, const IterT end) { std::copy(begin, end, _beta.begin()); }
+
+    // --- Input/Output shift and scale
+    double getInputShift(int i) const { return _in_shift[i]; }
+    double getInputScale(int i) const { return _in_scale[i]; }
+    double getOutputShift(int i) const { return _out_shift[i]; }
+    double getOutputScale(int i) const { return _out_scale[i]; }
+    void setInputShift(int i, double shift) { _in_shift[i] = shift; }
+    void setInputScale(int i, double scale) { _in_scale[i] = scale; }
+    void setOutputShift(int i, double shift) { _out_shift[i] = shift; }
+    void setOutputScale(int i, double scale) { _out_scale[i] = scale; }
+
+    // Fold the input shift/scale into the first layer's weights (input shift/scale become identity).
+    // The net function stays the same, but the weights (and hence VD1/VD2) change meaning.
+    void foldInputShiftScale();
+
+    // Fold the output shift/scale into the last layer's weights, which is only possible if
+    // the output activation function is linear (NoOp). Returns false if nothing was folded.
+    bool foldOutputShiftScale();
+
+    // --- Propagation with external state (thread-safe, as long as states are not shared)
+    // (throws std::invalid_argument if the state was created for a net of different shape)
+    void Propagate(State &state, const double input[]) const;
+
+    // --- Propagation with the default state (using this->dflags)
+    void Propagate(const double input[]);
+};
+
+
+// DynNetState constructors (need the full DynNet)
+inline DynNetState::DynNetState(const DynNet &dnet): DynNetState(dnet, dnet.dflags) {}
+
+inline DynNetState::DynNetState(const DynNet &dnet, DynamicDFlags init_dflags):
+        _ninput(dnet.getNInput()), _noutput(dnet.getNOutput()), _nbeta(dnet.getNBeta()), _dconf(dnet.getDConf()),
+        _input(_ninput), _output(_noutput),
+        _d1_net(_noutput*_ninput),
+        _d1(_dconf.d1() ? _noutput*_ninput : 0), _d2(_dconf.d2() ? _noutput*_ninput : 0),
+        _vd1(_dconf.vd1() ? _noutput*_nbeta : 0), _vd2(_dconf.vd2() ? _noutput*_nbeta : 0),
+        dflags(init_dflags)
+{
+    int nin = _ninput;
+    for (int i = 0; i < dnet.getNLayer(); ++i) {
+        _layers.emplace_back(_ninput, nin, dnet.getNUnit(i), _noutput, dnet.getACTF(i), _dconf);
+        nin = dnet.getNUnit(i);
+    }
+}
+
+inline bool DynNetState::isCompatible(const DynNet &dnet) const
+{
+    const DynamicDFlags dconf = dnet.getDConf();
+    if (_ninput != dnet.getNInput() || _noutput != dnet.getNOutput() || _nbeta != dnet.getNBeta()
+        || _dconf.d1() != dconf.d1() || _dconf.d2() != dconf.d2() || _dconf.vd1() != dconf.vd1() || _dconf.vd2() != dconf.vd2()
+        || static_cast<int>(_layers.size()) != dnet.getNLayer()) {
+        return false;
+    }
+    int nin = _ninput;
+    for (int i = 0; i < dnet.getNLayer(); ++i) {
+        if (_layers[i].ninput() != nin || _layers[i].noutput() != dnet.getNUnit(i) || _layers[i].getACTF() != dnet.getACTF(i)) {
+            return false;
+        }
+        nin = dnet.getNUnit(i);
+    }
+    return true;
+}
+} // templ
+
+#endif
@@ -0,0 +1,79 @@
+#ifndef QNETS_TEMPL_DYNNETSTATE_HPP
+#define QNETS_TEMPL_DYNNETSTATE_HPP
+
+#include "qnets/templ/DynLayer.hpp"
+#include "qnets/templ/DerivConfig.hpp"
+
+#include <vector>
+
+namespace templ
+{
+class DynNet;
+
+// --- The evaluation state of a DynNet
+//
+// Runtime-sized counterpart of TemplNetState: Holds the layers (with their
+// value/derivative buffers) and the final output/derivative arrays, but no weights.
+// A State must be created for a specific net (DynNet::State state(net);) and
+// may then be used for concurrent propagations, one state per thread.
+//
+class DynNetState
+{
+    friend class DynNet;
+
+private:
+    // sizes of the net this state was created for
+    int _ninput;
+    int _noutput;
+    int _nbeta;
+    DynamicDFlags _dconf; // allocated derivatives
+
+    std::vector<DynLayer> _layers;
+
+    // input/output arrays (after input/output shift/scale)
+    std::vector<double> _input;
+    std::vector<double> _output;
+
+    // deriv arrays
+    std::vector<double> _d1_net; // helper array to calc d1 from backprop
+    std::vector<double> _d1;
+    std::vector<double> _d2;
+    std::vector<double> _vd1;
+    std::vector<double> _vd2;
+
+public:
+    // dynamic (opt-out) derivative config (defaults to the net's dflags)
+    DynamicDFlags dflags;
+
+    explicit DynNetState(const DynNet &dnet); // defined in DynNet.hpp
+    DynNetState(const DynNet &dnet, DynamicDFlags init_dflags);
+
+    // true if the state was created for a net of dnet's shape (layers, actfs and allocated derivatives)
+    bool isCompatible(const DynNet &dnet) const; // defined in DynNet.hpp
+
+    // Read access to layers
+    const std::vector<DynLayer> &getLayers() const { return _layers; }
+    const DynLayer &getLayer(int i) const { return _layers[i]; }
+
+    // --- const get Value Arrays/Elements
+    const std::vector<double> &getInput() const { return _input; }
+    const std::vector<double> &getOutput() const { return _output; } // get values of output layer (incl. output shift/scale)
+    double getOutput(int i) const { return _output[i]; }
+    const std::vector<double> &getD1() const { return _d1; } // get derivative of output with respect to (original) input
+    double getD1(int i, int j) const { return _d1[i*_ninput + j]; }
+    const std::vector<double> &getD2() const { return _d2; }
+    double getD2(int i, int j) const { return _d2[i*_ninput + j]; }
+    const std::vector<double> &getVD1() const { return _vd1; }
+    double getVD1(int i, int j) const { return _vd1[i*_nbeta + j]; }
+    const std::vector<double> &getVD2() const { return _vd2; }
+    double getVD2(int i, int j) const { return _vd2[i*_nbeta + j]; }
+
+    // --- check derivative setup
+    bool hasD1() const { return _dconf.d1() && dflags.d1(); }
+    bool hasD2() const { return _dconf.d2() && dflags.d2(); }
+    bool hasVD1() const { return _dconf.vd1() && dflags.vd1(); }
+    bool hasVD2() const { return _dconf.vd2() && dflags.vd2(); }
+};
+} // templ
+
+#endif
@@ -0,0 +1,47 @@
+#ifndef QNETS_TEMPL_PRECCONFIG_HPP
+#define QNETS_TEMPL_PRECCONFIG_HPP
+
+#include <type_traits>
+
+namespace templ
+{
+// --- TemplNet Precision Config
+
+// The first template parameter of TemplNet (and of its layers/state) selects
+// the floating point precision. It can either be a plain floating point type,
+// which is then used for everything (e.g. TemplNet<float, ...>), or a
+// MixedPrec<StorageT, AccuT> type. In the mixed case all arrays (weights,
+// values, derivatives) are stored as StorageT, but the dot products of the
+// layer feeds are accumulated in AccuT (e.g. MixedPrec<float, double>).
+
+template <typename StorageT, typename AccuT>
+struct MixedPrec {};
+
+
+// Mapping to value (storage) and accumulation type
+
+template <typename PrecT>
+struct PrecTraits
+{
+    static_assert(std::is_floating_point<PrecT>::value, "[PrecTraits] PrecT must be a floating point type or MixedPrec.");
+    using value_type = PrecT;
+    using accu_type = PrecT;
+};
+
+template <typename StorageT, typename AccuT>
+struct PrecTraits<MixedPrec<StorageT, AccuT>>
+{
+    static_assert(std::is_floating_point<StorageT>::value, "[PrecTraits] StorageT must be a floating point type.");
+    static_assert(std::is_floating_point<AccuT>::value, "[PrecTraits] AccuT must be a floating point type.");
+    using value_type = StorageT;
+    using accu_type = AccuT;
+};
+
+template <typename PrecT>
+using value_t = typename PrecTraits<PrecT>::value_type;
+
+template <typename PrecT>
+using accu_t = typename PrecTraits<PrecT>::accu_type;
+} // templ
+
+#endif
@@ -0,0 +1,78 @@
+#ifndef QNETS_TEMPL_SPARSEORIGD1_HPP
+#define QNETS_TEMPL_SPARSEORIGD1_HPP
+
+#include <vector>
+#include <stdexcept>
+
+namespace templ
+{
+// --- Sparse input-to-original derivatives
+//
+// Compressed sparse row (CSR) storage of the first derivatives of the network inputs
+// with respect to the original inputs (the ninput x orig_ninput orig_d1 of PropagateDerived).
+// Row j holds the nonzero derivatives d input_j / d orig_k, i.e. the per-feature index list
+// of feature j. This is the typical structure of hand-crafted features, e.g. a pair distance
+// depends only on the 2*ndim coordinates of the two particles.
+// Rows must be added in order (addRow / addEntry+finishRow). clear() keeps the capacity,
+// so the same object can be refilled for every propagation without reallocation.
+
+template <typename ValueT>
+class SparseOrigD1
+{
+private:
+    int _norig; // number of columns (original inputs)
+    std::vector<int> _row_ptr{0}; // nrows + 1 entries, row j is [_row_ptr[j], _row_ptr[j+1])
+    std::vector<int> _col_idx;
+    std::vector<ValueT> _values;
+
+public:
+    explicit SparseOrigD1(int norig = 0): _norig(norig) {}
+
+    // create from a dense (nrows x norig) array, dropping zeros
+    SparseOrigD1(const ValueT dense[], int nrows, int norig): _norig(norig)
+    {
+        for (int j = 0; j < nrows; ++j) {
+            for (int k = 0; k < norig; ++k) {
+                if (dense[j*norig + k] != 0) { this->addEntry(k, dense[j*norig + k]); }
+            }
+            this->finishRow();
+        }
+    }
+
+    // --- Fill
+    void clear()
+    {
+        _row_ptr.resize(1);
+        _col_idx.clear();
+        _values.clear();
+    }
+
+    void addEntry(int k, ValueT value) // add entry to current row
+    {
+        if (k < 0 || k >= _norig) {
+            throw std::out_of_range("[SparseOrigD1::addEntry] Column index out of range.");
+        }
+        _col_idx.push_back(k);
+        _values.push_back(value);
+    }
+
+    void finishRow() { _row_ptr.push_back(static_cast<int>(_col_idx.size())); }
+
+    void addRow(const int cols[], const ValueT values[], int nnz_row)
+    {
+        for (int i = 0; i < nnz_row; ++i) { this->addEntry(cols[i], values[i]); }
+        this->finishRow();
+    }
+
+    // --- Access
+    int getNRows() const { return static_cast<int>(_row_ptr.size()) - 1; }
+    int getNOrig() const { return _norig; }
+    int getNNZ() const { return static_cast<int>(_col_idx.size()); }
+
+    const std::vector<int> &rowPtr() const { return _row_ptr; }
+    const std::vector<int> &colIdx() const { return _col_idx; }
+    const std::vector<ValueT> &values() const { return _values; }
+};
+} // templ
+
+#endif
@@ -0,0 +1,271 @@
+#ifndef QNETS_TEMPL_TEMPLFEATUREMAP_HPP
+#define QNETS_TEMPL_TEMPLFEATUREMAP_HPP
+
+#include "qnets/tool/PackTools.hpp"
+#include "qnets/templ/PrecConfig.hpp"
+
+#include <array>
+#include <algorithm>
+#include <initializer_list>
+#include <memory>
+#include <stdexcept>
+#include <utility>
+
+namespace templ
+{
+// --- TemplNet Feature Maps
+//
+// Compile-time counterparts of the poly feature maps (see qnets/poly/fmap/), which
+// compute features of the original inputs and their first and (diagonal) second
+// derivatives with respect to the original inputs. A TemplFeatureMap is used as
+// front end of a TemplNet via TemplNet::PropagateFeatures, so that the net's D1/D2
+// come out with respect to the original inputs (e.g. particle coordinates).
+//
+// Every map has static source indices into the original input and provides:
+//   static constexpr int nsrc;                    // number of sources
+//   static constexpr int source(int k);           // original input index of source k
+//   static ValueT f(const ValueT x[]);            // the feature value
+//   static ValueT fd12(x, d1[], d2[]);            // value and (diagonal) derivatives by source
+namespace fmap
+{
+// Identity of one input (IdentityMap)
+template <int SRC>
+struct IdentityMap
+{
+    static constexpr int nsrc = 1;
+    static constexpr int source(int /*k*/) { return SRC; }
+
+    template <typename ValueT>
+    static constexpr ValueT f(const ValueT x[]) { return x[SRC]; }
+
+    template <typename ValueT>
+    static constexpr ValueT fd12(const ValueT x[], ValueT d1[], ValueT d2[])
+    {
+        d1[0] = 1.;
+        d2[0] = 0.;
+        return x[SRC];
+    }
+};
+
+// Sum of two inputs (PairSumMap)
+template <int SRC0, int SRC1>
+struct PairSumMap
+{
+    static_assert(SRC0 != SRC1, "[PairSumMap] Sources must differ.");
+    static constexpr int nsrc = 2;
+    static constexpr int source(int k) { return k == 0 ? SRC0 : SRC1; }
+
+    template <typename ValueT>
+    static constexpr ValueT f(const ValueT x[]) { return x[SRC0] + x[SRC1]; }
+
+    template <typename ValueT>
+    static constexpr ValueT fd12(const ValueT x[], ValueT d1[], ValueT d2[])
+    {
+        d1[0] = 1.;
+        d1[1] = 1.;
+        d2[0] = 0.;
+        d2[1] = 0.;
+        return x[SRC0] + x[SRC1];
+    }
+};
+
+// Difference of two inputs (PairDifferenceMap)
+template <int SRC0, int SRC1>
+struct PairDifferenceMap
+{
+    static_assert(SRC0 != SRC1, "[PairDifferenceMap] Sources must differ.");
+    static constexpr int nsrc = 2;
+    static constexpr int source(int k) { return k == 0 ? SRC0 : SRC1; }
+
+    template <typename ValueT>
+    static constexpr ValueT f(const ValueT x[]) { return x[SRC0] - x[SRC1]; }
+
+    template <typename ValueT>
+    static constexpr ValueT fd12(const ValueT x[], ValueT d1[], ValueT d2[])
+    {
+        d1[0] = 1.;
+        d1[1] = -1.;
+        d2[0] = 0.;
+        d2[1] = 0.;
+        return x[SRC0] - x[SRC1];
+    }
+};
+
+// Squared euclidean distance of two NDIM-dimensional points starting at SRC0 and SRC1 (EuclideanPairDistanceMap)
+template <int NDIM, int SRC0, int SRC1>
+struct EuclideanPairDistanceMap
+{
+    static_assert(NDIM > 0, "[EuclideanPairDistanceMap] NDIM must be positive.");
+    static_assert(SRC0 + NDIM <= SRC1 || SRC1 + NDIM <= SRC0, "[EuclideanPairDistanceMap] Source points must not overlap.");
+    static constexpr int nsrc = 2*NDIM;
+    static constexpr int source(int k) { return k < NDIM ? SRC0 + k : SRC1 + k - NDIM; }
+
+    template <typename ValueT>
+    static constexpr ValueT f(const ValueT x[])
+    {
+        ValueT dist = 0.;
+        for (int d = 0; d < NDIM; ++d) {
+            dist += (x[SRC0 + d] - x[SRC1 + d])*(x[SRC0 + d] - x[SRC1 + d]);
+        }
+        return dist;
+    }
+
+    template <typename ValueT>
+    static constexpr ValueT fd12(const ValueT x[], ValueT d1[], ValueT d2[])
+    {
+        ValueT dist = 0.;
+        for (int d = 0; d < NDIM; ++d) {
+            const ValueT diff = x[SRC0 + d] - x[SRC1 + d];
+            dist += diff*diff;
+            d1[d] = 2.*diff;
+            d1[NDIM + d] = -2.*diff;
+            d2[d] = 2.;
+            d2[NDIM + d] = 2.;
+        }
+        return dist;
+    }
+};
+} // fmap
+
+
+// The feature map "layer", computing all features of the Maps pack
+//
+// Holds the feature values and their derivatives (i.e. it is part of the per-thread
+// evaluation state, like a TemplLayer). The derivatives are stored compactly by source
+// (used to chain the backprop input gradient with the cost of the nonzeros only) and as
+// dense noutput x orig_ninput arrays (zero outside of the sources, used for forward accumulation).
+template <typename PrecT, int ORIG_N_IN, class ... Maps>
+class TemplFeatureMap
+{
+public:
+    using ValueT = value_t<PrecT>;
+
+    static constexpr int orig_ninput = ORIG_N_IN;
+    static constexpr int noutput = static_cast<int>(sizeof...(Maps));
+    static constexpr int nsrc = pack::sum<int, Maps::nsrc...>(); // total number of sources (nonzero derivatives)
+
+    static_assert(noutput > 0, "[TemplFeatureMap] Maps pack is empty.");
+
+private:
+    std::array<ValueT, noutput> _out{};
+    std::array<ValueT, nsrc> _cd1{}; // compact derivatives, by source
+    std::array<ValueT, nsrc> _cd2{};
+    std::array<int, nsrc> _src{}; // original input index of compact derivatives
+    std::array<int, noutput + 1> _row_ptr{}; // feature j has the sources [_row_ptr[j], _row_ptr[j+1])
+
+    // the dense deriv arrays could be quite large, so we heap allocate them
+    const std::unique_ptr<std::array<ValueT, noutput*ORIG_N_IN>> _d1_ptr{std::make_unique<std::array<ValueT, noutput*ORIG_N_IN>>()};
+    const std::unique_ptr<std::array<ValueT, noutput*ORIG_N_IN>> _d2_ptr{std::make_unique<std::array<ValueT, noutput*ORIG_N_IN>>()};
+
+    template <class MapT>
+    constexpr int _setupMap(int j, int isrc)
+    {
+        for (int k = 0; k < MapT::nsrc; ++k) {
+            _src[isrc + k] = MapT::source(k);
+        }
+        _row_ptr[j + 1] = isrc + MapT::nsrc;
+        return 0;
+    }
+
+    template <class MapT>
+    constexpr int _computeMap(const ValueT input[], int j, bool flag_d)
+    {
+        const int isrc = _row_ptr[j];
+        if (flag_d) {
+            _out[j] = MapT::fd12(input, _cd1.begin() + isrc, _cd2.begin() + isrc);
+            ValueT * const D1_j = (*_d1_ptr).begin() + j*ORIG_N_IN;
+            ValueT * const D2_j = (*_d2_ptr).begin() + j*ORIG_N_IN;
+            for (int l = isrc; l < isrc + MapT::nsrc; ++l) {
+                D1_j[_src[l]] = _cd1[l];
+                D2_j[_src[l]] = _cd2[l];
+            }
+        }
+        else {
+            _out[j] = MapT::f(input);
+        }
+        return 0;
+    }
+
+public:
+    TemplFeatureMap()
+    {
+        int j = 0, isrc = 0;
+        (void) std::initializer_list<int>{(_setupMap<Maps>(j, isrc), isrc += Maps::nsrc, ++j)...};
+        for (const int src : _src) {
+            if (src < 0 || src >= ORIG_N_IN) {
+                throw std::out_of_range("[TemplFeatureMap] Map source index out of range.");
+            }
+        }
+    }
+
+    // public const output references
+    constexpr const std::array<ValueT, noutput> &out() const { return _out; }
+    constexpr const std::array<ValueT, noutput*ORIG_N_IN> &d1() const { return *_d1_ptr; } // dense d feature_j / d input_k
+    constexpr const std::array<ValueT, noutput*ORIG_N_IN> &d2() const { return *_d2_ptr; } // dense d^2 feature_j / d input_k^2
+
+    // --- Compute the features (and their derivatives, if flag_d)
+    constexpr void Compute(const ValueT input[], bool flag_d)
+    {
+        int j = 0;
+        (void) std::initializer_list<int>{(_computeMap<Maps>(input, j++, flag_d))...};
+    }
+
+    // --- Chain the input gradient d1_net (nout_net x noutput) with the feature derivatives
+    // into d1_out (nout_net x orig_ninput). The cost scales with the number of sources.
+    constexpr void chainD1(const ValueT d1_net[], int nout_net, ValueT d1_out[]) const
+    {
+        std::fill(d1_out, d1_out + nout_net*ORIG_N_IN, 0.);
+        for (int i = 0; i < nout_net; ++i) {
+            ValueT * const d1_i = d1_out + i*ORIG_N_IN;
+            for (int j = 0; j < noutput; ++j) {
+                const ValueT d1_net_ij = d1_net[i*noutput + j];
+                for (int l = _row_ptr[j]; l < _row_ptr[j + 1]; ++l) {
+                    d1_i[_src[l]] += d1_net_ij*_cd1[l];
+                }
+            }
+        }
+    }
+};
+
+
+// --- Helpers to create the feature map of all particle pair distances
+
+namespace detail
+{
+constexpr int pairFirst(int npart, int ipair) // first particle of the ipair'th pair (p < q, p-major)
+{
+    int p = 0;
+    while (ipair >= npart - 1 - p) {
+        ipair -= npart - 1 - p;
+        ++p;
+    }
+    return p;
+}
+
+constexpr int pairSecond(int npart, int ipair) // second particle of the ipair'th pair
+{
+    int p = 0;
+    while (ipair >= npart - 1 - p) {
+        ipair -= npart - 1 - p;
+        ++p;
+    }
+    return p + 1 + ipair;
+}
+
+template <typename PrecT, int NPART, int NDIM, class ISeq>
+struct PairDistanceFeatureMapImpl;
+
+template <typename PrecT, int NPART, int NDIM, size_t ... Is>
+struct PairDistanceFeatureMapImpl<PrecT, NPART, NDIM, std::index_sequence<Is...>>
+{
+    using type = TemplFeatureMap<PrecT, NPART*NDIM, fmap::EuclideanPairDistanceMap<NDIM, pairFirst(NPART, Is)*NDIM, pairSecond(NPART, Is)*NDIM>...>;
+};
+} // detail
+
+// Feature map of the squared distances of all NPART*(NPART-1)/2 particle pairs,
+// with original input x[p*NDIM + d] (coordinate d of particle p)
+template <typename PrecT, int NPART, int NDIM>
+using PairDistanceFeatureMap = typename detail::PairDistanceFeatureMapImpl<PrecT, NPART, NDIM, std::make_index_sequence<NPART*(NPART - 1)/2>>::type;
+} // templ
+
+#endif
@@ -2,10 +2,12 @@
 #define QNETS_TEMPL_TEMPLLAYER_HPP
 
 #include "qnets/templ/DerivConfig.hpp"
+#include "qnets/templ/PrecConfig.hpp"
 
 #include <array>
 #include <vector>
 #include <algorithm>
+#include <functional>
 #include <numeric>
 #include <type_traits>
 #include <memory>
@@ -29,10 +31,18 @@ struct LayerConfig
 
 // The actual Layer class
 //
-template <typename ValueT, int ORIG_NINPUT,int NET_NINPUT, int NET_NOUTPUT, int NBETA_NEXT, int N_IN, int N_OUT, class ACTFType, DerivConfig DCONF>
+// A TemplLayer holds only the per-evaluation buffers (values, derivatives, backprop values).
+// The weights are NOT owned by the layer, but passed to every method that needs them
+// (as a pointer/array of nbeta values), so that one set of weights can be shared by many
+// layer instances, e.g. one per thread (see TemplNetState).
+template <typename PrecT, int ORIG_NINPUT, int NET_NINPUT, int NET_NOUTPUT, int NBETA_NEXT, int N_IN, int N_OUT, class ACTFType, DerivConfig DCONF>
 class TemplLayer: public LayerConfig<N_OUT, ACTFType>
 {
 public:
+    // Precision types (see PrecConfig.hpp)
+    using ValueT = value_t<PrecT>; // storage type
+    using AccuT = accu_t<PrecT>; // accumulation type of the feed dot products
+
     // N_IN dependent sizes
     static constexpr int ninput = N_IN;
     static constexpr int nbeta = (N_IN + 1)*N_OUT;
@@ -73,7 +83,6 @@ private: // arrays
 
 public: // public member variables
     ACTFType actf{}; // the activation function
-    std::array<ValueT, nbeta> beta{}; // the weights (NOTE: If the network should contain millions of weights, stacksize must be increased for the program)
 
     // public const output references
     constexpr const std::array<ValueT, N_OUT> &out() const { return _out; }
@@ -85,11 +94,12 @@ public: // public member variables
     constexpr const std::array<ValueT, nad2> &ad2() const { return _ad2; };
 
 private:
-    constexpr void _computeFeed(const ValueT input[])
+    constexpr void _computeFeed(const ValueT input[], const ValueT beta[])
     {
         int beta_i0 = 1; // increments through the indices of the first non-offset beta per unit
         for (int i = 0; i < N_OUT; ++i, beta_i0 += N_IN + 1) {
-            _out[i] = std::inner_product(input, input + ninput, beta.begin() + beta_i0, beta[beta_i0 - 1]/*bias weight*/); // found to be faster than loop
+            _out[i] = static_cast<ValueT>(std::inner_product(input, input + ninput, beta + beta_i0, static_cast<AccuT>(beta[beta_i0 - 1])/*bias weight*/,
+                                                             std::plus<AccuT>(), [](ValueT x, ValueT b) { return static_cast<AccuT>(x)*b; })); // found to be faster than loop
         }
     }
 
@@ -106,14 +116,14 @@ private:
         }
     }
 
-    constexpr void _computeOutput(const ValueT input[], DynamicDFlags dflags)
+    constexpr void _computeOutput(const ValueT input[], const ValueT beta[], DynamicDFlags dflags)
     {
-        this->_computeFeed(input);
+        this->_computeFeed(input, beta);
         this->_computeActivation(dflags.needsAny(), dflags.d2() || dflags.vd2());
     }
 
     // forward-accumulate second order input derivatives from a layer
-    constexpr void _computeD2_Layer(const ValueT * in_d1, const ValueT * in_d2)
+    constexpr void _computeD2_Layer(const ValueT * in_d1, const ValueT * in_d2, const ValueT beta[])
     {
         auto &D1 = *_d1_ptr;
         auto &D2 = *_d2_ptr;
@@ -135,7 +145,7 @@ private:
     }
 
     // forward-accumulate second order deriv when the inputs correspond (besides shift/scale) to the true network inputs
-    constexpr void _computeD2_Input()
+    constexpr void _computeD2_Input(const ValueT beta[])
     {
         auto &D1 = *_d1_ptr;
         auto &D2 = *_d2_ptr;
@@ -149,30 +159,30 @@ private:
     }
 
     // start forward pass from true network inputs
-    constexpr void _forwardInput(const ValueT input[], DynamicDFlags dflags)
+    constexpr void _forwardInput(const ValueT input[], const ValueT beta[], DynamicDFlags dflags)
     {
         // statically secure this call (i.e. using it on non-input layer will not compile)
         static_assert(N_IN == NET_NINPUT, "[TemplLayer::ForwardInput] N_IN != NET_NINPUT");
         static_assert(N_IN == ORIG_NINPUT, "[TemplLayer::ForwardInput] N_IN != ORIG_NINPUT");
 
         dflags = dflags.AND(dconf); // AND static and dynamic conf
-        this->_computeOutput(input, dflags);
+        this->_computeOutput(input, beta, dflags);
 
         // fill diagonal d1,d2
         if (dflags.d2()) {
-            this->_computeD2_Input();
+            this->_computeD2_Input(beta);
         }
     }
 
     // continue/start forward pass from previous layer / external source
-    constexpr void _forwardLayer(const ValueT input[], const ValueT in_d1[], const ValueT in_d2[], DynamicDFlags dflags)
+    constexpr void _forwardLayer(const ValueT input[], const ValueT in_d1[], const ValueT in_d2[], const ValueT beta[], DynamicDFlags dflags)
     {
         dflags = dflags.AND(dconf); // AND static and dynamic conf
-        this->_computeOutput(input, dflags);
+        this->_computeOutput(input, beta, dflags);
 
         // input derivs
         if (dflags.d2()) {
-            this->_computeD2_Layer(in_d1, in_d2);
+            this->_computeD2_Layer(in_d1, in_d2, beta);
         }
     }
 
@@ -280,7 +290,47 @@ private:
         }
     }
 
-    constexpr void _inputGrad(ValueT d1_out[], DynamicDFlags dflags) const
+    // --- Vector-Jacobian product (VJP) mode: backprop of a single seeded row, stored in the first row of bd1
+
+    constexpr void _backwardOutputVJP(const ValueT seed[])
+    {
+        static_assert(N_OUT == NET_NOUTPUT, "[TemplLayer::BackwardOutputVJP] N_OUT != NET_NOUTPUT");
+        static_assert(dconf.needsBD1(), "[TemplLayer::BackwardOutputVJP] DCONF must enable D1 or VD1.");
+        auto &BD1 = *_bd1_ptr;
+        for (int k = 0; k < N_OUT; ++k) {
+            BD1[k] = seed[k]*_ad1[k];
+        }
+    }
+
+    constexpr void _backwardLayerVJP(const ValueT bd1_next[], const ValueT beta_next[])
+    {
+        static_assert(dconf.needsBD1(), "[TemplLayer::BackwardLayerVJP] DCONF must enable D1 or VD1.");
+        auto &BD1 = *_bd1_ptr;
+        std::fill(BD1.begin(), BD1.begin() + N_OUT, 0.);
+        for (int j = 0; j < nout_next; ++j) {
+            const int beta_i0 = 1 + j*(N_OUT + 1);
+            for (int k = 0; k < N_OUT; ++k) {
+                BD1[k] += beta_next[beta_i0 + k]*bd1_next[j];
+            }
+        }
+        for (int k = 0; k < N_OUT; ++k) {
+            BD1[k] *= _ad1[k];
+        }
+    }
+
+    constexpr void _layerGradVJP(const ValueT input[], ValueT grad_block[]) const
+    {
+        static_assert(dconf.needsBD1(), "[TemplLayer::storeLayerVJP] DCONF must enable D1 or VD1.");
+        const auto &BD1 = *_bd1_ptr;
+        for (int j = 0; j < N_OUT; ++j) {
+            *grad_block++ = BD1[j]; // bias weight gradient
+            for (int k = 0; k < N_IN; ++k, ++grad_block) {
+                *grad_block = input[k]*BD1[j];
+            }
+        }
+    }
+
+    constexpr void _inputGrad(ValueT d1_out[], const ValueT beta[], DynamicDFlags dflags) const
     {
         dflags = dflags.AND(dconf); // AND static and dynamic conf
         if (!dflags.d1()) { return; }
@@ -306,27 +356,27 @@ public: // public propagate methods
 
     // --- Propagation of original input data (not layer)
 
-    constexpr void ForwardInput(const std::array<ValueT, ORIG_NINPUT> &input, DynamicDFlags dflags)
+    constexpr void ForwardInput(const std::array<ValueT, ORIG_NINPUT> &input, const std::array<ValueT, nbeta> &beta, DynamicDFlags dflags)
     {
-        _forwardInput(input.begin(), dflags);
+        _forwardInput(input.begin(), beta.begin(), dflags);
     }
 
-    constexpr void ForwardInput(const ValueT input[], DynamicDFlags dflags)
+    constexpr void ForwardInput(const ValueT input[], const ValueT beta[], DynamicDFlags dflags)
     {
-        _forwardInput(input, dflags);
+        _forwardInput(input, beta, dflags);
     }
 
 
     // --- Forward Propagation of layer data or external source
 
-    constexpr void ForwardLayer(const std::array<ValueT, N_IN> &input, const std::array<ValueT, nd2_prev> &in_d1, const std::array<ValueT, nd2_prev> &in_d2, DynamicDFlags dflags)
+    constexpr void ForwardLayer(const std::array<ValueT, N_IN> &input, const std::array<ValueT, nd2_prev> &in_d1, const std::array<ValueT, nd2_prev> &in_d2, const std::array<ValueT, nbeta> &beta, DynamicDFlags dflags)
     {
-        _forwardLayer(input.begin(), in_d1.begin(), in_d2.begin(), dflags);
+        _forwardLayer(input.begin(), in_d1.begin(), in_d2.begin(), beta.begin(), dflags);
     }
 
-    constexpr void ForwardLayer(const ValueT input[], const ValueT in_d1[], const ValueT in_d2[], DynamicDFlags dflags)
+    constexpr void ForwardLayer(const ValueT input[], const ValueT in_d1[], const ValueT in_d2[], const ValueT beta[], DynamicDFlags dflags)
     {
-        _forwardLayer(input, in_d1, in_d2, dflags);
+        _forwardLayer(input, in_d1, in_d2, beta, dflags);
     }
 
 
@@ -374,16 +424,37 @@ public: // public propagate methods
     }
 
 
+    // --- Vector-Jacobian product mode
+    // Backpropagate only the seed-weighted sum of the outputs, i.e. the first N_OUT
+    // elements of bd1() become d(sum_i seed_i*out_i)/dfeed of this layer. Requires that
+    // the forward pass computed the activation derivatives (D1 or VD1 in dflags).
+
+    constexpr void BackwardOutputVJP(const ValueT seed[])
+    {
+        _backwardOutputVJP(seed);
+    }
+
+    constexpr void BackwardLayerVJP(const ValueT bd1_next[], const ValueT beta_next[])
+    {
+        _backwardLayerVJP(bd1_next, beta_next);
+    }
+
+    constexpr void storeLayerVJP(const ValueT input[], ValueT grad_block[]) const
+    {
+        _layerGradVJP(input, grad_block);
+    }
+
+
     // --- Calculate input gradient block of output units with respect to this layers inputs
 
-    constexpr void storeInputD1(std::array<ValueT, NET_NOUTPUT*N_IN> &d1_out, DynamicDFlags dflags) const
+    constexpr void storeInputD1(std::array<ValueT, NET_NOUTPUT*N_IN> &d1_out, const std::array<ValueT, nbeta> &beta, DynamicDFlags dflags) const
     {
-        _inputGrad(d1_out.begin(), dflags);
+        _inputGrad(d1_out.begin(), beta.begin(), dflags);
     }
 
-    constexpr void storeInputD1(ValueT d1_out[], DynamicDFlags dflags) const
+    constexpr void storeInputD1(ValueT d1_out[], const ValueT beta[], DynamicDFlags dflags) const
     {
-        _inputGrad(d1_out, dflags);
+        _inputGrad(d1_out, beta, dflags);
     }
 };
 } // templ
@@ -4,8 +4,12 @@
 #include "qnets/tool/PackTools.hpp"
 #include "qnets/tool/TupleTools.hpp"
 #include "qnets/templ/TemplLayer.hpp"
+#include "qnets/templ/TemplNetState.hpp"
+#include "qnets/templ/SparseOrigD1.hpp"
+#include "qnets/templ/BinaryWeights.hpp"
 #include "qnets/templ/LayerPackTools.hpp"
 #include "qnets/templ/DerivConfig.hpp"
+#include "qnets/templ/PrecConfig.hpp"
 
 #include <array>
 #include <tuple>
@@ -16,6 +20,7 @@
 #include <string>
 #include <iomanip>
 #include <exception>
+#include <vector>
 
 namespace templ
 {
@@ -46,31 +51,46 @@ template <class LTuplType, size_t ... Is>
 constexpr std::array<int, sizeof...(Is)> TemplNetShape<LTuplType, std::index_sequence<Is...>>::nbetas;
 
 
-// --- subroutines to propagate (i.e. fwd+back) input through a tuple of layers
+// --- beta offset of layer I inside the contiguous weight array of a net
 
-// Recursive ForwardProp over tuple
 template <class TupleT>
-constexpr void fwdprop_layers_impl(TupleT &/*layers*/, DynamicDFlags /*dflags*/, std::index_sequence<>) {}
+constexpr int nbeta_upto_impl(std::index_sequence<>) { return 0; }
 
 template <class TupleT, size_t I, size_t ... Is>
-constexpr void fwdprop_layers_impl(TupleT &layers, DynamicDFlags dflags, std::index_sequence<I, Is...>)
+constexpr int nbeta_upto_impl(std::index_sequence<I, Is...>)
+{
+    return std::tuple_element<I, TupleT>::type::nbeta + nbeta_upto_impl<TupleT>(std::index_sequence<Is...>{});
+}
+
+template <size_t I, class TupleT>
+constexpr int beta_offset() { return nbeta_upto_impl<TupleT>(std::make_index_sequence<I>{}); }
+
+
+// --- subroutines to propagate (i.e. fwd+back) input through a tuple of layers
+
+// Recursive ForwardProp over tuple
+template <class TupleT, class ArrayT>
+constexpr void fwdprop_layers_impl(TupleT &/*layers*/, const ArrayT &/*beta*/, DynamicDFlags /*dflags*/, std::index_sequence<>) {}
+
+template <class TupleT, class ArrayT, size_t I, size_t ... Is>
+constexpr void fwdprop_layers_impl(TupleT &layers, const ArrayT &beta, DynamicDFlags dflags, std::index_sequence<I, Is...>)
 {
     const auto &prev_layer = std::get<I>(layers);
-    std::get<I + 1>(layers).ForwardLayer(prev_layer.out(), prev_layer.d1(), prev_layer.d2(), dflags);
-    fwdprop_layers_impl<TupleT>(layers, dflags, std::index_sequence<Is...>{});
+    std::get<I + 1>(layers).ForwardLayer(prev_layer.out().begin(), prev_layer.d1().begin(), prev_layer.d2().begin(), beta.begin() + beta_offset<I + 1, TupleT>(), dflags);
+    fwdprop_layers_impl<TupleT>(layers, beta, dflags, std::index_sequence<Is...>{});
 }
 
 // Recursive BackProp over tuple
-template <class TupleT>
-constexpr void backprop_layers_impl(TupleT &/*layers*/, DynamicDFlags /*dflags*/, std::index_sequence<>) {}
+template <class TupleT, class ArrayT>
+constexpr void backprop_layers_impl(TupleT &/*layers*/, const ArrayT &/*beta*/, DynamicDFlags /*dflags*/, std::index_sequence<>) {}
 
-template <class TupleT, size_t I, size_t ... Is>
-constexpr void backprop_layers_impl(TupleT &layers, DynamicDFlags dflags, std::index_sequence<I, Is...>)
+template <class TupleT, class ArrayT, size_t I, size_t ... Is>
+constexpr void backprop_layers_impl(TupleT &layers, const ArrayT &beta, DynamicDFlags dflags, std::index_sequence<I, Is...>)
 {
     constexpr size_t idx = sizeof...(Is);
     const auto &next_layer = std::get<idx + 1>(layers);
-    std::get<idx>(layers).BackwardLayer(next_layer.bd1(), next_layer.bd2(), next_layer.beta, dflags);
-    backprop_layers_impl<TupleT>(layers, dflags, std::index_sequence<Is...>{});
+    std::get<idx>(layers).BackwardLayer(next_layer.bd1().begin(), next_layer.bd2().begin(), beta.begin() + beta_offset<idx + 1, TupleT>(), dflags);
+    backprop_layers_impl<TupleT>(layers, beta, dflags, std::index_sequence<Is...>{});
 }
 
 // calculate final weight gradients of a backpropped layer
@@ -96,20 +116,67 @@ constexpr void grad_layers_impl(const TupleT &layers, const ArrayT1 &input, Arra
     calc_grad_layer<ibeta_begin, nbeta_net, decltype(this_layer)/*clang fix*/>(this_layer, input, vd1, vd2, dflags);
     grad_layers_impl<ibeta_begin + layerT::nbeta, nbeta_net, TupleT>(layers, this_layer.out(), vd1, vd2, dflags, std::index_sequence<Is...>{});
 }
+
+// Recursive single-row (VJP) BackProp over tuple
+template <class TupleT, class ArrayT>
+constexpr void backprop_vjp_layers_impl(TupleT &/*layers*/, const ArrayT &/*beta*/, std::index_sequence<>) {}
+
+template <class TupleT, class ArrayT, size_t I, size_t ... Is>
+constexpr void backprop_vjp_layers_impl(TupleT &layers, const ArrayT &beta, std::index_sequence<I, Is...>)
+{
+    constexpr size_t idx = sizeof...(Is);
+    const auto &next_layer = std::get<idx + 1>(layers);
+    std::get<idx>(layers).BackwardLayerVJP(next_layer.bd1().begin(), beta.begin() + beta_offset<idx + 1, TupleT>());
+    backprop_vjp_layers_impl<TupleT>(layers, beta, std::index_sequence<Is...>{});
+}
+
+// store the single-row (VJP) weight gradients into grad
+template <int ibeta_begin, class TupleT, class ArrayT, typename ValueT>
+constexpr void grad_vjp_layers_impl(const TupleT &/*layers*/, const ArrayT &/*input*/, ValueT /*grad*/[], std::index_sequence<>) {}
+
+template <int ibeta_begin, class TupleT, class ArrayT, typename ValueT, size_t I, size_t ... Is>
+constexpr void grad_vjp_layers_impl(const TupleT &layers, const ArrayT &input, ValueT grad[], std::index_sequence<I, Is...>)
+{
+    using layerT = std::tuple_element_t<I, TupleT>;
+    const auto &this_layer = std::get<I>(layers);
+
+    this_layer.storeLayerVJP(input.begin(), grad + ibeta_begin);
+    grad_vjp_layers_impl<ibeta_begin + layerT::nbeta, TupleT>(layers, this_layer.out(), grad, std::index_sequence<Is...>{});
+}
+
+
+// --- poly activation function ids of a tuple of layers
+
+template <class TupleT, size_t ... Is>
+std::vector<std::string> actf_poly_ids(std::index_sequence<Is...>)
+{
+    return {ActfPolyId<typename std::tuple_element<Is, TupleT>::type::ACTF_Type>::id()...};
+}
 } // detail
 
 
 
 // --- The fully templated TemplNet FFNN
-
-template <typename ValueT, DerivConfig DCONF, int ORIG_N_IN, int NET_N_IN, class ... LayerConfs>
+//
+// TemplNet owns the network weights (in one contiguous array) and a default
+// evaluation state. The propagation methods taking an explicit State do not
+// modify the net itself, so they may be called concurrently from several threads,
+// as long as each thread uses its own State (e.g. one TemplNet<...>::State per thread).
+// The methods without State argument use the internal default state and are not thread-safe.
+
+template <typename PrecT, DerivConfig DCONF, int ORIG_N_IN, int NET_N_IN, class ... LayerConfs>
 class TemplNet
 {
 public:
     // --- Static Setup
 
-    // LayerTuple type / Shape
-    using LayerTuple = typename lpack::LayerPackTuple<ValueT, DCONF, ORIG_N_IN, NET_N_IN, LayerConfs...>::type;
+    // Precision types (see PrecConfig.hpp)
+    using ValueT = value_t<PrecT>; // storage type of weights, values and derivatives
+    using AccuT = accu_t<PrecT>; // accumulation type of the layer feeds
+
+    // State / LayerTuple type / Shape
+    using State = TemplNetState<PrecT, DCONF, ORIG_N_IN, NET_N_IN, LayerConfs...>;
+    using LayerTuple = typename State::LayerTuple;
     using Shape = detail::TemplNetShape<LayerTuple, std::make_index_sequence<sizeof...(LayerConfs)>>;
 
     // some basic static sizes
@@ -120,21 +187,26 @@ public:
     static constexpr int nbeta = lpack::countBetas<NET_N_IN, LayerConfs...>();
     static constexpr int nunit = lpack::countUnits<LayerConfs...>();
 
+    // column tile of the dense input gradient chain d1 = d1_net*orig_d1 (PropagateDerived), such that a
+    // noutput x orig_d1_tile block of d1 (~16 KiB, but at least 64 columns) stays in L1 cache over all ninput rows of orig_d1
+    static constexpr int orig_d1_tile = std::max<int>(64, 16384/(sizeof(ValueT)*noutput));
+
     // static derivative config
     static constexpr StaticDFlags<DCONF> dconf{};
 
     // Static Output Deriv Array Sizes (depend on DCONF)
-    static constexpr int nd1_net = noutput*ninput; // helper array to calc d1 from backprop
-    static constexpr int nd1 = dconf.d1 ? noutput*orig_ninput : 0;
-    static constexpr int nd2 = dconf.d2 ? noutput*orig_ninput : 0;
-    static constexpr int nvd1 = dconf.vd1 ? noutput*nbeta : 0;
-    static constexpr int nvd2 = dconf.vd2 ? noutput*nbeta : 0;
+    static constexpr int nd1_net = State::nd1_net; // helper array to calc d1 from backprop
+    static constexpr int nd1 = State::nd1;
+    static constexpr int nd2 = State::nd2;
+    static constexpr int nvd1 = State::nvd1;
+    static constexpr int nvd2 = State::nvd2;
 
 
     // Basic assertions
     static_assert(nlayer == static_cast<int>(sizeof...(LayerConfs)), ""); // -> BUG!
     static_assert(ninput == NET_N_IN, ""); // -> BUG!
     static_assert(noutput == Shape::nunits[nlayer - 1], ""); // -> BUG!
+    static_assert(nbeta == detail::beta_offset<nlayer, LayerTuple>(), ""); // -> BUG!
     static_assert(nlayer > 1, "[TemplNet] nlayer <= 1");
     static_assert(lpack::hasNoEmptyLayer<(ninput > 0), LayerConfs...>(), "[TemplNet] LayerConf pack contains empty Layer.");
 
@@ -142,159 +214,166 @@ public:
     // --- Non-statics
 
 private:
-    // The layer tuple
-    LayerTuple _layers{};
-
-    // arrays of array.begin() pointers, for run-time indexing
-    const std::array<const ValueT *, nlayer> _out_begins;
-    const std::array<ValueT *, nlayer> _beta_begins;
-
-    // input array
-    std::array<ValueT, ninput> _input{};
+    // The weights of all layers, stored contiguously (layer by layer)
+    std::array<ValueT, nbeta> _beta{};
 
-    // deriv arrays
-    std::array<ValueT, nd1_net> _d1_net{};
-    std::array<ValueT, nd1> _d1{};
-    std::array<ValueT, nd2> _d2{};
-    std::array<ValueT, nvd1> _vd1{};
-    std::array<ValueT, nvd2> _vd2{};
+    // The default state, used by propagate calls without explicit state
+    State _state;
 
 public:
-    // dynamic (opt-out) derivative config (default to DCONF or explicit set in ctor)
+    // dynamic (opt-out) derivative config of the default state (default to DCONF or explicit set in ctor)
     DynamicDFlags dflags{DCONF};
 
 private:
     // some helper methods
 
-    void _propagateLayers() // continue the initialized fwd prop
+    void _propagateLayers(State &state) const // continue the initialized fwd prop
     {
         using namespace detail;
 
         // continue fwd prop
-        fwdprop_layers_impl(_layers, dflags, std::make_index_sequence<nlayer - 1>{});
+        fwdprop_layers_impl(state._layers, _beta, state.dflags, std::make_index_sequence<nlayer - 1>{});
 
         // backprop
-        std::get<nlayer - 1>(_layers).BackwardOutput(dflags);
-        backprop_layers_impl(_layers, dflags, std::make_index_sequence<nlayer - 1>{});
+        std::get<nlayer - 1>(state._layers).BackwardOutput(state.dflags);
+        backprop_layers_impl(state._layers, _beta, state.dflags, std::make_index_sequence<nlayer - 1>{});
 
         // store backprop grads into vd1/vd2
-        grad_layers_impl<0, nbeta>(_layers, _input, _vd1, _vd2, dflags, std::make_index_sequence<nlayer>{});
+        grad_layers_impl<0, nbeta>(state._layers, state._input, state._vd1, state._vd2, state.dflags, std::make_index_sequence<nlayer>{});
     }
 
     template <int ONIN = ORIG_N_IN>
-    typename std::enable_if<ONIN == NET_N_IN && nd2 != 0, void>::type _computeInputGradients() // use only if network input is the original input and D2 derivs allocated
+    typename std::enable_if<ONIN == NET_N_IN && nd2 != 0, void>::type _computeInputGradients(State &state) const // use only if network input is the original input and D2 derivs allocated
     {
         // store input grads into d1/d2
-        if (this->hasD2()) { // we used forward accumulation
-            _d1 = std::get<nlayer - 1>(_layers).d1();
-            _d2 = std::get<nlayer - 1>(_layers).d2();
+        if (state.hasD2()) { // we used forward accumulation
+            state._d1 = std::get<nlayer - 1>(state._layers).d1();
+            state._d2 = std::get<nlayer - 1>(state._layers).d2();
         }
         else { // compute original input derivative from backprop derivatives
-            std::get<0>(_layers).storeInputD1(_d1, dflags);
+            std::get<0>(state._layers).storeInputD1(state._d1.begin(), _beta.begin(), state.dflags);
         }
     }
 
     template <int ONIN = ORIG_N_IN>
-    typename std::enable_if<ONIN == NET_N_IN && nd2 == 0, void>::type _computeInputGradients() // use only if network input is the original input and D2 derivs not allocated
+    typename std::enable_if<ONIN == NET_N_IN && nd2 == 0, void>::type _computeInputGradients(State &state) const // use only if network input is the original input and D2 derivs not allocated
     {
         // compute original input derivative from backprop derivatives
-        std::get<0>(_layers).storeInputD1(_d1, dflags);
+        std::get<0>(state._layers).storeInputD1(state._d1.begin(), _beta.begin(), state.dflags);
     }
 
 
     template <int ONIN = ORIG_N_IN>
-    typename std::enable_if<ONIN != NET_N_IN && (nd1 != 0 || nd2 != 0), void>::type _computeInputGradients()
+    typename std::enable_if<ONIN != NET_N_IN && (nd1 != 0 || nd2 != 0), void>::type _computeInputGradients(State &/*state*/) const
     {
         throw std::runtime_error("[TemplNet::_processOrigInput] Original input derivatives require provided input-to-orig derivatives.");
     }
 
     template <int N_D2 = nd2>
-    typename std::enable_if<N_D2 != 0, void>::type _computeInputGradients(const ValueT orig_d1[]) // used if network input is not the original input and D2 derivs allocated
+    typename std::enable_if<N_D2 != 0, void>::type _computeInputGradients(State &state, const ValueT orig_d1[]) const // used if network input is not the original input and D2 derivs allocated
     {
         // store input grads into d1/d2
-        if (this->hasD2()) { // we used forward accumulation
-            _d1 = std::get<nlayer - 1>(_layers).d1();
-            _d2 = std::get<nlayer - 1>(_layers).d2();
+        if (state.hasD2()) { // we used forward accumulation
+            state._d1 = std::get<nlayer - 1>(state._layers).d1();
+            state._d2 = std::get<nlayer - 1>(state._layers).d2();
         }
         else { // compute original input derivative from backprop derivatives
-            _d1.fill(0.);
-            std::get<0>(_layers).storeInputD1(_d1_net, dflags);
-            for (int i = 0; i < noutput; ++i) {
-                for (int j = 0; j < ninput; ++j) {
-                    for (int k = 0; k < orig_ninput; ++k) {
-                        _d1[i*orig_ninput + k] += _d1_net[i*ninput + j]*orig_d1[j*orig_ninput + k];
+            this->_chainInputGradients(state, orig_d1);
+        }
+    }
+
+    template <int N_D2 = nd2>
+    typename std::enable_if<N_D2 == 0, void>::type _computeInputGradients(State &state, const ValueT orig_d1[]) const // used if network input is not the original input and D2 derivs not allocated
+    {
+        // compute original input derivative from backprop derivatives
+        this->_chainInputGradients(state, orig_d1);
+    }
+
+    void _chainInputGradients(State &state, const ValueT orig_d1[]) const // d1 = d1_net * orig_d1
+    {
+        state._d1.fill(0.);
+        std::get<0>(state._layers).storeInputD1(state._d1_net.begin(), _beta.begin(), state.dflags);
+        // blocked over the original inputs: every tile of d1 is accumulated over all rows of orig_d1 while it is
+        // cached, and within a tile every row segment of orig_d1 is loaded once and used for all outputs
+        for (int k0 = 0; k0 < orig_ninput; k0 += orig_d1_tile) {
+            const int k1 = std::min(orig_ninput, k0 + orig_d1_tile);
+            for (int j = 0; j < ninput; ++j) {
+                const ValueT * const orig_d1_j = orig_d1 + j*orig_ninput;
+                for (int i = 0; i < noutput; ++i) {
+                    const ValueT d1_net_ij = state._d1_net[i*ninput + j];
+                    if (d1_net_ij == 0) { continue; }
+                    ValueT * const d1_i = state._d1.begin() + i*orig_ninput;
+                    for (int k = k0; k < k1; ++k) {
+                        d1_i[k] += d1_net_ij*orig_d1_j[k];
                     }
                 }
             }
         }
     }
 
-    template <int N_D2 = nd2>
-    typename std::enable_if<N_D2 == 0, void>::type _computeInputGradients(const ValueT orig_d1[]) // used if network input is not the original input and D2 derivs not allocated
+    void _chainInputGradients(State &state, const SparseOrigD1<ValueT> &orig_d1) const // d1 = d1_net * orig_d1 (CSR), scales with nnz
     {
-        // compute original input derivative from backprop derivatives
-        _d1.fill(0.);
-        std::get<0>(_layers).storeInputD1(_d1_net, dflags);
+        state._d1.fill(0.);
+        std::get<0>(state._layers).storeInputD1(state._d1_net.begin(), _beta.begin(), state.dflags);
+        const int * const row_ptr = orig_d1.rowPtr().data();
+        const int * const col_idx = orig_d1.colIdx().data();
+        const ValueT * const values = orig_d1.values().data();
         for (int i = 0; i < noutput; ++i) {
+            ValueT * const d1_i = state._d1.begin() + i*orig_ninput;
             for (int j = 0; j < ninput; ++j) {
-                for (int k = 0; k < orig_ninput; ++k) {
-                    _d1[i*orig_ninput + k] += _d1_net[i*ninput + j]*orig_d1[j*orig_ninput + k];
+                const ValueT d1_net_ij = state._d1_net[i*ninput + j];
+                for (int l = row_ptr[j]; l < row_ptr[j + 1]; ++l) {
+                    d1_i[col_idx[l]] += d1_net_ij*values[l];
                 }
             }
         }
     }
 
     template <int ONIN = ORIG_N_IN>
-    typename std::enable_if<ONIN == NET_N_IN && nd1 != 0, void>::type _processOrigInput()
+    typename std::enable_if<ONIN == NET_N_IN && nd1 != 0, void>::type _processOrigInput(State &state) const
     {
         // feed original input
-        std::get<0>(_layers).ForwardInput(_input, dflags);
-        this->_propagateLayers();
-        if (this->hasD1()) { this->_computeInputGradients(); }
+        std::get<0>(state._layers).ForwardInput(state._input.begin(), _beta.begin(), state.dflags);
+        this->_propagateLayers(state);
+        if (state.hasD1()) { this->_computeInputGradients(state); }
     }
 
     template <int ONIN = ORIG_N_IN>
-    typename std::enable_if<ONIN == NET_N_IN && nd1 == 0, void>::type _processOrigInput()
+    typename std::enable_if<ONIN == NET_N_IN && nd1 == 0, void>::type _processOrigInput(State &state) const
     {
         // feed original input
-        std::get<0>(_layers).ForwardInput(_input, dflags);
-        this->_propagateLayers();
+        std::get<0>(state._layers).ForwardInput(state._input.begin(), _beta.begin(), state.dflags);
+        this->_propagateLayers(state);
     }
 
     template <int ONIN = ORIG_N_IN>
-    typename std::enable_if<ONIN != NET_N_IN, void>::type _processOrigInput()
+    typename std::enable_if<ONIN != NET_N_IN, void>::type _processOrigInput(State &/*state*/) const
     {
         throw std::runtime_error("[TemplNet::_processOrigInput] Original input can't be fed directly, because it differs in size from network input.");
     }
 
     template <int N_D1 = nd1>
-    typename std::enable_if<N_D1 != 0, void>::type _processDerivInput(const ValueT orig_d1[], const ValueT orig_d2[])
+    typename std::enable_if<N_D1 != 0, void>::type _processDerivInput(State &state, const ValueT orig_d1[], const ValueT orig_d2[]) const
     {
         // feed derived network input
-        std::get<0>(_layers).ForwardLayer(_input.data(), orig_d1, orig_d2, dflags);
-        this->_propagateLayers();
-        if (this->hasD1()) { this->_computeInputGradients(orig_d1); }
+        std::get<0>(state._layers).ForwardLayer(state._input.begin(), orig_d1, orig_d2, _beta.begin(), state.dflags);
+        this->_propagateLayers(state);
+        if (state.hasD1()) { this->_computeInputGradients(state, orig_d1); }
     }
 
     template <int N_D1 = nd1>
-    typename std::enable_if<N_D1 == 0, void>::type _processDerivInput(const ValueT orig_d1[], const ValueT orig_d2[])
+    typename std::enable_if<N_D1 == 0, void>::type _processDerivInput(State &state, const ValueT orig_d1[], const ValueT orig_d2[]) const
     {
         // feed derived network input
-        std::get<0>(_layers).ForwardLayer(_input.data(), orig_d1, orig_d2, dflags);
-        this->_propagateLayers();
+        std::get<0>(state._layers).ForwardLayer(state._input.begin(), orig_d1, orig_d2, _beta.begin(), state.dflags);
+        this->_propagateLayers(state);
     }
 
 public:
-    explicit constexpr TemplNet(DynamicDFlags init_dflags = DynamicDFlags{DCONF}):
-            _out_begins(tupl::make_fcont<std::array<const ValueT *, nlayer>>(_layers, [](const auto &layer) { return &layer.out().front(); })),
-            _beta_begins(tupl::make_fcont<std::array<ValueT *, nlayer>>(_layers, [](auto &layer) { return &layer.beta.front(); })),
-            dflags(init_dflags) {}
+    explicit constexpr TemplNet(DynamicDFlags init_dflags = DynamicDFlags{DCONF}): _state(init_dflags), dflags(init_dflags) {}
 
-    // hacky copy constructor that works for the moment
-    TemplNet(const TemplNet &other): TemplNet(other.dflags)
-    {
-        for (int i = 0; i < other.getNBeta(); ++i) { this->setBeta(i, other.getBeta(i)); }
-    }
+    // copies weights and dflags (the default state is fresh)
+    TemplNet(const TemplNet &other): _beta(other._beta), _state(other.dflags), dflags(other.dflags) {}
 
     // --- Get information about the NN structure
 
@@ -305,22 +384,23 @@ public:
     static constexpr int getNUnit(int i) { return Shape::nunits[i]; }
     static constexpr const auto &getUnitShape() { return Shape::nunits; }
 
-    // Read access to LayerTuple / individual layers
-    constexpr const LayerTuple &getLayers() const { return _layers; }
+    // Read access to the default state / its LayerTuple / individual layers
+    constexpr const State &getState() const { return _state; }
+    constexpr const LayerTuple &getLayers() const { return _state.getLayers(); }
     template <int I>
-    constexpr const auto &getLayer() const { return std::get<I>(_layers); }
-
-    // --- const get Value Arrays/Elements
-    constexpr const auto &getOutput() const { return std::get<nlayer - 1>(_layers).out(); } // get values of output layer
-    constexpr ValueT getOutput(int i) const { return this->getOutput()[i]; }
-    constexpr const auto &getD1() const { return _d1; } // get derivative of output with respect to input
-    constexpr ValueT getD1(int i, int j) const { return _d1[i*ninput + j]; }
-    constexpr const auto &getD2() const { return _d2; }
-    constexpr ValueT getD2(int i, int j) const { return _d2[i*ninput + j]; }
-    constexpr const auto &getVD1() const { return _vd1; }
-    constexpr ValueT getVD1(int i, int j) const { return _vd1[i*nbeta + j]; }
-    constexpr const auto &getVD2() const { return _vd2; }
-    constexpr ValueT getVD2(int i, int j) const { return _vd2[i*nbeta + j]; }
+    constexpr const auto &getLayer() const { return _state.template getLayer<I>(); }
+
+    // --- const get Value Arrays/Elements (of default state)
+    constexpr const auto &getOutput() const { return _state.getOutput(); } // get values of output layer
+    constexpr ValueT getOutput(int i) const { return _state.getOutput(i); }
+    constexpr const auto &getD1() const { return _state.getD1(); } // get derivative of output with respect to input
+    constexpr ValueT getD1(int i, int j) const { return _state.getD1(i, j); }
+    constexpr const auto &getD2() const { return _state.getD2(); }
+    constexpr ValueT getD2(int i, int j) const { return _state.getD2(i, j); }
+    constexpr const auto &getVD1() const { return _state.getVD1(); }
+    constexpr ValueT getVD1(int i, int j) const { return _state.getVD1(i, j); }
+    constexpr const auto &getVD2() const { return _state.getVD2(); }
+    constexpr ValueT getVD2(int i, int j) const { return _state.getVD2(i, j); }
 
     // --- check derivative setup
     static constexpr bool allowsD1() { return dconf.d1; }
@@ -338,95 +418,205 @@ public:
     static constexpr int getNBeta(int i) { return Shape::nbetas[i]; }
     static constexpr const auto &getBetaShape() { return Shape::nbetas; }
 
-    constexpr ValueT getBeta(int i) const // get beta by index
-    {
-        int idx = 0;
-        while (i >= Shape::nbetas[idx]) {
-            i -= Shape::nbetas[idx];
-            ++idx;
-        }
-        return *(_beta_begins[idx] + i);
-    }
+    constexpr const std::array<ValueT, nbeta> &getBetas() const { return _beta; } // the full contiguous weight array
+    constexpr ValueT getBeta(int i) const { return _beta[i]; } // get beta by index
 
     template <class IterT>
     constexpr void getBetas(IterT begin, const IterT end) const // get betas into range
     {
-        int idx = 0;
-        while (begin < end) {
-            const auto blocksize = (end - begin > Shape::nbetas[idx]) ? Shape::nbetas[idx] : end - begin;
-            std::copy(_beta_begins[idx], _beta_begins[idx] + blocksize, begin);
-            begin += blocksize;
-            ++idx;
-        }
+        std::copy(_beta.begin(), _beta.begin() + (end - begin), begin);
     }
     // get betas into array
-    constexpr void getBetas(std::array<ValueT, nbeta> &b_arr) const { return getBetas(b_arr.begin(), b_arr.end()); }
+    constexpr void getBetas(std::array<ValueT, nbeta> &b_arr) const { b_arr = _beta; }
 
-    constexpr void setBeta(int i, ValueT beta)
-    {
-        int idx = 0;
-        while (i >= Shape::nbetas[idx]) {
-            i -= Shape::nbetas[idx];
-            ++idx;
-        }
-        *(_beta_begins[idx] + i) = beta;
-    }
+    constexpr void setBeta(int i, ValueT beta) { _beta[i] = beta; }
 
     template <class IterT>
     constexpr void setBetas(IterT begin, const IterT end)
     {
-        int idx = 0;
-        while (begin < end) {
-            const auto blocksize = (end - begin > Shape::nbetas[idx]) ? Shape::nbetas[idx] : end - begin;
-            std::copy(begin, begin + blocksize, _beta_begins[idx]);
-            begin += blocksize;
-            ++idx;
-        }
+        std::copy(begin, end, _beta.begin());
     }
     // set betas from array
-    constexpr void setBetas(const std::array<ValueT, nbeta> &b_arr) { setBetas(b_arr.begin(), b_arr.end()); }
+    constexpr void setBetas(const std::array<ValueT, nbeta> &b_arr) { _beta = b_arr; }
     /*
     void randomizeBetas(); // has to be changed maybe if we add beta that are not "normal" weights*/
 
 
-    // --- Propagation
+    // --- Propagation with external state (thread-safe, as long as states are not shared)
+
+    constexpr void Propagate(State &state, const ValueT input[]) const
+    {
+        std::copy(input, input + ninput, state._input.begin());
+        this->_processOrigInput(state);
+    }
+
+    constexpr void Propagate(State &state, const std::array<ValueT, ninput> &in_arr) const
+    {
+        state._input = in_arr;
+        this->_processOrigInput(state);
+    }
+
+    constexpr void PropagateDerived(State &state, const ValueT input[], const ValueT orig_d1[], const ValueT orig_d2[]) const
+    {
+        std::copy(input, input + ninput, state._input.begin());
+        this->_processDerivInput(state, orig_d1, orig_d2);
+    }
+
+    constexpr void PropagateDerived(State &state, const std::array<ValueT, ninput> &in_arr, const std::array<ValueT, ninput*orig_ninput> &orig_d1, const std::array<ValueT, ninput*orig_ninput> &orig_d2) const
+    {
+        state._input = in_arr;
+        this->_processDerivInput(state, orig_d1.data(), orig_d2.data());
+    }
+
+    // Derived input with sparse orig_d1 (see SparseOrigD1.hpp): The input gradient is chained in
+    // reverse mode, i.e. the cost scales with the number of nonzeros of orig_d1.
+    // Second order input derivatives are not available in this mode (D2 is not computed, but set to zero).
+    void PropagateDerived(State &state, const ValueT input[], const SparseOrigD1<ValueT> &orig_d1) const
+    {
+        if (orig_d1.getNRows() != ninput || orig_d1.getNOrig() != orig_ninput) {
+            throw std::invalid_argument("[TemplNet::PropagateDerived] Sparse orig_d1 must be of size ninput x orig_ninput.");
+        }
+        std::copy(input, input + ninput, state._input.begin());
+        DynamicDFlags user_dflags = state.dflags;
+        state.dflags = user_dflags.AND(DynamicDFlags{DerivConfig::D1_VD12}); // no D2
+        std::get<0>(state._layers).ForwardLayer(state._input.begin(), nullptr, nullptr, _beta.begin(), state.dflags);
+        this->_propagateLayers(state);
+        if (state.hasD1()) { this->_chainInputGradients(state, orig_d1); }
+        state._d2.fill(0.); // no stale values of previous propagations
+        state.dflags = user_dflags;
+    }
+
+
+    // --- Propagation of original input through a feature map front end (see TemplFeatureMap.hpp)
+    // The features computed by fmap (which is part of the evaluation state, i.e. one per thread)
+    // are the network input, while D1/D2 are computed with respect to the original input.
+
+    template <class FMapT>
+    void PropagateFeatures(State &state, FMapT &fmap, const ValueT orig_input[]) const
+    {
+        static_assert(FMapT::orig_ninput == orig_ninput, "[TemplNet::PropagateFeatures] Feature map orig_ninput != ORIG_N_IN");
+        static_assert(FMapT::noutput == ninput, "[TemplNet::PropagateFeatures] Feature map noutput != NET_N_IN");
+
+        fmap.Compute(orig_input, state.hasD1() || state.hasD2());
+        state._input = fmap.out();
+        std::get<0>(state._layers).ForwardLayer(state._input.begin(), fmap.d1().begin(), fmap.d2().begin(), _beta.begin(), state.dflags);
+        this->_propagateLayers(state);
+        if (state.hasD1()) {
+            if (state.hasD2()) { // we used forward accumulation
+                state._d1 = std::get<nlayer - 1>(state._layers).d1();
+                state._d2 = std::get<nlayer - 1>(state._layers).d2();
+            }
+            else { // chain the backprop input gradient with the sparse feature derivatives
+                std::get<0>(state._layers).storeInputD1(state._d1_net.begin(), _beta.begin(), state.dflags);
+                fmap.chainD1(state._d1_net.begin(), noutput, state._d1.begin());
+            }
+        }
+    }
+
+    template <class FMapT>
+    void PropagateFeatures(State &state, FMapT &fmap, const std::array<ValueT, orig_ninput> &orig_in_arr) const
+    {
+        this->PropagateFeatures(state, fmap, orig_in_arr.data());
+    }
+
+
+    // --- Vector-Jacobian product mode (e.g. for training on a scalar loss)
+    // Propagate input and store the gradient of sum_i output_seed[i]*output_i with respect to the
+    // weights into grad_out (nbeta values, overwritten). Only a single backprop row is computed,
+    // i.e. the cost does not scale with noutput and the noutput x nbeta VD1 array is not used.
+    // Input derivatives are not computed, so this also works for ORIG_N_IN != NET_N_IN.
+    // Requires DCONF with D1 or VD1 (for the backprop buffers), state.dflags are ignored.
+
+    constexpr void PropagateVJP(State &state, const ValueT input[], const ValueT output_seed[], ValueT grad_out[]) const
+    {
+        static_assert(dconf.needsBD1(), "[TemplNet::PropagateVJP] DCONF must enable D1 or VD1.");
+        using namespace detail;
+        constexpr DynamicDFlags vjp_dflags{DerivConfig::D1_VD1}; // computes activation derivatives, but no forward accumulation
+
+        std::copy(input, input + ninput, state._input.begin());
+        std::get<0>(state._layers).ForwardLayer(state._input.begin(), nullptr, nullptr, _beta.begin(), vjp_dflags);
+        fwdprop_layers_impl(state._layers, _beta, vjp_dflags, std::make_index_sequence<nlayer - 1>{});
+
+        std::get<nlayer - 1>(state._layers).BackwardOutputVJP(output_seed);
+        backprop_vjp_layers_impl(state._layers, _beta, std::make_index_sequence<nlayer - 1>{});
+        grad_vjp_layers_impl<0>(state._layers, state._input, grad_out, std::make_index_sequence<nlayer>{});
+    }
+
+    constexpr void PropagateVJP(State &state, const std::array<ValueT, ninput> &in_arr, const std::array<ValueT, noutput> &output_seed, std::array<ValueT, nbeta> &grad_out) const
+    {
+        this->PropagateVJP(state, in_arr.data(), output_seed.data(), grad_out.data());
+    }
+
+
+    // --- Propagation with the default state (using this->dflags)
 
     constexpr void Propagate(const ValueT input[])
     {
-        std::copy(input, input + ninput, _input.begin());
-        this->_processOrigInput();
+        _state.dflags = dflags;
+        this->Propagate(_state, input);
     }
 
     constexpr void Propagate(const std::array<ValueT, ninput> &in_arr)
     {
-        _input = in_arr;
-        this->_processOrigInput();
+        _state.dflags = dflags;
+        this->Propagate(_state, in_arr);
     }
 
     constexpr void PropagateDerived(const ValueT input[], const ValueT orig_d1[], const ValueT orig_d2[])
     {
-        std::copy(input, input + ninput, _input.begin());
-        this->_processDerivInput(orig_d1, orig_d2);
+        _state.dflags = dflags;
+        this->PropagateDerived(_state, input, orig_d1, orig_d2);
     }
 
     constexpr void PropagateDerived(const std::array<ValueT, ninput> &in_arr, const std::array<ValueT, ninput*orig_ninput> &orig_d1, const std::array<ValueT, ninput*orig_ninput> &orig_d2)
     {
-        _input = in_arr;
-        this->_processDerivInput(orig_d1.data(), orig_d2.data());
+        _state.dflags = dflags;
+        this->PropagateDerived(_state, in_arr, orig_d1, orig_d2);
+    }
+
+    void PropagateDerived(const ValueT input[], const SparseOrigD1<ValueT> &orig_d1)
+    {
+        _state.dflags = dflags;
+        this->PropagateDerived(_state, input, orig_d1);
+    }
+
+
+    template <class FMapT>
+    void PropagateFeatures(FMapT &fmap, const ValueT orig_input[])
+    {
+        _state.dflags = dflags;
+        this->PropagateFeatures(_state, fmap, orig_input);
+    }
+
+    template <class FMapT>
+    void PropagateFeatures(FMapT &fmap, const std::array<ValueT, orig_ninput> &orig_in_arr)
+    {
+        _state.dflags = dflags;
+        this->PropagateFeatures(_state, fmap, orig_in_arr);
+    }
+
+    constexpr void PropagateVJP(const ValueT input[], const ValueT output_seed[], ValueT grad_out[])
+    {
+        this->PropagateVJP(_state, input, output_seed, grad_out);
+    }
+
+    constexpr void PropagateVJP(const std::array<ValueT, ninput> &in_arr, const std::array<ValueT, noutput> &output_seed, std::array<ValueT, nbeta> &grad_out)
+    {
+        this->PropagateVJP(_state, in_arr, output_seed, grad_out);
     }
 
 
     // --- Store FFNN weights to stream/file
     // NOTE: Dynamic dflags are not stored!
-    void storeToStream(std::ofstream &ostream)
+    void storeToStream(std::ofstream &ostream) const
     {
         ostream << typeid(*this).name() << "\n";
         ostream << std::setprecision(18); // to achieve maximal accuracy of doubles
-        for (int i = 0; i < nbeta - 1; ++i) { ostream << this->getBeta(i) << " "; }
-        ostream << this->getBeta(nbeta - 1) << std::endl;
+        for (int i = 0; i < nbeta - 1; ++i) { ostream << _beta[i] << " "; }
+        ostream << _beta[nbeta - 1] << std::endl;
     }
 
-    void storeToFile(const std::string &filename)
+    void storeToFile(const std::string &filename) const
     {
         std::ofstream file;
         file.open(filename);
@@ -446,7 +636,7 @@ public:
         for (int i = 0; i < nbeta; ++i) {
             double beta;
             istream >> beta;
-            this->setBeta(i, beta);
+            _beta[i] = static_cast<ValueT>(beta);
         }
     }
 
@@ -457,6 +647,50 @@ public:
         this->loadFromStream(file, checkTypeID);
         file.close();
     }
+
+
+    // --- Store/Load FFNN weights in the versioned binary format (see BinaryWeights.hpp)
+    // The stored shape (ninput, units and activation functions per layer) is checked on load,
+    // so files can be exchanged with other compilers, precisions, DCONFs and poly networks.
+    static WeightShape getWeightShape()
+    {
+        WeightShape shape;
+        shape.ninput = ninput;
+        shape.nunits.assign(Shape::nunits.begin(), Shape::nunits.end());
+        shape.actf_ids = detail::actf_poly_ids<LayerTuple>(std::make_index_sequence<nlayer>{});
+        return shape;
+    }
+
+    void storeToBinaryStream(std::ostream &ostream) const
+    {
+        const std::vector<double> betas(_beta.begin(), _beta.end());
+        writeBinaryWeights(ostream, getWeightShape(), betas.data());
+    }
+
+    void storeToBinaryFile(const std::string &filename) const
+    {
+        std::ofstream file(filename, std::ios::binary);
+        this->storeToBinaryStream(file);
+    }
+
+    void loadFromBinaryStream(std::istream &istream)
+    {
+        std::vector<double> betas;
+        if (readBinaryWeights(istream, betas) != getWeightShape()) {
+            throw std::invalid_argument("[TemplNet::loadFromBinaryStream] The stored shape is not identical to the shape of this FFNN.");
+        }
+        std::transform(betas.begin(), betas.end(), _beta.begin(), [](double b) { return static_cast<ValueT>(b); });
+    }
+
+    // memory maps the file and reads the weights straight from the mapping
+    void loadFromBinaryFile(const std::string &filename)
+    {
+        const MappedBinaryWeights mapped(filename);
+        if (mapped.getShape() != getWeightShape()) {
+            throw std::invalid_argument("[TemplNet::loadFromBinaryFile] The stored shape is not identical to the shape of this FFNN.");
+        }
+        std::transform(mapped.getBetas(), mapped.getBetas() + nbeta, _beta.begin(), [](double b) { return static_cast<ValueT>(b); });
+    }
 };
 } // templ
 
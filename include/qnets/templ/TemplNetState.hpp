@@ -0,0 +1,104 @@
+#ifndef QNETS_TEMPL_TEMPLNETSTATE_HPP
+#define QNETS_TEMPL_TEMPLNETSTATE_HPP
+
+#include "qnets/tool/TupleTools.hpp"
+#include "qnets/templ/TemplLayer.hpp"
+#include "qnets/templ/LayerPackTools.hpp"
+#include "qnets/templ/DerivConfig.hpp"
+#include "qnets/templ/PrecConfig.hpp"
+
+#include <array>
+#include <tuple>
+
+namespace templ
+{
+// Forward declaration of the net, which is the only one allowed to write into states
+template <typename PrecT, DerivConfig DCONF, int ORIG_N_IN, int NET_N_IN, class ... LayerConfs>
+class TemplNet;
+
+
+// --- The evaluation state of a TemplNet
+//
+// Holds everything that is written during a propagation (layer values,
+// derivative buffers and the final derivative arrays), but no weights.
+// The weights live in TemplNet and are only read while propagating, so
+// one TemplNet can be propagated concurrently as long as every thread
+// passes its own TemplNetState. The state type matching a net is
+// available as TemplNet<...>::State .
+//
+template <typename PrecT, DerivConfig DCONF, int ORIG_N_IN, int NET_N_IN, class ... LayerConfs>
+class TemplNetState
+{
+    friend class TemplNet<PrecT, DCONF, ORIG_N_IN, NET_N_IN, LayerConfs...>;
+
+public:
+    // Precision types (see PrecConfig.hpp)
+    using ValueT = value_t<PrecT>;
+
+    // LayerTuple type
+    using LayerTuple = typename lpack::LayerPackTuple<PrecT, DCONF, ORIG_N_IN, NET_N_IN, LayerConfs...>::type;
+
+    // some basic static sizes
+    static constexpr int nlayer = tupl::count<int, LayerTuple>();
+    static constexpr int orig_ninput = ORIG_N_IN;
+    static constexpr int ninput = std::tuple_element<0, LayerTuple>::type::ninput;
+    static constexpr int noutput = std::tuple_element<nlayer - 1, LayerTuple>::type::noutput;
+    static constexpr int nbeta = lpack::countBetas<NET_N_IN, LayerConfs...>();
+
+    // static derivative config
+    static constexpr StaticDFlags<DCONF> dconf{};
+
+    // Static Output Deriv Array Sizes (depend on DCONF)
+    static constexpr int nd1_net = noutput*ninput; // helper array to calc d1 from backprop
+    static constexpr int nd1 = dconf.d1 ? noutput*orig_ninput : 0;
+    static constexpr int nd2 = dconf.d2 ? noutput*orig_ninput : 0;
+    static constexpr int nvd1 = dconf.vd1 ? noutput*nbeta : 0;
+    static constexpr int nvd2 = dconf.vd2 ? noutput*nbeta : 0;
+
+private:
+    // The layer tuple
+    LayerTuple _layers{};
+
+    // input array
+    std::array<ValueT, ninput> _input{};
+
+    // deriv arrays
+    std::array<ValueT, nd1_net> _d1_net{};
+    std::array<ValueT, nd1> _d1{};
+    std::array<ValueT, nd2> _d2{};
+    std::array<ValueT, nvd1> _vd1{};
+    std::array<ValueT, nvd2> _vd2{};
+
+public:
+    // dynamic (opt-out) derivative config (default to DCONF or explicit set in ctor)
+    DynamicDFlags dflags{DCONF};
+
+    explicit constexpr TemplNetState(DynamicDFlags init_dflags = DynamicDFlags{DCONF}): dflags(init_dflags) {}
+
+    // Read access to LayerTuple / individual layers
+    constexpr const LayerTuple &getLayers() const { return _layers; }
+    template <int I>
+    constexpr const auto &getLayer() const { return std::get<I>(_layers); }
+
+    // --- const get Value Arrays/Elements
+    constexpr const auto &getInput() const { return _input; }
+    constexpr const auto &getOutput() const { return std::get<nlayer - 1>(_layers).out(); } // get values of output layer
+    constexpr ValueT getOutput(int i) const { return this->getOutput()[i]; }
+    constexpr const auto &getD1() const { return _d1; } // get derivative of output with respect to (original) input
+    constexpr ValueT getD1(int i, int j) const { return _d1[i*orig_ninput + j]; }
+    constexpr const auto &getD2() const { return _d2; }
+    constexpr ValueT getD2(int i, int j) const { return _d2[i*orig_ninput + j]; }
+    constexpr const auto &getVD1() const { return _vd1; }
+    constexpr ValueT getVD1(int i, int j) const { return _vd1[i*nbeta + j]; }
+    constexpr const auto &getVD2() const { return _vd2; }
+    constexpr ValueT getVD2(int i, int j) const { return _vd2[i*nbeta + j]; }
+
+    // --- check derivative setup
+    constexpr bool hasD1() const { return dconf.d1 && dflags.d1(); }
+    constexpr bool hasD2() const { return dconf.d2 && dflags.d2(); }
+    constexpr bool hasVD1() const { return dconf.vd1 && dflags.vd1(); }
+    constexpr bool hasVD2() const { return dconf.vd2 && dflags.vd2(); }
+};
+} // templ
+
+#endif
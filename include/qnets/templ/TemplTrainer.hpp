@@ -0,0 +1,267 @@
+#ifndef QNETS_TEMPL_TEMPLTRAINER_HPP
+#define QNETS_TEMPL_TEMPLTRAINER_HPP
+
+#include "qnets/poly/train/NNOptimizer.hpp"
+#include "qnets/poly/train/NNTrainingData.hpp"
+#include "qnets/poly/train/NNTrainingConfig.hpp"
+#include "qnets/templ/DerivConfig.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdio>
+#include <memory>
+#include <numeric>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+#ifdef OPENMP
+#include <omp.h>
+#endif
+
+namespace templ
+{
+// --- Optimizer configuration of the TemplTrainer (shared with NNTrainerSGD)
+
+using ::OptMethod;
+using ::OptimizerConfig;
+
+
+// --- Native mini-batch trainer for TemplNet
+//
+// Minimizes the same least squares cost as the NNTrainerGSL, i.e.
+//   1/ntraining sum_i sum_j (w_ij*(f_j(x_i) - y_ij))^2 + lambda_r^2/nbeta sum_k beta_k^2 ,
+// by SGD, momentum SGD or Adam on shuffled mini-batches (one epoch per step of tconfig.maxn_steps).
+// The data layout and split (training/validation/testing) follows NNTrainingData, the
+// early stopping follows NNTrainingConfig (maxn_novali epochs without improved validation loss).
+// Derivative fitting (lambda_d1/lambda_d2 > 0) is not supported, because TemplNet provides
+// no cross derivatives of D1/D2 with respect to the weights.
+//
+// The loss gradient of every sample is obtained by the existing backprop (VD1), so NetT must
+// allow VD1. Every worker owns an evaluation state and a gradient buffer and processes a fixed
+// contiguous slice of the mini-batch. The buffers are reduced in worker order, so the result does
+// not depend on the thread scheduling (only on nworkers).
+template <class NetT>
+class TemplTrainer
+{
+public:
+    using ValueT = typename NetT::ValueT;
+    using State = typename NetT::State;
+
+    static constexpr int ninput = NetT::ninput;
+    static constexpr int noutput = NetT::noutput;
+    static constexpr int nbeta = NetT::nbeta;
+
+    static_assert(NetT::allowsVD1(), "[TemplTrainer] NetT must allow VD1.");
+
+private:
+    const NNTrainingData _tdata; // shallow copy, like in NNTrainer
+    const NNTrainingConfig _tconfig;
+    const OptimizerConfig _oconfig;
+    const int _nworkers;
+
+    // per-worker evaluation states, inputs and gradient buffers
+    std::vector<std::unique_ptr<State>> _states;
+    std::vector<std::array<ValueT, ninput>> _inputs;
+    std::vector<double> _grad_buf; // nworkers x nbeta
+    std::vector<double> _loss_buf; // nworkers
+
+    NNOptimizer _optimizer;
+
+    std::mt19937_64 _rgen;
+    std::vector<int> _perm; // shuffled training indices
+
+    static int _defaultNWorkers()
+    {
+#ifdef OPENMP
+        return omp_get_max_threads();
+#else
+        return 1;
+#endif
+    }
+
+    // propagate data point idata with worker iw and return its squared weighted residual,
+    // adding the scaled gradient to grad (if not nullptr)
+    double _sampleLoss(const NetT &net, int iw, int idata, double scale, double grad[])
+    {
+        State &state = *_states[iw];
+        std::copy(_tdata.x[idata], _tdata.x[idata] + ninput, _inputs[iw].begin());
+        net.Propagate(state, _inputs[iw].data());
+
+        double loss = 0.;
+        for (int j = 0; j < noutput; ++j) {
+            const double w = _tdata.w[idata][j];
+            const double diff = static_cast<double>(state.getOutput(j)) - _tdata.y[idata][j];
+            loss += w*w*diff*diff;
+            if (grad != nullptr) {
+                const double seed = 2.*scale*w*w*diff;
+                for (int k = 0; k < nbeta; ++k) {
+                    grad[k] += seed*state.getVD1(j, k);
+                }
+            }
+        }
+        return loss;
+    }
+
+    // squared loss sum (and gradient, if grad != nullptr) over the data indices idx[0..n)
+    double _computeLoss(const NetT &net, const int idx[], int n, double grad[])
+    {
+        const double scale = 1./n;
+        if (grad != nullptr) { std::fill(_grad_buf.begin(), _grad_buf.end(), 0.); }
+#ifdef OPENMP
+#pragma omp parallel for schedule(static, 1)
+#endif
+        for (int iw = 0; iw < _nworkers; ++iw) {
+            double * const my_grad = (grad != nullptr) ? _grad_buf.data() + iw*nbeta : nullptr;
+            double my_loss = 0.;
+            for (int i = (iw*n)/_nworkers; i < ((iw + 1)*n)/_nworkers; ++i) {
+                my_loss += this->_sampleLoss(net, iw, idx[i], scale, my_grad);
+            }
+            _loss_buf[iw] = my_loss;
+        }
+
+        // deterministic reduction
+        double loss = 0.;
+        for (int iw = 0; iw < _nworkers; ++iw) { loss += _loss_buf[iw]; }
+        if (grad != nullptr) {
+            std::copy(_grad_buf.begin(), _grad_buf.begin() + nbeta, grad);
+            for (int iw = 1; iw < _nworkers; ++iw) {
+                for (int k = 0; k < nbeta; ++k) { grad[k] += _grad_buf[iw*nbeta + k]; }
+            }
+        }
+        return scale*loss;
+    }
+
+    // loss over the contiguous data range [begin, end)
+    double _computeRangeLoss(const NetT &net, int begin, int end)
+    {
+        std::vector<int> idx(end - begin);
+        std::iota(idx.begin(), idx.end(), begin);
+        return this->_computeLoss(net, idx.data(), end - begin, nullptr);
+    }
+
+    double _regLoss(const NetT &net) const
+    {
+        const double lambda_r_fac = _tconfig.lambda_r*_tconfig.lambda_r/nbeta;
+        double reg = 0.;
+        for (int k = 0; k < nbeta; ++k) { reg += lambda_r_fac*net.getBeta(k)*net.getBeta(k); }
+        return reg;
+    }
+
+    // apply one optimizer update with the loss gradient grad
+    void _update(NetT &net, const double grad[])
+    {
+        std::array<ValueT, nbeta> betas = net.getBetas();
+        _optimizer.step(grad, betas.data(), nbeta);
+        net.setBetas(betas);
+    }
+
+public:
+    TemplTrainer(const NNTrainingData &tdata, const NNTrainingConfig &tconfig, const OptimizerConfig &oconfig = OptimizerConfig{}):
+            _tdata(tdata), _tconfig(tconfig), _oconfig(oconfig),
+            _nworkers(oconfig.nworkers > 0 ? oconfig.nworkers : _defaultNWorkers()),
+            _inputs(_nworkers), _grad_buf(_nworkers*nbeta), _loss_buf(_nworkers),
+            _optimizer(oconfig), _rgen(oconfig.seed), _perm(tdata.ntraining)
+    {
+        if (_tdata.xndim != ninput || _tdata.yndim != noutput) {
+            throw std::invalid_argument("[TemplTrainer] Data dimensions don't match the network.");
+        }
+        if (_tdata.ntraining < 1 || _tdata.ntraining + _tdata.nvalidation > _tdata.ndata) {
+            throw std::invalid_argument("[TemplTrainer] Invalid training/validation data split.");
+        }
+        if (_tconfig.lambda_d1 > 0 || _tconfig.lambda_d2 > 0) {
+            throw std::invalid_argument("[TemplTrainer] Derivative fitting (lambda_d1/lambda_d2 > 0) is not supported.");
+        }
+        for (int iw = 0; iw < _nworkers; ++iw) {
+            _states.emplace_back(std::make_unique<State>(DynamicDFlags{DerivConfig::VD1}));
+        }
+        std::iota(_perm.begin(), _perm.end(), 0);
+    }
+
+    int getNWorkers() const { return _nworkers; }
+
+    // reset the optimizer moments and shuffling
+    void reset()
+    {
+        _optimizer.reset();
+        _rgen.seed(_oconfig.seed);
+        std::iota(_perm.begin(), _perm.end(), 0);
+    }
+
+    // cost (as minimized, including regularization) on the full training set and its gradient
+    double computeTrainingLoss(const NetT &net, std::array<double, nbeta> &grad)
+    {
+        const double loss = this->_computeLoss(net, _perm.data(), _tdata.ntraining, grad.data());
+        const double lambda_r_fac = _tconfig.lambda_r*_tconfig.lambda_r/nbeta;
+        for (int k = 0; k < nbeta; ++k) { grad[k] += 2.*lambda_r_fac*net.getBeta(k); }
+        return loss + this->_regLoss(net);
+    }
+
+    // compute testing residual sqrt(1/N sum (w*(f(x) - y))^2) of net vs testing data (vs training+validation if no testing present),
+    // like NNTrainer::computeResidual
+    double computeResidual(const NetT &net, bool flag_r = false)
+    {
+        const int ntrain = _tdata.ntraining + _tdata.nvalidation;
+        const bool flag_test = ntrain < _tdata.ndata;
+        double resi = flag_test ? this->_computeRangeLoss(net, ntrain, _tdata.ndata) : this->_computeRangeLoss(net, 0, ntrain);
+        if (flag_r) { resi += this->_regLoss(net); }
+        return std::sqrt(resi);
+    }
+
+    // train net for (up to) tconfig.maxn_steps epochs, starting from its current weights. If validation data is present,
+    // stops after tconfig.maxn_novali epochs without improved validation loss (if > 0) and leaves the net at the weights
+    // with best validation loss. Returns the number of epochs done.
+    int findFit(NetT &net, int verbose = 0)
+    {
+        const int ntrain = _tdata.ntraining;
+        const int nbatch = (_oconfig.batch_size > 0 && _oconfig.batch_size < ntrain) ? _oconfig.batch_size : ntrain;
+        const bool flag_vali = _tdata.nvalidation > 0;
+        const double lambda_r_fac = _tconfig.lambda_r*_tconfig.lambda_r/nbeta;
+
+        std::array<double, nbeta> grad{};
+        std::array<ValueT, nbeta> best_betas = net.getBetas();
+        double best_vali = flag_vali ? this->_computeRangeLoss(net, ntrain, ntrain + _tdata.nvalidation) : 0.;
+        int count_novali = 0;
+
+        int iepoch = 0;
+        while (iepoch < _tconfig.maxn_steps) {
+            std::shuffle(_perm.begin(), _perm.end(), _rgen);
+            double train_loss = 0.;
+            for (int ib = 0; ib + nbatch <= ntrain; ib += nbatch) { // incomplete last batch is dropped (reshuffled next epoch)
+                train_loss += nbatch*this->_computeLoss(net, _perm.data() + ib, nbatch, grad.data());
+                for (int k = 0; k < nbeta; ++k) { grad[k] += 2.*lambda_r_fac*net.getBeta(k); }
+                this->_update(net, grad.data());
+            }
+            ++iepoch;
+
+            if (verbose > 1) {
+                fprintf(stderr, "[TemplTrainer] epoch %i: mean training loss %g\n", iepoch, train_loss/((ntrain/nbatch)*nbatch));
+            }
+
+            if (flag_vali) {
+                const double vali = this->_computeRangeLoss(net, ntrain, ntrain + _tdata.nvalidation);
+                if (vali < best_vali) {
+                    best_vali = vali;
+                    best_betas = net.getBetas();
+                    count_novali = 0;
+                }
+                else if (_tconfig.maxn_novali > 0 && ++count_novali >= _tconfig.maxn_novali) {
+                    if (verbose > 0) {
+                        fprintf(stderr, "[TemplTrainer] No improvement of validation loss for %i epochs. Stopping early.\n", count_novali);
+                    }
+                    break;
+                }
+            }
+        }
+
+        if (flag_vali) { net.setBetas(best_betas); }
+        if (verbose > 0) {
+            fprintf(stderr, "[TemplTrainer] Finished after %i epochs with testing residual %f.\n", iepoch, this->computeResidual(net));
+        }
+        return iepoch;
+    }
+};
+} // templ
+
+#endif
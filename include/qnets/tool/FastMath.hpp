@@ -0,0 +1,292 @@
+#ifndef QNETS_TOOL_FASTMATH_HPP
+#define QNETS_TOOL_FASTMATH_HPP
+
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+namespace fmath
+{
+// Collection of fast, branch-free approximations of elementary functions,
+// for usage in the Fast* array activation functions (see qnets/actf/).
+// Everything is written as straight-line code on integer/floating point
+// values (no table lookups, no branches, no libm calls), such that loops
+// over arrays calling these functions can be auto-vectorized (e.g. -O3).
+// Implemented for float and double, with polynomial degrees adapted to
+// the respective precision.
+//
+// Accuracy bounds (checked in test/ut16, eps = machine epsilon):
+//   exp(x):    rel. error < 4 eps            (double: |x| < 708, float: |x| < 87, saturates beyond)
+//   log1p(x):  abs. error < 4 eps*(1+|log1p(x)|), for x > -1 (and finite)
+//   tanh(x):   abs. error < 4 eps
+//   sin/cos(x):abs. error < 4 eps, for |x| < 1e5 (double) / 1e3 (float)
+// Special values (inf/nan) are NOT handled.
+//
+// Note: The loops over double values need 64-bit integer vector compares for
+// the argument clamping of exp (SSE4.2 or AVX, e.g. via -march=native),
+// while float loops vectorize with plain SSE2 already.
+
+namespace detail
+{
+// --- Bit casting (memcpy based, optimized away by the compiler)
+
+template <typename ValueT>
+struct FloatBits;
+
+template <>
+struct FloatBits<double>
+{
+    using UIntT = uint64_t;
+    static constexpr int nmant = 52; // mantissa bits
+    static constexpr UIntT expo_bias = 1023;
+    static constexpr double shifter = 6755399441055744.; // 1.5*2^52, adding it rounds to integer
+    static constexpr UIntT shifter_bits = 0x4338000000000000ULL;
+    static constexpr UIntT sqrthalf_bits = 0x3fe6a09e667f3bcdULL; // bits of sqrt(1/2)
+    static constexpr double max_exp_arg = 708.;
+};
+
+template <>
+struct FloatBits<float>
+{
+    using UIntT = uint32_t;
+    static constexpr int nmant = 23;
+    static constexpr UIntT expo_bias = 127;
+    static constexpr float shifter = 12582912.f; // 1.5*2^23
+    static constexpr UIntT shifter_bits = 0x4b400000U;
+    static constexpr UIntT sqrthalf_bits = 0x3f3504f3U;
+    static constexpr float max_exp_arg = 87.f;
+};
+
+template <typename ValueT>
+inline typename FloatBits<ValueT>::UIntT toBits(ValueT x)
+{
+    typename FloatBits<ValueT>::UIntT u;
+    std::memcpy(&u, &x, sizeof(ValueT));
+    return u;
+}
+
+template <typename ValueT>
+inline ValueT fromBits(typename FloatBits<ValueT>::UIntT u)
+{
+    ValueT x;
+    std::memcpy(&x, &u, sizeof(ValueT));
+    return x;
+}
+
+// --- Branch-free selections (floating point comparisons inhibit vectorization,
+// unless -fno-trapping-math is used, so we work on the bits instead)
+
+// x clamped to [-maxabs, maxabs], for maxabs >= 0
+template <typename ValueT>
+inline ValueT clampAbs(ValueT x, ValueT maxabs)
+{
+    using UIntT = typename FloatBits<ValueT>::UIntT;
+    using IntT = typename std::make_signed<UIntT>::type;
+    constexpr UIntT sign_mask = UIntT(1) << (8*sizeof(UIntT) - 1);
+    const UIntT sign = toBits(x) & sign_mask;
+    const auto absbits = static_cast<IntT>(toBits(x) ^ sign); // for positive values the bit order is the value order
+    const auto maxbits = static_cast<IntT>(toBits(maxabs));
+    return fromBits<ValueT>(static_cast<UIntT>(absbits < maxbits ? absbits : maxbits) | sign);
+}
+
+// (signbit(x) ? a : b)
+template <typename ValueT>
+inline ValueT selectNeg(ValueT x, ValueT a, ValueT b)
+{
+    using UIntT = typename FloatBits<ValueT>::UIntT;
+    const UIntT mask = UIntT(0) - (toBits(x) >> (8*sizeof(UIntT) - 1)); // all bits set if x is negative
+    return fromBits<ValueT>((toBits(a) & mask) | (toBits(b) & ~mask));
+}
+
+// --- Polynomials (Horner scheme, highest degree first)
+
+template <typename ValueT>
+inline ValueT horner(ValueT /*x*/, ValueT c) { return c; }
+
+template <typename ValueT, typename ... Coeffs>
+inline ValueT horner(ValueT x, ValueT c0, ValueT c1, Coeffs ... cs)
+{
+    return horner(x, c0*x + c1, cs...);
+}
+
+// Taylor polynomial of exp(r), for |r| <= ln(2)/2
+inline double expPoly(double r)
+{   // degree 12, truncation error < 2e-16
+    return horner(r, 1./479001600., 1./39916800., 1./3628800., 1./362880., 1./40320., 1./5040., 1./720., 1./120., 1./24., 1./6., 0.5, 1., 1.);
+}
+
+inline float expPoly(float r)
+{   // degree 7, truncation error < 1e-8
+    return horner(r, 1.f/5040.f, 1.f/720.f, 1.f/120.f, 1.f/24.f, 1.f/6.f, 0.5f, 1.f, 1.f);
+}
+
+// 2*atanh(s)/s = 2*(1 + s^2/3 + s^4/5 + ...), as polynomial in s2 = s^2, for |s| <= 0.1716
+inline double atanhPoly(double s2)
+{   // up to s^20, truncation error < 1e-17
+    return horner(s2, 2./21., 2./19., 2./17., 2./15., 2./13., 2./11., 2./9., 2./7., 2./5., 2./3., 2.);
+}
+
+inline float atanhPoly(float s2)
+{   // up to s^10, truncation error < 2e-9
+    return horner(s2, 2.f/11.f, 2.f/9.f, 2.f/7.f, 2.f/5.f, 2.f/3.f, 2.f);
+}
+
+// Taylor polynomial of sin(r)/r, as polynomial in r2 = r^2, for |r| <= pi/2
+inline double sinPoly(double r2)
+{   // up to r^23, truncation error < 4e-18
+    return horner(r2, -1./25852016738884976640000., 1./51090942171709440000., -1./121645100408832000., 1./355687428096000.,
+                  -1./1307674368000., 1./6227020800., -1./39916800., 1./362880., -1./5040., 1./120., -1./6., 1.);
+}
+
+inline float sinPoly(float r2)
+{   // up to r^15, truncation error < 7e-10
+    return horner(r2, -1.f/1307674368000.f, 1.f/6227020800.f, -1.f/39916800.f, 1.f/362880.f, -1.f/5040.f, 1.f/120.f, -1.f/6.f, 1.f);
+}
+
+// ln(2) and pi, split in high parts with trailing zero bits and low corrections (Cody-Waite),
+// such that multiples n*hi are exact for the supported argument ranges
+template <typename ValueT>
+struct Consts;
+
+template <>
+struct Consts<double>
+{
+    static constexpr double log2e = 1.4426950408889634;
+    static constexpr double ln2_hi = 6.93147180369123816490e-01;
+    static constexpr double ln2_lo = 1.90821492927058770002e-10;
+    static constexpr double invpi = 0.31830988618379067154;
+    static constexpr double pi_hi = 3.1415926534682512;
+    static constexpr double pi_lo = 1.2154201012607932e-10;
+    static constexpr double pi_lo2 = 4.044532497591901e-21;
+};
+
+template <>
+struct Consts<float>
+{
+    static constexpr float log2e = 1.44269504f;
+    static constexpr float ln2_hi = 0.693145752f;
+    static constexpr float ln2_lo = 1.42860677e-06f;
+    static constexpr float invpi = 0.318309886f;
+    static constexpr float pi_hi = 3.140625f;
+    static constexpr float pi_lo = 9.67502594e-04f;
+    static constexpr float pi_lo2 = 1.50995803e-07f;
+};
+} // detail
+
+
+// --- exp(x)
+template <typename ValueT>
+inline ValueT exp(ValueT x)
+{
+    using namespace detail;
+    using FB = FloatBits<ValueT>;
+    using C = Consts<ValueT>;
+
+    // clamp to the range where 2^n is a normal number
+    x = clampAbs(x, FB::max_exp_arg);
+
+    // x = n*ln2 + r, with integer n and |r| <= ln2/2
+    const ValueT nshift = x*C::log2e + FB::shifter; // n is now stored in the low mantissa bits
+    const ValueT n = nshift - FB::shifter;
+    const ValueT r = (x - n*C::ln2_hi) - n*C::ln2_lo;
+
+    // 2^n via the exponent bits (the low mantissa bits of nshift hold n + 2^(nmant-1))
+    const auto twon = fromBits<ValueT>((toBits(nshift) + FB::expo_bias) << FB::nmant);
+
+    return expPoly(r)*twon;
+}
+
+
+// --- log1p(x), for x > -1
+template <typename ValueT>
+inline ValueT log1p(ValueT x)
+{
+    using namespace detail;
+    using FB = FloatBits<ValueT>;
+    using UIntT = typename FB::UIntT;
+    using C = Consts<ValueT>;
+    constexpr ValueT one = 1;
+    constexpr UIntT expo_mask = ((UIntT(1) << (8*sizeof(UIntT) - FB::nmant)) - 1) << FB::nmant; // all non-mantissa bits
+    constexpr UIntT k_bias = UIntT(1) << (8*sizeof(UIntT) - FB::nmant - 1); // keeps (signed) k positive
+
+    // u = 1 + x, with correction c such that log1p(x) = log(u) + c/u (to 1st order)
+    const ValueT u = one + x;
+    const ValueT c = x - (u - one);
+
+    // u = 2^k * m with sqrt(1/2) <= m < sqrt(2)
+    const UIntT tmp = toBits(u) - FB::sqrthalf_bits;
+    const ValueT m = fromBits<ValueT>(toBits(u) - (tmp & expo_mask));
+    const UIntT kbits = ((tmp + (k_bias << FB::nmant)) >> FB::nmant) + FB::shifter_bits; // k + k_bias, stored in shifter's mantissa
+    const ValueT k = (fromBits<ValueT>(kbits) - FB::shifter) - static_cast<ValueT>(k_bias);
+
+    // log(m) = 2*atanh(s), s = (m-1)/(m+1)
+    const ValueT s = (m - one)/(m + one);
+    const ValueT logm = s*atanhPoly(s*s);
+
+    return (k*C::ln2_lo + c/u) + logm + k*C::ln2_hi;
+}
+
+
+// --- Branch-free selection: (signbit(x) ? a : b)
+using detail::selectNeg;
+
+
+// --- max(x, 0)
+template <typename ValueT>
+inline ValueT relu(ValueT x)
+{
+    return detail::selectNeg(x, static_cast<ValueT>(0), x);
+}
+
+
+// --- tanh(x)
+template <typename ValueT>
+inline ValueT tanh(ValueT x)
+{
+    constexpr ValueT one = 1, two = 2;
+    return one - two/(fmath::exp(two*x) + one);
+}
+
+
+// --- sin(x)
+template <typename ValueT>
+inline ValueT sin(ValueT x)
+{
+    using namespace detail;
+    using FB = FloatBits<ValueT>;
+    using UIntT = typename FB::UIntT;
+    using C = Consts<ValueT>;
+
+    // x = n*pi + r, with integer n and |r| <= pi/2
+    const ValueT nshift = x*C::invpi + FB::shifter;
+    const ValueT n = nshift - FB::shifter;
+    const ValueT r = ((x - n*C::pi_hi) - n*C::pi_lo) - n*C::pi_lo2;
+
+    // sin(x) = (-1)^n sin(r), the parity of n is the lowest mantissa bit of nshift
+    const UIntT sign = (toBits(nshift) & UIntT(1)) << (8*sizeof(UIntT) - 1);
+    return fromBits<ValueT>(toBits(r*sinPoly(r*r)) ^ sign);
+}
+
+
+// --- cos(x)
+template <typename ValueT>
+inline ValueT cos(ValueT x)
+{
+    using namespace detail;
+    using FB = FloatBits<ValueT>;
+    using UIntT = typename FB::UIntT;
+    using C = Consts<ValueT>;
+    constexpr ValueT half = 0.5;
+
+    // cos(x) = sin(x + pi/2) = (-1)^n sin(r), where x + pi/2 = n*pi + r
+    // we use x = (n - 1/2)*pi + r, to not lose accuracy by adding pi/2 to x
+    const ValueT nshift = (x*C::invpi + half) + FB::shifter;
+    const ValueT nh = (nshift - FB::shifter) - half;
+    const ValueT r = ((x - nh*C::pi_hi) - nh*C::pi_lo) - nh*C::pi_lo2;
+
+    const UIntT sign = (toBits(nshift) & UIntT(1)) << (8*sizeof(UIntT) - 1);
+    return fromBits<ValueT>(toBits(r*sinPoly(r*r)) ^ sign);
+}
+} // fmath
+
+#endif
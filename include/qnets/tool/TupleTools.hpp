@@ -3,6 +3,7 @@
 
 #include <utility>
 #include <tuple>
+#include <cstddef>
 
 namespace tupl
 {
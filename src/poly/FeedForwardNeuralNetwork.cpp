@@ -1,9 +1,11 @@
 #include "qnets/poly/FeedForwardNeuralNetwork.hpp"
+#include "qnets/templ/BinaryWeights.hpp"
 
 #include <algorithm>
 #include <fstream>
 #include <iostream>
 #include <random>
+#include <stdexcept>
 
 
 // --- Beta
@@ -122,6 +124,18 @@ void FeedForwardNeuralNetwork::randomizeBetas()
     }
 }
 
+void FeedForwardNeuralNetwork::randomizeBetas(std::mt19937_64 &rgen)
+{
+    for (auto &i : _L_fed) {
+        for (int j = 0; j < i->getNFedUnits(); ++j) {
+            FeederInterface * feeder = i->getFedUnit(j)->getFeeder();
+            if (feeder != nullptr) {
+                feeder->randomizeBeta(rgen);
+            }
+        }
+    }
+}
+
 
 // --- Variational Parameters
 
@@ -278,7 +292,7 @@ void FeedForwardNeuralNetwork::getCrossFirstDerivative(double *** d1vd1) const
 void FeedForwardNeuralNetwork::getCrossFirstDerivative(const int &i, double ** d1vd1) const
 {
     for (int i1d = 0; i1d < getNInput(); ++i1d) {
-        for (int iv1d = 0; iv1d < getNBeta(); ++iv1d) {
+        for (int iv1d = 0; iv1d < getNVariationalParameters(); ++iv1d) {
             d1vd1[i1d][iv1d] = getCrossFirstDerivative(i, i1d, iv1d);
         }
     }
@@ -301,7 +315,7 @@ double FeedForwardNeuralNetwork::getVariationalFirstDerivative(const int &i, con
 
 void FeedForwardNeuralNetwork::getVariationalFirstDerivative(const int &i, double * vd1) const
 {
-    for (int iv1d = 0; iv1d < getNInput(); ++iv1d) {
+    for (int iv1d = 0; iv1d < getNVariationalParameters(); ++iv1d) {
         vd1[iv1d] = getVariationalFirstDerivative(i, iv1d);
     }
 }
@@ -310,7 +324,7 @@ void FeedForwardNeuralNetwork::getVariationalFirstDerivative(const int &i, doubl
 void FeedForwardNeuralNetwork::getVariationalFirstDerivative(double ** vd1) const
 {
     for (int i = 0; i < getNOutput(); ++i) {
-        for (int iv1d = 0; iv1d < getNBeta(); ++iv1d) {
+        for (int iv1d = 0; iv1d < getNVariationalParameters(); ++iv1d) {
             vd1[i][iv1d] = getVariationalFirstDerivative(i, iv1d);
         }
     }
@@ -740,6 +754,53 @@ void FeedForwardNeuralNetwork::storeOnFile(const char * filename, const bool sto
 }
 
 
+// --- Binary betas
+
+namespace
+{
+// shape descriptor of a plain FFNN (INL, NNL..., OUTL), as used by the binary weight format
+templ::WeightShape binaryWeightShape(InputLayer * const L_in, const std::vector<NNLayer *> &L_nn, const int nfml, const bool connected)
+{
+    if (!connected || nfml > 0) {
+        throw std::invalid_argument("FFNN binary betas: Only connected FFNNs without feature map layers are supported.");
+    }
+    templ::WeightShape shape;
+    shape.ninput = L_in->getNInputUnits();
+    for (NNLayer * const nnl : L_nn) {
+        const std::string actf_id = nnl->getNNUnit(0)->getActivationFunction()->getIdCode();
+        for (int i = 1; i < nnl->getNNeuralUnits(); ++i) {
+            if (nnl->getNNUnit(i)->getActivationFunction()->getIdCode() != actf_id) {
+                throw std::invalid_argument("FFNN binary betas: All units of a layer must use the same activation function.");
+            }
+        }
+        shape.nunits.push_back(nnl->getNNeuralUnits());
+        shape.actf_ids.push_back(actf_id);
+    }
+    return shape;
+}
+} // namespace
+
+void FeedForwardNeuralNetwork::storeBetasOnBinaryFile(const char * filename) const
+{
+    const templ::WeightShape shape = binaryWeightShape(_L_in, _L_nn, getNFeatureMapLayers(), _flag_connected);
+    if (shape.getNBeta() != getNBeta()) {
+        throw std::invalid_argument("FFNN binary betas: Number of betas doesn't match the shape (non-standard feeders?).");
+    }
+    std::vector<double> betas(getNBeta());
+    getBeta(betas.data());
+    templ::storeBinaryWeights(filename, shape, betas.data());
+}
+
+void FeedForwardNeuralNetwork::loadBetasFromBinaryFile(const char * filename)
+{
+    const templ::MappedBinaryWeights mapped(filename);
+    if (mapped.getShape() != binaryWeightShape(_L_in, _L_nn, getNFeatureMapLayers(), _flag_connected) || mapped.getNBeta() != getNBeta()) {
+        throw std::invalid_argument("FFNN binary betas: The stored shape is not identical to the shape of this FFNN.");
+    }
+    setBeta(mapped.getBetas());
+}
+
+
 // --- Constructor
 
 FeedForwardNeuralNetwork::FeedForwardNeuralNetwork(const char * filename)
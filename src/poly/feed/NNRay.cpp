@@ -61,6 +61,11 @@ void NNRay::randomizeBeta()
     std::mt19937_64 rgen;
 
     rgen = std::mt19937_64(rdev());
+    randomizeBeta(rgen);
+}
+
+void NNRay::randomizeBeta(std::mt19937_64 &rgen)
+{
     const double init_sigma = sqrt(1./_sources.size()); // beta initialization width guess
     std::normal_distribution<double> rd(0., init_sigma);
 
@@ -1,5 +1,7 @@
 #include "qnets/poly/layer/FedLayer.hpp"
 
+int FedLayer::_omp_min_nunits = 3;
+
 
 // --- Register Unit
 
@@ -115,7 +117,7 @@ void FedLayer::computeValues()
 #ifdef OPENMP
     // compile with -DOPENMP -fopenmp flags to use parallelization here
 
-    if (this->getNUnits()>2) {
+    if (this->getNUnits() >= _omp_min_nunits) {
 #pragma omp for schedule(static, 1)
         for (std::vector<NetworkUnit *>::size_type i=0; i<_U.size(); ++i) _U[i]->computeValues();
     }
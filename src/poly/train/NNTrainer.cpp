@@ -2,46 +2,77 @@
 #include "qnets/poly/feed/SmartBetaGenerator.hpp"
 
 #include <algorithm>
+#include <cmath>
+#include <limits>
 #include <random>
+#include <vector>
 
-// --- Helpers
+#ifdef OPENMP
+#include <omp.h>
+#endif
 
-inline double computeMu(const double * const * const array, const int &len, const int &index)
+// --- Reduction helpers
+
+namespace nn_trainer_details
+{
+column_stats::column_stats(const int ncols):
+        mean(ncols, 0.), m2(ncols, 0.), lbound(ncols, std::numeric_limits<double>::infinity()), ubound(ncols, -std::numeric_limits<double>::infinity()) {}
+
+void column_stats::add(const double * const row)
 {
-    double mean = 0.;
-    for (int i = 0; i < len; ++i) {
-        mean += array[i][index];
+    ++n;
+    const double ninv = 1./n;
+    for (size_t i = 0; i < mean.size(); ++i) {
+        const double delta = row[i] - mean[i];
+        mean[i] += delta*ninv;
+        m2[i] += delta*(row[i] - mean[i]);
+        lbound[i] = std::min(lbound[i], row[i]);
+        ubound[i] = std::max(ubound[i], row[i]);
     }
-    return mean/len;
 }
 
-inline double computeSigma(const double * const * const array, const int &len, const int &index, const double &mean)
+void column_stats::merge(const column_stats &other)
 {
-    double std = 0.;
-    for (int i = 0; i < len; ++i) {
-        std += pow(array[i][index] - mean, 2);
+    if (other.n == 0) { return; }
+    const int ntot = n + other.n;
+    const double fac = static_cast<double>(other.n)/ntot;
+    for (size_t i = 0; i < mean.size(); ++i) {
+        const double delta = other.mean[i] - mean[i];
+        mean[i] += delta*fac;
+        m2[i] += other.m2[i] + delta*delta*n*fac;
+        lbound[i] = std::min(lbound[i], other.lbound[i]);
+        ubound[i] = std::max(ubound[i], other.ubound[i]);
     }
-    return sqrt(std/(len - 1));
+    n = ntot;
 }
 
-inline double computeSigma(const double * const * const array, const int &len, const int &index)
+double column_stats::sigma(const int icol) const
 {
-    return computeSigma(array, len, index, computeMu(array, len, index));
+    return sqrt(m2[icol]/(n - 1));
 }
 
-inline void computeBounds(const double * const * const array, const int &len, const int &index, double &lbound, double &ubound)
+column_stats computeColumnStats(const double * const * const array, const int ifirst, const int ilast, const int ncols)
 {
-    lbound = array[0][index];
-    ubound = array[0][index];
-    for (int i = 1; i < len; ++i) {
-        if (array[i][index] < lbound) {
-            lbound = array[i][index];
-        }
-        else if (array[i][index] > ubound) {
-            ubound = array[i][index];
+    const int nchunks = (ilast - ifirst + reduction_chunk - 1)/reduction_chunk;
+    std::vector<column_stats> chunk_stats(nchunks, column_stats(ncols));
+
+#ifdef OPENMP
+#pragma omp parallel for schedule(static) if (nchunks > 1)
+#endif
+    for (int ic = 0; ic < nchunks; ++ic) {
+        const int i1 = std::min(ilast, ifirst + (ic + 1)*reduction_chunk);
+        for (int i = ifirst + ic*reduction_chunk; i < i1; ++i) {
+            chunk_stats[ic].add(array[i]);
         }
     }
+
+    column_stats stats(ncols);
+    for (const auto &cs : chunk_stats) { // fixed merge order
+        stats.merge(cs);
+    }
+    return stats;
 }
+} // namespace nn_trainer_details
 
 
 // -- Class methods
@@ -72,18 +103,19 @@ void NNTrainer::_configureFFNN(FeedForwardNeuralNetwork * const ffnn, const bool
 
 void NNTrainer::setNormalization(FeedForwardNeuralNetwork * const ffnn)
 {
+    using namespace nn_trainer_details;
+
     // input side
+    const column_stats xstats = computeColumnStats(_tdata.x, 0, _tdata.ndata, _tdata.xndim);
     for (int i = 0; i < _tdata.xndim; ++i) {
-        double mu = computeMu(_tdata.x, _tdata.ndata, i);
-        ffnn->getInputLayer()->getInputUnit(i)->setInputMu(mu);
-        ffnn->getInputLayer()->getInputUnit(i)->setInputSigma(computeSigma(_tdata.x, _tdata.ndata, i, mu));
+        ffnn->getInputLayer()->getInputUnit(i)->setInputMu(xstats.mean[i]);
+        ffnn->getInputLayer()->getInputUnit(i)->setInputSigma(xstats.sigma(i));
     }
 
     // output side
+    const column_stats ystats = computeColumnStats(_tdata.y, 0, _tdata.ndata, _tdata.yndim);
     for (int i = 0; i < _tdata.yndim; ++i) {
-        double lbound, ubound;
-        computeBounds(_tdata.y, _tdata.ndata, i, lbound, ubound);
-        ffnn->getOutputLayer()->getOutputNNUnit(i)->setOutputBounds(lbound, ubound);
+        ffnn->getOutputLayer()->getOutputNNUnit(i)->setOutputBounds(ystats.lbound[i], ystats.ubound[i]);
     }
 }
 
@@ -92,6 +124,8 @@ double NNTrainer::computeResidual(FeedForwardNeuralNetwork * const ffnn, const b
     //
     // Basic form is sqrt(1/N sum (f(x) - y)^2), but inside the sqrt additional terms may be added
     //
+    using nn_trainer_details::reduction_chunk;
+
     const int npar = ffnn->getNVariationalParameters();
     const int offset = _flag_test
                        ? _tdata.ntraining + _tdata.nvalidation
@@ -101,43 +135,82 @@ double NNTrainer::computeResidual(FeedForwardNeuralNetwork * const ffnn, const b
     const double lambda_d1_fac = scale*_tconfig.lambda_d1*_tconfig.lambda_d1/_tdata.xndim;
     const double lambda_d2_fac = scale*_tconfig.lambda_d2*_tconfig.lambda_d2/_tdata.xndim;
 
-
-    double resi = 0.;
-
-    if (_flag_r && flag_r) {
-        // add regularization residual from NN betas
-        for (int i = 0; i < npar; ++i) {
-            resi += lambda_r_fac*pow(ffnn->getBeta(i), 2);
-        }
+    // partial residuals of fixed chunks of data points
+    const int nchunks = (_tdata.ndata - offset + reduction_chunk - 1)/reduction_chunk;
+    std::vector<double> chunk_resi(nchunks, 0.);
+
+    // thread 0 uses ffnn, the others copies (unless we are called by parallel fits or the copies don't pay off)
+#ifdef OPENMP
+    const int nthreads = omp_in_parallel() ? 1 : std::max(1, std::min(nchunks/nn_trainer_details::residual_min_chunks, omp_get_max_threads()));
+#else
+    const int nthreads = 1;
+#endif
+    std::vector<FeedForwardNeuralNetwork *> ffnns(nthreads, ffnn);
+    for (int i = 1; i < nthreads; ++i) {
+        ffnns[i] = new FeedForwardNeuralNetwork(ffnn);
     }
 
     //get difference NN vs data
-    for (int i = offset; i < _tdata.ndata; ++i) {
-        ffnn->setInput(_tdata.x[i]);
-        ffnn->FFPropagate();
-        for (int j = 0; j < _tdata.yndim; ++j) {
-            resi += scale*pow(_tdata.w[i][j]*(ffnn->getOutput(j) - _tdata.y[i][j]), 2);
-
-            if (flag_d) { // add derivative residuals
-                for (int k = 0; k < _tdata.xndim; ++k) {
-                    if (_flag_d1) {
-                        resi += lambda_d1_fac*pow(_tdata.w[i][j]*(ffnn->getFirstDerivative(j, k) - _tdata.yd1[i][j][k]), 2);
-                    }
-                    if (_flag_d2) {
-                        resi += lambda_d2_fac*pow(_tdata.w[i][j]*(ffnn->getSecondDerivative(j, k) - _tdata.yd2[i][j][k]), 2);
+#ifdef OPENMP
+#pragma omp parallel for schedule(dynamic, 1) num_threads(nthreads) if (nthreads > 1)
+#endif
+    for (int ic = 0; ic < nchunks; ++ic) {
+#ifdef OPENMP
+        FeedForwardNeuralNetwork * const my_ffnn = ffnns[omp_get_thread_num()];
+#else
+        FeedForwardNeuralNetwork * const my_ffnn = ffnns[0];
+#endif
+        double resi = 0.;
+        const int i1 = std::min(_tdata.ndata, offset + (ic + 1)*reduction_chunk);
+        for (int i = offset + ic*reduction_chunk; i < i1; ++i) {
+            my_ffnn->setInput(_tdata.x[i]);
+            my_ffnn->FFPropagate();
+            for (int j = 0; j < _tdata.yndim; ++j) {
+                const double wij = _tdata.w[i][j];
+                const double diff = wij*(my_ffnn->getOutput(j) - _tdata.y[i][j]);
+                resi += scale*diff*diff;
+
+                if (flag_d) { // add derivative residuals
+                    for (int k = 0; k < _tdata.xndim; ++k) {
+                        if (_flag_d1) {
+                            const double diff1 = wij*(my_ffnn->getFirstDerivative(j, k) - _tdata.yd1[i][j][k]);
+                            resi += lambda_d1_fac*diff1*diff1;
+                        }
+                        if (_flag_d2) {
+                            const double diff2 = wij*(my_ffnn->getSecondDerivative(j, k) - _tdata.yd2[i][j][k]);
+                            resi += lambda_d2_fac*diff2*diff2;
+                        }
                     }
                 }
             }
         }
+        chunk_resi[ic] = resi;
+    }
+
+    for (int i = 1; i < nthreads; ++i) {
+        delete ffnns[i];
+    }
+
+    double resi = 0.;
+    for (const double cr : chunk_resi) { // fixed reduction order
+        resi += cr;
+    }
+
+    if (_flag_r && flag_r) {
+        // add regularization residual from NN betas
+        for (int i = 0; i < npar; ++i) {
+            const double beta = ffnn->getBeta(i);
+            resi += lambda_r_fac*beta*beta;
+        }
     }
     return sqrt(resi);
 }
 
 void NNTrainer::bestFit(FeedForwardNeuralNetwork * const ffnn, double * bestfit, double * bestfit_err, const int &nfits, const double &resi_target, const int &verbose, const bool &flag_smart_beta)
 {
-    int npar = ffnn->getNVariationalParameters();
-    double fit[npar], err[npar];
-    double bestresi_pure = -1.0, bestresi_noreg = -1.0, bestresi_full = -1.0;
+    const int npar = ffnn->getNVariationalParameters();
+    std::vector<std::vector<double>> fits(nfits, std::vector<double>(npar)), errs(nfits, std::vector<double>(npar));
+    std::vector<double> resis_full(nfits), resis_noreg(nfits), resis_pure(nfits);
 
     if (!_flag_test && verbose > 0) {
         fprintf(stderr, "[NNTrainer] Warning: Testing residual calculation disabled, i.e. testing is based on training+validation data.\n");
@@ -145,71 +218,108 @@ void NNTrainer::bestFit(FeedForwardNeuralNetwork * const ffnn, double * bestfit,
 
     _configureFFNN(ffnn, false); // set non-vderiv substrates (the child implementation may use a copy FFNN with variational substrates)
 
-    int ifit = 0;
-    while (true) {
+    // every fit uses its own generator stream, so the initial betas don't depend on the thread
+    std::mt19937_64::result_type seed = _seed;
+    if (!_flag_seed) {
+        random_device rdev;
+        seed = rdev();
+    }
+
+    // thread 0 fits with ffnn, the others with copies
+#ifdef OPENMP
+    const int nthreads = std::max(1, std::min(nfits, omp_get_max_threads()));
+#else
+    const int nthreads = 1;
+#endif
+    std::vector<FeedForwardNeuralNetwork *> ffnns(nthreads, ffnn);
+    for (int i = 1; i < nthreads; ++i) {
+        ffnns[i] = new FeedForwardNeuralNetwork(ffnn);
+    }
+
+    int ifit_stop = nfits - 1; // the first fit meeting resi_target (fits after it are skipped or discarded)
+
+#ifdef OPENMP
+#pragma omp parallel for schedule(dynamic, 1) if (nthreads > 1)
+#endif
+    for (int ifit = 0; ifit < nfits; ++ifit) {
+        bool flag_skip;
+#ifdef OPENMP
+#pragma omp critical (bestfit_stop)
+#endif
+        flag_skip = ifit > ifit_stop;
+        if (flag_skip) { continue; }
+
+#ifdef OPENMP
+        FeedForwardNeuralNetwork * const my_ffnn = ffnns[omp_get_thread_num()];
+#else
+        FeedForwardNeuralNetwork * const my_ffnn = ffnns[0];
+#endif
+        mt19937_64 rgen(seed + ifit);
+
         // initial parameters
         if (flag_smart_beta) {
-            smart_beta::generateSmartBeta(ffnn);
+            smart_beta::generateSmartBeta(my_ffnn);
         }
-        else if (ffnn->getNFeatureMapLayers() > 0) { // hack because of fitting problems when using FMLs
-            random_device rdev;
-            mt19937_64 rgen = std::mt19937_64(rdev());
+        else if (my_ffnn->getNFeatureMapLayers() > 0) { // hack because of fitting problems when using FMLs
             uniform_real_distribution<double> rd(-0.1, 0.1);
-            for (int i = 0; i < ffnn->getNBeta(); ++i) {
-                ffnn->setBeta(i, rd(rgen));
+            for (int i = 0; i < my_ffnn->getNBeta(); ++i) {
+                my_ffnn->setBeta(i, rd(rgen));
             }
         }
         else {
-            ffnn->randomizeBetas();
+            my_ffnn->randomizeBetas(rgen);
         }
 
-        findFit(ffnn, fit, err, verbose); // try new fit
-        ffnn->setVariationalParameter(fit); // make sure ffnn is set to fit betas
+        findFit(my_ffnn, fits[ifit].data(), errs[ifit].data(), verbose); // try new fit
+        my_ffnn->setVariationalParameter(fits[ifit].data()); // make sure ffnn is set to fit betas
 
-        double resi_full = computeResidual(ffnn, true, true);
-        double resi_noreg = computeResidual(ffnn, false, true);
-        double resi_pure = computeResidual(ffnn, false, false);
+        resis_full[ifit] = computeResidual(my_ffnn, true, true);
+        resis_noreg[ifit] = computeResidual(my_ffnn, false, true);
+        resis_pure[ifit] = computeResidual(my_ffnn, false, false);
 
-        // check for new best testing residual
-        if (ifit < 1 || (resi_noreg < bestresi_noreg)) {
-            for (int i = 0; i < npar; ++i) {
-                bestfit[i] = fit[i];
-                bestfit_err[i] = err[i];
-            }
-            bestresi_full = resi_full;
-            bestresi_noreg = resi_noreg;
-            bestresi_pure = resi_pure;
+        // check break condition
+        if (resis_noreg[ifit] <= resi_target) {
+#ifdef OPENMP
+#pragma omp critical (bestfit_stop)
+#endif
+            ifit_stop = std::min(ifit_stop, ifit);
+        }
+        if (verbose > 0) {
+            fprintf(stderr, "Fit %i: Unregularized testing residual %f (full: %f, pure: %f) %s tolerance %f.\n", ifit, resis_noreg[ifit], resis_full[ifit], resis_pure[ifit],
+                    resis_noreg[ifit] <= resi_target ? "meets" : "above", resi_target);
         }
+    }
 
-        ++ifit;
+    for (int i = 1; i < nthreads; ++i) {
+        delete ffnns[i];
+    }
 
-        // check break conditions
-        if (bestresi_noreg <= resi_target) {
-            if (verbose > 0) {
-                fprintf(stderr, "Unregularized testing residual %f (full: %f, pure: %f) meets tolerance %f. Exiting with good fit.\n\n", bestresi_noreg, bestresi_full, bestresi_pure, resi_target);
-            }
-            break;
+    // find the best fit deterministically (lowest residual, then lowest index)
+    int ibest = 0;
+    for (int ifit = 1; ifit <= ifit_stop; ++ifit) {
+        if (resis_noreg[ifit] < resis_noreg[ibest]) {
+            ibest = ifit;
         }
-        if (verbose > 0) {
-            fprintf(stderr, "Unregularized testing residual %f (full: %f, pure: %f) above tolerance %f.\n", resi_noreg, resi_full, resi_pure, resi_target);
-        }
-        if (ifit >= nfits) {
-            if (verbose > 0) {
-                fprintf(stderr, "Maximum number of fits reached (%i). Exiting with best unregularized testing residual %f.\n\n", nfits, bestresi_noreg);
-            }
-            break;
+    }
+    for (int i = 0; i < npar; ++i) {
+        bestfit[i] = fits[ibest][i];
+        bestfit_err[i] = errs[ibest][i];
+    }
+
+    if (verbose > 0) {
+        if (resis_noreg[ibest] <= resi_target) {
+            fprintf(stderr, "Unregularized testing residual %f (full: %f, pure: %f) meets tolerance %f. Exiting with good fit.\n\n", resis_noreg[ibest], resis_full[ibest], resis_pure[ibest], resi_target);
         }
-        if (verbose > 0) {
-            fprintf(stderr, "Let's try again.\n");
+        else {
+            fprintf(stderr, "Maximum number of fits reached (%i). Exiting with best unregularized testing residual %f.\n\n", nfits, resis_noreg[ibest]);
         }
-    }
 
-    if (verbose > 0) { // print summary
+        // print summary
         fprintf(stderr, "best fit summary:\n");
         for (int i = 0; i < npar; ++i) {
             fprintf(stderr, "b%i      = %.5f +/- %.5f\n", i, bestfit[i], bestfit_err[i]);
         }
-        fprintf(stderr, "|f(x)| = %f (w/o reg: %f, pure: %f)\n\n", bestresi_full, bestresi_noreg, bestresi_pure);
+        fprintf(stderr, "|f(x)| = %f (w/o reg: %f, pure: %f)\n\n", resis_full[ibest], resis_noreg[ibest], resis_pure[ibest]);
     }
 
     // set ffnn to bestfit betas
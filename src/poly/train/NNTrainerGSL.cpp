@@ -1,6 +1,17 @@
 #include "qnets/poly/train/NNTrainerGSL.hpp"
 
 #include <gsl/gsl_blas.h>
+#include <gsl/gsl_errno.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+
+#ifdef OPENMP
+#include <omp.h>
+#endif
 
 namespace nn_trainer_gsl_details
 {
@@ -19,6 +30,11 @@ void training_workspace::copyData(const NNTrainingData &tdata)
     yd1 = tdata.yd1;
     yd2 = tdata.yd2;
     w = tdata.w;
+    xdata = tdata.xdata; // contiguous blocks (not owned)
+    ydata = tdata.ydata;
+    yd1data = tdata.yd1data;
+    yd2data = tdata.yd2data;
+    wdata = tdata.wdata;
 }
 
 void training_workspace::copyConfig(const NNTrainingConfig &tconfig)
@@ -40,12 +56,43 @@ void training_workspace::copyDatConf(const NNTrainingData &tdata, const NNTraini
     copyConfig(tconfig);
 }
 
+void training_workspace::createReplicas(const int nthreads)
+{
+    deleteReplicas();
+    for (int i = 1; i < nthreads; ++i) {
+        ffnn_replicas.push_back(new FeedForwardNeuralNetwork(ffnn));
+        ffnn_vderiv_replicas.push_back(new FeedForwardNeuralNetwork(ffnn_vderiv));
+    }
+}
+
+void training_workspace::deleteReplicas()
+{
+    for (auto &replica : ffnn_replicas) {
+        delete replica;
+    }
+    for (auto &replica : ffnn_vderiv_replicas) {
+        delete replica;
+    }
+    ffnn_replicas.clear();
+    ffnn_vderiv_replicas.clear();
+}
+
+void training_workspace::invalidateCache()
+{
+    cache_betas.clear();
+    cache_nvalues = 0;
+}
+
 // --- Helper functions
 
 // set new NN betas
 int setVP(FeedForwardNeuralNetwork * const ffnn, const gsl_vector * const betas)
 {
     const int npar = ffnn->getNVariationalParameters();
+    if (betas->stride == 1) { // set all in one pass over the layers
+        ffnn->setVariationalParameter(betas->data);
+        return npar;
+    }
     for (int i = 0; i < npar; ++i) {
         ffnn->setVariationalParameter(i, gsl_vector_get(betas, i));
     }
@@ -98,108 +145,327 @@ void calcFitErr(gsl_multifit_nlinear_workspace * const w, double * const fit, do
 };
 
 
-// --- Cost functions
+// --- Propagation cache
 
-int ffnn_f(const gsl_vector * betas, training_workspace * const tws, gsl_vector * f, const bool flag_r, const bool flag_d)
+bool isCachedBetas(const std::vector<double> &cache_betas, const gsl_vector * const betas)
 {
-    const int n = tws->ntraining + tws->nvalidation;
-    const bool flag_vali = tws->nvalidation > 0;
-    FeedForwardNeuralNetwork * ffnn = tws->ffnn;
+    if (cache_betas.size() != betas->size) { return false; }
+    for (size_t i = 0; i < betas->size; ++i) {
+        if (cache_betas[i] != gsl_vector_get(betas, i)) { return false; }
+    }
+    return true;
+}
 
-    const int npar = ffnn->getNVariationalParameters();
-    const double lambda_d1_red = tws->lambda_d1/sqrt(tws->xndim), lambda_d2_red = tws->lambda_d2/sqrt(tws->xndim), lambda_r_red = tws->lambda_r/sqrt(npar);
+void setCachedBetas(std::vector<double> &cache_betas, const gsl_vector * const betas)
+{
+    cache_betas.resize(betas->size);
+    for (size_t i = 0; i < betas->size; ++i) {
+        cache_betas[i] = gsl_vector_get(betas, i);
+    }
+}
 
-    gsl_vector * fnow = f;
-    double scale_now = 1./sqrt(tws->ntraining);
+// store output, d1 and d2 (if used) of a propagated ffnn
+void storeValues(FeedForwardNeuralNetwork * const ffnn, const training_workspace * const tws, double * const values)
+{
+    double * const d1 = values + tws->yndim;
+    double * const d2 = d1 + tws->yndim*tws->xndim;
+    for (int j = 0; j < tws->yndim; ++j) {
+        values[j] = ffnn->getOutput(j);
+        for (int k = 0; k < tws->xndim; ++k) {
+            d1[j*tws->xndim + k] = tws->flag_d1 ? ffnn->getFirstDerivative(j, k) : 0.;
+            d2[j*tws->xndim + k] = tws->flag_d2 ? ffnn->getSecondDerivative(j, k) : 0.;
+        }
+    }
+}
 
-    setVP(ffnn, betas);
-    if (flag_vali) {
-        gsl_vector_set_zero(tws->fvali); // set fvali to zero
+// store vd1, cd1 and cd2 (if used) of a propagated ffnn
+void storeVDerivs(FeedForwardNeuralNetwork * const ffnn, const training_workspace * const tws, const int npar, double * const vderivs)
+{
+    double * const cd1 = vderivs + tws->yndim*npar;
+    double * const cd2 = cd1 + tws->yndim*tws->xndim*npar;
+    for (int j = 0; j < tws->yndim; ++j) {
+        for (int ib = 0; ib < npar; ++ib) {
+            vderivs[j*npar + ib] = ffnn->getVariationalFirstDerivative(j, ib);
+        }
+        for (int k = 0; k < tws->xndim; ++k) {
+            for (int ib = 0; ib < npar; ++ib) {
+                cd1[(j*tws->xndim + k)*npar + ib] = tws->flag_d1 ? ffnn->getCrossFirstDerivative(j, k, ib) : 0.;
+                cd2[(j*tws->xndim + k)*npar + ib] = tws->flag_d2 ? ffnn->getCrossSecondDerivative(j, k, ib) : 0.;
+            }
+        }
     }
+}
 
-    int idx = 0;
-    for (int i = 0; i < n; ++i) {
-        ffnn->setInput(tws->x[i]);
-        ffnn->FFPropagate();
+void cacheValues(const gsl_vector * const betas, training_workspace * const tws, const int npoints)
+{
+    const int ifirst = isCachedBetas(tws->cache_betas, betas) ? tws->cache_nvalues : 0; // first uncached point
+    if (ifirst >= npoints) { // the caller's network still has to be at betas
+        setVP(tws->ffnn, betas);
+        return;
+    }
 
-        if (i == tws->ntraining) { // now setup the validation calculation
-            idx = 0;
-            fnow = tws->fvali;
-            scale_now = 1./sqrt(tws->nvalidation);
+    const int nthreads = tws->getNThreads();
+    const int stride = tws->getCacheValueStride();
+    tws->cache_values.resize(static_cast<size_t>(tws->ntraining + tws->nvalidation)*stride);
+
+    // every thread evaluates a contiguous chunk of data points with its own replica
+#ifdef OPENMP
+#pragma omp parallel for schedule(static, 1) if (nthreads > 1)
+#endif
+    for (int it = 0; it < nthreads; ++it) {
+        FeedForwardNeuralNetwork * const ffnn = tws->getFFNN(it);
+        setVP(ffnn, betas);
+
+        for (int i = ifirst + ((npoints - ifirst)*it)/nthreads; i < ifirst + ((npoints - ifirst)*(it + 1))/nthreads; ++i) {
+            ffnn->setInput(tws->x[i]);
+            ffnn->FFPropagate();
+            storeValues(ffnn, tws, tws->cache_values.data() + static_cast<size_t>(i)*stride);
         }
+    }
 
-        for (int j = 0; j < tws->yndim; ++j) {
-            gsl_vector_set(fnow, idx, scale_now*tws->w[i][j]*(ffnn->getOutput(j) - tws->y[i][j])); // the "pure" residual
-            ++idx;
+    setCachedBetas(tws->cache_betas, betas);
+    tws->cache_nvalues = npoints;
+}
 
-            if (flag_d) { // derivative residual
-                for (int k = 0; k < tws->xndim; ++k) {
-                    gsl_vector_set(fnow, idx, tws->flag_d1
-                                              ? scale_now*tws->w[i][j]*lambda_d1_red*(ffnn->getFirstDerivative(j, k) - tws->yd1[i][j][k])
-                                              : 0.0);
-                    ++idx;
-                    gsl_vector_set(fnow, idx, tws->flag_d2
-                                              ? scale_now*tws->w[i][j]*lambda_d2_red*(ffnn->getSecondDerivative(j, k) - tws->yd2[i][j][k])
-                                              : 0.0);
-                    ++idx;
-                }
+// --- Residual rows of single data points
+
+void calcPointResiduals(const training_workspace * const tws, const int i, const double * const values, const double scale, const bool flag_d, double * const f)
+{
+    const double * const d1 = values + tws->yndim;
+    const double * const d2 = d1 + tws->yndim*tws->xndim;
+    const double lambda_d1_red = tws->lambda_d1/sqrt(tws->xndim), lambda_d2_red = tws->lambda_d2/sqrt(tws->xndim);
+
+    int idx = 0;
+    for (int j = 0; j < tws->yndim; ++j) {
+        f[idx] = scale*tws->w[i][j]*(values[j] - tws->y[i][j]); // the "pure" residual
+        ++idx;
+
+        if (flag_d) { // derivative residual
+            for (int k = 0; k < tws->xndim; ++k) {
+                f[idx] = tws->flag_d1 ? scale*tws->w[i][j]*lambda_d1_red*(d1[j*tws->xndim + k] - tws->yd1[i][j][k]) : 0.0;
+                ++idx;
+                f[idx] = tws->flag_d2 ? scale*tws->w[i][j]*lambda_d2_red*(d2[j*tws->xndim + k] - tws->yd2[i][j][k]) : 0.0;
+                ++idx;
             }
         }
     }
+}
 
-    if (flag_r) { //append regularization residual
-        int offr_train = calcNData(tws->ntraining, tws->yndim, 0, flag_d ? tws->xndim : 0, 2);
-        int offr_vali = calcNData(tws->nvalidation, tws->yndim, 0, flag_d ? tws->xndim : 0, 2);
+void calcPointJacobian(const training_workspace * const tws, const int i, const double * const vderivs, const double scale, const bool flag_d, const int ldj, double * const J)
+{
+    const int npar = tws->ffnn_vderiv->getNVariationalParameters();
+    const double * const cd1 = vderivs + tws->yndim*npar;
+    const double * const cd2 = cd1 + tws->yndim*tws->xndim*npar;
+    const double lambda_d1_red = scale*tws->lambda_d1/sqrt(tws->xndim), lambda_d2_red = scale*tws->lambda_d2/sqrt(tws->xndim);
+
+    double * Jrow = J;
+    for (int j = 0; j < tws->yndim; ++j) {
         for (int ib = 0; ib < npar; ++ib) {
-            gsl_vector_set(f, offr_train + ib, lambda_r_red*gsl_vector_get(betas, ib));
-            if (flag_vali) {
-                gsl_vector_set(tws->fvali, offr_vali + ib, lambda_r_red*gsl_vector_get(betas, ib));
+            Jrow[ib] = scale*tws->w[i][j]*vderivs[j*npar + ib]; // the "pure" gradient
+        }
+        Jrow += ldj;
+
+        if (flag_d) { // derivative residual gradient
+            for (int k = 0; k < tws->xndim; ++k) {
+                for (int ib = 0; ib < npar; ++ib) {
+                    Jrow[ib] = tws->flag_d1 ? tws->w[i][j]*lambda_d1_red*cd1[(j*tws->xndim + k)*npar + ib] : 0.0;
+                }
+                Jrow += ldj;
+                for (int ib = 0; ib < npar; ++ib) {
+                    Jrow[ib] = tws->flag_d2 ? tws->w[i][j]*lambda_d2_red*cd2[(j*tws->xndim + k)*npar + ib] : 0.0;
+                }
+                Jrow += ldj;
             }
         }
     }
-
-    return GSL_SUCCESS;
 }
 
-int ffnn_df(const gsl_vector * betas, training_workspace * const tws, gsl_matrix * J, const bool flag_r, const bool flag_d)
+
+// --- Validation residuals
+
+void calcFVali(const gsl_vector * const betas, training_workspace * const tws, gsl_vector * const fvali, const bool flag_r, const bool flag_d)
 {
-    FeedForwardNeuralNetwork * ffnn = tws->ffnn_vderiv;
+    const int npar = tws->ffnn->getNVariationalParameters();
+    const int stride = tws->getCacheValueStride();
+    const int nrows = calcNData(1, tws->yndim, 0, flag_d ? tws->xndim : 0, 2); // residual rows per data point
+    const double lambda_r_red = tws->lambda_r/sqrt(npar);
+    std::vector<double> frows(nrows);
 
-    const int npar = ffnn->getNVariationalParameters();
-    const double scale = 1./sqrt(tws->ntraining), lambda_d1_red = scale*tws->lambda_d1/sqrt(tws->xndim), lambda_d2_red = scale*tws->lambda_d2/sqrt(tws->xndim), lambda_r_red = tws->lambda_r/sqrt(npar);
+    gsl_vector_set_zero(fvali);
+    if (tws->nvalidation < 1) { return; }
+    const double scale = 1./sqrt(tws->nvalidation);
 
-    setVP(ffnn, betas);
+    cacheValues(betas, tws, tws->ntraining + tws->nvalidation);
 
     int idx = 0;
-    for (int i = 0; i < tws->ntraining; ++i) {
+    for (int i = tws->ntraining; i < tws->ntraining + tws->nvalidation; ++i) {
+        calcPointResiduals(tws, i, tws->cache_values.data() + static_cast<size_t>(i)*stride, scale, flag_d, frows.data());
+        for (int r = 0; r < nrows; ++r) {
+            gsl_vector_set(fvali, idx, frows[r]);
+            ++idx;
+        }
+    }
+
+    if (flag_r) { //append regularization residual
+        int offr = calcNData(tws->nvalidation, tws->yndim, 0, flag_d ? tws->xndim : 0, 2);
+        for (int ib = 0; ib < npar; ++ib) {
+            gsl_vector_set(fvali, offr + ib, lambda_r_red*gsl_vector_get(betas, ib));
+        }
+    }
+}
+
+double evalValiResidual(const gsl_vector * const betas, training_workspace * const tws, const bool flag_d)
+{
+    const int stride = tws->getCacheValueStride();
+    const int nrows = calcNData(1, tws->yndim, 0, flag_d ? tws->xndim : 0, 2);
+    const double scale = 1./sqrt(tws->nvalidation);
+    std::vector<double> frows(nrows);
+
+    cacheValues(betas, tws, tws->ntraining + tws->nvalidation);
+
+    double chisq_vali = 0.;
+    for (int i = tws->ntraining; i < tws->ntraining + tws->nvalidation; ++i) {
+        calcPointResiduals(tws, i, tws->cache_values.data() + static_cast<size_t>(i)*stride, scale, flag_d, frows.data());
+        for (const double fr : frows) {
+            chisq_vali += fr*fr;
+        }
+    }
+    return sqrt(chisq_vali);
+}
+
+double evalValiResidual(const std::vector<double> &betas, const training_workspace * const tws, FeedForwardNeuralNetwork * const ffnn, const bool flag_d)
+{
+    const int nrows = calcNData(1, tws->yndim, 0, flag_d ? tws->xndim : 0, 2);
+    const double scale = 1./sqrt(tws->nvalidation);
+    std::vector<double> values(tws->getCacheValueStride()), frows(nrows);
+
+    ffnn->setVariationalParameter(betas.data());
+
+    double chisq_vali = 0.; // summed in the same order as above, i.e. the results are equal
+    for (int i = tws->ntraining; i < tws->ntraining + tws->nvalidation; ++i) {
         ffnn->setInput(tws->x[i]);
         ffnn->FFPropagate();
+        storeValues(ffnn, tws, values.data());
+        calcPointResiduals(tws, i, values.data(), scale, flag_d, frows.data());
+        for (const double fr : frows) {
+            chisq_vali += fr*fr;
+        }
+    }
+    return sqrt(chisq_vali);
+}
 
-        for (int j = 0; j < tws->yndim; ++j) {
-            for (int ib = 0; ib < npar; ++ib) {
-                gsl_matrix_set(J, idx, ib, scale*tws->w[i][j]*ffnn->getVariationalFirstDerivative(j, ib)); // the "pure" gradient
-            }
+bool validation_scheduler::update(const gsl_vector * const betas, const int iter, double &resi_vali)
+{
+    if (_tws->nvalidation < 1 || iter%std::max(1, _tws->vali_interval) != 0) { return false; }
+
+    if (_tws->ffnn_vali == nullptr) { // synchronous, via the cache (which the trial step at betas partially filled)
+        resi_vali = evalValiResidual(betas, _tws, _flag_d);
+        return true;
+    }
+
+    // collect the previous background result, then start the next evaluation on a snapshot of betas
+    const bool flag_result = _pending.valid();
+    if (flag_result) {
+        resi_vali = _pending.get();
+    }
+    _betas.resize(betas->size);
+    for (size_t i = 0; i < betas->size; ++i) {
+        _betas[i] = gsl_vector_get(betas, i);
+    }
+    _pending = std::async(std::launch::async, [this]() {
+#ifdef OPENMP
+        omp_set_num_threads(1); // FFPropagate would start a full team of its own, competing with the fit's threads
+#endif
+        return evalValiResidual(_betas, _tws, _tws->ffnn_vali, _flag_d);
+    });
+    return flag_result;
+}
+
+void validation_scheduler::wait()
+{
+    if (_pending.valid()) {
+        _pending.wait();
+        _pending = std::future<double>();
+    }
+}
+
+
+// --- Cost functions
+
+int ffnn_f(const gsl_vector * betas, training_workspace * const tws, gsl_vector * f, const bool flag_r, const bool flag_d)
+{
+    const int npar = tws->ffnn->getNVariationalParameters();
+    const int stride = tws->getCacheValueStride();
+    const int nrows = calcNData(1, tws->yndim, 0, flag_d ? tws->xndim : 0, 2); // residual rows per data point
+    const double scale = 1./sqrt(tws->ntraining), lambda_r_red = tws->lambda_r/sqrt(npar);
+    std::vector<double> frows(nrows);
+
+    cacheValues(betas, tws, tws->ntraining);
+
+    int idx = 0;
+    for (int i = 0; i < tws->ntraining; ++i) {
+        calcPointResiduals(tws, i, tws->cache_values.data() + static_cast<size_t>(i)*stride, scale, flag_d, frows.data());
+        for (int r = 0; r < nrows; ++r) {
+            gsl_vector_set(f, idx, frows[r]);
             ++idx;
+        }
+    }
 
-            if (flag_d) { // derivative residual gradient
-                for (int k = 0; k < tws->xndim; ++k) {
-                    for (int ib = 0; ib < npar; ++ib) {
-                        gsl_matrix_set(J, idx, ib, tws->flag_d1
-                                                   ? tws->w[i][j]*lambda_d1_red*ffnn->getCrossFirstDerivative(j, k, ib)
-                                                   : 0.0);
-                    }
-                    ++idx;
-                    for (int ib = 0; ib < npar; ++ib) {
-                        gsl_matrix_set(J, idx, ib, tws->flag_d2
-                                                   ? tws->w[i][j]*lambda_d2_red*ffnn->getCrossSecondDerivative(j, k, ib)
-                                                   : 0.0);
-                    }
-                    ++idx;
-                }
+    if (flag_r) { //append regularization residual
+        int offr = calcNData(tws->ntraining, tws->yndim, 0, flag_d ? tws->xndim : 0, 2);
+        for (int ib = 0; ib < npar; ++ib) {
+            gsl_vector_set(f, offr + ib, lambda_r_red*gsl_vector_get(betas, ib));
+        }
+    }
+
+    if (tws->fvali != nullptr && tws->nvalidation > 0) { // validation residuals only on request
+        calcFVali(betas, tws, tws->fvali, flag_r, flag_d);
+    }
+
+    return GSL_SUCCESS;
+}
+
+int ffnn_df(const gsl_vector * betas, training_workspace * const tws, gsl_matrix * J, const bool flag_r, const bool flag_d)
+{
+    const int n = tws->ntraining;
+    const int nthreads = tws->getNThreads();
+    const int npar = tws->ffnn_vderiv->getNVariationalParameters();
+    const int stride = tws->getCacheValueStride(), stride_vd = tws->getVDerivStride();
+    const int nrows = calcNData(1, tws->yndim, 0, flag_d ? tws->xndim : 0, 2); // residual rows per data point
+    const int ldj = static_cast<int>(J->tda);
+    const double scale = 1./sqrt(n), lambda_r_red = tws->lambda_r/sqrt(npar);
+    const bool flag_values = !isCachedBetas(tws->cache_betas, betas); // the values of the training points come for free
+    std::vector<double> vderivs(static_cast<size_t>(nthreads)*stride_vd); // of the current point, per thread
+    if (flag_values) {
+        tws->cache_values.resize(static_cast<size_t>(tws->ntraining + tws->nvalidation)*stride);
+    }
+
+    // every thread evaluates a contiguous chunk of data points with its own replica and writes their rows of J
+#ifdef OPENMP
+#pragma omp parallel for schedule(static, 1) if (nthreads > 1)
+#endif
+    for (int it = 0; it < nthreads; ++it) {
+        FeedForwardNeuralNetwork * const ffnn = tws->getFFNNVDeriv(it);
+        double * const my_vderivs = vderivs.data() + static_cast<size_t>(it)*stride_vd;
+        setVP(ffnn, betas);
+
+        for (int i = (n*it)/nthreads; i < (n*(it + 1))/nthreads; ++i) {
+            ffnn->setInput(tws->x[i]);
+            ffnn->FFPropagate();
+            storeVDerivs(ffnn, tws, npar, my_vderivs);
+            calcPointJacobian(tws, i, my_vderivs, scale, flag_d, ldj, gsl_matrix_ptr(J, static_cast<size_t>(i)*nrows, 0));
+            if (flag_values) {
+                storeValues(ffnn, tws, tws->cache_values.data() + static_cast<size_t>(i)*stride);
             }
         }
     }
 
+    if (flag_values) {
+        setCachedBetas(tws->cache_betas, betas);
+        tws->cache_nvalues = n;
+    }
+    setVP(tws->ffnn, betas);
+
     if (flag_r) {//append regularization gradient
         int offr = calcNData(tws->ntraining, tws->yndim, 0, flag_d ? tws->xndim : 0, 2);
         for (int ib = 0; ib < npar; ++ib) {
@@ -265,7 +531,7 @@ int ffnn_df_deriv_reg(const gsl_vector * betas, void * const tws, gsl_matrix * J
 // --- Custom driver routines
 
 // if verbose, this is used to print info on every fit iteration
-void printStepInfo(const gsl_multifit_nlinear_workspace * const w, const training_workspace * const tws, const int &status)
+void printStepInfo(const gsl_multifit_nlinear_workspace * const w, const double resi_vali, const int &status)
 {
     gsl_vector * f = gsl_multifit_nlinear_residual(w);
     gsl_vector * x = gsl_multifit_nlinear_position(w);
@@ -276,81 +542,516 @@ void printStepInfo(const gsl_multifit_nlinear_workspace * const w, const trainin
 
     // print
     fprintf(stderr, "status = %s\n", gsl_strerror(status));
-    fprintf(stderr, "iter %zu: cond(J) = %8.4f, |f(x)| = %.8f (train), %.8f (vali)\n", gsl_multifit_nlinear_niter(w), 1.0/rcond, gsl_blas_dnrm2(f), (tws->fvali) != nullptr
-                                                                                                                                                    ? gsl_blas_dnrm2(tws->fvali)
-                                                                                                                                                    : 0.);
+    if (resi_vali >= 0.) {
+        fprintf(stderr, "iter %zu: cond(J) = %8.4f, |f(x)| = %.8f (train), %.8f (vali, w/o reg)\n", gsl_multifit_nlinear_niter(w), 1.0/rcond, gsl_blas_dnrm2(f), resi_vali);
+    }
+    else {
+        fprintf(stderr, "iter %zu: cond(J) = %8.4f, |f(x)| = %.8f (train)\n", gsl_multifit_nlinear_niter(w), 1.0/rcond, gsl_blas_dnrm2(f));
+    }
     for (size_t i = 0; i < x->size; ++i) {
         fprintf(stderr, "b%zu: %f, ", i, gsl_vector_get(x, i));
     }
     fprintf(stderr, "\n");
 };
 
+// check if the (unregularized) validation residual went down, return true if we should stop early
+bool checkEarlyStop(const double resi_vali, const training_workspace * const tws, const int &verbose, double &bestvali, int &count_novali, int &info)
+{
+    if (resi_vali == 0 || std::isnan(resi_vali)) { // if it is 0 or nan, stop
+        info = 0;
+        if (verbose > 1) {
+            fprintf(stderr, "Unregularized validation residual reached 0 (or NaN). Stopping early.\n\n");
+        }
+        return true;
+    }
+
+    if (bestvali >= 0. && resi_vali >= bestvali) { // count how long it didn't go down
+        if (verbose > 1) {
+            fprintf(stderr, "Unregularized validation residual %.4f did not decrease from previous minimum %.4f. No new minimum since %i iteration(s).\n\n", resi_vali, bestvali, count_novali);
+        }
+
+        ++count_novali;
+        if (count_novali < tws->maxn_novali) {
+            return false;
+        } // if too long, break
+        info = 1;
+        if (verbose > 1) {
+            fprintf(stderr, "Reached maximal number of iterations (%i) without new validation minimum. Stopping early.\n\n", count_novali);
+        }
+        return true;
+    }
+    // new validation minimum found
+    count_novali = 0;
+    bestvali = resi_vali;
+    return false;
+}
+
 // solve the system with a maximum of tws->max_nsteps iterations, stopping early when validation error doesn't decrease for too long
-void earlyStopDriver(gsl_multifit_nlinear_workspace * const w, const training_workspace * const tws, const int &verbose, int &status, int &info)
+void earlyStopDriver(gsl_multifit_nlinear_workspace * const w, training_workspace * const tws, const int &verbose, int &status, int &info)
 {
     double bestvali = -1.;
     int count_novali = 0;
-
-    const int n = calcNData(tws->nvalidation, tws->yndim, 0, (tws->flag_d1 || tws->flag_d2) ? tws->xndim : 0, 2);
-    gsl_vector * fvali_noreg = gsl_vector_alloc(n);
+    validation_scheduler vali(tws, tws->flag_d1 || tws->flag_d2); // we ignore the regularization part for validation
 
     while (true) {
         status = gsl_multifit_nlinear_iterate(w); // iterate workspace
+        const int iter = static_cast<int>(gsl_multifit_nlinear_niter(w));
+        double resi_vali = -1.;
+        const bool flag_vali = iter < tws->maxn_steps && vali.update(gsl_multifit_nlinear_position(w), iter, resi_vali);
         if (verbose > 1) {
-            printStepInfo(w, tws, status);
+            printStepInfo(w, resi_vali, status);
         }
 
-        if ((static_cast<int>(gsl_multifit_nlinear_niter(w))) >= tws->maxn_steps) {  // check if we reached maxnsteps
+        if (iter >= tws->maxn_steps) {  // check if we reached maxnsteps
             info = 0;
             break;
         }
 
-        if (tws->nvalidation > 0) {
-            // then check if validation residual went down (we ignore the regularization part for that)
-            for (int i = 0; i < n; ++i) {
-                gsl_vector_set(fvali_noreg, i, gsl_vector_get(tws->fvali, i));
+        if (flag_vali) {
+            // then check if validation residual went down
+            const int count_novali_old = count_novali;
+            if (checkEarlyStop(resi_vali, tws, verbose, bestvali, count_novali, info)) {
+                break;
+            }
+            if (count_novali > count_novali_old) {
+                continue;
+            }
+        }
+
+        if (verbose > 1) {
+            fprintf(stderr, "\n");
+        }
+    }
+};
+
+
+// --- Native dense linear algebra (normal equation mode)
+//
+// Matrices are row-major with leading dimension ld. The threaded loops compute every output element
+// within one thread and in a fixed order, so the results don't depend on the number of threads.
+
+namespace
+{
+constexpr int chol_nblock = 64; // block size of the Cholesky decomposition
+constexpr int syrk_ntile = 512; // row tile of the JT JT^T products (fits into L1 for two rows)
+constexpr double omp_min_flops = 1.e5; // don't start threads for less work
+
+// return an aligned pointer to (at least) n doubles in buf
+double * alignedBuffer(std::vector<double> &buf, const size_t n)
+{
+    buf.resize(n + NNTrainingData::ALIGN_NDOUBLE - 1);
+    const auto addr = reinterpret_cast<std::uintptr_t>(buf.data());
+    const std::uintptr_t align = NNTrainingData::ALIGN_NDOUBLE*sizeof(double);
+    return reinterpret_cast<double *>(((addr + align - 1)/align)*align);
+}
+} // namespace
+
+void syrkLowerT(const double * const JT, const int npar, const int nrow, const int ldj, double * const A, const int lda)
+{
+#ifdef OPENMP
+#pragma omp parallel for schedule(dynamic, 4) if (0.5*npar*npar*nrow > omp_min_flops)
+#endif
+    for (int a = 0; a < npar; ++a) {
+        const double * const ja = JT + static_cast<size_t>(a)*ldj;
+        double * const Aa = A + static_cast<size_t>(a)*lda;
+        for (int r0 = 0; r0 < nrow; r0 += syrk_ntile) {
+            const int r1 = std::min(nrow, r0 + syrk_ntile);
+            for (int b = 0; b <= a; ++b) {
+                const double * const jb = JT + static_cast<size_t>(b)*ldj;
+                double s = 0.;
+                for (int r = r0; r < r1; ++r) {
+                    s += ja[r]*jb[r];
+                }
+                Aa[b] += s;
             }
-            double resih = gsl_blas_dnrm2(fvali_noreg);
+        }
+    }
+}
+
+void gemvT(const double * const JT, const int npar, const int nrow, const int ldj, const double * const f, double * const JTf)
+{
+#ifdef OPENMP
+#pragma omp parallel for schedule(static) if (1.*npar*nrow > omp_min_flops)
+#endif
+    for (int a = 0; a < npar; ++a) {
+        const double * const ja = JT + static_cast<size_t>(a)*ldj;
+        double s = 0.;
+        for (int r = 0; r < nrow; ++r) {
+            s += ja[r]*f[r];
+        }
+        JTf[a] += s;
+    }
+}
+
+bool choleskyDecomp(double * const A, const int n, const int lda)
+{
+    const auto el = [A, lda](const int i, const int j) -> double & { return A[static_cast<size_t>(i)*lda + j]; };
 
-            if (resih == 0 || std::isnan(resih)) { // if it is 0 or nan, stop
-                info = 0;
-                if (verbose > 1) {
-                    fprintf(stderr, "Unregularized validation residual reached 0 (or NaN). Stopping early.\n\n");
+    for (int k0 = 0; k0 < n; k0 += chol_nblock) { // right-looking, block column by block column
+        const int k1 = std::min(n, k0 + chol_nblock);
+
+        // factorize the diagonal block (the previous block columns are already subtracted)
+        for (int j = k0; j < k1; ++j) {
+            double d = el(j, j);
+            for (int k = k0; k < j; ++k) {
+                d -= el(j, k)*el(j, k);
+            }
+            if (!(d > 0.)) { return false; } // not positive definite (or NaN)
+            d = sqrt(d);
+            el(j, j) = d;
+            for (int i = j + 1; i < k1; ++i) {
+                double s = el(i, j);
+                for (int k = k0; k < j; ++k) {
+                    s -= el(i, k)*el(j, k);
                 }
-                break;
+                el(i, j) = s/d;
             }
+        }
 
-            if (bestvali >= 0. && resih >= bestvali) { // count how long it didn't go down
-                if (verbose > 1) {
-                    fprintf(stderr, "Unregularized validation residual %.4f did not decrease from previous minimum %.4f. No new minimum since %i iteration(s).\n\n", resih, bestvali, count_novali);
+        // solve for the panel below the diagonal block, then update the trailing matrix
+#ifdef OPENMP
+#pragma omp parallel if (1.*(n - k1)*(n - k1)*(k1 - k0) > omp_min_flops)
+#endif
+        {
+#ifdef OPENMP
+#pragma omp for schedule(static)
+#endif
+            for (int i = k1; i < n; ++i) {
+                for (int j = k0; j < k1; ++j) {
+                    double s = el(i, j);
+                    for (int k = k0; k < j; ++k) {
+                        s -= el(i, k)*el(j, k);
+                    }
+                    el(i, j) = s/el(j, j);
                 }
+            }
+#ifdef OPENMP
+#pragma omp for schedule(dynamic, 4)
+#endif
+            for (int i = k1; i < n; ++i) {
+                const double * const Li = &el(i, k0);
+                for (int j = k1; j <= i; ++j) {
+                    const double * const Lj = &el(j, k0);
+                    double s = 0.;
+                    for (int k = 0; k < k1 - k0; ++k) {
+                        s += Li[k]*Lj[k];
+                    }
+                    el(i, j) -= s;
+                }
+            }
+        }
+    }
+    return true;
+}
+
+void choleskySolve(const double * const L, const int n, const int lda, const double * const b, double * const x)
+{
+    for (int i = 0; i < n; ++i) { // L y = b
+        const double * const Li = L + static_cast<size_t>(i)*lda;
+        double s = b[i];
+        for (int k = 0; k < i; ++k) {
+            s -= Li[k]*x[k];
+        }
+        x[i] = s/Li[i];
+    }
+    for (int i = n - 1; i >= 0; --i) { // L^T x = y
+        double s = x[i];
+        for (int k = i + 1; k < n; ++k) {
+            s -= L[static_cast<size_t>(k)*lda + i]*x[k];
+        }
+        x[i] = s/L[static_cast<size_t>(i)*lda + i];
+    }
+}
 
-                ++count_novali;
-                if (count_novali < tws->maxn_novali) {
-                    continue;
-                } // if too long, break
-                info = 1;
-                if (verbose > 1) {
-                    fprintf(stderr, "Reached maximal number of iterations (%i) without new validation minimum. Stopping early.\n\n", count_novali);
+void choleskyInverseDiag(const double * const L, const int n, const int lda, double * const diag)
+{
+    // (A^-1)_ii = |L^-1 e_i|^2, with L^-1 e_i from forward substitution (zero above i)
+#ifdef OPENMP
+#pragma omp parallel if (n*n*(n/3.) > omp_min_flops)
+#endif
+    {
+        std::vector<double> y(n);
+#ifdef OPENMP
+#pragma omp for schedule(dynamic, 4)
+#endif
+        for (int i = 0; i < n; ++i) {
+            double sum = 0.;
+            for (int k = i; k < n; ++k) {
+                const double * const Lk = L + static_cast<size_t>(k)*lda;
+                double s = (k == i) ? 1. : 0.;
+                for (int m = i; m < k; ++m) {
+                    s -= Lk[m]*y[m];
                 }
-                break;
+                y[k] = s/Lk[k];
+                sum += y[k]*y[k];
+            }
+            diag[i] = sum;
+        }
+    }
+}
+
+
+// --- Normal equation mode
+
+namespace
+{
+// training chisq (incl. regularization if flag_r) and, if resi_vali != nullptr, the validation residual w/o regularization
+double calcChisqImpl(const gsl_vector * const betas, training_workspace * const tws, const bool flag_r, const bool flag_d, double * const resi_vali)
+{
+    const int n = tws->ntraining + ((resi_vali != nullptr) ? tws->nvalidation : 0);
+    const int npar = tws->ffnn->getNVariationalParameters();
+    const int stride = tws->getCacheValueStride();
+    const int nrows = calcNData(1, tws->yndim, 0, flag_d ? tws->xndim : 0, 2);
+    const double scale_train = 1./sqrt(tws->ntraining), scale_vali = tws->nvalidation > 0 ? 1./sqrt(tws->nvalidation) : 0.;
+    std::vector<double> frows(nrows);
+
+    cacheValues(betas, tws, n);
+
+    double chisq = 0., chisq_vali = 0.;
+    for (int i = 0; i < n; ++i) {
+        const bool flag_train = i < tws->ntraining;
+        calcPointResiduals(tws, i, tws->cache_values.data() + static_cast<size_t>(i)*stride, flag_train ? scale_train : scale_vali, flag_d, frows.data());
+        for (const double fr : frows) {
+            (flag_train ? chisq : chisq_vali) += fr*fr;
+        }
+    }
+
+    if (flag_r) { // regularization
+        const double lambda_r_red = tws->lambda_r/sqrt(npar);
+        for (int ib = 0; ib < npar; ++ib) {
+            chisq += lambda_r_red*lambda_r_red*gsl_vector_get(betas, ib)*gsl_vector_get(betas, ib);
+        }
+    }
+
+    if (resi_vali != nullptr) {
+        *resi_vali = sqrt(chisq_vali);
+    }
+    return chisq;
+}
+} // namespace
+
+double calcChisq(const gsl_vector * const betas, training_workspace * const tws, const bool flag_r, const bool flag_d, double &resi_vali)
+{
+    return calcChisqImpl(betas, tws, flag_r, flag_d, &resi_vali);
+}
+
+double calcChisq(const gsl_vector * const betas, training_workspace * const tws, const bool flag_r, const bool flag_d)
+{
+    return calcChisqImpl(betas, tws, flag_r, flag_d, nullptr);
+}
+
+double accumulateNormalEq(const gsl_vector * const betas, training_workspace * const tws, gsl_matrix * const JTJ, gsl_vector * const JTf, const bool flag_r, const bool flag_d)
+{
+    const int n = tws->ntraining;
+    const int nthreads = tws->getNThreads();
+    const int npar = tws->ffnn_vderiv->getNVariationalParameters();
+    const int stride = tws->getCacheValueStride(), stride_vd = tws->getVDerivStride();
+    const int nrows = calcNData(1, tws->yndim, 0, flag_d ? tws->xndim : 0, 2); // residual rows per data point
+    const int nblock = std::min(n, std::max(nthreads, tws->nblock_entries/(nrows*npar))); // data points per block
+    const int ldj = static_cast<int>(NNTrainingData::alignedSize(static_cast<size_t>(nblock)*nrows)); // aligned rows of the transposed Jacobian
+    const double scale = 1./sqrt(n);
+
+    // the transposed Jacobian block (npar x ldj), so that the products below run over contiguous, aligned rows
+    std::vector<double> JTbuf, fblock(static_cast<size_t>(nblock)*nrows), JTf_acc(npar, 0.);
+    double * const JT = alignedBuffer(JTbuf, static_cast<size_t>(npar)*ldj);
+    std::vector<double> scratch(static_cast<size_t>(nthreads)*(stride + stride_vd + static_cast<size_t>(nrows)*npar)); // values, vderivs and Jacobian rows of the current point, per thread
+
+    double * const A = JTJ->data;
+    const int lda = static_cast<int>(JTJ->tda);
+    for (int a = 0; a < npar; ++a) {
+        std::fill(A + static_cast<size_t>(a)*lda, A + static_cast<size_t>(a)*lda + a + 1, 0.);
+    }
+    double chisq = 0.;
+
+    for (int ib0 = 0; ib0 < n; ib0 += nblock) {
+        const int nb = std::min(nblock, n - ib0);
+
+        // every thread evaluates a contiguous chunk of the block's data points with its own replica
+#ifdef OPENMP
+#pragma omp parallel for schedule(static, 1) if (nthreads > 1)
+#endif
+        for (int it = 0; it < nthreads; ++it) {
+            FeedForwardNeuralNetwork * const ffnn = tws->getFFNNVDeriv(it);
+            double * const values = scratch.data() + static_cast<size_t>(it)*(stride + stride_vd + static_cast<size_t>(nrows)*npar);
+            double * const vderivs = values + stride;
+            double * const Jrows = vderivs + stride_vd;
+            setVP(ffnn, betas);
+
+            for (int i = (nb*it)/nthreads; i < (nb*(it + 1))/nthreads; ++i) {
+                ffnn->setInput(tws->x[ib0 + i]);
+                ffnn->FFPropagate();
+                storeValues(ffnn, tws, values);
+                storeVDerivs(ffnn, tws, npar, vderivs);
+                calcPointResiduals(tws, ib0 + i, values, scale, flag_d, fblock.data() + static_cast<size_t>(i)*nrows);
+                calcPointJacobian(tws, ib0 + i, vderivs, scale, flag_d, npar, Jrows);
+                for (int r = 0; r < nrows; ++r) {
+                    for (int ib = 0; ib < npar; ++ib) {
+                        JT[static_cast<size_t>(ib)*ldj + i*nrows + r] = Jrows[r*npar + ib];
+                    }
+                }
+            }
+        }
+
+        // accumulate the block
+        syrkLowerT(JT, npar, nb*nrows, ldj, A, lda);
+        gemvT(JT, npar, nb*nrows, ldj, fblock.data(), JTf_acc.data());
+        for (int r = 0; r < nb*nrows; ++r) {
+            chisq += fblock[r]*fblock[r];
+        }
+    }
+
+    if (flag_r) { // regularization rows (lambda_r_red times unit matrix)
+        const double lambda_r_red = tws->lambda_r/sqrt(npar);
+        for (int ib = 0; ib < npar; ++ib) {
+            const double beta = gsl_vector_get(betas, ib);
+            A[static_cast<size_t>(ib)*lda + ib] += lambda_r_red*lambda_r_red;
+            JTf_acc[ib] += lambda_r_red*lambda_r_red*beta;
+            chisq += lambda_r_red*lambda_r_red*beta*beta;
+        }
+    }
+    for (int ib = 0; ib < npar; ++ib) {
+        gsl_vector_set(JTf, ib, JTf_acc[ib]);
+    }
+
+    return chisq;
+}
+
+// Levenberg-Marquardt with Marquardt scaling: solve (JTJ + mu*diag(JTJ)) dx = -JTf, accept if chisq decreased
+void normalEqDriver(gsl_vector * const x, training_workspace * const tws, gsl_matrix * const JTJ, const int &verbose, int &status, int &info, double &chisq)
+{
+    const int npar = x->size;
+    const int maxn_trials = 20; // maximal number of damping increases per iteration
+    const bool flag_d = tws->flag_d1 || tws->flag_d2;
+    const int lda = static_cast<int>(NNTrainingData::alignedSize(npar)); // aligned rows of the damped matrix
+    std::vector<double> Abuf, dx(npar), xtrial(npar);
+    double * const A = alignedBuffer(Abuf, static_cast<size_t>(npar)*lda);
+    gsl_vector * const JTf = gsl_vector_alloc(npar);
+    gsl_vector_view gxtrial = gsl_vector_view_array(xtrial.data(), npar);
+
+    double mu = 1.e-3, bestvali = -1., resi_vali = 0.;
+    int count_novali = 0;
+    validation_scheduler vali(tws, flag_d);
+    chisq = accumulateNormalEq(x, tws, JTJ, JTf, tws->flag_r, flag_d);
+
+    status = GSL_SUCCESS;
+    info = 0;
+    for (int iter = 1; true; ++iter) {
+        bool flag_accept = false;
+        for (int itrial = 0; itrial < maxn_trials && !flag_accept; ++itrial) {
+            for (int a = 0; a < npar; ++a) { // lower triangle of JTJ, with damped diagonal
+                const double * const JTJa = JTJ->data + static_cast<size_t>(a)*JTJ->tda;
+                std::copy(JTJa, JTJa + a + 1, A + static_cast<size_t>(a)*lda);
+                A[static_cast<size_t>(a)*lda + a] += mu*std::max(JTJa[a], 1.e-12);
+            }
+            if (choleskyDecomp(A, npar, lda)) { // a failed decomposition just means more damping
+                choleskySolve(A, npar, lda, JTf->data, dx.data());
+                for (int ib = 0; ib < npar; ++ib) {
+                    xtrial[ib] = gsl_vector_get(x, ib) - dx[ib];
+                }
+                flag_accept = calcChisq(&gxtrial.vector, tws, tws->flag_r, flag_d) < chisq; // trial steps skip the validation
             }
-            // new validation minimum found
-            count_novali = 0;
-            bestvali = resih;
+            mu = flag_accept ? std::max(mu/3., 1.e-12) : 2.*mu;
+        }
+        if (!flag_accept) { // no further progress possible
+            status = GSL_FAILURE;
+            info = 0;
+            if (verbose > 1) {
+                fprintf(stderr, "No decreasing step found. Stopping.\n\n");
+            }
+            break;
         }
+        for (int ib = 0; ib < npar; ++ib) {
+            gsl_vector_set(x, ib, xtrial[ib]);
+        }
+        const bool flag_vali = iter < tws->maxn_steps && vali.update(x, iter, resi_vali);
+        chisq = accumulateNormalEq(x, tws, JTJ, JTf, tws->flag_r, flag_d);
 
         if (verbose > 1) {
-            fprintf(stderr, "\n");
+            if (flag_vali) {
+                fprintf(stderr, "iter %i: mu = %g, |f(x)| = %.8f (train), %.8f (vali)\n", iter, mu, sqrt(chisq), resi_vali);
+            }
+            else {
+                fprintf(stderr, "iter %i: mu = %g, |f(x)| = %.8f (train)\n", iter, mu, sqrt(chisq));
+            }
+        }
+
+        if (iter >= tws->maxn_steps) {  // check if we reached maxnsteps
+            info = 0;
+            break;
+        }
+        if (flag_vali && checkEarlyStop(resi_vali, tws, verbose, bestvali, count_novali, info)) {
+            break;
         }
     }
 
-    gsl_vector_free(fvali_noreg);
-};
+    setVP(tws->ffnn, x); // the last trial step may have been rejected
+    gsl_vector_free(JTf);
+}
+
+// fit errors from the covariance (JTJ)^-1, like calcFitErr (JTJ is overwritten)
+bool calcNormalEqFitErr(gsl_matrix * const JTJ, double * const err, const int &ndata, const double &chisq)
+{
+    const int npar = JTJ->size1;
+    const double c = GSL_MAX_DBL(1, sqrt(chisq/(ndata - npar)));
+    std::vector<double> covar_diag(npar);
+    const bool flag_covar = choleskyDecomp(JTJ->data, npar, static_cast<int>(JTJ->tda));
+    if (flag_covar) {
+        choleskyInverseDiag(JTJ->data, npar, static_cast<int>(JTJ->tda), covar_diag.data());
+    }
+    for (int i = 0; i < npar; ++i) {
+        err[i] = flag_covar ? c*sqrt(covar_diag[i]) : std::nan("");
+    }
+    return flag_covar;
+}
+
+void normalEqFit(training_workspace * const tws, double * const fit, double * const err, const int &verbose)
+{
+    const int npar = tws->ffnn->getNVariationalParameters();
+    gsl_vector_view gx = gsl_vector_view_array(fit, npar);
+    gsl_matrix * const JTJ = gsl_matrix_alloc(npar, npar);
+    int status, info;
+    double chisq;
+
+    normalEqDriver(&gx.vector, tws, JTJ, verbose, status, info, chisq);
+    const bool flag_covar = calcNormalEqFitErr(JTJ, err, tws->ntraining, chisq);
+
+    if (verbose > 1) {
+        const bool flag_d = tws->flag_d1 || tws->flag_d2;
+        double resi_vali_full, resi_vali_noreg, resi_vali_pure;
+        const double resi_full = sqrt(calcChisq(&gx.vector, tws, tws->flag_r, flag_d, resi_vali_full));
+        const double resi_noreg = sqrt(calcChisq(&gx.vector, tws, false, flag_d, resi_vali_noreg));
+        const double resi_pure = sqrt(calcChisq(&gx.vector, tws, false, false, resi_vali_pure));
+
+        fprintf(stderr, "summary from normal equation mode\n");
+        fprintf(stderr, "reason for stopping: %s\n", (info == 1) ? "failed validation" : (status == GSL_SUCCESS ? "max steps || 0 residual" : "no decreasing step"));
+        fprintf(stderr, "final   |f(x)| = %f (train), %f (vali)\n", resi_full, resi_vali_full);
+        fprintf(stderr, "w/o reg |f(x)| = %f (train), %f (vali)\n", resi_noreg, resi_vali_noreg);
+        fprintf(stderr, "pure    |f(x)| = %f (train), %f (vali)\n", resi_pure, resi_vali_pure);
+        fprintf(stderr, "chisq/dof = %g\n", chisq/(tws->ntraining - npar));
+        if (!flag_covar) {
+            fprintf(stderr, "[NNTrainerGSL] Warning: J^T J is singular, fit errors are NaN.\n");
+        }
+        for (int i = 0; i < npar; ++i) {
+            fprintf(stderr, "b%i      = %.5f +/- %.5f\n", i, fit[i], err[i]);
+        }
+        fprintf(stderr, "\n");
+    }
+
+    gsl_matrix_free(JTJ);
+}
 }  // namespace nn_trainer_gsl_details
 
 // --- Class method implementation
 
+void NNTrainerGSL::setValidationInterval(const int vali_interval, const bool flag_async)
+{
+    if (vali_interval < 1) {
+        throw std::invalid_argument("[NNTrainerGSL::setValidationInterval] The validation interval must be at least 1.");
+    }
+    _vali_interval = vali_interval;
+    _flag_vali_async = flag_async;
+}
+
 void NNTrainerGSL::findFit(FeedForwardNeuralNetwork * const ffnn, double * const fit, double * const err, const int &verbose)
 {
     //   Fit NN ffnn with the following passed variables:
@@ -369,6 +1070,7 @@ void NNTrainerGSL::findFit(FeedForwardNeuralNetwork * const ffnn, double * const
     gsl_multifit_nlinear_fdf fdf_full, fdf_noreg, fdf_pure;
     gsl_multifit_nlinear_workspace * w_full, * w_noreg, * w_pure;
     gsl_vector_view gx = gsl_vector_view_array(fit, npar);
+    gsl_vector * fvali = nullptr;
 
     const int dof = ntrain - npar;
     const bool flag_d = _flag_d1 || _flag_d2;
@@ -391,6 +1093,21 @@ void NNTrainerGSL::findFit(FeedForwardNeuralNetwork * const ffnn, double * const
     tws.copyDatConf(_tdata, _tconfig);
     tws.ffnn = ffnn; // set the to-be-fitted FFNN
     tws.ffnn_vderiv = _createVDerivFFNN(ffnn); // set the copy with vderivs
+#ifdef OPENMP
+    tws.createReplicas(omp_in_parallel() ? 1 : omp_get_max_threads()); // for data-parallel residual evaluation (unless bestFit runs parallel fits)
+#endif
+    tws.vali_interval = _vali_interval;
+    if (_flag_vali && _flag_vali_async) {
+        tws.ffnn_vali = new FeedForwardNeuralNetwork(ffnn); // the copy for background validation
+    }
+
+    if (_flag_normal_eq) { // solve without storing the Jacobian
+        normalEqFit(&tws, fit, err, verbose);
+        tws.deleteReplicas();
+        delete tws.ffnn_vali;
+        delete tws.ffnn_vderiv;
+        return;
+    }
 
     // configure all three fdf objects
 
@@ -452,10 +1169,9 @@ void NNTrainerGSL::findFit(FeedForwardNeuralNetwork * const ffnn, double * const
     w_noreg = gsl_multifit_nlinear_alloc(T_noreg, &_gsl_params, ntrain_noreg, npar);
     w_pure = gsl_multifit_nlinear_alloc(T_pure, &_gsl_params, ntrain_pure, npar);
     if (_flag_vali) {
-        tws.fvali = gsl_vector_alloc(nvali_full);
+        fvali = gsl_vector_alloc(nvali_full); // not passed to ffnn_f, i.e. computed only where needed below
     }
     else {
-        tws.fvali = nullptr;
         if (verbose > 1) {
             fprintf(stderr, "[NNTrainerGSL] Warning: Validation residual calculation disabled, i.e. no early stopping.\n");
         }
@@ -463,22 +1179,26 @@ void NNTrainerGSL::findFit(FeedForwardNeuralNetwork * const ffnn, double * const
 
     // initialize solver with starting point and calculate initial cost
     gsl_multifit_nlinear_init(&gx.vector, &fdf_full, w_full);
-    calcCosts(w_full, chi0, resih, tws.fvali, chi0_vali, resih);
+    if (_flag_vali) { calcFVali(&gx.vector, &tws, fvali, tws.flag_r, flag_d); }
+    calcCosts(w_full, chi0, resih, fvali, chi0_vali, resih);
 
     // run driver to find fit
     earlyStopDriver(w_full, &tws, verbose, status, info);
 
     // compute again final full cost and error of best fit parameters
-    calcCosts(w_full, resi_full, chisq, tws.fvali, resi_vali_full, resih);
+    if (_flag_vali) { calcFVali(gsl_multifit_nlinear_position(w_full), &tws, fvali, tws.flag_r, flag_d); }
+    calcCosts(w_full, resi_full, chisq, fvali, resi_vali_full, resih);
     calcFitErr(w_full, fit, err, ntrain, npar, chisq);
 
     // final unregularized cost calculation
     gsl_multifit_nlinear_init(&gx.vector, &fdf_noreg, w_noreg);
-    calcCosts(w_noreg, resi_noreg, resih, tws.fvali, resi_vali_noreg, resih);
+    if (_flag_vali) { calcFVali(&gx.vector, &tws, fvali, false, flag_d); }
+    calcCosts(w_noreg, resi_noreg, resih, fvali, resi_vali_noreg, resih);
 
     // final pure (no deriv, no reg) cost calculation
     gsl_multifit_nlinear_init(&gx.vector, &fdf_pure, w_pure);
-    calcCosts(w_pure, resi_pure, resih, tws.fvali, resi_vali_pure, resih);
+    if (_flag_vali) { calcFVali(&gx.vector, &tws, fvali, false, false); }
+    calcCosts(w_pure, resi_pure, resih, fvali, resi_vali_pure, resih);
 
     if (verbose > 1) {
         fprintf(stderr, "summary from method '%s/%s'\n", gsl_multifit_nlinear_name(w_full), gsl_multifit_nlinear_trs_name(w_full));
@@ -505,8 +1225,10 @@ void NNTrainerGSL::findFit(FeedForwardNeuralNetwork * const ffnn, double * const
     gsl_multifit_nlinear_free(w_noreg);
     gsl_multifit_nlinear_free(w_pure);
     if (_flag_vali) {
-        gsl_vector_free(tws.fvali);
+        gsl_vector_free(fvali);
     }
+    tws.deleteReplicas();
+    delete tws.ffnn_vali;
     delete tws.ffnn_vderiv;
 };
 
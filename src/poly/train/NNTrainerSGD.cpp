@@ -0,0 +1,242 @@
+#include "qnets/poly/train/NNTrainerSGD.hpp"
+
+#include <gsl/gsl_matrix.h>
+#include <gsl/gsl_vector.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <numeric>
+#include <random>
+#include <vector>
+
+#ifdef OPENMP
+#include <omp.h>
+#endif
+
+namespace nn_trainer_sgd_details
+{
+using namespace nn_trainer_gsl_details; // the residual row helpers
+
+// --- Gradient and validation
+
+double calcBatchGradient(const double * const betas, training_workspace * const tws, const int * const idx, const int nb, const bool flag_d, std::vector<double> &grad_buf, double * const grad)
+{
+    const int nthreads = tws->getNThreads();
+    const int npar = tws->ffnn_vderiv->getNVariationalParameters();
+    const int stride = tws->getCacheValueStride(), stride_vd = tws->getVDerivStride();
+    const int nrows = calcNData(1, tws->yndim, 0, flag_d ? tws->xndim : 0, 2); // residual rows per data point
+    const size_t nscratch = stride + stride_vd + nrows + static_cast<size_t>(nrows)*npar; // values, vderivs, f and J of the current point
+    const double scale = 1./sqrt(nb);
+    grad_buf.resize(static_cast<size_t>(nthreads)*(npar + 1 + nscratch));
+
+    // every thread evaluates a contiguous chunk of the batch with its own replica
+#ifdef OPENMP
+#pragma omp parallel for schedule(static, 1) if (nthreads > 1)
+#endif
+    for (int it = 0; it < nthreads; ++it) {
+        FeedForwardNeuralNetwork * const ffnn = tws->getFFNNVDeriv(it);
+        double * const my_grad = grad_buf.data() + static_cast<size_t>(it)*(npar + 1); // gradient and chisq
+        double * const values = grad_buf.data() + static_cast<size_t>(nthreads)*(npar + 1) + it*nscratch;
+        double * const vderivs = values + stride;
+        double * const f = vderivs + stride_vd;
+        double * const J = f + nrows;
+        ffnn->setVariationalParameter(betas);
+        std::fill(my_grad, my_grad + npar + 1, 0.);
+
+        for (int i = (nb*it)/nthreads; i < (nb*(it + 1))/nthreads; ++i) {
+            ffnn->setInput(tws->x[idx[i]]);
+            ffnn->FFPropagate();
+            storeValues(ffnn, tws, values);
+            storeVDerivs(ffnn, tws, npar, vderivs);
+            calcPointResiduals(tws, idx[i], values, scale, flag_d, f);
+            calcPointJacobian(tws, idx[i], vderivs, scale, flag_d, npar, J);
+            for (int r = 0; r < nrows; ++r) {
+                for (int ib = 0; ib < npar; ++ib) {
+                    my_grad[ib] += 2.*f[r]*J[r*npar + ib];
+                }
+                my_grad[npar] += f[r]*f[r];
+            }
+        }
+    }
+
+    // deterministic reduction
+    std::copy(grad_buf.begin(), grad_buf.begin() + npar, grad);
+    double chisq = grad_buf[npar];
+    for (int it = 1; it < nthreads; ++it) {
+        const double * const th_grad = grad_buf.data() + static_cast<size_t>(it)*(npar + 1);
+        for (int ib = 0; ib < npar; ++ib) {
+            grad[ib] += th_grad[ib];
+        }
+        chisq += th_grad[npar];
+    }
+
+    if (tws->flag_r) { // regularization
+        const double lambda_r_fac = tws->lambda_r*tws->lambda_r/npar;
+        for (int ib = 0; ib < npar; ++ib) {
+            grad[ib] += 2.*lambda_r_fac*betas[ib];
+            chisq += lambda_r_fac*betas[ib]*betas[ib];
+        }
+    }
+    return chisq;
+}
+
+double calcRangeChisq(const double * const betas, training_workspace * const tws, const int ifirst, const int n, const bool flag_d, std::vector<double> &resi_buf)
+{
+    const int nthreads = tws->getNThreads();
+    const int stride = tws->getCacheValueStride();
+    const int nrows = calcNData(1, tws->yndim, 0, flag_d ? tws->xndim : 0, 2);
+    const size_t nscratch = stride + nrows; // values and f of the current point
+    const double scale = 1./sqrt(n);
+    resi_buf.resize(nthreads*(1 + nscratch));
+
+#ifdef OPENMP
+#pragma omp parallel for schedule(static, 1) if (nthreads > 1)
+#endif
+    for (int it = 0; it < nthreads; ++it) {
+        FeedForwardNeuralNetwork * const ffnn = tws->getFFNN(it);
+        double * const values = resi_buf.data() + nthreads + it*nscratch;
+        double * const f = values + stride;
+        ffnn->setVariationalParameter(betas);
+
+        double chisq = 0.;
+        for (int i = ifirst + (n*it)/nthreads; i < ifirst + (n*(it + 1))/nthreads; ++i) {
+            ffnn->setInput(tws->x[i]);
+            ffnn->FFPropagate();
+            storeValues(ffnn, tws, values);
+            calcPointResiduals(tws, i, values, scale, flag_d, f);
+            for (int r = 0; r < nrows; ++r) {
+                chisq += f[r]*f[r];
+            }
+        }
+        resi_buf[it] = chisq;
+    }
+
+    double chisq_range = 0.;
+    for (int it = 0; it < nthreads; ++it) { chisq_range += resi_buf[it]; }
+    return chisq_range;
+}
+
+double calcValiResidual(const double * const betas, training_workspace * const tws, const bool flag_d, std::vector<double> &resi_buf)
+{
+    return sqrt(calcRangeChisq(betas, tws, tws->ntraining, tws->nvalidation, flag_d, resi_buf));
+}
+
+} // namespace nn_trainer_sgd_details
+
+// --- Class method implementation
+
+void NNTrainerSGD::findFit(FeedForwardNeuralNetwork * const ffnn, double * const fit, double * const err, const int &verbose)
+{
+    using namespace nn_trainer_gsl_details; // workspace and normal equations
+    using namespace nn_trainer_sgd_details;
+
+    const int npar = ffnn->getNVariationalParameters(), ntrain = _tdata.ntraining;
+    const int nbatch = (_oconfig.batch_size > 0 && _oconfig.batch_size < ntrain) ? _oconfig.batch_size : ntrain;
+    const bool flag_d = _flag_d1 || _flag_d2;
+
+    // make sure the ffnn is configured
+    _configureFFNN(ffnn, false); // without vderiv substrates!
+
+    // set fit to initial betas
+    for (int i = 0; i < npar; ++i) {
+        fit[i] = ffnn->getVariationalParameter(i);
+    }
+
+    // configure training workspace
+    training_workspace tws;
+    tws.copyDatConf(_tdata, _tconfig);
+    tws.ffnn = ffnn;
+    tws.ffnn_vderiv = _createVDerivFFNN(ffnn);
+    int nworkers = _oconfig.nworkers; // replicas for data-parallel batch evaluation
+#ifdef OPENMP
+    if (nworkers < 1) {
+        nworkers = omp_in_parallel() ? 1 : omp_get_max_threads(); // unless bestFit runs parallel fits
+    }
+#endif
+    tws.createReplicas(nworkers);
+    if (!_flag_vali && verbose > 1) {
+        fprintf(stderr, "[NNTrainerSGD] Warning: Validation residual calculation disabled, i.e. no early stopping.\n");
+    }
+
+    std::vector<double> grad(npar), grad_buf, resi_buf, bestfit(fit, fit + npar);
+    std::vector<int> perm(ntrain);
+    std::iota(perm.begin(), perm.end(), 0);
+    std::mt19937_64 rgen(_oconfig.seed);
+    NNOptimizer optimizer(_oconfig);
+
+    double bestvali = -1.;
+    int count_novali = 0, info = 0, iepoch = 0;
+    while (iepoch < _tconfig.maxn_steps) {
+        std::shuffle(perm.begin(), perm.end(), rgen);
+        double chisq = 0.;
+        for (int ib = 0; ib + nbatch <= ntrain; ib += nbatch) {
+            chisq += calcBatchGradient(fit, &tws, perm.data() + ib, nbatch, flag_d, grad_buf, grad.data());
+            optimizer.step(grad.data(), fit, npar);
+        }
+        ++iepoch;
+
+        if (_flag_vali) {
+            const double resi_vali = calcValiResidual(fit, &tws, flag_d, resi_buf);
+            if (verbose > 1) {
+                fprintf(stderr, "epoch %i: mean batch |f(x)| = %.8f (train), %.8f (vali)\n", iepoch, sqrt(chisq/(ntrain/nbatch)), resi_vali);
+            }
+            const bool flag_stop = checkEarlyStop(resi_vali, &tws, verbose, bestvali, count_novali, info);
+            if (resi_vali == 0. || (!flag_stop && count_novali == 0)) { // new validation minimum
+                std::copy(fit, fit + npar, bestfit.begin());
+            }
+            if (flag_stop) {
+                break;
+            }
+        }
+        else if (verbose > 1) {
+            fprintf(stderr, "epoch %i: mean batch |f(x)| = %.8f (train)\n", iepoch, sqrt(chisq/(ntrain/nbatch)));
+        }
+    }
+    if (_flag_vali) {
+        std::copy(bestfit.begin(), bestfit.end(), fit);
+    }
+    ffnn->setVariationalParameter(fit);
+
+    // fit errors from the normal equations at the fit
+    gsl_vector_view gx = gsl_vector_view_array(fit, npar);
+    gsl_matrix * const JTJ = gsl_matrix_alloc(npar, npar);
+    gsl_vector * const JTf = gsl_vector_alloc(npar);
+    const double chisq = accumulateNormalEq(&gx.vector, &tws, JTJ, JTf, tws.flag_r, flag_d);
+    const bool flag_covar = calcNormalEqFitErr(JTJ, err, ntrain, chisq);
+
+    if (verbose > 1) {
+        // streamed like the epochs, the residual caches of NNTrainerGSL would hold all training and validation points
+        double chisq_reg = 0.;
+        if (tws.flag_r) {
+            for (int i = 0; i < npar; ++i) {
+                chisq_reg += tws.lambda_r*tws.lambda_r/npar*fit[i]*fit[i];
+            }
+        }
+        const double chisq_noreg = calcRangeChisq(fit, &tws, 0, ntrain, flag_d, resi_buf);
+        const double resi_full = sqrt(chisq_noreg + chisq_reg), resi_noreg = sqrt(chisq_noreg);
+        const double resi_pure = sqrt(calcRangeChisq(fit, &tws, 0, ntrain, false, resi_buf));
+        const double resi_vali_noreg = (_tdata.nvalidation > 0) ? calcValiResidual(fit, &tws, flag_d, resi_buf) : 0.;
+        const double resi_vali_pure = (_tdata.nvalidation > 0) ? calcValiResidual(fit, &tws, false, resi_buf) : 0.;
+
+        fprintf(stderr, "summary from stochastic trainer (method %i, batch size %i)\n", static_cast<int>(_oconfig.method), nbatch);
+        fprintf(stderr, "number of epochs: %i\n", iepoch);
+        fprintf(stderr, "reason for stopping: %s\n", (info == 1) ? "failed validation" : "max steps || 0 residual");
+        fprintf(stderr, "final   |f(x)| = %f (train), %f (vali)\n", resi_full, resi_vali_noreg);
+        fprintf(stderr, "w/o reg |f(x)| = %f (train), %f (vali)\n", resi_noreg, resi_vali_noreg);
+        fprintf(stderr, "pure    |f(x)| = %f (train), %f (vali)\n", resi_pure, resi_vali_pure);
+        fprintf(stderr, "chisq/dof = %g\n", chisq/(ntrain - npar));
+        if (!flag_covar) {
+            fprintf(stderr, "[NNTrainerSGD] Warning: J^T J is singular, fit errors are NaN.\n");
+        }
+        for (int i = 0; i < npar; ++i) {
+            fprintf(stderr, "b%i      = %.5f +/- %.5f\n", i, fit[i], err[i]);
+        }
+        fprintf(stderr, "\n");
+    }
+
+    gsl_vector_free(JTf);
+    gsl_matrix_free(JTJ);
+    tws.deleteReplicas();
+    delete tws.ffnn_vderiv;
+}
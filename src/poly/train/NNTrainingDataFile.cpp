@@ -0,0 +1,257 @@
+#include "qnets/poly/train/NNTrainingDataFile.hpp"
+
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// --- Helpers
+
+namespace
+{
+constexpr char td_magic[8] = {'Q', 'N', 'E', 'T', 'S', 'T', 'D', '\0'};
+constexpr uint32_t td_endian_marker = 0x01020304;
+constexpr size_t td_header_size = NNTrainingData::ALIGN_NDOUBLE*sizeof(double); // header bytes incl. padding
+constexpr int32_t td_flag_d1 = 1, td_flag_d2 = 2;
+
+struct FileLayout // sizes of the (padded) blocks in doubles
+{
+    size_t nx, ny, nyd;
+    bool flag_d1, flag_d2;
+
+    FileLayout(const NNTrainingData &tdata, const bool flag_d1, const bool flag_d2):
+            nx(NNTrainingData::alignedSize(static_cast<size_t>(tdata.ndata)*tdata.xndim)),
+            ny(NNTrainingData::alignedSize(static_cast<size_t>(tdata.ndata)*tdata.yndim)),
+            nyd(NNTrainingData::alignedSize(static_cast<size_t>(tdata.ndata)*tdata.yndim*tdata.xndim)),
+            flag_d1(flag_d1), flag_d2(flag_d2) {}
+
+    size_t getFileSize() const { return td_header_size + (nx + 2*ny + (flag_d1 ? nyd : 0) + (flag_d2 ? nyd : 0))*sizeof(double); }
+};
+
+// valid counts: disjoint training and validation sets (the rest is used for testing) and positive dimensions
+bool isValidCounts(const int ndata, const int ntraining, const int nvalidation, const int xndim, const int yndim)
+{
+    return ndata >= 0 && ntraining >= 0 && nvalidation >= 0 && static_cast<int64_t>(ntraining) + nvalidation <= ndata && xndim >= 1 && yndim >= 1;
+}
+
+// does a file of nbytes match the counts of tdata? (bounded by the file size first, so that the layout can't overflow)
+bool matchesFileSize(const NNTrainingData &tdata, const bool flag_d1, const bool flag_d2, const size_t nbytes)
+{
+    const size_t ndoubles = nbytes/sizeof(double);
+    if (tdata.ndata > 0) {
+        const size_t nmax = ndoubles/tdata.ndata; // max. doubles per data point in any block
+        if (static_cast<size_t>(tdata.xndim) > nmax || static_cast<size_t>(tdata.yndim) > nmax ||
+            ((flag_d1 || flag_d2) && static_cast<size_t>(tdata.yndim)*tdata.xndim > nmax)) {
+            return false;
+        }
+    }
+    return FileLayout(tdata, flag_d1, flag_d2).getFileSize() == nbytes;
+}
+
+void packHeader(const NNTrainingData &tdata, const bool flag_d1, const bool flag_d2, char * header)
+{
+    const uint32_t head[2] = {training_data_file_version, td_endian_marker};
+    const int32_t dims[6] = {tdata.ndata, tdata.ntraining, tdata.nvalidation, tdata.xndim, tdata.yndim, (flag_d1 ? td_flag_d1 : 0) | (flag_d2 ? td_flag_d2 : 0)};
+    std::memset(header, 0, td_header_size);
+    std::memcpy(header, td_magic, 8);
+    std::memcpy(header + 8, head, sizeof(head));
+    std::memcpy(header + 8 + sizeof(head), dims, sizeof(dims));
+}
+
+// parse the header into the counts of tdata and the flags, or throw
+void unpackHeader(const char * header, NNTrainingData &tdata, bool &flag_d1, bool &flag_d2)
+{
+    if (std::memcmp(header, td_magic, 8) != 0) {
+        throw std::invalid_argument("[NNTrainingDataFile] Not a binary training data file.");
+    }
+    uint32_t head[2];
+    std::memcpy(head, header + 8, sizeof(head));
+    if (head[1] != td_endian_marker) {
+        throw std::invalid_argument("[NNTrainingDataFile] Training data file has different endianness.");
+    }
+    if (head[0] != training_data_file_version) {
+        throw std::invalid_argument("[NNTrainingDataFile] Unsupported training data file version " + std::to_string(head[0]) + ".");
+    }
+    int32_t dims[6];
+    std::memcpy(dims, header + 8 + sizeof(head), sizeof(dims));
+    if (!isValidCounts(dims[0], dims[1], dims[2], dims[3], dims[4])) {
+        throw std::invalid_argument("[NNTrainingDataFile] Invalid data counts in training data file.");
+    }
+    tdata.ndata = dims[0];
+    tdata.ntraining = dims[1];
+    tdata.nvalidation = dims[2];
+    tdata.xndim = dims[3];
+    tdata.yndim = dims[4];
+    flag_d1 = (dims[5] & td_flag_d1) != 0;
+    flag_d2 = (dims[5] & td_flag_d2) != 0;
+}
+
+// write the rows of a 2D/3D array as one zero padded block
+void writeBlock(std::ofstream &file, double * const * rows, const int nrows, const int ncols, const size_t nblock)
+{
+    for (int i = 0; i < nrows; ++i) {
+        file.write(reinterpret_cast<const char *>(rows[i]), ncols*sizeof(double));
+    }
+    const std::vector<double> padding(nblock - static_cast<size_t>(nrows)*ncols, 0.);
+    file.write(reinterpret_cast<const char *>(padding.data()), padding.size()*sizeof(double));
+}
+
+void writeDerivBlock(std::ofstream &file, double *** const yd, const NNTrainingData &tdata, const size_t nblock)
+{
+    for (int i = 0; i < tdata.ndata; ++i) {
+        for (int j = 0; j < tdata.yndim; ++j) {
+            file.write(reinterpret_cast<const char *>(yd[i][j]), tdata.xndim*sizeof(double));
+        }
+    }
+    const std::vector<double> padding(nblock - static_cast<size_t>(tdata.ndata)*tdata.yndim*tdata.xndim, 0.);
+    file.write(reinterpret_cast<const char *>(padding.data()), padding.size()*sizeof(double));
+}
+} // namespace
+
+
+// --- Store/Load
+
+void storeTrainingData(const std::string &filename, const NNTrainingData &tdata)
+{
+    if (!isValidCounts(tdata.ndata, tdata.ntraining, tdata.nvalidation, tdata.xndim, tdata.yndim)) {
+        throw std::invalid_argument("[storeTrainingData] Invalid data counts.");
+    }
+    const bool flag_d1 = tdata.yd1 != nullptr, flag_d2 = tdata.yd2 != nullptr;
+    const FileLayout layout(tdata, flag_d1, flag_d2);
+
+    std::ofstream file(filename, std::ios::binary);
+    if (!file.is_open()) {
+        throw std::runtime_error("[storeTrainingData] Could not open file " + filename);
+    }
+    char header[td_header_size];
+    packHeader(tdata, flag_d1, flag_d2, header);
+    file.write(header, td_header_size);
+    writeBlock(file, tdata.x, tdata.ndata, tdata.xndim, layout.nx);
+    writeBlock(file, tdata.y, tdata.ndata, tdata.yndim, layout.ny);
+    writeBlock(file, tdata.w, tdata.ndata, tdata.yndim, layout.ny);
+    if (flag_d1) { writeDerivBlock(file, tdata.yd1, tdata, layout.nyd); }
+    if (flag_d2) { writeDerivBlock(file, tdata.yd2, tdata, layout.nyd); }
+    if (!file) {
+        throw std::runtime_error("[storeTrainingData] Writing to file " + filename + " failed.");
+    }
+}
+
+void loadTrainingData(const std::string &filename, NNTrainingData &tdata)
+{
+    std::ifstream file(filename, std::ios::binary);
+    if (!file.is_open()) {
+        throw std::runtime_error("[loadTrainingData] Could not open file " + filename);
+    }
+    file.seekg(0, std::ios::end);
+    const std::streamoff fsize = file.tellg();
+    file.seekg(0, std::ios::beg);
+    char header[td_header_size];
+    file.read(header, td_header_size);
+    if (!file || fsize < static_cast<std::streamoff>(td_header_size)) {
+        throw std::invalid_argument("[loadTrainingData] Training data file " + filename + " is truncated.");
+    }
+
+    // check the header against the file size, before tdata is touched
+    NNTrainingData counts = {0, 0, 0, 1, 1, nullptr, nullptr, nullptr, nullptr, nullptr};
+    bool flag_d1, flag_d2;
+    unpackHeader(header, counts, flag_d1, flag_d2);
+    if (!matchesFileSize(counts, flag_d1, flag_d2, static_cast<size_t>(fsize))) {
+        throw std::invalid_argument("[loadTrainingData] Size of file " + filename + " doesn't match the stored data counts.");
+    }
+    const FileLayout layout(counts, flag_d1, flag_d2);
+
+    tdata.deallocate();
+    tdata.ndata = counts.ndata;
+    tdata.ntraining = counts.ntraining;
+    tdata.nvalidation = counts.nvalidation;
+    tdata.xndim = counts.xndim;
+    tdata.yndim = counts.yndim;
+    tdata.allocate(flag_d1, flag_d2); // the same block sizes as in the file
+
+    file.read(reinterpret_cast<char *>(tdata.xdata), layout.nx*sizeof(double));
+    file.read(reinterpret_cast<char *>(tdata.ydata), layout.ny*sizeof(double));
+    file.read(reinterpret_cast<char *>(tdata.wdata), layout.ny*sizeof(double));
+    if (flag_d1) { file.read(reinterpret_cast<char *>(tdata.yd1data), layout.nyd*sizeof(double)); }
+    if (flag_d2) { file.read(reinterpret_cast<char *>(tdata.yd2data), layout.nyd*sizeof(double)); }
+    if (!file) {
+        tdata.deallocate();
+        throw std::invalid_argument("[loadTrainingData] Training data file " + filename + " is truncated.");
+    }
+}
+
+
+// --- MappedTrainingData
+
+MappedTrainingData::MappedTrainingData(const std::string &filename)
+{
+    const int fd = open(filename.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw std::runtime_error("[MappedTrainingData] Could not open file " + filename);
+    }
+    struct stat st{};
+    if (fstat(fd, &st) != 0 || st.st_size <= 0) {
+        close(fd);
+        throw std::runtime_error("[MappedTrainingData] Could not stat file " + filename);
+    }
+    _size = static_cast<size_t>(st.st_size);
+    _map = mmap(nullptr, _size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd); // the mapping stays valid
+    if (_map == MAP_FAILED) {
+        _map = nullptr;
+        throw std::runtime_error("[MappedTrainingData] Could not map file " + filename);
+    }
+
+    try {
+        if (_size < td_header_size) {
+            throw std::invalid_argument("[MappedTrainingData] Training data file is truncated.");
+        }
+        auto * const data = static_cast<char *>(_map);
+        bool flag_d1, flag_d2;
+        unpackHeader(data, _tdata, flag_d1, flag_d2);
+        if (!matchesFileSize(_tdata, flag_d1, flag_d2, _size)) {
+            throw std::invalid_argument("[MappedTrainingData] File size doesn't match the stored data counts.");
+        }
+        const FileLayout layout(_tdata, flag_d1, flag_d2);
+
+        // blocks are 64 byte aligned in the page aligned mapping
+        double * next = reinterpret_cast<double *>(data + td_header_size);
+        _tdata.xdata = next;
+        next += layout.nx;
+        _tdata.ydata = next;
+        next += layout.ny;
+        _tdata.wdata = next;
+        next += layout.ny;
+        if (flag_d1) {
+            _tdata.yd1data = next;
+            next += layout.nyd;
+        }
+        if (flag_d2) {
+            _tdata.yd2data = next;
+        }
+        _tdata.createViews(flag_d1, flag_d2);
+    }
+    catch (...) {
+        munmap(_map, _size);
+        throw;
+    }
+}
+
+void MappedTrainingData::setDataSplit(const int ntraining, const int nvalidation)
+{
+    if (!isValidCounts(_tdata.ndata, ntraining, nvalidation, _tdata.xndim, _tdata.yndim)) {
+        throw std::invalid_argument("[MappedTrainingData::setDataSplit] Invalid data split.");
+    }
+    _tdata.ntraining = ntraining;
+    _tdata.nvalidation = nvalidation;
+}
+
+MappedTrainingData::~MappedTrainingData()
+{
+    _tdata.deleteViews();
+    if (_map != nullptr) { munmap(_map, _size); }
+}
@@ -0,0 +1,251 @@
+#include "qnets/templ/BinaryWeights.hpp"
+
+#include <algorithm>
+#include <climits>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace templ
+{
+// --- Helpers
+
+namespace
+{
+constexpr char bw_magic[8] = {'Q', 'N', 'E', 'T', 'S', 'B', 'W', '\0'};
+constexpr uint32_t bw_endian_marker = 0x01020304;
+constexpr size_t bw_actf_id_len = 12;
+
+size_t headerSize(int nlayer) // header bytes before the checksum
+{
+    return 8 + 2*sizeof(uint32_t) + 2*sizeof(uint32_t) + nlayer*(sizeof(uint32_t) + bw_actf_id_len) + sizeof(uint64_t);
+}
+
+// check magic, endianness and version of the fixed header part (of nbytes), returns the valid nlayer or throws
+uint32_t checkFixedHeader(const char * data, size_t nbytes)
+{
+    if (nbytes < 8 || std::memcmp(data, bw_magic, 8) != 0) {
+        throw std::invalid_argument("[BinaryWeights] Not a binary weight file.");
+    }
+    if (nbytes < headerSize(0)) {
+        throw std::invalid_argument("[BinaryWeights] Binary weight file is truncated.");
+    }
+    uint32_t head[4];
+    std::memcpy(head, data + 8, sizeof(head));
+    if (head[1] != bw_endian_marker) {
+        throw std::invalid_argument("[BinaryWeights] Binary weight file has different endianness.");
+    }
+    if (head[0] != binary_weights_version) {
+        throw std::invalid_argument("[BinaryWeights] Unsupported binary weight file version " + std::to_string(head[0]) + ".");
+    }
+    if (head[3] < 1 || head[3] > binary_weights_max_nlayer) {
+        throw std::invalid_argument("[BinaryWeights] Invalid number of layers " + std::to_string(head[3]) + ".");
+    }
+    return head[3];
+}
+
+// serialize the header (without checksum) into bytes
+std::vector<char> packHeader(const WeightShape &shape)
+{
+    if (shape.ninput < 1 || shape.getNLayer() < 1 || shape.getNLayer() > static_cast<int>(binary_weights_max_nlayer)
+        || shape.actf_ids.size() != shape.nunits.size()) {
+        throw std::invalid_argument("[BinaryWeights] Invalid weight shape.");
+    }
+    std::vector<char> header(headerSize(shape.getNLayer()), '\0');
+    char * p = header.data();
+    const auto put = [&p](const void * src, size_t n) {
+        std::memcpy(p, src, n);
+        p += n;
+    };
+    const uint32_t head[4] = {binary_weights_version, bw_endian_marker, static_cast<uint32_t>(shape.ninput), static_cast<uint32_t>(shape.getNLayer())};
+    put(bw_magic, 8);
+    put(head, sizeof(head));
+    for (int i = 0; i < shape.getNLayer(); ++i) {
+        if (shape.nunits[i] < 1 || shape.actf_ids[i].empty() || shape.actf_ids[i].size() >= bw_actf_id_len) {
+            throw std::invalid_argument("[BinaryWeights] Invalid layer shape or activation function id.");
+        }
+        const auto nu = static_cast<uint32_t>(shape.nunits[i]);
+        put(&nu, sizeof(nu));
+        char id[bw_actf_id_len] = {};
+        std::copy(shape.actf_ids[i].begin(), shape.actf_ids[i].end(), id);
+        put(id, bw_actf_id_len);
+    }
+    const auto nbeta = static_cast<uint64_t>(shape.getNBeta());
+    put(&nbeta, sizeof(nbeta));
+    return header;
+}
+
+// parse the header from bytes (of at least nbytes), returns the header size or throws
+size_t unpackHeader(const char * data, size_t nbytes, WeightShape &shape)
+{
+    const int nlayer = static_cast<int>(checkFixedHeader(data, nbytes));
+    const size_t hsize = headerSize(nlayer);
+    if (nbytes < hsize) {
+        throw std::invalid_argument("[BinaryWeights] Binary weight file is truncated.");
+    }
+    uint32_t ninput;
+    std::memcpy(&ninput, data + 8 + 2*sizeof(uint32_t), sizeof(ninput));
+    if (ninput < 1 || ninput > INT_MAX) {
+        throw std::invalid_argument("[BinaryWeights] Invalid number of inputs.");
+    }
+    shape.ninput = static_cast<int>(ninput);
+    shape.nunits.resize(nlayer);
+    shape.actf_ids.resize(nlayer);
+    const char * p = data + 8 + 4*sizeof(uint32_t);
+    for (int i = 0; i < nlayer; ++i) {
+        uint32_t nu;
+        std::memcpy(&nu, p, sizeof(nu));
+        p += sizeof(nu);
+        if (nu < 1 || nu > INT_MAX) {
+            throw std::invalid_argument("[BinaryWeights] Invalid number of units.");
+        }
+        shape.nunits[i] = static_cast<int>(nu);
+        shape.actf_ids[i] = std::string(p, strnlen(p, bw_actf_id_len));
+        p += bw_actf_id_len;
+    }
+    uint64_t nbeta;
+    std::memcpy(&nbeta, p, sizeof(nbeta));
+    if (nbeta != static_cast<uint64_t>(shape.getNBeta())) { // getNBeta throws on overflow
+        throw std::invalid_argument("[BinaryWeights] Stored number of weights doesn't match the stored shape.");
+    }
+    return hsize;
+}
+
+uint64_t computeChecksum(const char * header, size_t hsize, const double betas[], int nbeta)
+{
+    return fnv1aHash(betas, nbeta*sizeof(double), fnv1aHash(header, hsize));
+}
+} // namespace
+
+
+// --- WeightShape
+
+int WeightShape::getNBeta() const
+{
+    size_t nbeta = 0;
+    size_t nin = ninput;
+    for (const int nu : nunits) {
+        nbeta += (nin + 1)*static_cast<size_t>(nu); // no size_t overflow for int sizes (term < 2^62)
+        if (nbeta > INT_MAX) {
+            throw std::invalid_argument("[WeightShape::getNBeta] Number of weights exceeds INT_MAX.");
+        }
+        nin = nu;
+    }
+    return static_cast<int>(nbeta);
+}
+
+
+// --- Read/Write
+
+uint64_t fnv1aHash(const void * data, const size_t nbytes, uint64_t hash)
+{
+    const auto * bytes = static_cast<const unsigned char *>(data);
+    for (size_t i = 0; i < nbytes; ++i) {
+        hash ^= bytes[i];
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+void writeBinaryWeights(std::ostream &os, const WeightShape &shape, const double betas[])
+{
+    const std::vector<char> header = packHeader(shape);
+    const int nbeta = shape.getNBeta();
+    const uint64_t checksum = computeChecksum(header.data(), header.size(), betas, nbeta);
+    os.write(header.data(), header.size());
+    os.write(reinterpret_cast<const char *>(&checksum), sizeof(checksum));
+    os.write(reinterpret_cast<const char *>(betas), nbeta*sizeof(double));
+    if (!os) {
+        throw std::runtime_error("[writeBinaryWeights] Writing to stream failed.");
+    }
+}
+
+WeightShape readBinaryWeights(std::istream &is, std::vector<double> &betas)
+{
+    // read and check the fixed part first, to know the (bounded) full header size
+    std::vector<char> header(headerSize(0));
+    is.read(header.data(), header.size());
+    const size_t nfixed = header.size();
+    const uint32_t nlayer = checkFixedHeader(header.data(), static_cast<size_t>(is.gcount()));
+    header.resize(headerSize(static_cast<int>(nlayer)));
+    is.read(header.data() + nfixed, header.size() - nfixed);
+    if (!is) {
+        throw std::invalid_argument("[readBinaryWeights] Binary weight stream is truncated.");
+    }
+
+    WeightShape shape;
+    unpackHeader(header.data(), header.size(), shape);
+    uint64_t checksum;
+    is.read(reinterpret_cast<char *>(&checksum), sizeof(checksum));
+    betas.resize(shape.getNBeta());
+    is.read(reinterpret_cast<char *>(betas.data()), betas.size()*sizeof(double));
+    if (!is) {
+        throw std::invalid_argument("[readBinaryWeights] Binary weight stream is truncated.");
+    }
+    if (checksum != computeChecksum(header.data(), header.size(), betas.data(), shape.getNBeta())) {
+        throw std::invalid_argument("[readBinaryWeights] Checksum mismatch.");
+    }
+    return shape;
+}
+
+void storeBinaryWeights(const std::string &filename, const WeightShape &shape, const double betas[])
+{
+    std::ofstream file(filename, std::ios::binary);
+    if (!file.is_open()) {
+        throw std::runtime_error("[storeBinaryWeights] Could not open file " + filename);
+    }
+    writeBinaryWeights(file, shape, betas);
+}
+
+
+// --- MappedBinaryWeights
+
+MappedBinaryWeights::MappedBinaryWeights(const std::string &filename)
+{
+    const int fd = open(filename.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw std::runtime_error("[MappedBinaryWeights] Could not open file " + filename);
+    }
+    struct stat st{};
+    if (fstat(fd, &st) != 0 || st.st_size <= 0) {
+        close(fd);
+        throw std::runtime_error("[MappedBinaryWeights] Could not stat file " + filename);
+    }
+    _size = static_cast<size_t>(st.st_size);
+    _map = mmap(nullptr, _size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd); // the mapping stays valid
+    if (_map == MAP_FAILED) {
+        _map = nullptr;
+        throw std::runtime_error("[MappedBinaryWeights] Could not map file " + filename);
+    }
+
+    try {
+        const char * const data = static_cast<const char *>(_map);
+        const size_t hsize = unpackHeader(data, _size, _shape);
+        if (_size != hsize + sizeof(uint64_t) + _shape.getNBeta()*sizeof(double)) {
+            throw std::invalid_argument("[MappedBinaryWeights] File size doesn't match the stored shape.");
+        }
+        uint64_t checksum;
+        std::memcpy(&checksum, data + hsize, sizeof(checksum));
+        _betas = reinterpret_cast<const double *>(data + hsize + sizeof(uint64_t)); // 8 byte aligned in the page aligned mapping
+        if (checksum != computeChecksum(data, hsize, _betas, _shape.getNBeta())) {
+            throw std::invalid_argument("[MappedBinaryWeights] Checksum mismatch.");
+        }
+    }
+    catch (...) {
+        munmap(_map, _size);
+        throw;
+    }
+}
+
+MappedBinaryWeights::~MappedBinaryWeights()
+{
+    if (_map != nullptr) { munmap(_map, _size); }
+}
+} // templ
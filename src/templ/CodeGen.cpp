@@ -0,0 +1,152 @@
+#include "qnets/templ/CodeGen.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <limits>
+#include <set>
+#include <sstream>
+#include <stdexcept>
+
+namespace templ
+{
+std::string actfTypeName(const DynACTF actf)
+{
+    switch (actf) {
+    case DynACTF::NoOp:
+        return "actf::NoOp";
+    case DynACTF::Sigmoid:
+        return "actf::Sigmoid";
+    case DynACTF::TanSig:
+        return "actf::TanSig";
+    case DynACTF::Sine:
+        return "actf::Sine";
+    case DynACTF::ReLU:
+        return "actf::ReLU";
+    case DynACTF::SRLU:
+        return "actf::SRLU";
+    case DynACTF::Exp:
+        return "actf::Exp";
+    }
+    throw std::invalid_argument("[actfTypeName] Unknown DynACTF.");
+}
+
+std::string actfHeaderName(const DynACTF actf)
+{
+    const std::string type_name = actfTypeName(actf);
+    return "qnets/actf/" + type_name.substr(type_name.find("::") + 2) + ".hpp";
+}
+
+std::string derivConfigName(const DerivConfig dconf)
+{
+    switch (dconf) {
+    case DerivConfig::OFF:
+        return "templ::DerivConfig::OFF";
+    case DerivConfig::D1:
+        return "templ::DerivConfig::D1";
+    case DerivConfig::D12:
+        return "templ::DerivConfig::D12";
+    case DerivConfig::VD1:
+        return "templ::DerivConfig::VD1";
+    case DerivConfig::VD12:
+        return "templ::DerivConfig::VD12";
+    case DerivConfig::D1_VD1:
+        return "templ::DerivConfig::D1_VD1";
+    case DerivConfig::D1_VD12:
+        return "templ::DerivConfig::D1_VD12";
+    case DerivConfig::D12_VD1:
+        return "templ::DerivConfig::D12_VD1";
+    case DerivConfig::D12_VD12:
+        return "templ::DerivConfig::D12_VD12";
+    }
+    throw std::invalid_argument("[derivConfigName] Unknown DerivConfig.");
+}
+
+namespace
+{
+bool isIdentifier(const std::string &name)
+{
+    if (name.empty() || std::isdigit(static_cast<unsigned char>(name[0])) != 0) { return false; }
+    return std::all_of(name.begin(), name.end(), [](char c) { return std::isalnum(static_cast<unsigned char>(c)) != 0 || c == '_'; });
+}
+
+void writeArray(std::ostream &os, const std::string &name, const std::string &size, const double * const values, const int n, const int nperline)
+{
+    os << "constexpr std::array<double, " << size << "> " << name << "{{";
+    for (int i = 0; i < n; ++i) {
+        os << (i % nperline == 0 ? "\n        " : " ") << values[i] + 0. << (i < n - 1 ? "," : ""); // + 0. prints -0 as 0
+    }
+    os << "\n}};\n";
+}
+} // namespace
+
+void writeTemplNetHeader(std::ostream &os, const DynNet &dnet, const std::string &net_name, const DerivConfig dconf)
+{
+    if (!isIdentifier(net_name)) {
+        throw std::invalid_argument("[writeTemplNetHeader] net_name \"" + net_name + "\" is not a valid C++ identifier.");
+    }
+
+    // fold shift/scale into a copy of the net
+    DynNet fnet(dnet);
+    fnet.foldInputShiftScale();
+    const bool output_folded = fnet.foldOutputShiftScale();
+
+    std::string guard = "QNETS_GENERATED_" + net_name + "_HPP";
+    std::transform(guard.begin(), guard.end(), guard.begin(), [](char c) { return static_cast<char>(std::toupper(static_cast<unsigned char>(c))); });
+
+    const auto flags = os.flags();
+    const auto precision = os.precision();
+    os.precision(std::numeric_limits<double>::max_digits10); // exact round trip
+
+    // header and includes
+    os << "// Generated by templ::writeTemplNetHeader (qnets/templ/CodeGen.hpp), do not edit.\n";
+    os << "#ifndef " << guard << "\n#define " << guard << "\n\n";
+    os << "#include \"qnets/templ/TemplNet.hpp\"\n";
+    std::set<std::string> headers;
+    for (int i = 0; i < fnet.getNLayer(); ++i) { headers.insert(actfHeaderName(fnet.getACTF(i))); }
+    for (const auto &header : headers) { os << "#include \"" << header << "\"\n"; }
+    os << "\n#include <array>\n\n";
+
+    // network type
+    os << "namespace " << net_name << "\n{\n";
+    os << "using Net = templ::TemplNet<double, " << derivConfigName(dconf) << ", " << fnet.getNInput() << ", " << fnet.getNInput();
+    for (int i = 0; i < fnet.getNLayer(); ++i) {
+        os << ",\n                              templ::LayerConfig<" << fnet.getNUnit(i) << ", " << actfTypeName(fnet.getACTF(i)) << ">";
+    }
+    os << ">;\n\n";
+
+    // weights
+    os << "// weights (input shift/scale folded into the first layer" << (output_folded ? ", output shift/scale into the last layer)\n" : ")\n");
+    writeArray(os, "betas", "Net::nbeta", fnet.getBetas().data(), fnet.getNBeta(), 4);
+    os << "\n";
+
+    // output shift/scale
+    std::vector<double> out_shift(fnet.getNOutput()), out_scale(fnet.getNOutput());
+    for (int i = 0; i < fnet.getNOutput(); ++i) {
+        out_shift[i] = fnet.getOutputShift(i);
+        out_scale[i] = fnet.getOutputScale(i);
+    }
+    os << "// output shift/scale: final output y_i = (net.getOutput(i) + output_shift[i])*output_scale[i]\n";
+    os << "constexpr bool output_folded = " << (output_folded ? "true" : "false") << "; // if true, shift/scale are identity\n";
+    writeArray(os, "output_shift", "Net::noutput", out_shift.data(), fnet.getNOutput(), 4);
+    writeArray(os, "output_scale", "Net::noutput", out_scale.data(), fnet.getNOutput(), 4);
+    os << "\n";
+
+    // helpers
+    os << "// copy the stored weights into the net (at runtime, the net owns its weights)\n";
+    os << "inline void initNet(Net &net) { net.setBetas(betas.begin(), betas.end()); }\n\n";
+    os << "// get the final output, from a Net (default state) or Net::State\n";
+    os << "template <class NetOrState>\n";
+    os << "inline double getOutput(const NetOrState &net, int i)\n{\n";
+    os << "    return output_folded ? net.getOutput(i) : (net.getOutput(i) + output_shift[i])*output_scale[i];\n}\n\n";
+    os << "// get the derivatives of the final output (scaled like the output, if enabled in Net's DerivConfig)\n";
+    for (const std::string deriv : {"D1", "D2", "VD1"}) {
+        os << (deriv != "D1" ? "\n" : "") << "template <class NetOrState>\n";
+        os << "inline double get" << deriv << "(const NetOrState &net, int i, int j)\n{\n";
+        os << "    return output_folded ? net.get" << deriv << "(i, j) : net.get" << deriv << "(i, j)*output_scale[i];\n}\n";
+    }
+    os << "} // " << net_name << "\n\n#endif\n";
+
+    os.flags(flags);
+    os.precision(precision);
+}
+} // templ
@@ -0,0 +1,289 @@
+#include "qnets/templ/DynNet.hpp"
+#include "qnets/poly/serial/StringCodeUtilities.hpp"
+
+#include <fstream>
+#include <numeric>
+#include <stdexcept>
+
+namespace templ
+{
+// --- Setup
+
+void DynNet::_setupShape(const int ninput, const std::vector<int> &nunits, const std::vector<DynACTF> &actfs, const DerivConfig dconf)
+{
+    if (ninput < 1) {
+        throw std::invalid_argument("[DynNet] ninput must be at least 1.");
+    }
+    if (nunits.size() < 2) {
+        throw std::invalid_argument("[DynNet] nlayer <= 1");
+    }
+    if (actfs.size() != nunits.size()) {
+        throw std::invalid_argument("[DynNet] actfs and nunits must be of same size.");
+    }
+    for (const int nu : nunits) {
+        if (nu < 1) {
+            throw std::invalid_argument("[DynNet] nunits contains empty Layer.");
+        }
+    }
+
+    _ninput = ninput;
+    _nunits = nunits;
+    _actfs = actfs;
+    _dconf = DynamicDFlags(dconf);
+
+    _beta_offsets.resize(_nunits.size());
+    _nbeta = 0;
+    for (int i = 0; i < getNLayer(); ++i) {
+        _beta_offsets[i] = _nbeta;
+        _nbeta += getNBeta(i);
+    }
+    _beta.assign(_nbeta, 0.);
+
+    _in_shift.assign(_ninput, 0.);
+    _in_scale.assign(_ninput, 1.);
+    _out_shift.assign(getNOutput(), 0.);
+    _out_scale.assign(getNOutput(), 1.);
+}
+
+DynNet::DynNet(const int ninput, const std::vector<int> &nunits, const std::vector<DynACTF> &actfs, const DerivConfig dconf): dflags(dconf)
+{
+    this->_setupShape(ninput, nunits, actfs, dconf);
+    _state = std::make_unique<State>(*this);
+}
+
+DynNet::DynNet(const std::string &filename, const DerivConfig dconf): dflags(dconf)
+{
+    this->_loadPolyFile(filename, dconf);
+    _state = std::make_unique<State>(*this);
+}
+
+DynNet::DynNet(const DynNet &other):
+        _ninput(other._ninput), _nunits(other._nunits), _actfs(other._actfs), _beta_offsets(other._beta_offsets), _nbeta(other._nbeta), _dconf(other._dconf),
+        _beta(other._beta), _in_shift(other._in_shift), _in_scale(other._in_scale), _out_shift(other._out_shift), _out_scale(other._out_scale),
+        dflags(other.dflags)
+{
+    _state = std::make_unique<State>(*this);
+}
+
+int DynNet::getNUnit() const
+{
+    return std::accumulate(_nunits.begin(), _nunits.end(), 0);
+}
+
+
+// --- Fold shift/scale into weights
+
+void DynNet::foldInputShiftScale()
+{
+    // b_i0 + sum_j b_ij*(x_j + shift_j)*scale_j == (b_i0 + sum_j b_ij*scale_j*shift_j) + sum_j (b_ij*scale_j)*x_j
+    double * const beta = _beta.data() + _beta_offsets[0];
+    for (int i = 0; i < _nunits[0]; ++i) {
+        double * const beta_i = beta + i*(_ninput + 1);
+        for (int j = 0; j < _ninput; ++j) {
+            beta_i[j + 1] *= _in_scale[j];
+            beta_i[0] += beta_i[j + 1]*_in_shift[j];
+        }
+    }
+    _in_shift.assign(_ninput, 0.);
+    _in_scale.assign(_ninput, 1.);
+}
+
+bool DynNet::foldOutputShiftScale()
+{
+    if (_actfs.back() != DynACTF::NoOp) {
+        return false;
+    }
+    // (b_i0 + sum_j b_ij*x_j + shift_i)*scale_i == (b_i0 + shift_i)*scale_i + sum_j (b_ij*scale_i)*x_j
+    const int nlayer = getNLayer();
+    const int nin = _nunits[nlayer - 2];
+    double * const beta = _beta.data() + _beta_offsets[nlayer - 1];
+    for (int i = 0; i < getNOutput(); ++i) {
+        double * const beta_i = beta + i*(nin + 1);
+        beta_i[0] = (beta_i[0] + _out_shift[i])*_out_scale[i];
+        for (int j = 1; j <= nin; ++j) {
+            beta_i[j] *= _out_scale[i];
+        }
+    }
+    _out_shift.assign(getNOutput(), 0.);
+    _out_scale.assign(getNOutput(), 1.);
+    return true;
+}
+
+
+// --- Load from poly file
+
+void DynNet::_loadPolyFile(const std::string &filename, const DerivConfig dconf)
+{
+    // NOTE: This reads the format written by FeedForwardNeuralNetwork::storeOnFile, which
+    // consists of the number of layers, the treeCode of every layer (one per line) and flags.
+    // Offset units (OFF) are contained in the stored nunits, but not in DynNet's nunits.
+    std::ifstream file(filename);
+    if (!file.is_open()) {
+        throw std::runtime_error("[DynNet] Could not open file " + filename);
+    }
+
+    int nlayers = 0;
+    file >> nlayers;
+    std::vector<std::string> layerCodes;
+    std::string line;
+    while (static_cast<int>(layerCodes.size()) < nlayers && std::getline(file, line)) {
+        if (!line.empty()) {
+            layerCodes.push_back(line);
+        }
+    }
+    if (static_cast<int>(layerCodes.size()) != nlayers) {
+        throw std::invalid_argument("[DynNet] Stored FFNN file declares to have more layers than it has layer codes.");
+    }
+    bool connected = false;
+    file >> connected;
+    if (!connected) {
+        throw std::invalid_argument("[DynNet] Stored FFNN is not connected.");
+    }
+    if (nlayers < 3 || readIdCode(layerCodes[0]) != "INL" || readIdCode(layerCodes[nlayers - 1]) != "OUTL") {
+        throw std::invalid_argument("[DynNet] Stored FFNN must consist of INL, NNL and OUTL layers.");
+    }
+
+    // read the shape and actfs
+    const auto readNUnits = [](const std::string &layerCode) {
+        int nunits = 0;
+        setParamValue(readParams(layerCode), "nunits", nunits);
+        return nunits - 1; // without offset unit
+    };
+    const auto unitCode = [](const std::string &layerCode, int iu) { // treeCode of unit iu (without offset)
+        return readTreeCode(readMemberTreeCode(layerCode), iu + 1);
+    };
+    const auto actfId = [](const std::string &unitCode) { // actf id of NNU/OUT unit code
+        return readIdCode(readTreeCode(readMemberTreeCode(unitCode), 1));
+    };
+
+    const int ninput = readNUnits(layerCodes[0]);
+    std::vector<int> nunits;
+    std::vector<DynACTF> actfs;
+    for (int il = 1; il < nlayers; ++il) {
+        const std::string id = readIdCode(layerCodes[il]);
+        if (id != "NNL" && id != "OUTL") {
+            throw std::invalid_argument("[DynNet] Layer type " + id + " is not supported (e.g. feature maps).");
+        }
+        nunits.push_back(readNUnits(layerCodes[il]));
+        const std::string actf_id = actfId(unitCode(layerCodes[il], 0));
+        for (int iu = 1; iu < nunits.back(); ++iu) {
+            if (actfId(unitCode(layerCodes[il], iu)) != actf_id) {
+                throw std::invalid_argument("[DynNet] All units of a layer must use the same activation function.");
+            }
+        }
+        actfs.push_back(dynACTFFromPolyId(actf_id));
+    }
+    this->_setupShape(ninput, nunits, actfs, dconf);
+
+    // NOTE: The shift/scale of poly InputUnits (IN) is stored, but not applied in the poly
+    // propagation (InputUnit::computeValues), so we keep the input shift/scale at identity.
+
+    // weights (RAY feeders, b0 is the offset weight) and output shift/scale
+    for (int il = 1; il < nlayers; ++il) {
+        const int nin = il == 1 ? _ninput : _nunits[il - 2];
+        double * const beta_layer = _beta.data() + _beta_offsets[il - 1];
+        for (int iu = 0; iu < _nunits[il - 1]; ++iu) {
+            const std::string ucode = unitCode(layerCodes[il], iu);
+            const std::string feeder = readTreeCode(readMemberTreeCode(ucode), 0);
+            if (readIdCode(feeder) != "RAY") {
+                throw std::invalid_argument("[DynNet] Only RAY feeders are supported.");
+            }
+            const std::string params = readParams(feeder);
+            for (int ib = 0; ib <= nin; ++ib) {
+                setParamValue(params, "b" + std::to_string(ib), beta_layer[iu*(nin + 1) + ib]);
+            }
+            if (il == nlayers - 1) {
+                setParamValue(readParams(ucode), "shift", _out_shift[iu]);
+                setParamValue(readParams(ucode), "scale", _out_scale[iu]);
+            }
+        }
+    }
+}
+
+
+// --- Propagation
+
+void DynNet::Propagate(State &state, const double input[]) const
+{
+    if (!state.isCompatible(*this)) {
+        throw std::invalid_argument("[DynNet::Propagate] The state was created for a net of different shape.");
+    }
+    const int nlayer = getNLayer();
+    const int noutput = getNOutput();
+    const DynamicDFlags dflags = state.dflags;
+    auto &layers = state._layers;
+
+    // input shift/scale
+    for (int i = 0; i < _ninput; ++i) {
+        state._input[i] = (input[i] + _in_shift[i])*_in_scale[i];
+    }
+
+    // fwd prop
+    layers[0].ForwardInput(state._input.data(), _beta.data(), dflags);
+    for (int i = 1; i < nlayer; ++i) {
+        const auto &prev_layer = layers[i - 1];
+        layers[i].ForwardLayer(prev_layer.out().data(), prev_layer.d1().data(), prev_layer.d2().data(), _beta.data() + _beta_offsets[i], dflags);
+    }
+
+    // backprop
+    layers[nlayer - 1].BackwardOutput(dflags);
+    for (int i = nlayer - 2; i >= 0; --i) {
+        const auto &next_layer = layers[i + 1];
+        layers[i].BackwardLayer(next_layer.bd1().data(), next_layer.bd2().data(), _beta.data() + _beta_offsets[i + 1], _nunits[i + 1], dflags);
+    }
+
+    // store backprop grads into vd1/vd2
+    if (state.hasVD1() || state.hasVD2()) {
+        for (int i = 0; i < nlayer; ++i) {
+            const double * const layer_input = i == 0 ? state._input.data() : layers[i - 1].out().data();
+            for (int j = 0; j < noutput; ++j) {
+                layers[i].storeLayerVD1(layer_input, state._vd1.data() + j*_nbeta + _beta_offsets[i], j, dflags);
+                layers[i].storeLayerVD2(layer_input, state._vd2.data() + j*_nbeta + _beta_offsets[i], j, dflags);
+            }
+        }
+    }
+
+    // store input grads into d1/d2
+    if (state.hasD1()) {
+        if (state.hasD2()) { // we used forward accumulation
+            state._d1 = layers[nlayer - 1].d1();
+            state._d2 = layers[nlayer - 1].d2();
+        }
+        else { // compute input derivative from backprop derivatives
+            layers[0].storeInputD1(state._d1.data(), _beta.data(), dflags);
+        }
+
+        // chain input scale
+        for (int i = 0; i < noutput; ++i) {
+            for (int j = 0; j < _ninput; ++j) {
+                state._d1[i*_ninput + j] *= _in_scale[j];
+                if (state.hasD2()) { state._d2[i*_ninput + j] *= _in_scale[j]*_in_scale[j]; }
+            }
+        }
+    }
+
+    // output shift/scale
+    const auto &out = layers[nlayer - 1].out();
+    for (int i = 0; i < noutput; ++i) {
+        state._output[i] = (out[i] + _out_shift[i])*_out_scale[i];
+        if (state.hasD1()) {
+            for (int j = 0; j < _ninput; ++j) { state._d1[i*_ninput + j] *= _out_scale[i]; }
+        }
+        if (state.hasD2()) {
+            for (int j = 0; j < _ninput; ++j) { state._d2[i*_ninput + j] *= _out_scale[i]; }
+        }
+        if (state.hasVD1()) {
+            for (int j = 0; j < _nbeta; ++j) { state._vd1[i*_nbeta + j] *= _out_scale[i]; }
+        }
+        if (state.hasVD2()) {
+            for (int j = 0; j < _nbeta; ++j) { state._vd2[i*_nbeta + j] *= _out_scale[i]; }
+        }
+    }
+}
+
+void DynNet::Propagate(const double input[])
+{
+    _state->dflags = dflags;
+    this->Propagate(*_state, input);
+}
+} // templ
@@ -7,6 +7,7 @@
 #include "qnets/actf/Sine.hpp"
 
 #include <vector>
+#include <algorithm>
 #include <cassert>
 
 template <class ACTF>
@@ -67,6 +68,24 @@ void checkACTFDerivatives(const std::vector<double> &x_to_test, double dx, doubl
     // std::cout << std::endl;
 }
 
+template <class ACTF>
+void checkACTFFloat(const std::vector<double> &x_to_test, float TINY)
+{   // check that the float versions agree with the double ones
+    ACTF actf;
+    const size_t ntest = x_to_test.size();
+    std::vector<double> fv(x_to_test), d1v(ntest), d2v(ntest);
+    std::vector<float> fv_f(x_to_test.begin(), x_to_test.end()), d1v_f(ntest), d2v_f(ntest);
+
+    actf.fd12(fv.data(), fv.data()+ntest, d1v.data(), d2v.data());
+    actf.fd12(fv_f.data(), fv_f.data()+ntest, d1v_f.data(), d2v_f.data());
+    for (size_t i = 0; i < ntest; ++i) {
+        const double scale = std::max(1., fabs(fv[i])); // relative for large values
+        assert(fabs(fv_f[i] - fv[i]) < TINY*scale);
+        assert(fabs(d1v_f[i] - d1v[i]) < TINY*std::max(1., fabs(d1v[i])));
+        assert(fabs(d2v_f[i] - d2v[i]) < TINY*std::max(1., fabs(d2v[i])));
+    }
+}
+
 int main()
 {
     using namespace std;
@@ -84,5 +103,15 @@ int main()
     checkACTFDerivatives<Exp>(x_to_test, dx, 0.001); // hard to get better accuracy on exp
     checkACTFDerivatives<Sine>(x_to_test, dx, TINY_DEFAULT);
 
+    // float versions
+    const float TINY_FLOAT = 0.00001f;
+    checkACTFFloat<NoOp>(x_to_test, TINY_FLOAT);
+    checkACTFFloat<ReLU>(x_to_test, TINY_FLOAT);
+    checkACTFFloat<SRLU>(x_to_test, TINY_FLOAT);
+    checkACTFFloat<Sigmoid>(x_to_test, TINY_FLOAT);
+    checkACTFFloat<TanSig>(x_to_test, TINY_FLOAT);
+    checkACTFFloat<Exp>(x_to_test, TINY_FLOAT);
+    checkACTFFloat<Sine>(x_to_test, TINY_FLOAT);
+
     return 0;
 }
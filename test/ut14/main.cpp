@@ -0,0 +1,121 @@
+#include <iostream>
+#include <random>
+#include <cassert>
+#include <memory>
+#include <vector>
+
+#include "qnets/templ/TemplNet.hpp"
+#include "qnets/actf/Sigmoid.hpp"
+#include "qnets/actf/SRLU.hpp"
+#include "qnets/actf/Exp.hpp"
+
+template <class StateT1, class StateT2>
+void checkStateIdentity(const StateT1 &s1, const StateT2 &s2)
+{
+    assert(s1.getOutput() == s2.getOutput());
+    assert(s1.getD1() == s2.getD1());
+    assert(s1.getD2() == s2.getD2());
+    assert(s1.getVD1() == s2.getVD1());
+    assert(s1.getVD2() == s2.getVD2());
+}
+
+int main()
+{
+    using namespace std;
+    using namespace templ;
+
+    // Setup TemplNet
+    const int NU_IN = 4;
+    using layer1 = LayerConfig<7, actf::Sigmoid>;
+    using layer2 = LayerConfig<5, actf::SRLU>;
+    using layer3 = LayerConfig<2, actf::Exp>;
+    const auto dopt = DerivConfig::D12_VD12;
+    using TestNet = TemplNet<double, dopt, NU_IN, NU_IN, layer1, layer2, layer3>;
+    using State = TestNet::State;
+
+    static_assert(State::nbeta == TestNet::nbeta, "");
+    static_assert(State::nvd1 == TestNet::nvd1, "");
+
+    auto tmpl_ptr = std::make_unique<TestNet>();
+    auto &tmpl = *tmpl_ptr;
+
+    // random generator with fixed seed for generating the beta, in order to eliminate randomness of results in the unittest
+    mt19937_64 rgen;
+    rgen.seed(1337);
+    uniform_real_distribution<double> rd(-0.5, 0.5);
+    for (int i = 0; i < tmpl.getNBeta(); ++i) {
+        tmpl.setBeta(i, rd(rgen));
+    }
+
+    // weights are stored contiguously
+    for (int i = 0; i < tmpl.getNBeta(); ++i) {
+        assert(tmpl.getBetas()[i] == tmpl.getBeta(i));
+    }
+
+    // some inputs
+    const int ndata = 64;
+    vector<double> xdata(ndata*NU_IN);
+    for (auto &x : xdata) { x = rd(rgen); }
+
+    // propagate through an external state, via a const reference to the net
+    const TestNet &ctmpl = tmpl;
+    auto state1_ptr = std::make_unique<State>();
+    auto state2_ptr = std::make_unique<State>();
+    auto &state1 = *state1_ptr;
+    auto &state2 = *state2_ptr;
+
+    tmpl.Propagate(xdata.data()); // default state
+    ctmpl.Propagate(state1, xdata.data());
+    checkStateIdentity(tmpl.getState(), state1);
+
+    // a second state must not interfere with the first one
+    ctmpl.Propagate(state2, xdata.data() + NU_IN);
+    checkStateIdentity(tmpl.getState(), state1);
+    tmpl.Propagate(xdata.data() + NU_IN);
+    checkStateIdentity(tmpl.getState(), state2);
+
+    // per-state dflags
+    state2.dflags.set(DerivConfig::OFF);
+    assert(!state2.hasD1() && !state2.hasVD1());
+    assert(tmpl.hasD1() && tmpl.hasVD1());
+    ctmpl.Propagate(state2, xdata.data());
+    assert(state2.getOutput() == state1.getOutput());
+
+    // copied nets share the same weights, but not the state
+    TestNet tmpl_copy(tmpl);
+    for (int i = 0; i < tmpl.getNBeta(); ++i) {
+        assert(tmpl_copy.getBeta(i) == tmpl.getBeta(i));
+    }
+    tmpl_copy.Propagate(xdata.data());
+    checkStateIdentity(tmpl_copy.getState(), state1);
+
+
+    // serial reference results
+    vector<double> out_ref(ndata*TestNet::noutput), vd1_ref(ndata*TestNet::nvd1);
+    for (int i = 0; i < ndata; ++i) {
+        tmpl.Propagate(xdata.data() + i*NU_IN);
+        std::copy(tmpl.getOutput().begin(), tmpl.getOutput().end(), out_ref.begin() + i*TestNet::noutput);
+        std::copy(tmpl.getVD1().begin(), tmpl.getVD1().end(), vd1_ref.begin() + i*TestNet::nvd1);
+    }
+
+    // every thread uses its own state, but all share the same net
+    vector<double> out_par(ndata*TestNet::noutput), vd1_par(ndata*TestNet::nvd1);
+#ifdef OPENMP
+#pragma omp parallel
+#endif
+    {
+        auto my_state = std::make_unique<State>();
+#ifdef OPENMP
+#pragma omp for schedule(static, 1)
+#endif
+        for (int i = 0; i < ndata; ++i) {
+            ctmpl.Propagate(*my_state, xdata.data() + i*NU_IN);
+            std::copy(my_state->getOutput().begin(), my_state->getOutput().end(), out_par.begin() + i*TestNet::noutput);
+            std::copy(my_state->getVD1().begin(), my_state->getVD1().end(), vd1_par.begin() + i*TestNet::nvd1);
+        }
+    }
+    assert(out_par == out_ref);
+    assert(vd1_par == vd1_ref);
+
+    return 0;
+}
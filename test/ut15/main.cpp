@@ -0,0 +1,96 @@
+#include <iostream>
+#include <random>
+#include <cassert>
+#include <memory>
+#include <vector>
+#include <algorithm>
+
+#include "qnets/templ/TemplNet.hpp"
+#include "qnets/actf/Sigmoid.hpp"
+#include "qnets/actf/SRLU.hpp"
+#include "qnets/actf/TanSig.hpp"
+
+template <class RefNet, class TestNet>
+double maxDeviation(const RefNet &ref, const TestNet &test)
+{   // maximal absolute deviation over all (enabled) result arrays
+    double maxdev = 0.;
+    for (int i = 0; i < RefNet::noutput; ++i) {
+        maxdev = std::max(maxdev, fabs(ref.getOutput(i) - test.getOutput(i)));
+        for (int j = 0; j < RefNet::orig_ninput; ++j) {
+            maxdev = std::max(maxdev, fabs(ref.getD1(i, j) - test.getD1(i, j)));
+            maxdev = std::max(maxdev, fabs(ref.getD2(i, j) - test.getD2(i, j)));
+        }
+        for (int j = 0; j < RefNet::nbeta; ++j) {
+            maxdev = std::max(maxdev, fabs(ref.getVD1(i, j) - test.getVD1(i, j)));
+        }
+    }
+    return maxdev;
+}
+
+int main()
+{
+    using namespace std;
+    using namespace templ;
+
+    const double TINY_FLOAT = 1.e-5;
+
+    // Setup TemplNets of different precision
+    const int NU_IN = 4;
+    using layer1 = LayerConfig<12, actf::Sigmoid>;
+    using layer2 = LayerConfig<8, actf::TanSig>;
+    using layer3 = LayerConfig<2, actf::SRLU>;
+    const auto dopt = DerivConfig::D12_VD1;
+    using DoubleNet = TemplNet<double, dopt, NU_IN, NU_IN, layer1, layer2, layer3>;
+    using FloatNet = TemplNet<float, dopt, NU_IN, NU_IN, layer1, layer2, layer3>;
+    using MixedNet = TemplNet<MixedPrec<float, double>, dopt, NU_IN, NU_IN, layer1, layer2, layer3>;
+
+    static_assert(std::is_same<FloatNet::ValueT, float>::value, "");
+    static_assert(std::is_same<FloatNet::AccuT, float>::value, "");
+    static_assert(std::is_same<MixedNet::ValueT, float>::value, "");
+    static_assert(std::is_same<MixedNet::AccuT, double>::value, "");
+    static_assert(sizeof(FloatNet::State) < sizeof(DoubleNet::State), "");
+
+    auto dnet_ptr = std::make_unique<DoubleNet>();
+    auto fnet_ptr = std::make_unique<FloatNet>();
+    auto mnet_ptr = std::make_unique<MixedNet>();
+    auto &dnet = *dnet_ptr;
+    auto &fnet = *fnet_ptr;
+    auto &mnet = *mnet_ptr;
+
+    // random generator with fixed seed for generating the beta, in order to eliminate randomness of results in the unittest
+    mt19937_64 rgen;
+    rgen.seed(1337);
+    uniform_real_distribution<float> rd(-0.5f, 0.5f);
+    for (int i = 0; i < DoubleNet::nbeta; ++i) {
+        const float beta = rd(rgen); // same (float representable) weights everywhere
+        dnet.setBeta(i, beta);
+        fnet.setBeta(i, beta);
+        mnet.setBeta(i, beta);
+    }
+
+    const int ndata = 32;
+    vector<float> xdata(ndata*NU_IN);
+    for (auto &x : xdata) { x = rd(rgen); }
+    const vector<double> xdata_d(xdata.begin(), xdata.end());
+
+    for (int i = 0; i < ndata; ++i) {
+        dnet.Propagate(xdata_d.data() + i*NU_IN);
+        fnet.Propagate(xdata.data() + i*NU_IN);
+        mnet.Propagate(xdata.data() + i*NU_IN);
+
+        const double fdev = maxDeviation(dnet, fnet);
+        const double mdev = maxDeviation(dnet, mnet);
+        //std::cout << "x_" << i << ": float dev " << fdev << " mixed dev " << mdev << std::endl;
+        assert(fdev < TINY_FLOAT);
+        assert(mdev < TINY_FLOAT);
+    }
+
+    // the float state interface is usable from several threads, just like the double one
+    auto fstate_ptr = std::make_unique<FloatNet::State>();
+    const FloatNet &cfnet = fnet;
+    cfnet.Propagate(*fstate_ptr, xdata.data());
+    fnet.Propagate(xdata.data());
+    assert(fstate_ptr->getOutput() == fnet.getOutput());
+
+    return 0;
+}
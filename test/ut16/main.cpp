@@ -0,0 +1,146 @@
+#include <iostream>
+#include <cassert>
+#include <cmath>
+#include <limits>
+#include <vector>
+#include <algorithm>
+
+#include "qnets/tool/FastMath.hpp"
+#include "qnets/actf/FastExp.hpp"
+#include "qnets/actf/FastSigmoid.hpp"
+#include "qnets/actf/FastSRLU.hpp"
+#include "qnets/actf/FastTanSig.hpp"
+#include "qnets/actf/FastSine.hpp"
+#include "qnets/actf/Exp.hpp"
+#include "qnets/actf/Sigmoid.hpp"
+#include "qnets/actf/SRLU.hpp"
+#include "qnets/actf/TanSig.hpp"
+#include "qnets/actf/Sine.hpp"
+
+// Check the documented accuracy bounds of the fmath functions (see FastMath.hpp),
+// in units of machine epsilon, against the double precision std:: functions
+
+template <typename ValueT>
+std::vector<ValueT> makeGrid(double xmin, double xmax, int npoints)
+{
+    std::vector<ValueT> xv(npoints);
+    for (int i = 0; i < npoints; ++i) {
+        xv[i] = static_cast<ValueT>(xmin + (xmax - xmin)*i/(npoints - 1.));
+    }
+    return xv;
+}
+
+template <typename ValueT, class FastF, class RefF, class ScaleF>
+double maxError(const std::vector<ValueT> &xv, FastF fastf, RefF reff, ScaleF scalef)
+{   // max of |fast - ref|/scale, in units of eps
+    const double eps = std::numeric_limits<ValueT>::epsilon();
+    double maxerr = 0.;
+    for (const ValueT x : xv) {
+        const double ref = reff(static_cast<double>(x)); // reference at the exact (rounded) argument
+        maxerr = std::max(maxerr, fabs(static_cast<double>(fastf(x)) - ref)/scalef(ref)/eps);
+    }
+    return maxerr;
+}
+
+template <typename ValueT>
+void checkFastMath(double sincos_xmax, double exp_xmax)
+{
+    const double TINY = 4.; // accuracy bound in eps
+    const int npoints = 200001;
+    const auto rel = [](double ref) { return fabs(ref); };
+    const auto abs = [](double /*ref*/) { return 1.; };
+    const auto abs_log = [](double ref) { return 1. + fabs(ref); };
+
+    const auto xexp = makeGrid<ValueT>(-exp_xmax, exp_xmax, npoints);
+    const auto xlog = makeGrid<ValueT>(-0.999, 1000., npoints);
+    const auto xsmall = makeGrid<ValueT>(-1.e-4, 1.e-4, npoints);
+    const auto xtanh = makeGrid<ValueT>(-20., 20., npoints);
+    const auto xsin = makeGrid<ValueT>(-sincos_xmax, sincos_xmax, npoints);
+
+    const double err_exp = maxError(xexp, [](ValueT x) { return fmath::exp(x); }, [](double x) { return std::exp(x); }, rel);
+    const double err_log1p = std::max(maxError(xlog, [](ValueT x) { return fmath::log1p(x); }, [](double x) { return std::log1p(x); }, abs_log),
+                                      maxError(xsmall, [](ValueT x) { return fmath::log1p(x); }, [](double x) { return std::log1p(x); }, rel));
+    const double err_tanh = maxError(xtanh, [](ValueT x) { return fmath::tanh(x); }, [](double x) { return std::tanh(x); }, abs);
+    const double err_sin = maxError(xsin, [](ValueT x) { return fmath::sin(x); }, [](double x) { return std::sin(x); }, abs);
+    const double err_cos = maxError(xsin, [](ValueT x) { return fmath::cos(x); }, [](double x) { return std::cos(x); }, abs);
+
+    //std::cout << "exp " << err_exp << " log1p " << err_log1p << " tanh " << err_tanh << " sin " << err_sin << " cos " << err_cos << std::endl;
+    assert(err_exp < TINY);
+    assert(err_log1p < TINY);
+    assert(err_tanh < TINY);
+    assert(err_sin < TINY);
+    assert(err_cos < TINY);
+
+    // saturation of exp
+    assert(fmath::exp(static_cast<ValueT>(-1.e4)) >= 0);
+    assert(fmath::exp(static_cast<ValueT>(-1.e4)) < std::numeric_limits<ValueT>::epsilon());
+    assert(std::isfinite(fmath::exp(static_cast<ValueT>(1.e4))));
+}
+
+template <class FastACTF, class ACTF, typename ValueT>
+void checkFastACTF(const std::vector<ValueT> &xv, double TINY)
+{   // the fast actfs must agree with the exact ones (within TINY, relative to max(1, |value|))
+    FastACTF fast_actf;
+    ACTF actf;
+    const size_t ntest = xv.size();
+    std::vector<ValueT> fv(xv), d1v(ntest), d2v(ntest);
+    std::vector<ValueT> fv_fast(xv), d1v_fast(ntest), d2v_fast(ntest);
+    actf.fd12(fv.data(), fv.data() + ntest, d1v.data(), d2v.data());
+    fast_actf.fd12(fv_fast.data(), fv_fast.data() + ntest, d1v_fast.data(), d2v_fast.data());
+    for (size_t i = 0; i < ntest; ++i) {
+        assert(fabs(fv_fast[i] - fv[i]) < TINY*std::max(1., fabs(static_cast<double>(fv[i]))));
+        assert(fabs(d1v_fast[i] - d1v[i]) < TINY*std::max(1., fabs(static_cast<double>(d1v[i]))));
+        assert(fabs(d2v_fast[i] - d2v[i]) < TINY*std::max(1., fabs(static_cast<double>(d2v[i]))));
+    }
+
+    // f and fd1 must agree with fd12
+    std::vector<ValueT> fv_f(xv), fv_fd1(xv), d1v_fd1(ntest);
+    fast_actf.f(fv_f.data(), fv_f.data() + ntest);
+    fast_actf.fd1(fv_fd1.data(), fv_fd1.data() + ntest, d1v_fd1.data());
+    for (size_t i = 0; i < ntest; ++i) {
+        assert(fabs(fv_f[i] - fv_fast[i]) < TINY*std::max(1., fabs(static_cast<double>(fv_fast[i]))));
+        assert(fv_fd1[i] == fv_fast[i]);
+        assert(d1v_fd1[i] == d1v_fast[i]);
+    }
+}
+
+template <typename ValueT>
+void checkFastTanSig(const std::vector<ValueT> &xv)
+{   // value and derivatives of FastTanSig come from the same tanh approximation
+    actf::FastTanSig fast_actf;
+    const size_t ntest = xv.size();
+    const double eps = 4.*std::numeric_limits<ValueT>::epsilon(); // rounding only (e.g. contracted to FMA)
+    std::vector<ValueT> fv(xv), fv12(xv), d1v(ntest), d2v(ntest);
+    fast_actf.f(fv.data(), fv.data() + ntest);
+    fast_actf.fd12(fv12.data(), fv12.data() + ntest, d1v.data(), d2v.data());
+    for (size_t i = 0; i < ntest; ++i) {
+        const double t = fv[i];
+        assert(fv12[i] == fv[i]);
+        assert(fabs(d1v[i] - (1. - t*t)) < eps);
+        assert(fabs(d2v[i] + 2.*t*(1. - t*t)) < eps);
+    }
+}
+
+template <typename ValueT>
+void checkFastACTFs(double TINY)
+{
+    using namespace actf;
+    const auto xv = makeGrid<ValueT>(-10., 10., 2001);
+    checkFastACTF<FastExp, Exp>(xv, TINY);
+    checkFastACTF<FastSigmoid, Sigmoid>(xv, TINY);
+    checkFastACTF<FastSRLU, SRLU>(xv, TINY);
+    checkFastACTF<FastTanSig, TanSig>(xv, TINY);
+    checkFastACTF<FastSine, Sine>(xv, TINY);
+    checkFastTanSig(xv);
+}
+
+int main()
+{
+    checkFastMath<double>(1.e5, 708.);
+    checkFastMath<float>(1.e3, 87.);
+
+    checkFastACTFs<double>(1.e-14);
+    checkFastACTFs<float>(1.e-6);
+
+    return 0;
+}
@@ -0,0 +1,203 @@
+#include <iostream>
+#include <random>
+#include <stdexcept>
+#include <cassert>
+#include <vector>
+
+#include "qnets/templ/DynNet.hpp"
+#include "qnets/templ/TemplNet.hpp"
+#include "qnets/actf/Sigmoid.hpp"
+#include "qnets/actf/SRLU.hpp"
+#include "qnets/actf/Exp.hpp"
+#include "qnets/poly/FeedForwardNeuralNetwork.hpp"
+
+template <class NetT1, class NetT2>
+void checkIdentity(const NetT1 &net1, const NetT2 &net2, int ninput, int noutput, int nbeta, double TINY)
+{
+    for (int i = 0; i < noutput; ++i) {
+        //std::cout << "f_" << i << ": net1 " << net1.getOutput(i) << " net2 " << net2.getOutput(i) << std::endl;
+        assert(fabs(net1.getOutput(i) - net2.getOutput(i)) <= TINY);
+        for (int j = 0; j < ninput; ++j) {
+            assert(fabs(net1.getD1(i, j) - net2.getD1(i, j)) <= TINY);
+            assert(fabs(net1.getD2(i, j) - net2.getD2(i, j)) <= TINY);
+        }
+        for (int j = 0; j < nbeta; ++j) {
+            assert(fabs(net1.getVD1(i, j) - net2.getVD1(i, j)) <= TINY);
+        }
+    }
+}
+
+void checkPolyIdentity(FeedForwardNeuralNetwork &ffnn, const templ::DynNet &dnet, double TINY)
+{
+    for (int i = 0; i < ffnn.getNOutput(); ++i) {
+        //std::cout << "f_" << i << ": poly " << ffnn.getOutput(i) << " dyn " << dnet.getOutput(i) << std::endl;
+        assert(fabs(ffnn.getOutput(i) - dnet.getOutput(i)) < TINY);
+        for (int j = 0; j < ffnn.getNInput(); ++j) {
+            assert(fabs(ffnn.getFirstDerivative(i, j) - dnet.getD1(i, j)) < TINY);
+            assert(fabs(ffnn.getSecondDerivative(i, j) - dnet.getD2(i, j)) < TINY);
+        }
+        for (int j = 0; j < ffnn.getNBeta(); ++j) {
+            assert(fabs(ffnn.getVariationalFirstDerivative(i, j) - dnet.getVD1(i, j)) < TINY);
+        }
+    }
+}
+
+int main()
+{
+    using namespace std;
+    using namespace templ;
+
+    const double TINY = 1.e-14;
+    const char * filename = "ut17_ffnn.txt";
+
+    // Setup PolyNet with input/output shift and scale
+    FeedForwardNeuralNetwork ffnn(6, 10, 6);
+    ffnn.pushHiddenLayer(8);
+
+    for (int i = 0; i < ffnn.getNNLayer(0)->getNNeuralUnits(); ++i) {
+        ffnn.getNNLayer(0)->getNNUnit(i)->setActivationFunction(std_actf::provideActivationFunction("LGS"));
+    }
+    for (int i = 0; i < ffnn.getNNLayer(1)->getNNeuralUnits(); ++i) {
+        ffnn.getNNLayer(1)->getNNUnit(i)->setActivationFunction(std_actf::provideActivationFunction("SRLU"));
+    }
+    for (int i = 0; i < ffnn.getOutputLayer()->getNNeuralUnits(); ++i) {
+        ffnn.getOutputLayer()->getNNUnit(i)->setActivationFunction(std_actf::provideActivationFunction("EXP"));
+    }
+
+    ffnn.connectFFNN();
+    ffnn.assignVariationalParameters();
+    ffnn.addSecondDerivativeSubstrate();
+    ffnn.addVariationalFirstDerivativeSubstrate();
+
+    for (int i = 0; i < ffnn.getNInput(); ++i) { // stored, but not applied by poly (so neither by DynNet)
+        ffnn.getInputLayer()->getInputUnit(i)->setShift(0.1*i);
+        ffnn.getInputLayer()->getInputUnit(i)->setScale(1. + 0.5*i);
+    }
+    for (int i = 0; i < ffnn.getNOutput(); ++i) {
+        ffnn.getOutputLayer()->getOutputNNUnit(i)->setShift(-0.2*i);
+        ffnn.getOutputLayer()->getOutputNNUnit(i)->setScale(2. - 0.3*i);
+    }
+
+    // random generator with fixed seed for generating the beta, in order to eliminate randomness of results in the unittest
+    mt19937_64 rgen;
+    rgen.seed(1337);
+    uniform_real_distribution<double> rd(-0.5, 0.5);
+    for (int i = 0; i < ffnn.getNBeta(); ++i) {
+        ffnn.setBeta(i, rd(rgen));
+    }
+    ffnn.storeOnFile(filename);
+
+    // Load DynNet from file
+    DynNet dnet(filename);
+    assert(dnet.getNInput() == 5);
+    assert(dnet.getNOutput() == 5);
+    assert(dnet.getNLayer() == 3);
+    assert(dnet.getNUnit(0) == 9);
+    assert(dnet.getNUnit(1) == 7);
+    assert(dnet.getNUnit() == 21);
+    assert(dnet.getACTF(0) == DynACTF::Sigmoid);
+    assert(dnet.getACTF(1) == DynACTF::SRLU);
+    assert(dnet.getACTF(2) == DynACTF::Exp);
+    assert(dnet.getNBeta() == ffnn.getNBeta());
+    for (int i = 0; i < ffnn.getNBeta(); ++i) {
+        assert(dnet.getBeta(i) == ffnn.getBeta(i));
+    }
+
+    // compare against poly
+    const double x[5] = {0.7, -0.2, -0.5, 0.1, 0.3};
+    ffnn.setInput(x);
+    ffnn.FFPropagate();
+    dnet.Propagate(x);
+    checkPolyIdentity(ffnn, dnet, TINY);
+
+    // same with pure backprop for d1 (no d2)
+    dnet.dflags.set(DerivConfig::D1_VD1);
+    dnet.Propagate(x);
+    for (int i = 0; i < ffnn.getNOutput(); ++i) {
+        assert(fabs(ffnn.getOutput(i) - dnet.getOutput(i)) < TINY);
+        for (int j = 0; j < ffnn.getNInput(); ++j) {
+            assert(fabs(ffnn.getFirstDerivative(i, j) - dnet.getD1(i, j)) < TINY);
+        }
+    }
+    dnet.dflags.set(DerivConfig::D12_VD1);
+
+    // compare against an equivalent TemplNet (without shift/scale)
+    using layer1 = LayerConfig<9, actf::Sigmoid>;
+    using layer2 = LayerConfig<7, actf::SRLU>;
+    using layer3 = LayerConfig<5, actf::Exp>;
+    using TestNet = TemplNet<double, DerivConfig::D12_VD1, 5, 5, layer1, layer2, layer3>;
+    TestNet tmpl{};
+    DynNet dnet_plain(5, {9, 7, 5}, {DynACTF::Sigmoid, DynACTF::SRLU, DynACTF::Exp});
+    assert(dnet_plain.getNBeta() == tmpl.getNBeta());
+    dnet_plain.setBetas(dnet.getBetas().begin(), dnet.getBetas().end());
+    tmpl.setBetas(dnet.getBetas().begin(), dnet.getBetas().end());
+    tmpl.Propagate(x);
+    dnet_plain.Propagate(x);
+    checkIdentity(tmpl, dnet_plain, 5, 5, tmpl.getNBeta(), TINY);
+
+    // DynNet's own input/output shift/scale, against the TemplNet with transformed in/out
+    double x_shifted[5];
+    for (int i = 0; i < 5; ++i) {
+        dnet_plain.setInputShift(i, 0.1*i);
+        dnet_plain.setInputScale(i, 1. + 0.5*i);
+        x_shifted[i] = (x[i] + 0.1*i)*(1. + 0.5*i);
+    }
+    for (int i = 0; i < 5; ++i) {
+        dnet_plain.setOutputShift(i, -0.2*i);
+        dnet_plain.setOutputScale(i, 2. - 0.3*i);
+    }
+    tmpl.Propagate(x_shifted);
+    dnet_plain.Propagate(x);
+    for (int i = 0; i < 5; ++i) {
+        const double oscale = 2. - 0.3*i;
+        assert(fabs((tmpl.getOutput(i) - 0.2*i)*oscale - dnet_plain.getOutput(i)) < TINY);
+        for (int j = 0; j < 5; ++j) {
+            const double iscale = 1. + 0.5*j;
+            assert(fabs(tmpl.getD1(i, j)*iscale*oscale - dnet_plain.getD1(i, j)) < TINY);
+            assert(fabs(tmpl.getD2(i, j)*iscale*iscale*oscale - dnet_plain.getD2(i, j)) < TINY);
+        }
+        for (int j = 0; j < tmpl.getNBeta(); ++j) {
+            assert(fabs(tmpl.getVD1(i, j)*oscale - dnet_plain.getVD1(i, j)) < TINY);
+        }
+    }
+
+    // propagation with external states must match the default state
+    DynNet::State state1(dnet), state2(dnet);
+    const double x2[5] = {-0.3, 0.4, 0.2, -0.6, 0.05};
+    dnet.Propagate(x);
+    dnet.Propagate(state1, x);
+    dnet.Propagate(state2, x2);
+    checkIdentity(dnet, state1, 5, 5, dnet.getNBeta(), 0.);
+    ffnn.setInput(x2);
+    ffnn.FFPropagate();
+    for (int i = 0; i < ffnn.getNOutput(); ++i) {
+        assert(fabs(ffnn.getOutput(i) - state2.getOutput(i)) < TINY);
+    }
+
+    // copies propagate independently
+    DynNet dnet_copy(dnet);
+    dnet_copy.Propagate(x2);
+    checkIdentity(dnet_copy, state2, 5, 5, dnet.getNBeta(), 0.);
+    dnet_copy.Propagate(state1, x); // a copy has the same shape
+    checkIdentity(dnet, state1, 5, 5, dnet.getNBeta(), 0.);
+
+    // states of nets with different shape are rejected
+    const auto throwsInvalidArgument = [&](const DynNet &other) {
+        DynNet::State other_state(other);
+        try {
+            dnet.Propagate(other_state, x);
+        }
+        catch (const std::invalid_argument &) {
+            return true;
+        }
+        return false;
+    };
+    assert(throwsInvalidArgument(DynNet(5, {7, 5}, {DynACTF::Sigmoid, DynACTF::NoOp}))); // layer count
+    assert(throwsInvalidArgument(DynNet(5, {9, 8, 5}, {DynACTF::Sigmoid, DynACTF::SRLU, DynACTF::Exp}))); // layer size
+    assert(throwsInvalidArgument(DynNet(5, {9, 7, 5}, {DynACTF::Sigmoid, DynACTF::Sigmoid, DynACTF::Exp}))); // actf
+    assert(throwsInvalidArgument(DynNet(5, {9, 7, 5}, {DynACTF::Sigmoid, DynACTF::SRLU, DynACTF::Exp}, DerivConfig::D1))); // derivatives
+
+    remove(filename);
+
+    return 0;
+}
@@ -0,0 +1,78 @@
+// Generated by templ::writeTemplNetHeader (qnets/templ/CodeGen.hpp), do not edit.
+#ifndef QNETS_GENERATED_GENERATEDNET_HPP
+#define QNETS_GENERATED_GENERATEDNET_HPP
+
+#include "qnets/templ/TemplNet.hpp"
+#include "qnets/actf/Exp.hpp"
+#include "qnets/actf/Sigmoid.hpp"
+#include "qnets/actf/TanSig.hpp"
+
+#include <array>
+
+namespace GeneratedNet
+{
+using Net = templ::TemplNet<double, templ::DerivConfig::D12, 3, 3,
+                              templ::LayerConfig<6, actf::Sigmoid>,
+                              templ::LayerConfig<4, actf::TanSig>,
+                              templ::LayerConfig<2, actf::Exp>>;
+
+// weights (input shift/scale folded into the first layer)
+constexpr std::array<double, Net::nbeta> betas{{
+        -0.5625, -0.125, 0.3125, -0.4375,
+        0, 0.4375, -0.3125, 0.125,
+        0.5625, -0.1875, 0.25, -0.5,
+        -0.0625, 0.375, -0.375, 0.0625,
+        0.5, -0.25, 0.1875, -0.5625,
+        -0.125, 0.3125, -0.4375, 0,
+        0.4375, -0.3125, 0.125, 0.5625,
+        -0.1875, 0.25, -0.5, -0.0625,
+        0.375, -0.375, 0.0625, 0.5,
+        -0.25, 0.1875, -0.5625, -0.125,
+        0.3125, -0.4375, 0, 0.4375,
+        -0.3125, 0.125, 0.5625, -0.1875,
+        0.25, -0.5, -0.0625, 0.375,
+        -0.375, 0.0625, 0.5, -0.25,
+        0.1875, -0.5625, -0.125, 0.3125,
+        -0.4375, 0
+}};
+
+// output shift/scale: final output y_i = (net.getOutput(i) + output_shift[i])*output_scale[i]
+constexpr bool output_folded = false; // if true, shift/scale are identity
+constexpr std::array<double, Net::noutput> output_shift{{
+        0, -0.25
+}};
+constexpr std::array<double, Net::noutput> output_scale{{
+        1.5, 2
+}};
+
+// copy the stored weights into the net (at runtime, the net owns its weights)
+inline void initNet(Net &net) { net.setBetas(betas.begin(), betas.end()); }
+
+// get the final output, from a Net (default state) or Net::State
+template <class NetOrState>
+inline double getOutput(const NetOrState &net, int i)
+{
+    return output_folded ? net.getOutput(i) : (net.getOutput(i) + output_shift[i])*output_scale[i];
+}
+
+// get the derivatives of the final output (scaled like the output, if enabled in Net's DerivConfig)
+template <class NetOrState>
+inline double getD1(const NetOrState &net, int i, int j)
+{
+    return output_folded ? net.getD1(i, j) : net.getD1(i, j)*output_scale[i];
+}
+
+template <class NetOrState>
+inline double getD2(const NetOrState &net, int i, int j)
+{
+    return output_folded ? net.getD2(i, j) : net.getD2(i, j)*output_scale[i];
+}
+
+template <class NetOrState>
+inline double getVD1(const NetOrState &net, int i, int j)
+{
+    return output_folded ? net.getVD1(i, j) : net.getVD1(i, j)*output_scale[i];
+}
+} // GeneratedNet
+
+#endif
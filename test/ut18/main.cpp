@@ -0,0 +1,181 @@
+#include <iostream>
+#include <random>
+#include <array>
+#include <cassert>
+#include <cstdio>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "qnets/templ/DynNet.hpp"
+#include "qnets/templ/CodeGen.hpp"
+#include "qnets/poly/FeedForwardNeuralNetwork.hpp"
+
+#include "GeneratedNet.hpp" // checked-in output of writeTemplNetHeader for the net of setupPolyNet
+
+void checkSameFunction(templ::DynNet &dnet1, templ::DynNet &dnet2, const double x[], double TINY)
+{   // compare outputs and input derivatives
+    dnet1.Propagate(x);
+    dnet2.Propagate(x);
+    for (int i = 0; i < dnet1.getNOutput(); ++i) {
+        //std::cout << "f_" << i << ": net1 " << dnet1.getOutput(i) << " net2 " << dnet2.getOutput(i) << std::endl;
+        assert(fabs(dnet1.getOutput(i) - dnet2.getOutput(i)) < TINY);
+        for (int j = 0; j < dnet1.getNInput(); ++j) {
+            assert(fabs(dnet1.getD1(i, j) - dnet2.getD1(i, j)) < TINY);
+            assert(fabs(dnet1.getD2(i, j) - dnet2.getD2(i, j)) < TINY);
+        }
+    }
+}
+
+std::vector<double> readBetas(const std::string &header)
+{   // parse the constexpr betas array from generated header code
+    const size_t begin = header.find("{{", header.find("betas{{"));
+    const size_t end = header.find("}}", begin);
+    std::string values = header.substr(begin + 2, end - begin - 2);
+    for (char &c : values) {
+        if (c == ',') { c = ' '; }
+    }
+    std::istringstream iss(values);
+    std::vector<double> betas;
+    double beta;
+    while (iss >> beta) { betas.push_back(beta); }
+    return betas;
+}
+
+// setup the poly net that GeneratedNet.hpp was generated from (with exactly representable weights)
+void setupPolyNet(FeedForwardNeuralNetwork &ffnn)
+{
+    ffnn.pushHiddenLayer(5);
+    const char * actf_ids[3] = {"LGS", "TANS", "EXP"};
+    for (int il = 0; il < 3; ++il) {
+        for (int i = 0; i < ffnn.getNNLayer(il)->getNNeuralUnits(); ++i) {
+            ffnn.getNNLayer(il)->getNNUnit(i)->setActivationFunction(std_actf::provideActivationFunction(actf_ids[il]));
+        }
+    }
+    ffnn.connectFFNN();
+    ffnn.assignVariationalParameters();
+    ffnn.addSecondDerivativeSubstrate();
+    for (int i = 0; i < ffnn.getNBeta(); ++i) {
+        ffnn.setBeta(i, ((7*i)%19 - 9)/16.);
+    }
+    for (int i = 0; i < ffnn.getNOutput(); ++i) {
+        ffnn.getOutputLayer()->getOutputNNUnit(i)->setShift(-0.25*i);
+        ffnn.getOutputLayer()->getOutputNNUnit(i)->setScale(1.5 + 0.5*i);
+    }
+}
+
+int main()
+{
+    using namespace std;
+    using namespace templ;
+
+    const double TINY = 1.e-13;
+
+    // random generator with fixed seed for generating the beta, in order to eliminate randomness of results in the unittest
+    mt19937_64 rgen;
+    rgen.seed(1337);
+    uniform_real_distribution<double> rd(-1., 1.);
+
+    DynNet dnet(3, {6, 4, 2}, {DynACTF::Sigmoid, DynACTF::TanSig, DynACTF::NoOp});
+    for (int i = 0; i < dnet.getNBeta(); ++i) {
+        dnet.setBeta(i, rd(rgen));
+    }
+    for (int i = 0; i < dnet.getNInput(); ++i) {
+        dnet.setInputShift(i, rd(rgen));
+        dnet.setInputScale(i, 1. + rd(rgen)*0.5);
+    }
+    for (int i = 0; i < dnet.getNOutput(); ++i) {
+        dnet.setOutputShift(i, rd(rgen));
+        dnet.setOutputScale(i, 2. + rd(rgen));
+    }
+    const double x[3] = {0.4, -0.3, 0.9};
+
+    // folding must not change the net function
+    DynNet dnet_folded(dnet);
+    dnet_folded.foldInputShiftScale();
+    assert(dnet_folded.foldOutputShiftScale());
+    for (int i = 0; i < dnet.getNInput(); ++i) {
+        assert(dnet_folded.getInputShift(i) == 0.);
+        assert(dnet_folded.getInputScale(i) == 1.);
+    }
+    for (int i = 0; i < dnet.getNOutput(); ++i) {
+        assert(dnet_folded.getOutputShift(i) == 0.);
+        assert(dnet_folded.getOutputScale(i) == 1.);
+    }
+    checkSameFunction(dnet, dnet_folded, x, TINY);
+
+    // output shift/scale can't be folded through a non-linear output actf
+    DynNet dnet_exp(3, {6, 4, 2}, {DynACTF::Sigmoid, DynACTF::TanSig, DynACTF::Exp});
+    dnet_exp.setBetas(dnet.getBetas().begin(), dnet.getBetas().end());
+    dnet_exp.setOutputShift(1, 0.5);
+    dnet_exp.setOutputScale(1, 3.);
+    DynNet dnet_exp_folded(dnet_exp);
+    assert(!dnet_exp_folded.foldOutputShiftScale());
+    assert(dnet_exp_folded.getOutputShift(1) == 0.5);
+    assert(dnet_exp_folded.getOutputScale(1) == 3.);
+    assert(dnet_exp_folded.getBetas() == dnet_exp.getBetas());
+
+    // generated header code
+    ostringstream oss;
+    writeTemplNetHeader(oss, dnet, "TestNet", DerivConfig::D1);
+    const string header = oss.str();
+    //std::cout << header << std::endl;
+    assert(header.find("namespace TestNet") != string::npos);
+    assert(header.find("templ::TemplNet<double, templ::DerivConfig::D1, 3, 3,") != string::npos);
+    assert(header.find("templ::LayerConfig<6, actf::Sigmoid>") != string::npos);
+    assert(header.find("templ::LayerConfig<4, actf::TanSig>") != string::npos);
+    assert(header.find("templ::LayerConfig<2, actf::NoOp>") != string::npos);
+    assert(header.find("#include \"qnets/actf/TanSig.hpp\"") != string::npos);
+    assert(header.find("output_folded = true") != string::npos);
+    assert(readBetas(header) == dnet_folded.getBetas()); // exact round trip of the folded weights
+
+    ostringstream oss_exp;
+    writeTemplNetHeader(oss_exp, dnet_exp, "ExpNet");
+    assert(oss_exp.str().find("output_folded = false") != string::npos);
+    assert(readBetas(oss_exp.str()) == dnet_exp.getBetas());
+
+    // the checked-in generated header is up-to-date and reproduces the poly net it was generated from
+    FeedForwardNeuralNetwork ffnn(4, 7, 3);
+    setupPolyNet(ffnn);
+    const char * filename = "ut18_ffnn.txt";
+    ffnn.storeOnFile(filename);
+    DynNet dnet_gen(filename);
+    remove(filename);
+    ostringstream oss_gen;
+    writeTemplNetHeader(oss_gen, dnet_gen, "GeneratedNet", DerivConfig::D12);
+    assert(oss_gen.str().find("templ::TemplNet<double, templ::DerivConfig::D12, 3, 3,") != string::npos);
+    assert(readBetas(oss_gen.str()) == vector<double>(GeneratedNet::betas.begin(), GeneratedNet::betas.end()));
+    assert(oss_gen.str().find("-0,") == string::npos && oss_gen.str().find("-0\n") == string::npos); // no negative zeros
+    assert(!GeneratedNet::output_folded);
+    for (int i = 0; i < ffnn.getNOutput(); ++i) {
+        assert(GeneratedNet::output_shift[i] == dnet_gen.getOutputShift(i));
+        assert(GeneratedNet::output_scale[i] == dnet_gen.getOutputScale(i));
+    }
+
+    GeneratedNet::Net gnet;
+    GeneratedNet::initNet(gnet);
+    for (const auto &xg : {array<double, 3>{{0.4, -0.3, 0.9}}, array<double, 3>{{-1.2, 0.1, 0.6}}}) {
+        ffnn.setInput(xg.data());
+        ffnn.FFPropagate();
+        gnet.Propagate(xg);
+        for (int i = 0; i < ffnn.getNOutput(); ++i) {
+            assert(fabs(GeneratedNet::getOutput(gnet, i) - ffnn.getOutput(i)) < TINY);
+            for (int j = 0; j < ffnn.getNInput(); ++j) {
+                assert(fabs(GeneratedNet::getD1(gnet, i, j) - ffnn.getFirstDerivative(i, j)) < TINY);
+                assert(fabs(GeneratedNet::getD2(gnet, i, j) - ffnn.getSecondDerivative(i, j)) < TINY);
+            }
+        }
+    }
+
+    // invalid net names
+    bool thrown = false;
+    try {
+        writeTemplNetHeader(oss, dnet, "1Net");
+    }
+    catch (const std::invalid_argument &) {
+        thrown = true;
+    }
+    assert(thrown);
+
+    return 0;
+}
@@ -0,0 +1,81 @@
+#include <iostream>
+#include <random>
+#include <cassert>
+#include <array>
+
+#include "qnets/templ/TemplNet.hpp"
+#include "qnets/actf/Sigmoid.hpp"
+#include "qnets/actf/TanSig.hpp"
+#include "qnets/actf/Exp.hpp"
+
+// Check the vector-Jacobian product mode (PropagateVJP) of TemplNet against the seed-weighted sum of the VD1 rows
+
+template <class RefNet, class VJPNet>
+void checkVJP(RefNet &ref, VJPNet &vjp, double TINY)
+{
+    using ValueT = typename RefNet::ValueT;
+
+    // random generator with fixed seed for generating the beta, in order to eliminate randomness of results in the unittest
+    std::mt19937_64 rgen;
+    rgen.seed(1337);
+    std::uniform_real_distribution<double> rd(-0.5, 0.5);
+    for (int i = 0; i < RefNet::nbeta; ++i) {
+        ref.setBeta(i, static_cast<ValueT>(rd(rgen)));
+    }
+    vjp.setBetas(ref.getBetas());
+
+    std::array<ValueT, RefNet::ninput> x{};
+    std::array<ValueT, RefNet::noutput> seed{};
+    for (auto &xi : x) { xi = static_cast<ValueT>(rd(rgen)); }
+    for (auto &si : seed) { si = static_cast<ValueT>(4.*rd(rgen)); }
+
+    ref.Propagate(x);
+    std::array<ValueT, RefNet::nbeta> grad{};
+    vjp.PropagateVJP(x, seed, grad);
+
+    for (int i = 0; i < RefNet::noutput; ++i) {
+        assert(fabs(ref.getOutput(i) - vjp.getOutput(i)) < TINY);
+    }
+    for (int j = 0; j < RefNet::nbeta; ++j) {
+        double ref_grad = 0.;
+        for (int i = 0; i < RefNet::noutput; ++i) {
+            ref_grad += seed[i]*ref.getVD1(i, j);
+        }
+        //std::cout << "grad_" << j << ": ref " << ref_grad << " vjp " << grad[j] << std::endl;
+        assert(fabs(ref_grad - grad[j]) < TINY);
+    }
+
+    // the same with external state
+    typename VJPNet::State state{};
+    std::array<ValueT, RefNet::nbeta> grad_state{};
+    vjp.PropagateVJP(state, x, seed, grad_state);
+    assert(grad_state == grad);
+}
+
+int main()
+{
+    using namespace templ;
+
+    using L1 = LayerConfig<8, actf::Sigmoid>;
+    using L2 = LayerConfig<6, actf::TanSig>;
+    using L3 = LayerConfig<4, actf::Exp>;
+
+    // double, with the VD1 matrix allocated and without (only D1 backprop buffers)
+    TemplNet<double, DerivConfig::D12_VD1, 3, 3, L1, L2, L3> ref;
+    TemplNet<double, DerivConfig::D12_VD1, 3, 3, L1, L2, L3> vjp_vd1;
+    TemplNet<double, DerivConfig::D1, 3, 3, L1, L2, L3> vjp_d1;
+    checkVJP(ref, vjp_vd1, 1.e-14);
+    checkVJP(ref, vjp_d1, 1.e-14);
+
+    // float
+    TemplNet<float, DerivConfig::VD1, 3, 3, L1, L2, L3> ref_f;
+    TemplNet<float, DerivConfig::VD1, 3, 3, L1, L2, L3> vjp_f;
+    checkVJP(ref_f, vjp_f, 1.e-5);
+
+    // derived input (ORIG_N_IN != NET_N_IN), VJP needs no input derivatives
+    TemplNet<double, DerivConfig::VD1, 3, 3, L1, L2, L3> ref_orig;
+    TemplNet<double, DerivConfig::VD1, 7, 3, L1, L2, L3> vjp_derived;
+    checkVJP(ref_orig, vjp_derived, 1.e-14);
+
+    return 0;
+}
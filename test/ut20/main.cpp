@@ -0,0 +1,196 @@
+#include <iostream>
+#include <random>
+#include <cassert>
+#include <cmath>
+#include <array>
+#include <vector>
+
+#include "qnets/templ/TemplNet.hpp"
+#include "qnets/templ/SparseOrigD1.hpp"
+#include "qnets/actf/Sigmoid.hpp"
+#include "qnets/actf/Exp.hpp"
+
+// Check PropagateDerived with sparse (CSR) orig_d1 against the dense version,
+// for pair distance features of 4 particles in 3D (6 features of 12 coordinates),
+// and the blocked dense chain rule over several column tiles
+
+constexpr int NPART = 4;
+constexpr int NDIM = 3;
+constexpr int NORIG = NPART*NDIM;
+constexpr int NFEAT = NPART*(NPART - 1)/2;
+
+// compute pair distance features, with dense and sparse derivatives
+void computeFeatures(const double coords[], double feat[], double dense_d1[], double dense_d2[], templ::SparseOrigD1<double> &sparse_d1)
+{
+    std::fill(dense_d1, dense_d1 + NFEAT*NORIG, 0.);
+    std::fill(dense_d2, dense_d2 + NFEAT*NORIG, 0.);
+    sparse_d1.clear();
+    int j = 0;
+    for (int p = 0; p < NPART; ++p) {
+        for (int q = p + 1; q < NPART; ++q, ++j) {
+            double dist2 = 0.;
+            for (int d = 0; d < NDIM; ++d) {
+                dist2 += pow(coords[p*NDIM + d] - coords[q*NDIM + d], 2);
+            }
+            feat[j] = sqrt(dist2);
+            for (int d = 0; d < NDIM; ++d) { // d/dx_p
+                const double diff = coords[p*NDIM + d] - coords[q*NDIM + d];
+                dense_d1[j*NORIG + p*NDIM + d] = diff/feat[j];
+                dense_d1[j*NORIG + q*NDIM + d] = -diff/feat[j];
+                dense_d2[j*NORIG + p*NDIM + d] = (1. - diff*diff/dist2)/feat[j];
+                dense_d2[j*NORIG + q*NDIM + d] = dense_d2[j*NORIG + p*NDIM + d];
+                sparse_d1.addEntry(p*NDIM + d, diff/feat[j]);
+            }
+            for (int d = 0; d < NDIM; ++d) {
+                sparse_d1.addEntry(q*NDIM + d, -(coords[p*NDIM + d] - coords[q*NDIM + d])/feat[j]);
+            }
+            sparse_d1.finishRow();
+        }
+    }
+}
+
+template <class NetT>
+void checkSparse(NetT &net, double TINY)
+{
+    // random generator with fixed seed for generating the beta, in order to eliminate randomness of results in the unittest
+    std::mt19937_64 rgen;
+    rgen.seed(1337);
+    std::uniform_real_distribution<double> rd(-0.5, 0.5);
+    for (int i = 0; i < NetT::nbeta; ++i) {
+        net.setBeta(i, rd(rgen));
+    }
+
+    std::array<double, NORIG> coords{};
+    for (auto &c : coords) { c = 2.*rd(rgen); }
+    std::array<double, NFEAT> feat{};
+    std::array<double, NFEAT*NORIG> dense_d1{}, dense_d2{};
+    templ::SparseOrigD1<double> sparse_d1(NORIG);
+    computeFeatures(coords.data(), feat.data(), dense_d1.data(), dense_d2.data(), sparse_d1);
+    assert(sparse_d1.getNRows() == NFEAT);
+    assert(sparse_d1.getNNZ() == NFEAT*2*NDIM);
+
+    // the dense-to-sparse constructor drops zeros
+    const templ::SparseOrigD1<double> sparse_from_dense(dense_d1.data(), NFEAT, NORIG);
+    assert(sparse_from_dense.getNNZ() == sparse_d1.getNNZ());
+
+    typename NetT::State state_dense{}, state_sparse{}, state_sparse2{};
+    net.PropagateDerived(state_dense, feat, dense_d1, dense_d2);
+    net.PropagateDerived(state_sparse, feat.data(), sparse_d1);
+    net.PropagateDerived(state_sparse2, feat.data(), sparse_from_dense);
+
+    for (int i = 0; i < NetT::noutput; ++i) {
+        assert(state_dense.getOutput(i) == state_sparse.getOutput(i));
+        for (int k = 0; k < NORIG; ++k) {
+            //std::cout << "d1_" << i << "_" << k << ": dense " << state_dense.getD1(i, k) << " sparse " << state_sparse.getD1(i, k) << std::endl;
+            assert(fabs(state_dense.getD1(i, k) - state_sparse.getD1(i, k)) < TINY);
+            assert(fabs(state_sparse2.getD1(i, k) - state_sparse.getD1(i, k)) < TINY);
+        }
+        for (int j = 0; j < NetT::nbeta; ++j) {
+            assert(state_dense.getVD1(i, j) == state_sparse.getVD1(i, j));
+        }
+    }
+
+    if (NetT::allowsD2()) {
+        // dense D2 (forward accumulation of orig_d2) vs. central finite differences of dense D1
+        const double h = 1.e-5;
+        typename NetT::State state_fwd{}, state_bwd{};
+        for (int k = 0; k < NORIG; ++k) {
+            std::array<double, NORIG> coords_fwd = coords, coords_bwd = coords;
+            coords_fwd[k] += h;
+            coords_bwd[k] -= h;
+            std::array<double, NFEAT> feat_h{};
+            std::array<double, NFEAT*NORIG> d1_h{}, d2_h{};
+            templ::SparseOrigD1<double> sparse_h(NORIG);
+            computeFeatures(coords_fwd.data(), feat_h.data(), d1_h.data(), d2_h.data(), sparse_h);
+            net.PropagateDerived(state_fwd, feat_h, d1_h, d2_h);
+            computeFeatures(coords_bwd.data(), feat_h.data(), d1_h.data(), d2_h.data(), sparse_h);
+            net.PropagateDerived(state_bwd, feat_h, d1_h, d2_h);
+            for (int i = 0; i < NetT::noutput; ++i) {
+                const double d2_fd = (state_fwd.getD1(i, k) - state_bwd.getD1(i, k))/(2.*h);
+                assert(fabs(state_dense.getD2(i, k) - d2_fd) < 1.e-7*(1. + fabs(d2_fd)));
+            }
+        }
+
+        // sparse mode doesn't compute D2, but sets it to zero (also after a dense propagation)
+        net.PropagateDerived(state_sparse2, feat, dense_d1, dense_d2);
+        net.PropagateDerived(state_sparse2, feat.data(), sparse_d1);
+        for (int i = 0; i < NetT::noutput; ++i) {
+            for (int k = 0; k < NORIG; ++k) {
+                assert(state_sparse.getD2(i, k) == 0.);
+                assert(state_sparse2.getD2(i, k) == 0.);
+            }
+        }
+    }
+
+    // the user dflags are restored
+    assert(state_sparse.dflags.d2() == NetT::allowsD2());
+
+    // wrong sizes throw
+    bool thrown = false;
+    try {
+        net.PropagateDerived(state_sparse, feat.data(), templ::SparseOrigD1<double>(NORIG + 1));
+    }
+    catch (const std::invalid_argument &) {
+        thrown = true;
+    }
+    assert(thrown);
+}
+
+// the blocked dense chain rule over several column tiles, vs. the naive product d1_net*orig_d1
+void checkBlockedDense()
+{
+    using namespace templ;
+    constexpr int NIN = 5;
+    constexpr int NOUT = 32; // -> tile of 64 columns
+    constexpr int NORIG_BIG = 2*64 + 5; // two full tiles and a remainder
+    using L1 = LayerConfig<7, actf::Sigmoid>;
+    using L2 = LayerConfig<NOUT, actf::Sigmoid>;
+    using Net = TemplNet<double, DerivConfig::D1, NORIG_BIG, NIN, L1, L2>;
+    using NetDirect = TemplNet<double, DerivConfig::D1, NIN, NIN, L1, L2>; // to get d1_net
+    static_assert(Net::orig_d1_tile == 64, "unexpected tile size");
+
+    std::mt19937_64 rgen;
+    rgen.seed(4242);
+    std::uniform_real_distribution<double> rd(-0.5, 0.5);
+    Net net;
+    NetDirect net_direct;
+    for (int i = 0; i < Net::nbeta; ++i) {
+        net.setBeta(i, rd(rgen));
+        net_direct.setBeta(i, net.getBeta(i));
+    }
+    std::array<double, NIN> input{};
+    for (auto &x : input) { x = 2.*rd(rgen); }
+    std::vector<double> orig_d1(NIN*NORIG_BIG);
+    for (int l = 0; l < NIN*NORIG_BIG; ++l) { orig_d1[l] = (l%3 == 0) ? 0. : rd(rgen); } // with zeros
+
+    net.PropagateDerived(input.data(), orig_d1.data(), nullptr);
+    net_direct.Propagate(input);
+    for (int i = 0; i < NOUT; ++i) {
+        for (int k = 0; k < NORIG_BIG; ++k) {
+            double d1_ref = 0.;
+            for (int j = 0; j < NIN; ++j) { d1_ref += net_direct.getD1(i, j)*orig_d1[j*NORIG_BIG + k]; }
+            assert(fabs(net.getD1(i, k) - d1_ref) < 1.e-14);
+        }
+    }
+}
+
+int main()
+{
+    using namespace templ;
+
+    using L1 = LayerConfig<10, actf::Sigmoid>;
+    using L2 = LayerConfig<8, actf::Sigmoid>;
+    using L3 = LayerConfig<2, actf::Exp>;
+
+    // dense: backprop chain rule vs sparse
+    TemplNet<double, DerivConfig::D1_VD1, NORIG, NFEAT, L1, L2, L3> net_d1;
+    checkSparse(net_d1, 1.e-14);
+
+    // dense: forward accumulation (D2) vs sparse
+    TemplNet<double, DerivConfig::D12_VD1, NORIG, NFEAT, L1, L2, L3> net_d12;
+    checkSparse(net_d12, 1.e-14);
+
+    checkBlockedDense();
+
+    return 0;
+}
@@ -0,0 +1,123 @@
+#include <iostream>
+#include <random>
+#include <cassert>
+#include <cmath>
+#include <array>
+
+#include "qnets/templ/TemplNet.hpp"
+#include "qnets/templ/TemplFeatureMap.hpp"
+#include "qnets/actf/Sigmoid.hpp"
+#include "qnets/actf/Exp.hpp"
+
+// Check the TemplFeatureMap front end of TemplNet (PropagateFeatures)
+
+constexpr int NPART = 4;
+constexpr int NDIM = 3;
+constexpr int NORIG = NPART*NDIM;
+constexpr int NFEAT = NPART*(NPART - 1)/2;
+
+template <class FMapT>
+void checkFMapDerivs(FMapT &fm, const std::array<double, FMapT::orig_ninput> &x, double TINY)
+{   // compare feature derivatives against finite differences
+    const double dx = 1.e-4;
+    fm.Compute(x.data(), true);
+    const auto f0 = fm.out();
+    const auto d1 = fm.d1();
+    const auto d2 = fm.d2();
+    for (int k = 0; k < FMapT::orig_ninput; ++k) {
+        auto xp = x, xm = x;
+        xp[k] += dx;
+        xm[k] -= dx;
+        fm.Compute(xp.data(), false);
+        const auto fp = fm.out();
+        fm.Compute(xm.data(), false);
+        const auto fm_ = fm.out();
+        for (int j = 0; j < FMapT::noutput; ++j) {
+            assert(fabs((fp[j] - fm_[j])/(2.*dx) - d1[j*FMapT::orig_ninput + k]) < TINY);
+            assert(fabs((fp[j] - 2.*f0[j] + fm_[j])/(dx*dx) - d2[j*FMapT::orig_ninput + k]) < 1.e4*TINY);
+        }
+    }
+}
+
+int main()
+{
+    using namespace templ;
+
+    // random generator with fixed seed, in order to eliminate randomness of results in the unittest
+    std::mt19937_64 rgen;
+    rgen.seed(1337);
+    std::uniform_real_distribution<double> rd(-1., 1.);
+    std::array<double, NORIG> coords{};
+    for (auto &c : coords) { c = rd(rgen); }
+
+    // feature map of all pair distances
+    using FMap = PairDistanceFeatureMap<double, NPART, NDIM>;
+    static_assert(FMap::noutput == NFEAT, "");
+    static_assert(FMap::nsrc == NFEAT*2*NDIM, "");
+    FMap fmap;
+    fmap.Compute(coords.data(), true);
+    int j = 0;
+    for (int p = 0; p < NPART; ++p) {
+        for (int q = p + 1; q < NPART; ++q, ++j) {
+            double dist2 = 0.;
+            for (int d = 0; d < NDIM; ++d) { dist2 += pow(coords[p*NDIM + d] - coords[q*NDIM + d], 2); }
+            assert(fabs(fmap.out()[j] - dist2) < 1.e-15);
+        }
+    }
+    checkFMapDerivs(fmap, coords, 1.e-7);
+
+    // other maps
+    using FMap2 = TemplFeatureMap<double, 4, fmap::IdentityMap<2>, fmap::PairSumMap<0, 3>, fmap::PairDifferenceMap<1, 0>, fmap::EuclideanPairDistanceMap<2, 0, 2>>;
+    FMap2 fmap2;
+    const std::array<double, 4> x2{0.3, -0.5, 0.8, 0.1};
+    fmap2.Compute(x2.data(), false);
+    assert(fmap2.out()[0] == 0.8);
+    assert(fmap2.out()[1] == 0.3 + 0.1);
+    assert(fmap2.out()[2] == -0.5 - 0.3);
+    assert(fabs(fmap2.out()[3] - (pow(0.3 - 0.8, 2) + pow(-0.5 - 0.1, 2))) < 1.e-15);
+    checkFMapDerivs(fmap2, x2, 1.e-7);
+
+    // the net with feature map front end must agree with PropagateDerived on the (dense) feature derivatives
+    using L1 = LayerConfig<10, actf::Sigmoid>;
+    using L2 = LayerConfig<8, actf::Sigmoid>;
+    using L3 = LayerConfig<2, actf::Exp>;
+    using Net = TemplNet<double, DerivConfig::D12_VD1, NORIG, NFEAT, L1, L2, L3>;
+    Net net;
+    std::uniform_real_distribution<double> rd_beta(-0.5, 0.5);
+    for (int i = 0; i < Net::nbeta; ++i) { net.setBeta(i, rd_beta(rgen)); }
+
+    Net::State state_ref{}, state_fm{};
+    fmap.Compute(coords.data(), true);
+    net.PropagateDerived(state_ref, fmap.out(), fmap.d1(), fmap.d2());
+    FMap fmap_fresh;
+    net.PropagateFeatures(state_fm, fmap_fresh, coords);
+    assert(state_ref.getOutput() == state_fm.getOutput());
+    assert(state_ref.getD1() == state_fm.getD1());
+    assert(state_ref.getD2() == state_fm.getD2());
+    assert(state_ref.getVD1() == state_fm.getVD1());
+
+    // D1 only (chained via the compact feature derivatives) vs forward accumulation
+    Net::State state_d1{DynamicDFlags{DerivConfig::D1_VD1}};
+    net.PropagateFeatures(state_d1, fmap_fresh, coords);
+    for (int i = 0; i < Net::noutput; ++i) {
+        for (int k = 0; k < NORIG; ++k) {
+            assert(fabs(state_d1.getD1(i, k) - state_fm.getD1(i, k)) < 1.e-14);
+        }
+    }
+
+    // D1 of the net output with respect to coordinates, against finite differences
+    const double dx = 1.e-5;
+    for (int k = 0; k < NORIG; ++k) {
+        auto cp = coords, cm = coords;
+        cp[k] += dx;
+        cm[k] -= dx;
+        Net::State sp{}, sm{};
+        net.PropagateFeatures(sp, fmap_fresh, cp);
+        net.PropagateFeatures(sm, fmap_fresh, cm);
+        for (int i = 0; i < Net::noutput; ++i) {
+            assert(fabs((sp.getOutput(i) - sm.getOutput(i))/(2.*dx) - state_fm.getD1(i, k)) < 1.e-8);
+        }
+    }
+
+    return 0;
+}
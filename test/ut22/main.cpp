@@ -0,0 +1,112 @@
+#include <iostream>
+#include <random>
+#include <cassert>
+#include <cmath>
+#include <array>
+
+#include "qnets/templ/TemplNet.hpp"
+#include "qnets/templ/TemplTrainer.hpp"
+#include "qnets/actf/Sigmoid.hpp"
+#include "qnets/actf/NoOp.hpp"
+
+// Check the native TemplNet trainer (TemplTrainer): loss gradient, determinism and convergence
+
+using namespace templ;
+
+using L1 = LayerConfig<8, actf::Sigmoid>;
+using L2 = LayerConfig<1, actf::NoOp>;
+using Net = TemplNet<double, DerivConfig::VD1, 1, 1, L1, L2>;
+
+void initBetas(Net &net)
+{
+    // random generator with fixed seed, in order to eliminate randomness of results in the unittest
+    std::mt19937_64 rgen;
+    rgen.seed(1337);
+    std::uniform_real_distribution<double> rd(-1., 1.);
+    for (int i = 0; i < Net::nbeta; ++i) { net.setBeta(i, rd(rgen)); }
+}
+
+int main()
+{
+    // data of a gaussian
+    NNTrainingData tdata{200, 120, 40, 1, 1, nullptr, nullptr, nullptr, nullptr, nullptr};
+    tdata.allocate(false, false);
+    for (int i = 0; i < tdata.ndata; ++i) {
+        tdata.x[i][0] = -3. + 6.*((i*37)%tdata.ndata)/tdata.ndata; // spread over the interval
+        tdata.y[i][0] = exp(-tdata.x[i][0]*tdata.x[i][0]);
+        tdata.w[i][0] = 1.;
+    }
+    const NNTrainingConfig tconfig{0.01, 0., 0., 300, 0};
+
+    Net net;
+    initBetas(net);
+
+    // loss gradient vs finite differences
+    OptimizerConfig oconfig;
+    oconfig.nworkers = 3;
+    TemplTrainer<Net> trainer(tdata, tconfig, oconfig);
+    std::array<double, Net::nbeta> grad{}, grad_dummy{};
+    trainer.computeTrainingLoss(net, grad);
+    const double dx = 1.e-6;
+    for (int k = 0; k < Net::nbeta; ++k) {
+        Net net_p(net), net_m(net);
+        net_p.setBeta(k, net.getBeta(k) + dx);
+        net_m.setBeta(k, net.getBeta(k) - dx);
+        const double fd = (trainer.computeTrainingLoss(net_p, grad_dummy) - trainer.computeTrainingLoss(net_m, grad_dummy))/(2.*dx);
+        assert(fabs(fd - grad[k]) < 1.e-7);
+    }
+
+    // Adam fit, reproducible for fixed nworkers
+    const double resi_init = trainer.computeResidual(net);
+    oconfig.learning_rate = 0.02;
+    TemplTrainer<Net> adam1(tdata, tconfig, oconfig), adam2(tdata, tconfig, oconfig);
+    Net net_adam1(net), net_adam2(net);
+    assert(adam1.findFit(net_adam1) == tconfig.maxn_steps);
+    adam2.findFit(net_adam2);
+    assert(net_adam1.getBetas() == net_adam2.getBetas());
+    const double resi_adam = adam1.computeResidual(net_adam1);
+    assert(resi_adam < 0.2*resi_init);
+
+    // the number of workers only changes the summation order
+    oconfig.nworkers = 1;
+    TemplTrainer<Net> adam_serial(tdata, tconfig, oconfig);
+    Net net_serial(net);
+    adam_serial.findFit(net_serial);
+    for (int k = 0; k < Net::nbeta; ++k) {
+        assert(fabs(net_serial.getBeta(k) - net_adam1.getBeta(k)) < 1.e-8);
+    }
+
+    // SGD and momentum decrease the residual, too
+    oconfig.method = OptMethod::SGD;
+    oconfig.learning_rate = 0.05;
+    TemplTrainer<Net> sgd(tdata, tconfig, oconfig);
+    Net net_sgd(net);
+    sgd.findFit(net_sgd);
+    assert(sgd.computeResidual(net_sgd) < resi_init);
+
+    oconfig.method = OptMethod::Momentum;
+    oconfig.learning_rate = 0.01;
+    TemplTrainer<Net> mom(tdata, tconfig, oconfig);
+    Net net_mom(net);
+    mom.findFit(net_mom);
+    assert(mom.computeResidual(net_mom) < resi_init);
+
+    // early stopping on validation data
+    const NNTrainingConfig tconfig_es{0.01, 0., 0., 100000, 5};
+    TemplTrainer<Net> mom_es(tdata, tconfig_es, oconfig);
+    Net net_es(net);
+    assert(mom_es.findFit(net_es) < tconfig_es.maxn_steps);
+
+    // derivative fitting is not supported
+    bool thrown = false;
+    try {
+        TemplTrainer<Net> bad(tdata, NNTrainingConfig{0., 0.1, 0., 10, 0});
+    }
+    catch (const std::invalid_argument &) {
+        thrown = true;
+    }
+    assert(thrown);
+
+    tdata.deallocate();
+    return 0;
+}
@@ -0,0 +1,168 @@
+#include <iostream>
+#include <random>
+#include <cassert>
+#include <cmath>
+#include <array>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <vector>
+
+#include "qnets/templ/TemplNet.hpp"
+#include "qnets/templ/BinaryWeights.hpp"
+#include "qnets/actf/Sigmoid.hpp"
+#include "qnets/actf/FastSigmoid.hpp"
+#include "qnets/actf/TanSig.hpp"
+#include "qnets/actf/NoOp.hpp"
+#include "qnets/poly/FeedForwardNeuralNetwork.hpp"
+
+// Check the versioned binary weight format: round trips, shape checks, checksum and exchange between TemplNet and poly
+
+template <class Fun>
+bool throwsInvalidArgument(Fun fun)
+{
+    try {
+        fun();
+    }
+    catch (const std::invalid_argument &) {
+        return true;
+    }
+    return false;
+}
+
+template <class Fun>
+bool throwsInvalidArgument(Fun fun, const std::string &what) // and the message contains what
+{
+    try {
+        fun();
+    }
+    catch (const std::invalid_argument &e) {
+        return std::string(e.what()).find(what) != std::string::npos;
+    }
+    return false;
+}
+
+int main()
+{
+    using namespace std;
+    using namespace templ;
+
+    const char * filename = "ut23_betas.bin";
+    const char * filename_poly = "ut23_betas_poly.bin";
+
+    using L1 = LayerConfig<7, actf::Sigmoid>;
+    using L2 = LayerConfig<5, actf::TanSig>;
+    using L3 = LayerConfig<2, actf::NoOp>;
+    using Net = TemplNet<double, DerivConfig::OFF, 3, 3, L1, L2, L3>;
+
+    // random generator with fixed seed for generating the beta, in order to eliminate randomness of results in the unittest
+    std::mt19937_64 rgen;
+    rgen.seed(1337);
+    std::uniform_real_distribution<double> rd(-1., 1.);
+
+    Net net;
+    for (int i = 0; i < Net::nbeta; ++i) { net.setBeta(i, rd(rgen)); }
+
+    // shape descriptor
+    const WeightShape shape = Net::getWeightShape();
+    assert(shape.ninput == 3);
+    assert((shape.nunits == vector<int>{7, 5, 2}));
+    assert((shape.actf_ids == vector<string>{"LGS", "TANS", "ID"}));
+    assert(shape.getNBeta() == Net::nbeta);
+
+    // stream round trip
+    stringstream ss;
+    net.storeToBinaryStream(ss);
+    Net net_stream;
+    net_stream.loadFromBinaryStream(ss);
+    assert(net_stream.getBetas() == net.getBetas());
+
+    // file round trip (mmap), into different DCONF, precision and the Fast actf variant
+    net.storeToBinaryFile(filename);
+    TemplNet<double, DerivConfig::D12_VD1, 3, 3, L1, L2, L3> net_d12;
+    net_d12.loadFromBinaryFile(filename);
+    assert(net_d12.getBetas() == net.getBetas());
+    TemplNet<float, DerivConfig::OFF, 3, 3, LayerConfig<7, actf::FastSigmoid>, L2, L3> net_float;
+    net_float.loadFromBinaryFile(filename);
+    for (int i = 0; i < Net::nbeta; ++i) {
+        assert(net_float.getBeta(i) == static_cast<float>(net.getBeta(i)));
+    }
+
+    // shape mismatch
+    TemplNet<double, DerivConfig::OFF, 3, 3, L1, LayerConfig<5, actf::Sigmoid>, L3> net_other_actf;
+    TemplNet<double, DerivConfig::OFF, 3, 3, L1, LayerConfig<6, actf::TanSig>, L3> net_other_size;
+    assert(throwsInvalidArgument([&]() { net_other_actf.loadFromBinaryFile(filename); }));
+    assert(throwsInvalidArgument([&]() { net_other_size.loadFromBinaryFile(filename); }));
+
+    // corrupted weight byte -> checksum mismatch
+    {
+        fstream file(filename, ios::binary | ios::in | ios::out);
+        file.seekp(-3, ios::end);
+        file.put('\x7f');
+    }
+    Net net_corrupt;
+    assert(throwsInvalidArgument([&]() { net_corrupt.loadFromBinaryFile(filename); }));
+
+    // text and invalid headers are rejected before allocating anything of the stored size
+    vector<double> betas;
+    stringstream ss_text("FFNN_DEFAULT( INL( nunits{4} ) NNL( nunits{8} ) ... this is a text file of sufficient length");
+    assert(throwsInvalidArgument([&]() { readBinaryWeights(ss_text, betas); }, "Not a binary weight file"));
+    stringstream ss_short("FFNN");
+    assert(throwsInvalidArgument([&]() { readBinaryWeights(ss_short, betas); }, "Not a binary weight file"));
+
+    const auto withHeaderField = [&](const size_t offset, const uint32_t value) { // valid stream with one uint32 replaced
+        string bytes = ss.str();
+        memcpy(&bytes[offset], &value, sizeof(value));
+        return bytes;
+    };
+    stringstream ss_nlayer(withHeaderField(20, 1u << 30u)); // nlayer
+    assert(throwsInvalidArgument([&]() { readBinaryWeights(ss_nlayer, betas); }, "Invalid number of layers"));
+    stringstream ss_nlayer0(withHeaderField(20, 0u));
+    assert(throwsInvalidArgument([&]() { readBinaryWeights(ss_nlayer0, betas); }, "Invalid number of layers"));
+    stringstream ss_version(withHeaderField(8, binary_weights_version + 1));
+    assert(throwsInvalidArgument([&]() { readBinaryWeights(ss_version, betas); }, "Unsupported binary weight file version"));
+    stringstream ss_nunits(withHeaderField(24, 1u << 30u)); // nunits of the first layer, nbeta overflows int
+    assert(throwsInvalidArgument([&]() { readBinaryWeights(ss_nunits, betas); }, "exceeds INT_MAX"));
+
+    const WeightShape shape_large{3, {1 << 20, 1 << 20}, {"LGS", "ID"}};
+    assert(throwsInvalidArgument([&]() { shape_large.getNBeta(); }));
+
+    // exchange with poly network of the same shape
+    FeedForwardNeuralNetwork ffnn(4, 8, 3);
+    ffnn.pushHiddenLayer(6);
+    const char * actf_ids[3] = {"LGS", "TANS", "ID"};
+    for (int l = 0; l < ffnn.getNNeuralLayers(); ++l) {
+        for (int i = 0; i < ffnn.getNNLayer(l)->getNNeuralUnits(); ++i) {
+            ffnn.getNNLayer(l)->getNNUnit(i)->setActivationFunction(std_actf::provideActivationFunction(actf_ids[l]));
+        }
+    }
+    ffnn.connectFFNN();
+    assert(ffnn.getNBeta() == Net::nbeta);
+
+    net.storeToBinaryFile(filename); // rewrite the intact file
+    ffnn.loadBetasFromBinaryFile(filename);
+    const array<double, 3> x{0.3, -0.7, 1.1};
+    ffnn.setInput(x.data());
+    ffnn.FFPropagate();
+    net.Propagate(x);
+    for (int i = 0; i < Net::noutput; ++i) {
+        assert(fabs(ffnn.getOutput(i) - net.getOutput(i)) < 1.e-14);
+    }
+
+    ffnn.randomizeBetas();
+    ffnn.storeBetasOnBinaryFile(filename_poly);
+    Net net_from_poly;
+    net_from_poly.loadFromBinaryFile(filename_poly);
+    for (int i = 0; i < Net::nbeta; ++i) {
+        assert(net_from_poly.getBeta(i) == ffnn.getBeta(i));
+    }
+
+    // poly shape mismatch
+    FeedForwardNeuralNetwork ffnn_small(4, 8, 3);
+    ffnn_small.connectFFNN();
+    assert(throwsInvalidArgument([&]() { ffnn_small.loadBetasFromBinaryFile(filename); }));
+
+    remove(filename);
+    remove(filename_poly);
+    return 0;
+}
@@ -0,0 +1,128 @@
+#include <cassert>
+#include <cmath>
+#include <iostream>
+#include <random>
+
+#include <gsl/gsl_matrix.h>
+#include <gsl/gsl_vector.h>
+
+#include "qnets/poly/FeedForwardNeuralNetwork.hpp"
+#include "qnets/poly/train/NNTrainerGSL.hpp"
+
+using namespace std;
+using namespace nn_trainer_gsl_details; // to access hidden NNTrainerGSL methods
+
+// compare residuals, Jacobian and validation residuals of the serial evaluation to those computed with replicas
+void validate_replicas(training_workspace &tws, const gsl_vector * const betas, const bool flag_r, const bool flag_d, const int nthreads)
+{
+    const int npar = tws.ffnn->getNVariationalParameters();
+    const int nresi = calcNData(tws.ntraining, tws.yndim, flag_r ? npar : 0, flag_d ? tws.xndim : 0);
+    const int nvali = calcNData(tws.nvalidation, tws.yndim, flag_r ? npar : 0, flag_d ? tws.xndim : 0);
+    gsl_vector * f = gsl_vector_alloc(nresi), * f_rep = gsl_vector_alloc(nresi);
+    gsl_vector * fvali = gsl_vector_alloc(nvali);
+    gsl_matrix * J = gsl_matrix_alloc(nresi, npar), * J_rep = gsl_matrix_alloc(nresi, npar);
+    tws.fvali = gsl_vector_alloc(nvali);
+
+    // serial reference
+    tws.deleteReplicas();
+    assert(tws.getNThreads() == 1);
+    tws.invalidateCache();
+    ffnn_f(betas, &tws, f, flag_r, flag_d);
+    ffnn_df(betas, &tws, J, flag_r, flag_d);
+    gsl_vector_memcpy(fvali, tws.fvali);
+
+    // with replicas
+    tws.createReplicas(nthreads);
+    assert(tws.getNThreads() == nthreads);
+    tws.invalidateCache(); // don't reuse the serial propagations
+    ffnn_f(betas, &tws, f_rep, flag_r, flag_d);
+    ffnn_df(betas, &tws, J_rep, flag_r, flag_d);
+
+    // every data point is evaluated by exactly the same operations, so we expect exact equality
+    for (int i = 0; i < nresi; ++i) {
+        assert(gsl_vector_get(f_rep, i) == gsl_vector_get(f, i));
+        for (int j = 0; j < npar; ++j) {
+            assert(gsl_matrix_get(J_rep, i, j) == gsl_matrix_get(J, i, j));
+        }
+    }
+    for (int i = 0; i < nvali; ++i) {
+        assert(gsl_vector_get(tws.fvali, i) == gsl_vector_get(fvali, i));
+    }
+
+    tws.deleteReplicas();
+    assert(tws.getNThreads() == 1);
+
+    gsl_vector_free(tws.fvali);
+    tws.fvali = nullptr;
+    gsl_matrix_free(J_rep);
+    gsl_matrix_free(J);
+    gsl_vector_free(fvali);
+    gsl_vector_free(f_rep);
+    gsl_vector_free(f);
+}
+
+int main()
+{
+    const int xndim = 2;
+    const int nhu = 5;
+    const int yndim = 2;
+
+    // create FFNN
+    auto * ffnn = new FeedForwardNeuralNetwork(xndim + 1, nhu + 1, yndim + 1);
+    ffnn->connectFFNN();
+    ffnn->assignVariationalParameters();
+    const int npar = ffnn->getNVariationalParameters();
+
+    // create data (odd numbers of points, to have uneven chunks)
+    const int ntraining = 23;
+    const int nvalidation = 11;
+    const int ndata = ntraining + nvalidation;
+    NNTrainingData tdata = {ndata, ntraining, nvalidation, xndim, yndim, nullptr, nullptr, nullptr, nullptr, nullptr};
+    NNTrainingConfig tconfig = {0.001, 0.5, 0.5, 1, 1};
+    tdata.allocate(true, true);
+
+    mt19937_64 rgen;
+    rgen.seed(1337);
+    uniform_real_distribution<double> rd(-2., 2.);
+    for (int i = 0; i < ndata; ++i) {
+        for (int j = 0; j < xndim; ++j) {
+            tdata.x[i][j] = rd(rgen);
+        }
+        for (int j = 0; j < yndim; ++j) {
+            tdata.y[i][j] = rd(rgen);
+            tdata.w[i][j] = 1. + 0.1*rd(rgen);
+            for (int k = 0; k < xndim; ++k) {
+                tdata.yd1[i][j][k] = rd(rgen);
+                tdata.yd2[i][j][k] = rd(rgen);
+            }
+        }
+    }
+
+    // setup the workspace like NNTrainerGSL::findFit
+    training_workspace tws;
+    tws.copyDatConf(tdata, tconfig);
+    ffnn->addSubstrates(true, true, false, false, false);
+    auto * ffnn_vderiv = new FeedForwardNeuralNetwork(ffnn);
+    ffnn_vderiv->addSubstrates(true, true, true, true, true);
+    tws.ffnn = ffnn;
+    tws.ffnn_vderiv = ffnn_vderiv;
+
+    gsl_vector * betas = gsl_vector_alloc(npar);
+    for (int i = 0; i < npar; ++i) {
+        gsl_vector_set(betas, i, rd(rgen));
+    }
+
+    for (const int nthreads : {2, 3, 5}) {
+        validate_replicas(tws, betas, false, false, nthreads);
+        validate_replicas(tws, betas, true, false, nthreads);
+        validate_replicas(tws, betas, false, true, nthreads);
+        validate_replicas(tws, betas, true, true, nthreads);
+    }
+
+    gsl_vector_free(betas);
+    delete ffnn_vderiv;
+    delete ffnn;
+    tdata.deallocate();
+
+    return 0;
+}
@@ -0,0 +1,92 @@
+#include <cassert>
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "qnets/poly/FeedForwardNeuralNetwork.hpp"
+#include "qnets/poly/train/NNTrainerGSL.hpp"
+
+using namespace std;
+
+FeedForwardNeuralNetwork * createFFNN(const int xndim, const int nhu, const int yndim)
+{
+    auto * ffnn = new FeedForwardNeuralNetwork(xndim + 1, nhu + 1, yndim + 1);
+    ffnn->connectFFNN();
+    ffnn->assignVariationalParameters();
+    return ffnn;
+}
+
+// run a seeded bestFit and return the resulting betas
+vector<double> seededBestFit(const NNTrainingData &tdata, const NNTrainingConfig &tconfig, const unsigned long seed, const int nfits, const double resi_target)
+{
+    FeedForwardNeuralNetwork * ffnn = createFFNN(tdata.xndim, 4, tdata.yndim);
+    NNTrainerGSL trainer(tdata, tconfig);
+    trainer.setSeed(seed);
+    trainer.bestFit(ffnn, nfits, resi_target);
+
+    vector<double> betas(ffnn->getNVariationalParameters());
+    ffnn->getVariationalParameter(betas.data());
+    delete ffnn;
+    return betas;
+}
+
+int main()
+{
+    const int xndim = 1;
+    const int yndim = 1;
+
+    // seeded randomizeBetas is reproducible
+    FeedForwardNeuralNetwork * ffnn1 = createFFNN(xndim, 4, yndim);
+    FeedForwardNeuralNetwork * ffnn2 = createFFNN(xndim, 4, yndim);
+    mt19937_64 rgen1(1337), rgen2(1337);
+    ffnn1->randomizeBetas(rgen1);
+    ffnn2->randomizeBetas(rgen2);
+    for (int i = 0; i < ffnn1->getNBeta(); ++i) {
+        assert(ffnn1->getBeta(i) == ffnn2->getBeta(i));
+    }
+    ffnn2->randomizeBetas(rgen2); // the stream continues
+    bool flag_diff = false;
+    for (int i = 0; i < ffnn1->getNBeta(); ++i) {
+        flag_diff = flag_diff || ffnn1->getBeta(i) != ffnn2->getBeta(i);
+    }
+    assert(flag_diff);
+    delete ffnn2;
+
+    // gaussian data to fit
+    const int ntraining = 20;
+    const int nvalidation = 10;
+    const int ntesting = 10;
+    const int ndata = ntraining + nvalidation + ntesting;
+    NNTrainingData tdata = {ndata, ntraining, nvalidation, xndim, yndim, nullptr, nullptr, nullptr, nullptr, nullptr};
+    NNTrainingConfig tconfig = {0., 0., 0., 20, 5};
+    tdata.allocate(false, false);
+    for (int i = 0; i < ndata; ++i) {
+        tdata.x[i][0] = -2. + 4.*i/(ndata - 1.);
+        tdata.y[i][0] = exp(-tdata.x[i][0]*tdata.x[i][0]);
+        tdata.w[i][0] = 1.;
+    }
+
+    // the same seed gives the same best fit, independent of the number of threads
+    const vector<double> betas1 = seededBestFit(tdata, tconfig, 4711, 6, 0.);
+    const vector<double> betas2 = seededBestFit(tdata, tconfig, 4711, 6, 0.);
+    assert(betas1 == betas2);
+
+    // a fit meeting the target stops the restarts, i.e. with a huge target the first fit is the result
+    const vector<double> betas_first = seededBestFit(tdata, tconfig, 4711, 6, 1.e10);
+    const vector<double> betas_single = seededBestFit(tdata, tconfig, 4711, 1, 0.);
+    assert(betas_first == betas_single);
+
+    // and that fit started from the betas of the seeded stream of fit 0
+    NNTrainerGSL trainer(tdata, tconfig);
+    mt19937_64 rgen(4711);
+    ffnn1->randomizeBetas(rgen);
+    vector<double> fit(ffnn1->getNVariationalParameters()), err(ffnn1->getNVariationalParameters());
+    trainer.findFit(ffnn1, fit.data(), err.data());
+    assert(fit == betas_first);
+
+    delete ffnn1;
+    tdata.deallocate();
+
+    return 0;
+}
@@ -0,0 +1,168 @@
+#include <cassert>
+#include <cmath>
+#include <iostream>
+#include <random>
+
+#include <gsl/gsl_matrix.h>
+#include <gsl/gsl_vector.h>
+
+#include "qnets/poly/FeedForwardNeuralNetwork.hpp"
+#include "qnets/poly/train/NNTrainerGSL.hpp"
+
+using namespace std;
+using namespace nn_trainer_gsl_details; // to access hidden NNTrainerGSL methods
+
+struct ResiBuffers
+{
+    gsl_vector * f, * fvali;
+    gsl_matrix * J;
+
+    ResiBuffers(const int nresi, const int nvali, const int npar):
+            f(gsl_vector_alloc(nresi)), fvali(gsl_vector_alloc(nvali)), J(gsl_matrix_alloc(nresi, npar)) {}
+    ~ResiBuffers()
+    {
+        gsl_matrix_free(J);
+        gsl_vector_free(fvali);
+        gsl_vector_free(f);
+    }
+};
+
+void assert_equal(const ResiBuffers &a, const ResiBuffers &b, const double TINY = 1.e-14)
+{
+    for (size_t i = 0; i < a.f->size; ++i) {
+        assert(fabs(gsl_vector_get(a.f, i) - gsl_vector_get(b.f, i)) <= TINY);
+        for (size_t j = 0; j < a.J->size2; ++j) {
+            assert(fabs(gsl_matrix_get(a.J, i, j) - gsl_matrix_get(b.J, i, j)) <= TINY);
+        }
+    }
+    for (size_t i = 0; i < a.fvali->size; ++i) {
+        assert(fabs(gsl_vector_get(a.fvali, i) - gsl_vector_get(b.fvali, i)) <= TINY);
+    }
+}
+
+// evaluate f, fvali and J in the given order, optionally starting from an empty cache
+void evaluate(training_workspace &tws, const gsl_vector * const betas, ResiBuffers &out, const bool flag_r, const bool flag_d, const bool flag_df_first, const bool flag_fresh)
+{
+    if (flag_fresh) {
+        tws.invalidateCache();
+    }
+    tws.fvali = out.fvali; // validation residuals are written to the workspace
+    if (flag_df_first) {
+        ffnn_df(betas, &tws, out.J, flag_r, flag_d);
+        ffnn_f(betas, &tws, out.f, flag_r, flag_d);
+    }
+    else {
+        ffnn_f(betas, &tws, out.f, flag_r, flag_d);
+        ffnn_df(betas, &tws, out.J, flag_r, flag_d);
+    }
+    tws.fvali = nullptr;
+}
+
+// the caller's network holds betas after ffnn_f/ffnn_df, also if the values came from the cache
+void assert_ffnn_betas(const training_workspace &tws, const gsl_vector * const betas)
+{
+    for (int i = 0; i < tws.ffnn->getNVariationalParameters(); ++i) {
+        assert(tws.ffnn->getVariationalParameter(i) == gsl_vector_get(betas, i));
+    }
+}
+
+int main()
+{
+    const int xndim = 2;
+    const int nhu = 4;
+    const int yndim = 2;
+
+    // create FFNN
+    auto * ffnn = new FeedForwardNeuralNetwork(xndim + 1, nhu + 1, yndim + 1);
+    ffnn->connectFFNN();
+    ffnn->assignVariationalParameters();
+    const int npar = ffnn->getNVariationalParameters();
+
+    // create data
+    const int ntraining = 12;
+    const int nvalidation = 6;
+    const int ndata = ntraining + nvalidation;
+    NNTrainingData tdata = {ndata, ntraining, nvalidation, xndim, yndim, nullptr, nullptr, nullptr, nullptr, nullptr};
+    NNTrainingConfig tconfig = {0.001, 0.5, 0.5, 1, 1};
+    tdata.allocate(true, true);
+
+    mt19937_64 rgen;
+    rgen.seed(4242);
+    uniform_real_distribution<double> rd(-2., 2.);
+    for (int i = 0; i < ndata; ++i) {
+        for (int j = 0; j < xndim; ++j) {
+            tdata.x[i][j] = rd(rgen);
+        }
+        for (int j = 0; j < yndim; ++j) {
+            tdata.y[i][j] = rd(rgen);
+            tdata.w[i][j] = 1.;
+            for (int k = 0; k < xndim; ++k) {
+                tdata.yd1[i][j][k] = rd(rgen);
+                tdata.yd2[i][j][k] = rd(rgen);
+            }
+        }
+    }
+
+    // setup the workspace like NNTrainerGSL::findFit
+    training_workspace tws;
+    tws.copyDatConf(tdata, tconfig);
+    ffnn->addSubstrates(true, true, false, false, false);
+    auto * ffnn_vderiv = new FeedForwardNeuralNetwork(ffnn);
+    ffnn_vderiv->addSubstrates(true, true, true, true, true);
+    tws.ffnn = ffnn;
+    tws.ffnn_vderiv = ffnn_vderiv;
+
+    const int nresi = calcNData(ntraining, yndim, npar, xndim);
+    const int nvali = calcNData(nvalidation, yndim, npar, xndim);
+
+    gsl_vector * betas = gsl_vector_alloc(npar);
+    for (int istep = 0; istep < 3; ++istep) { // a few different beta vectors
+        for (int i = 0; i < npar; ++i) {
+            gsl_vector_set(betas, i, rd(rgen));
+        }
+
+        for (const bool flag_d : {false, true}) {
+            const int nresi_now = calcNData(ntraining, yndim, npar, flag_d ? xndim : 0);
+            const int nvali_now = calcNData(nvalidation, yndim, npar, flag_d ? xndim : 0);
+            ResiBuffers fresh(nresi_now, nvali_now, npar), cached(nresi_now, nvali_now, npar);
+            evaluate(tws, betas, fresh, true, flag_d, false, true); // reference
+
+            evaluate(tws, betas, cached, true, flag_d, false, false); // everything cached
+            assert_equal(fresh, cached);
+            evaluate(tws, betas, cached, true, flag_d, true, true); // f after df (validation points still to be computed)
+            assert_equal(fresh, cached);
+            assert_ffnn_betas(tws, betas);
+            evaluate(tws, betas, cached, true, flag_d, false, true); // df after f
+            assert_equal(fresh, cached);
+        }
+
+        // the values are cached also for the next betas, but must not be reused there
+        assert(tws.cache_nvalues == ndata);
+    }
+
+    // the cache is only used for equal betas
+    ResiBuffers fresh(nresi, nvali, npar), cached(nresi, nvali, npar);
+    evaluate(tws, betas, cached, true, true, false, false); // cache filled for betas
+    gsl_vector_set(betas, 0, gsl_vector_get(betas, 0) + 0.1);
+    evaluate(tws, betas, cached, true, true, false, false);
+    evaluate(tws, betas, fresh, true, true, false, true);
+    assert_equal(fresh, cached, 0.);
+
+    // a cache-served ffnn_f also sets the betas of the caller's network
+    gsl_vector * const betas_other = gsl_vector_alloc(npar);
+    gsl_vector_memcpy(betas_other, betas);
+    gsl_vector_set(betas_other, 1, gsl_vector_get(betas, 1) - 0.2);
+    ffnn_df(betas, &tws, cached.J, true, true);
+    assert_ffnn_betas(tws, betas);
+    ffnn->setVariationalParameter(betas_other->data); // changed directly, like by user code
+    ffnn_f(betas, &tws, cached.f, true, true); // cached, no propagation
+    assert_ffnn_betas(tws, betas);
+    gsl_vector_free(betas_other);
+
+    gsl_vector_free(betas);
+    delete ffnn_vderiv;
+    delete ffnn;
+    tdata.deallocate();
+
+    return 0;
+}
@@ -0,0 +1,171 @@
+#include <cassert>
+#include <cmath>
+#include <iostream>
+#include <random>
+
+#include <gsl/gsl_blas.h>
+#include <gsl/gsl_matrix.h>
+#include <gsl/gsl_vector.h>
+
+#include "qnets/poly/FeedForwardNeuralNetwork.hpp"
+#include "qnets/poly/train/NNTrainerGSL.hpp"
+
+using namespace std;
+using namespace nn_trainer_gsl_details; // to access hidden NNTrainerGSL methods
+
+// compare the blockwise accumulated normal equations to J^T J and J^T f from the full Jacobian
+void validate_normal_eq(training_workspace &tws, const gsl_vector * const betas, const bool flag_r, const bool flag_d, const int nblock_entries, const double TINY = 1.e-12)
+{
+    const int npar = tws.ffnn_vderiv->getNVariationalParameters();
+    const int nresi = calcNData(tws.ntraining, tws.yndim, flag_r ? npar : 0, flag_d ? tws.xndim : 0);
+    gsl_vector * f = gsl_vector_alloc(nresi);
+    gsl_matrix * J = gsl_matrix_alloc(nresi, npar);
+    gsl_matrix * JTJ = gsl_matrix_alloc(npar, npar);
+    gsl_vector * JTf = gsl_vector_alloc(npar);
+    const int nvalidation = tws.nvalidation;
+    tws.nvalidation = 0; // no fvali needed for ffnn_f
+    ffnn_f(betas, &tws, f, flag_r, flag_d);
+    ffnn_df(betas, &tws, J, flag_r, flag_d);
+    tws.nvalidation = nvalidation;
+
+    tws.nblock_entries = nblock_entries;
+    const double chisq = accumulateNormalEq(betas, &tws, JTJ, JTf, flag_r, flag_d);
+
+    double chisq_ref;
+    gsl_blas_ddot(f, f, &chisq_ref);
+    assert(fabs(chisq - chisq_ref) <= TINY*chisq_ref);
+    for (int a = 0; a < npar; ++a) {
+        double JTf_ref = 0.;
+        for (int i = 0; i < nresi; ++i) {
+            JTf_ref += gsl_matrix_get(J, i, a)*gsl_vector_get(f, i);
+        }
+        assert(fabs(gsl_vector_get(JTf, a) - JTf_ref) <= TINY*(1. + fabs(JTf_ref)));
+
+        for (int b = 0; b <= a; ++b) { // lower triangle
+            double JTJ_ref = 0.;
+            for (int i = 0; i < nresi; ++i) {
+                JTJ_ref += gsl_matrix_get(J, i, a)*gsl_matrix_get(J, i, b);
+            }
+            assert(fabs(gsl_matrix_get(JTJ, a, b) - JTJ_ref) <= TINY*(1. + fabs(JTJ_ref)));
+        }
+    }
+
+    // the training chisq of the residual-only pass agrees as well
+    double resi_vali;
+    assert(fabs(calcChisq(betas, &tws, flag_r, flag_d, resi_vali) - chisq_ref) <= TINY*chisq_ref);
+
+    gsl_vector_free(JTf);
+    gsl_matrix_free(JTJ);
+    gsl_matrix_free(J);
+    gsl_vector_free(f);
+}
+
+int main()
+{
+    const int xndim = 2;
+    const int nhu = 4;
+    const int yndim = 1;
+
+    // create FFNN
+    auto * ffnn = new FeedForwardNeuralNetwork(xndim + 1, nhu + 1, yndim + 1);
+    ffnn->connectFFNN();
+    ffnn->assignVariationalParameters();
+    const int npar = ffnn->getNVariationalParameters();
+
+    // the target is a network of the same shape, with known betas
+    auto * ffnn_target = new FeedForwardNeuralNetwork(ffnn);
+    ffnn_target->addSubstrates(true, true, false, false, false);
+    mt19937_64 rgen;
+    rgen.seed(8421);
+    ffnn_target->randomizeBetas(rgen);
+
+    const int ntraining = 40;
+    const int nvalidation = 20;
+    const int ntesting = 20;
+    const int ndata = ntraining + nvalidation + ntesting;
+    NNTrainingData tdata = {ndata, ntraining, nvalidation, xndim, yndim, nullptr, nullptr, nullptr, nullptr, nullptr};
+    NNTrainingConfig tconfig = {0.001, 0.5, 0.5, 50, 10};
+    tdata.allocate(true, true);
+
+    uniform_real_distribution<double> rd(-2., 2.);
+    for (int i = 0; i < ndata; ++i) {
+        for (int j = 0; j < xndim; ++j) {
+            tdata.x[i][j] = rd(rgen);
+        }
+        ffnn_target->setInput(tdata.x[i]);
+        ffnn_target->FFPropagate();
+        tdata.y[i][0] = ffnn_target->getOutput(0);
+        tdata.w[i][0] = 1.;
+        for (int k = 0; k < xndim; ++k) {
+            tdata.yd1[i][0][k] = ffnn_target->getFirstDerivative(0, k);
+            tdata.yd2[i][0][k] = ffnn_target->getSecondDerivative(0, k);
+        }
+    }
+
+    // setup the workspace like NNTrainerGSL::findFit
+    training_workspace tws;
+    tws.copyDatConf(tdata, tconfig);
+    ffnn->addSubstrates(true, true, false, false, false);
+    auto * ffnn_vderiv = new FeedForwardNeuralNetwork(ffnn);
+    ffnn_vderiv->addSubstrates(true, true, true, true, true);
+    tws.ffnn = ffnn;
+    tws.ffnn_vderiv = ffnn_vderiv;
+    tws.createReplicas(3);
+
+    gsl_vector * betas = gsl_vector_alloc(npar);
+    for (int i = 0; i < npar; ++i) {
+        gsl_vector_set(betas, i, rd(rgen));
+    }
+
+    // different block sizes (1 data point per thread, uneven blocks and a single block)
+    for (const int nblock_entries : {1, 7*5*npar, 1 << 20}) {
+        validate_normal_eq(tws, betas, false, false, nblock_entries);
+        validate_normal_eq(tws, betas, true, false, nblock_entries);
+        validate_normal_eq(tws, betas, false, true, nblock_entries);
+        validate_normal_eq(tws, betas, true, true, nblock_entries);
+    }
+
+    // close to the exact minimum, the driver converges until no step decreases chisq anymore (at the rounding level),
+    // then the network must be left at the accepted betas, not at the last rejected trial step
+    tws.flag_r = tws.flag_d1 = tws.flag_d2 = false;
+    tws.maxn_steps = 1000;
+    for (int i = 0; i < npar; ++i) {
+        gsl_vector_set(betas, i, ffnn_target->getVariationalParameter(i) + 1.e-6*rd(rgen));
+    }
+    gsl_matrix * JTJ = gsl_matrix_alloc(npar, npar);
+    int status, info;
+    double chisq;
+    normalEqDriver(betas, &tws, JTJ, 0, status, info, chisq);
+    assert(status != GSL_SUCCESS);
+    for (int i = 0; i < npar; ++i) {
+        assert(ffnn->getVariationalParameter(i) == gsl_vector_get(betas, i));
+    }
+    gsl_matrix_free(JTJ);
+
+    gsl_vector_free(betas);
+    tws.deleteReplicas();
+    delete ffnn_vderiv;
+
+    // fit in normal equation mode, starting near the target betas
+    NNTrainerGSL trainer(tdata, tconfig);
+    trainer.setNormalEquationMode(true);
+    assert(trainer.hasNormalEquationMode());
+    vector<double> fit(npar), err(npar);
+    for (int i = 0; i < npar; ++i) {
+        ffnn->setVariationalParameter(i, ffnn_target->getVariationalParameter(i) + 0.1*rd(rgen));
+    }
+    const double resi_start = trainer.computeResidual(ffnn, false, true);
+    trainer.findFit(ffnn, fit.data(), err.data());
+    ffnn->setVariationalParameter(fit.data());
+    const double resi_end = trainer.computeResidual(ffnn, false, true);
+    assert(resi_end < 0.1*resi_start);
+    for (int i = 0; i < npar; ++i) {
+        assert(err[i] >= 0.);
+    }
+
+    delete ffnn_target;
+    delete ffnn;
+    tdata.deallocate();
+
+    return 0;
+}
@@ -0,0 +1,82 @@
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+
+#include "qnets/poly/train/NNTrainingData.hpp"
+
+using namespace std;
+
+bool isAligned(const double * const ptr)
+{
+    return reinterpret_cast<std::uintptr_t>(ptr)%(NNTrainingData::ALIGN_NDOUBLE*sizeof(double)) == 0;
+}
+
+void validate_views(const NNTrainingData &tdata, const bool flag_d1, const bool flag_d2)
+{
+    assert(tdata.storage != nullptr);
+    assert(isAligned(tdata.xdata) && isAligned(tdata.ydata) && isAligned(tdata.wdata));
+    assert(flag_d1 == (tdata.yd1data != nullptr) && flag_d1 == (tdata.yd1 != nullptr));
+    assert(flag_d2 == (tdata.yd2data != nullptr) && flag_d2 == (tdata.yd2 != nullptr));
+
+    for (int i = 0; i < tdata.ndata; ++i) {
+        assert(tdata.x[i] == tdata.xdata + i*tdata.xndim);
+        assert(tdata.y[i] == tdata.ydata + i*tdata.yndim);
+        assert(tdata.w[i] == tdata.wdata + i*tdata.yndim);
+        for (int j = 0; j < tdata.yndim; ++j) {
+            assert(tdata.y[i][j] == 0.); // zero initialized
+            if (flag_d1) {
+                assert(isAligned(tdata.yd1data));
+                assert(tdata.yd1[i][j] == tdata.yd1data + (i*tdata.yndim + j)*tdata.xndim);
+            }
+            if (flag_d2) {
+                assert(isAligned(tdata.yd2data));
+                assert(tdata.yd2[i][j] == tdata.yd2data + (i*tdata.yndim + j)*tdata.xndim);
+            }
+        }
+    }
+}
+
+int main()
+{
+    NNTrainingData tdata = {7, 4, 2, 3, 2, nullptr, nullptr, nullptr, nullptr, nullptr};
+
+    // all flag combinations, reallocating the same struct
+    for (const bool flag_d1 : {false, true}) {
+        for (const bool flag_d2 : {false, true}) {
+            tdata.allocate(flag_d1, flag_d2);
+            validate_views(tdata, flag_d1, flag_d2);
+        }
+    }
+
+    // filling the contiguous blocks is visible through the views
+    const double xin[7*3] = {0., 1., 2., 3., 4., 5., 6., 7., 8., 9., 10., 11., 12., 13., 14., 15., 16., 17., 18., 19., 20.};
+    memcpy(tdata.xdata, xin, sizeof(xin));
+    assert(tdata.x[0][0] == 0. && tdata.x[2][1] == 7. && tdata.x[6][2] == 20.);
+    tdata.yd2[3][1][2] = 42.;
+    assert(tdata.yd2data[(3*2 + 1)*3 + 2] == 42.);
+
+    tdata.deallocate();
+    assert(tdata.storage == nullptr && tdata.xdata == nullptr && tdata.x == nullptr && tdata.yd1 == nullptr);
+    tdata.deallocate(); // no-op
+
+    // no data points
+    NNTrainingData tdata_empty = {0, 0, 0, 2, 1, nullptr, nullptr, nullptr, nullptr, nullptr};
+    tdata_empty.allocate(true, true);
+    tdata_empty.deallocate();
+
+    // user allocated rows are still deallocated per row
+    NNTrainingData tdata_user = {2, 2, 0, 1, 1, nullptr, nullptr, nullptr, nullptr, nullptr};
+    tdata_user.x = new double * [2];
+    tdata_user.y = new double * [2];
+    tdata_user.w = new double * [2];
+    for (int i = 0; i < 2; ++i) {
+        tdata_user.x[i] = new double[1];
+        tdata_user.y[i] = new double[1];
+        tdata_user.w[i] = new double[1];
+    }
+    tdata_user.deallocate();
+    assert(tdata_user.x == nullptr);
+
+    return 0;
+}
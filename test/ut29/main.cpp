@@ -0,0 +1,204 @@
+#include <cassert>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+#include "qnets/poly/train/NNTrainingData.hpp"
+#include "qnets/poly/train/NNTrainingDataFile.hpp"
+
+// Check the binary training data files: store/load round trips, in-place memory mapping and format checks
+
+using namespace std;
+
+template <class Fun>
+bool throwsInvalidArgument(Fun fun)
+{
+    try {
+        fun();
+    }
+    catch (const std::invalid_argument &) {
+        return true;
+    }
+    return false;
+}
+
+double value(const int i, const int j, const int k, const int block)
+{
+    return 1000.*block + 100.*i + 10.*j + k + 0.5;
+}
+
+void fill_data(NNTrainingData &tdata)
+{
+    for (int i = 0; i < tdata.ndata; ++i) {
+        for (int k = 0; k < tdata.xndim; ++k) {
+            tdata.x[i][k] = value(i, 0, k, 0);
+        }
+        for (int j = 0; j < tdata.yndim; ++j) {
+            tdata.y[i][j] = value(i, j, 0, 1);
+            tdata.w[i][j] = value(i, j, 0, 2);
+            for (int k = 0; k < tdata.xndim; ++k) {
+                if (tdata.yd1 != nullptr) { tdata.yd1[i][j][k] = value(i, j, k, 3); }
+                if (tdata.yd2 != nullptr) { tdata.yd2[i][j][k] = value(i, j, k, 4); }
+            }
+        }
+    }
+}
+
+void validate_data(const NNTrainingData &tdata, const NNTrainingData &ref, const bool flag_d1, const bool flag_d2)
+{
+    assert(tdata.ndata == ref.ndata && tdata.ntraining == ref.ntraining && tdata.nvalidation == ref.nvalidation);
+    assert(tdata.xndim == ref.xndim && tdata.yndim == ref.yndim);
+    assert(flag_d1 == (tdata.yd1 != nullptr));
+    assert(flag_d2 == (tdata.yd2 != nullptr));
+    for (int i = 0; i < tdata.ndata; ++i) {
+        assert(tdata.x[i] == tdata.xdata + i*tdata.xndim);
+        for (int k = 0; k < tdata.xndim; ++k) {
+            assert(tdata.x[i][k] == ref.x[i][k]);
+        }
+        for (int j = 0; j < tdata.yndim; ++j) {
+            assert(tdata.y[i][j] == ref.y[i][j]);
+            assert(tdata.w[i][j] == ref.w[i][j]);
+            for (int k = 0; k < tdata.xndim; ++k) {
+                if (flag_d1) { assert(tdata.yd1[i][j][k] == ref.yd1[i][j][k]); }
+                if (flag_d2) { assert(tdata.yd2[i][j][k] == ref.yd2[i][j][k]); }
+            }
+        }
+    }
+}
+
+void check_round_trip(const int ndata, const bool flag_d1, const bool flag_d2, const char * filename)
+{
+    NNTrainingData tdata = {ndata, ndata/2, ndata/4, 3, 2, nullptr, nullptr, nullptr, nullptr, nullptr};
+    tdata.allocate(flag_d1, flag_d2);
+    fill_data(tdata);
+    storeTrainingData(filename, tdata);
+
+    NNTrainingData loaded = {0, 0, 0, 1, 1, nullptr, nullptr, nullptr, nullptr, nullptr};
+    loadTrainingData(filename, loaded);
+    validate_data(loaded, tdata, flag_d1, flag_d2);
+    loaded.deallocate();
+
+    const MappedTrainingData mapped(filename);
+    assert(mapped.hasFirstDerivatives() == flag_d1 && mapped.hasSecondDerivatives() == flag_d2);
+    assert(mapped.getData().storage == nullptr); // views into the mapping
+    validate_data(mapped.getData(), tdata, flag_d1, flag_d2);
+
+    tdata.deallocate();
+}
+
+int main()
+{
+    const char * filename = "ut29_data.bin";
+
+    check_round_trip(11, false, false, filename);
+    check_round_trip(11, true, false, filename);
+    check_round_trip(13, true, true, filename);
+    check_round_trip(0, true, true, filename);
+
+    // data allocated per row by the user
+    const int ndata = 5, xndim = 2, yndim = 1;
+    NNTrainingData udata = {ndata, ndata, 0, xndim, yndim, nullptr, nullptr, nullptr, nullptr, nullptr};
+    udata.x = new double * [ndata];
+    udata.y = new double * [ndata];
+    udata.w = new double * [ndata];
+    udata.yd2 = new double ** [ndata];
+    for (int i = 0; i < ndata; ++i) {
+        udata.x[i] = new double[xndim];
+        udata.y[i] = new double[yndim];
+        udata.w[i] = new double[yndim];
+        udata.yd2[i] = new double * [yndim];
+        udata.yd2[i][0] = new double[xndim];
+    }
+    fill_data(udata);
+    storeTrainingData(filename, udata);
+    {
+        MappedTrainingData mapped(filename);
+        validate_data(mapped.getData(), udata, false, true);
+        mapped.setDataSplit(3, 2); // a different split
+        assert(mapped.getData().ntraining == 3 && mapped.getData().nvalidation == 2);
+        assert(throwsInvalidArgument([&]() { mapped.setDataSplit(4, 2); }));
+        assert(mapped.getData().ntraining == 3 && mapped.getData().nvalidation == 2);
+    }
+    udata.deallocate();
+
+    // data splits: training and validation sets are disjoint, i.e. nvalidation may exceed ntraining
+    {
+        NNTrainingData sdata = {100, 30, 50, 1, 1, nullptr, nullptr, nullptr, nullptr, nullptr};
+        sdata.allocate();
+        fill_data(sdata);
+        storeTrainingData(filename, sdata);
+        const MappedTrainingData mapped(filename);
+        validate_data(mapped.getData(), sdata, false, false);
+
+        // an impossible split is rejected before writing
+        remove(filename);
+        sdata.nvalidation = 71;
+        assert(throwsInvalidArgument([&]() { storeTrainingData(filename, sdata); }));
+        assert(!ifstream(filename).good());
+        sdata.nvalidation = 50;
+
+        // ... and when reading (the file was written by other means)
+        storeTrainingData(filename, sdata);
+        {
+            fstream file(filename, ios::binary | ios::in | ios::out);
+            const int32_t nvalidation = 71;
+            file.seekp(8 + 2*sizeof(uint32_t) + 2*sizeof(int32_t));
+            file.write(reinterpret_cast<const char *>(&nvalidation), sizeof(nvalidation));
+        }
+        assert(throwsInvalidArgument([&]() { MappedTrainingData mapped_bad(filename); }));
+        NNTrainingData bad = {0, 0, 0, 1, 1, nullptr, nullptr, nullptr, nullptr, nullptr};
+        assert(throwsInvalidArgument([&]() { loadTrainingData(filename, bad); }));
+        sdata.deallocate();
+    }
+
+    // truncated file
+    {
+        ifstream in(filename, ios::binary);
+        const string content((istreambuf_iterator<char>(in)), istreambuf_iterator<char>());
+        ofstream out(filename, ios::binary | ios::trunc);
+        out.write(content.data(), content.size() - 8);
+    }
+    assert(throwsInvalidArgument([&]() { MappedTrainingData mapped(filename); }));
+    NNTrainingData tdata = {0, 0, 0, 1, 1, nullptr, nullptr, nullptr, nullptr, nullptr};
+    assert(throwsInvalidArgument([&]() { loadTrainingData(filename, tdata); }));
+    assert(tdata.storage == nullptr && tdata.x == nullptr);
+
+    // header counts that don't fit the file (huge, or just a few more points), without touching the loaded data
+    NNTrainingData kept = {3, 1, 1, 2, 1, nullptr, nullptr, nullptr, nullptr, nullptr};
+    kept.allocate(true, false);
+    fill_data(kept);
+    storeTrainingData(filename, kept);
+    for (const pair<int32_t, int32_t> &dims : {make_pair(INT32_MAX, INT32_MAX), make_pair(11, 2)}) { // ndata, xndim
+        {
+            fstream file(filename, ios::binary | ios::in | ios::out);
+            file.seekp(8 + 2*sizeof(uint32_t));
+            file.write(reinterpret_cast<const char *>(&dims.first), sizeof(int32_t));
+            file.seekp(8 + 2*sizeof(uint32_t) + 3*sizeof(int32_t));
+            file.write(reinterpret_cast<const char *>(&dims.second), sizeof(int32_t));
+        }
+        assert(throwsInvalidArgument([&]() { MappedTrainingData mapped(filename); }));
+        NNTrainingData loaded = {3, 1, 1, 2, 1, nullptr, nullptr, nullptr, nullptr, nullptr};
+        loaded.allocate(true, false);
+        fill_data(loaded);
+        assert(throwsInvalidArgument([&]() { loadTrainingData(filename, loaded); }));
+        validate_data(loaded, kept, true, false);
+        loaded.deallocate();
+    }
+    kept.deallocate();
+
+    // not a training data file
+    {
+        ofstream out(filename, ios::binary | ios::trunc);
+        out << "This is not a training data file, but it is long enough to contain a header.";
+    }
+    assert(throwsInvalidArgument([&]() { MappedTrainingData mapped(filename); }));
+    assert(throwsInvalidArgument([&]() { loadTrainingData(filename, tdata); }));
+
+    remove(filename);
+    return 0;
+}
@@ -0,0 +1,196 @@
+#include <cassert>
+#include <cmath>
+#include <iostream>
+#include <numeric>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+#include <gsl/gsl_matrix.h>
+#include <gsl/gsl_vector.h>
+
+#include "qnets/poly/FeedForwardNeuralNetwork.hpp"
+#include "qnets/poly/train/NNTrainerSGD.hpp"
+
+using namespace std;
+using namespace nn_trainer_gsl_details; // to access hidden NNTrainerGSL methods
+using namespace nn_trainer_sgd_details; // to access hidden NNTrainerSGD methods
+
+// compare the full-batch gradient to 2 J^T f of the normal equations
+void validate_gradient(training_workspace &tws, const vector<double> &betas, const bool flag_r, const bool flag_d, const double TINY = 1.e-12)
+{
+    const int npar = static_cast<int>(betas.size());
+    gsl_vector * gx = gsl_vector_alloc(npar);
+    for (int i = 0; i < npar; ++i) {
+        gsl_vector_set(gx, i, betas[i]);
+    }
+    gsl_matrix * JTJ = gsl_matrix_alloc(npar, npar);
+    gsl_vector * JTf = gsl_vector_alloc(npar);
+    tws.flag_r = flag_r;
+    const double chisq_ref = accumulateNormalEq(gx, &tws, JTJ, JTf, flag_r, flag_d);
+
+    vector<int> idx(tws.ntraining);
+    iota(idx.begin(), idx.end(), 0);
+    vector<double> grad(npar), grad_buf;
+    const double chisq = calcBatchGradient(betas.data(), &tws, idx.data(), tws.ntraining, flag_d, grad_buf, grad.data());
+    assert(fabs(chisq - chisq_ref) <= TINY*chisq_ref);
+    for (int i = 0; i < npar; ++i) {
+        assert(fabs(grad[i] - 2.*gsl_vector_get(JTf, i)) <= TINY*(1. + fabs(grad[i])));
+    }
+
+    // the streamed residuals agree with the ones of the residual-only pass
+    double resi_vali_ref;
+    const double chisq_noreg_ref = calcChisq(gx, &tws, false, flag_d, resi_vali_ref);
+    vector<double> resi_buf;
+    assert(fabs(calcValiResidual(betas.data(), &tws, flag_d, resi_buf) - resi_vali_ref) <= TINY*resi_vali_ref);
+    assert(fabs(calcRangeChisq(betas.data(), &tws, 0, tws.ntraining, flag_d, resi_buf) - chisq_noreg_ref) <= TINY*chisq_noreg_ref);
+
+    gsl_vector_free(JTf);
+    gsl_matrix_free(JTJ);
+    gsl_vector_free(gx);
+}
+
+// fit ffnn with the given optimizer from the initial betas, returns the testing residual after the fit
+double run_fit(const NNTrainingData &tdata, const NNTrainingConfig &tconfig, const OptimizerConfig &oconfig, FeedForwardNeuralNetwork * ffnn, const vector<double> &initial_betas, vector<double> &fit)
+{
+    NNTrainerSGD trainer(tdata, tconfig, oconfig);
+    vector<double> err(initial_betas.size());
+    ffnn->setVariationalParameter(initial_betas.data());
+    trainer.findFit(ffnn, fit.data(), err.data());
+    for (const double e : err) {
+        assert(e >= 0. || std::isnan(e));
+    }
+    ffnn->setVariationalParameter(fit.data());
+    return trainer.computeResidual(ffnn);
+}
+
+int main()
+{
+    const int xndim = 2;
+    const int nhu = 4;
+    const int yndim = 1;
+
+    // create FFNN
+    auto * ffnn = new FeedForwardNeuralNetwork(xndim + 1, nhu + 1, yndim + 1);
+    ffnn->connectFFNN();
+    ffnn->assignVariationalParameters();
+    const int npar = ffnn->getNVariationalParameters();
+
+    // the target is a network of the same shape, with known betas
+    auto * ffnn_target = new FeedForwardNeuralNetwork(ffnn);
+    ffnn_target->addSubstrates(true, true, false, false, false);
+    mt19937_64 rgen;
+    rgen.seed(5531);
+    ffnn_target->randomizeBetas(rgen);
+
+    const int ntraining = 120;
+    const int nvalidation = 40;
+    const int ntesting = 40;
+    const int ndata = ntraining + nvalidation + ntesting;
+    NNTrainingData tdata = {ndata, ntraining, nvalidation, xndim, yndim, nullptr, nullptr, nullptr, nullptr, nullptr};
+    NNTrainingConfig tconfig = {0.001, 0.5, 0.5, 100, 20};
+    tdata.allocate(true, true);
+
+    uniform_real_distribution<double> rd(-2., 2.);
+    for (int i = 0; i < ndata; ++i) {
+        for (int j = 0; j < xndim; ++j) {
+            tdata.x[i][j] = rd(rgen);
+        }
+        ffnn_target->setInput(tdata.x[i]);
+        ffnn_target->FFPropagate();
+        tdata.y[i][0] = ffnn_target->getOutput(0);
+        tdata.w[i][0] = 1.;
+        for (int k = 0; k < xndim; ++k) {
+            tdata.yd1[i][0][k] = ffnn_target->getFirstDerivative(0, k);
+            tdata.yd2[i][0][k] = ffnn_target->getSecondDerivative(0, k);
+        }
+    }
+
+    // setup the workspace like NNTrainerSGD::findFit
+    training_workspace tws;
+    tws.copyDatConf(tdata, tconfig);
+    ffnn->addSubstrates(true, true, false, false, false);
+    auto * ffnn_vderiv = new FeedForwardNeuralNetwork(ffnn);
+    ffnn_vderiv->addSubstrates(true, true, true, true, true);
+    tws.ffnn = ffnn;
+    tws.ffnn_vderiv = ffnn_vderiv;
+
+    vector<double> betas(npar);
+    for (double &b : betas) {
+        b = rd(rgen);
+    }
+    for (const int nreplicas : {0, 3}) {
+        tws.createReplicas(nreplicas + 1);
+        validate_gradient(tws, betas, false, false);
+        validate_gradient(tws, betas, true, false);
+        validate_gradient(tws, betas, false, true);
+        validate_gradient(tws, betas, true, true);
+        tws.deleteReplicas();
+    }
+    delete ffnn_vderiv;
+
+    // the optimizer steps
+    const vector<double> grad = {1., -2., 0.5};
+    vector<double> b_sgd = {0., 0., 0.}, b_mom = b_sgd, b_adam = b_sgd;
+    OptimizerConfig oconfig;
+    oconfig.learning_rate = 0.1;
+    oconfig.method = OptMethod::SGD;
+    NNOptimizer opt_sgd(oconfig);
+    opt_sgd.step(grad.data(), b_sgd.data(), 3);
+    oconfig.method = OptMethod::Momentum;
+    NNOptimizer opt_mom(oconfig);
+    opt_mom.step(grad.data(), b_mom.data(), 3);
+    opt_mom.step(grad.data(), b_mom.data(), 3);
+    oconfig.method = OptMethod::Adam;
+    NNOptimizer opt_adam(oconfig);
+    opt_adam.step(grad.data(), b_adam.data(), 3);
+    for (int i = 0; i < 3; ++i) {
+        assert(fabs(b_sgd[i] + 0.1*grad[i]) < 1.e-14);
+        assert(fabs(b_mom[i] + 0.1*(1. + 1.9)*grad[i]) < 1.e-14);
+        assert(fabs(b_adam[i] + 0.1*grad[i]/(fabs(grad[i]) + oconfig.epsilon)) < 1.e-12); // first Adam step has size lr
+    }
+    // changing the number of parameters requires a reset, after which the next step is a first step again
+    bool flag_throws = false;
+    try {
+        opt_mom.step(grad.data(), b_mom.data(), 2);
+    }
+    catch (const std::invalid_argument &) {
+        flag_throws = true;
+    }
+    assert(flag_throws && opt_mom.getNSteps() == 2);
+    opt_mom.reset();
+    b_mom = {0., 0.};
+    opt_mom.step(grad.data(), b_mom.data(), 2);
+    assert(b_mom[0] == b_sgd[0] && b_mom[1] == b_sgd[1]);
+
+    // fits starting near the target betas reduce the testing residual, and are reproducible
+    vector<double> initial_betas(npar), fit(npar), fit2(npar);
+    for (int i = 0; i < npar; ++i) {
+        initial_betas[i] = ffnn_target->getVariationalParameter(i) + 0.2*rd(rgen);
+    }
+    ffnn->setVariationalParameter(initial_betas.data());
+    const double resi_start = NNTrainerSGD(tdata, tconfig).computeResidual(ffnn);
+
+    oconfig = OptimizerConfig{};
+    oconfig.learning_rate = 0.01;
+    oconfig.batch_size = 16;
+    const double resi_adam = run_fit(tdata, tconfig, oconfig, ffnn, initial_betas, fit);
+    assert(resi_adam < 0.5*resi_start);
+    run_fit(tdata, tconfig, oconfig, ffnn, initial_betas, fit2);
+    assert(fit == fit2);
+
+    oconfig.method = OptMethod::Momentum;
+    oconfig.learning_rate = 0.005;
+    assert(run_fit(tdata, tconfig, oconfig, ffnn, initial_betas, fit) < resi_start);
+
+    oconfig.method = OptMethod::SGD;
+    oconfig.batch_size = 0; // full batch
+    oconfig.learning_rate = 0.05;
+    assert(run_fit(tdata, tconfig, oconfig, ffnn, initial_betas, fit) < resi_start);
+
+    delete ffnn_target;
+    delete ffnn;
+    tdata.deallocate();
+
+    return 0;
+}
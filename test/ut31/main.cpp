@@ -0,0 +1,143 @@
+#include <cassert>
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include <gsl/gsl_matrix.h>
+
+#include "qnets/poly/train/NNTrainerGSL.hpp"
+
+using namespace std;
+using namespace nn_trainer_gsl_details; // to access hidden NNTrainerGSL methods
+
+// Check the native linear algebra of the normal equation mode against naive reference implementations
+
+// inverse of the symmetric matrix A (n x n, full) by Gauss-Jordan elimination without pivoting (A is positive definite)
+vector<double> naive_inverse(vector<double> A, const int n)
+{
+    vector<double> inv(n*n, 0.);
+    for (int i = 0; i < n; ++i) {
+        inv[i*n + i] = 1.;
+    }
+    for (int k = 0; k < n; ++k) {
+        const double p = A[k*n + k];
+        for (int j = 0; j < n; ++j) {
+            A[k*n + j] /= p;
+            inv[k*n + j] /= p;
+        }
+        for (int i = 0; i < n; ++i) {
+            if (i == k) { continue; }
+            const double fac = A[i*n + k];
+            for (int j = 0; j < n; ++j) {
+                A[i*n + j] -= fac*A[k*n + j];
+                inv[i*n + j] -= fac*inv[k*n + j];
+            }
+        }
+    }
+    return inv;
+}
+
+void check_size(const int n, const int nrow, mt19937_64 &rgen, const double TINY = 1.e-10)
+{
+    uniform_real_distribution<double> rd(-1., 1.);
+    const int ldj = nrow + 3, lda = n + 1; // padded leading dimensions
+
+    // random Jacobian (transposed) and residuals
+    vector<double> JT(n*ldj), f(nrow);
+    for (double &v : JT) {
+        v = rd(rgen);
+    }
+    for (double &v : f) {
+        v = rd(rgen);
+    }
+
+    // products
+    vector<double> A(n*lda, 0.), JTf(n, 0.);
+    syrkLowerT(JT.data(), n, nrow, ldj, A.data(), lda);
+    gemvT(JT.data(), n, nrow, ldj, f.data(), JTf.data());
+    vector<double> Afull(n*n); // reference A = J^T J + 1, full
+    for (int a = 0; a < n; ++a) {
+        double JTf_ref = 0.;
+        for (int r = 0; r < nrow; ++r) {
+            JTf_ref += JT[a*ldj + r]*f[r];
+        }
+        assert(fabs(JTf[a] - JTf_ref) < TINY);
+        for (int b = 0; b < n; ++b) {
+            double s = (a == b) ? 1. : 0.;
+            for (int r = 0; r < nrow; ++r) {
+                s += JT[a*ldj + r]*JT[b*ldj + r];
+            }
+            Afull[a*n + b] = s;
+            if (b <= a) { assert(fabs(A[a*lda + b] + ((a == b) ? 1. : 0.) - s) < TINY*(1. + fabs(s))); }
+        }
+        A[a*lda + a] += 1.;
+    }
+
+    // Cholesky decomposition: L L^T == A
+    vector<double> L = A;
+    assert(choleskyDecomp(L.data(), n, lda));
+    for (int a = 0; a < n; ++a) {
+        for (int b = 0; b <= a; ++b) {
+            double s = 0.;
+            for (int k = 0; k <= b; ++k) {
+                s += L[a*lda + k]*L[b*lda + k];
+            }
+            assert(fabs(s - Afull[a*n + b]) < TINY*(1. + fabs(Afull[a*n + b])));
+        }
+    }
+
+    // solve: A x == JTf
+    vector<double> x(n);
+    choleskySolve(L.data(), n, lda, JTf.data(), x.data());
+    for (int a = 0; a < n; ++a) {
+        double s = 0.;
+        for (int b = 0; b < n; ++b) {
+            s += Afull[a*n + b]*x[b];
+        }
+        assert(fabs(s - JTf[a]) < TINY*(1. + fabs(JTf[a])));
+    }
+
+    // diagonal of the inverse
+    const vector<double> inv = naive_inverse(Afull, n);
+    vector<double> diag(n);
+    choleskyInverseDiag(L.data(), n, lda, diag.data());
+    for (int a = 0; a < n; ++a) {
+        assert(fabs(diag[a] - inv[a*n + a]) < TINY*(1. + inv[a*n + a]));
+    }
+
+    // fit errors of the normal equation mode
+    const int ndata = n + 10;
+    const double chisq = 4.*(ndata - n); // -> error scale factor 2
+    gsl_matrix * JTJ = gsl_matrix_alloc(n, n);
+    for (int a = 0; a < n; ++a) {
+        for (int b = 0; b < n; ++b) {
+            gsl_matrix_set(JTJ, a, b, Afull[a*n + b]);
+        }
+    }
+    vector<double> err(n);
+    assert(calcNormalEqFitErr(JTJ, err.data(), ndata, chisq));
+    for (int a = 0; a < n; ++a) {
+        assert(fabs(err[a] - 2.*sqrt(inv[a*n + a])) < TINY);
+    }
+
+    // not positive definite
+    gsl_matrix_set_zero(JTJ);
+    gsl_matrix_set(JTJ, n - 1, n - 1, -1.);
+    assert(!calcNormalEqFitErr(JTJ, err.data(), ndata, chisq));
+    assert(std::isnan(err[0]));
+    gsl_matrix_free(JTJ);
+}
+
+int main()
+{
+    mt19937_64 rgen;
+    rgen.seed(90210);
+
+    // sizes below, at and above the Cholesky block size
+    for (const int n : {1, 5, 63, 64, 65, 150}) {
+        check_size(n, 2*n + 7, rgen);
+    }
+
+    return 0;
+}
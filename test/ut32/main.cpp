@@ -0,0 +1,230 @@
+#include <cassert>
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+#include <gsl/gsl_vector.h>
+
+#include "qnets/poly/FeedForwardNeuralNetwork.hpp"
+#include "qnets/poly/train/NNTrainerGSL.hpp"
+
+using namespace std;
+using namespace nn_trainer_gsl_details; // to access hidden NNTrainerGSL methods
+
+// Check the validation evaluation of NNTrainerGSL, decoupled from the residual function: scheduled, synchronous or in the background
+
+void validate_residuals(training_workspace &tws, const gsl_vector * const betas, const bool flag_r, const bool flag_d, const double TINY = 1.e-12)
+{
+    const int npar = tws.ffnn->getNVariationalParameters();
+    const int nresi = calcNData(tws.ntraining, tws.yndim, flag_r ? npar : 0, flag_d ? tws.xndim : 0);
+    const int nvali = calcNData(tws.nvalidation, tws.yndim, flag_r ? npar : 0, flag_d ? tws.xndim : 0);
+    const int nvali_noreg = calcNData(tws.nvalidation, tws.yndim, 0, flag_d ? tws.xndim : 0);
+    gsl_vector * f = gsl_vector_alloc(nresi), * fvali = gsl_vector_alloc(nvali), * fvali_ref = gsl_vector_alloc(nvali);
+
+    // without fvali in the workspace, ffnn_f propagates the training points only
+    tws.invalidateCache();
+    ffnn_f(betas, &tws, f, flag_r, flag_d);
+    assert(tws.cache_nvalues == tws.ntraining);
+
+    // calcFVali equals the rows written by ffnn_f on request
+    calcFVali(betas, &tws, fvali, flag_r, flag_d);
+    assert(tws.cache_nvalues == tws.ntraining + tws.nvalidation);
+    tws.invalidateCache();
+    tws.fvali = fvali_ref;
+    ffnn_f(betas, &tws, f, flag_r, flag_d);
+    tws.fvali = nullptr;
+    for (int i = 0; i < nvali; ++i) {
+        assert(gsl_vector_get(fvali, i) == gsl_vector_get(fvali_ref, i));
+    }
+
+    // the unregularized validation residual, from the cache or propagated with another network
+    const double resi_vali = evalValiResidual(betas, &tws, flag_d);
+    vector<double> vbetas(npar);
+    for (int i = 0; i < npar; ++i) {
+        vbetas[i] = gsl_vector_get(betas, i);
+    }
+    auto * ffnn_vali = new FeedForwardNeuralNetwork(tws.ffnn);
+    assert(evalValiResidual(vbetas, &tws, ffnn_vali, flag_d) == resi_vali); // same operations
+    delete ffnn_vali;
+
+    double resi_vali_chisq;
+    calcChisq(betas, &tws, flag_r, flag_d, resi_vali_chisq);
+    assert(fabs(resi_vali_chisq - resi_vali) <= TINY*resi_vali);
+    double chisq_vali_noreg = 0.;
+    for (int i = 0; i < nvali_noreg; ++i) {
+        chisq_vali_noreg += gsl_vector_get(fvali, i)*gsl_vector_get(fvali, i);
+    }
+    assert(fabs(sqrt(chisq_vali_noreg) - resi_vali) <= TINY*resi_vali);
+
+    gsl_vector_free(fvali_ref);
+    gsl_vector_free(fvali);
+    gsl_vector_free(f);
+}
+
+void validate_scheduler(training_workspace &tws, const vector<gsl_vector *> &betas_iter, const int vali_interval)
+{
+    const bool flag_d = tws.flag_d1 || tws.flag_d2;
+    tws.vali_interval = vali_interval;
+
+    // synchronous: results for every vali_interval-th iteration, at its betas
+    tws.ffnn_vali = nullptr;
+    {
+        validation_scheduler vali(&tws, flag_d);
+        for (int iter = 1; iter <= static_cast<int>(betas_iter.size()); ++iter) {
+            double resi_vali = -1.;
+            const bool flag_result = vali.update(betas_iter[iter - 1], iter, resi_vali);
+            assert(flag_result == (iter%vali_interval == 0));
+            if (flag_result) {
+                assert(resi_vali == evalValiResidual(betas_iter[iter - 1], &tws, flag_d));
+            }
+        }
+    }
+
+    // asynchronous: at the same iterations, the result of the previous scheduled iteration
+    tws.ffnn_vali = new FeedForwardNeuralNetwork(tws.ffnn);
+    {
+        validation_scheduler vali(&tws, flag_d);
+        int iter_prev = -1;
+        for (int iter = 1; iter <= static_cast<int>(betas_iter.size()); ++iter) {
+            double resi_vali = -1.;
+            const bool flag_result = vali.update(betas_iter[iter - 1], iter, resi_vali);
+            assert(flag_result == (iter%vali_interval == 0 && iter_prev > 0));
+            if (flag_result) {
+                assert(resi_vali == evalValiResidual(betas_iter[iter_prev - 1], &tws, flag_d));
+            }
+            if (iter%vali_interval == 0) {
+                iter_prev = iter;
+            }
+        }
+        vali.wait();
+        vali.wait(); // nothing pending
+    }
+    delete tws.ffnn_vali;
+    tws.ffnn_vali = nullptr;
+}
+
+// fit ffnn from the initial betas, returns the testing residual after the fit
+double run_fit(NNTrainerGSL &trainer, FeedForwardNeuralNetwork * ffnn, const vector<double> &initial_betas, vector<double> &fit)
+{
+    vector<double> err(initial_betas.size());
+    ffnn->setVariationalParameter(initial_betas.data());
+    trainer.findFit(ffnn, fit.data(), err.data());
+    ffnn->setVariationalParameter(fit.data());
+    return trainer.computeResidual(ffnn);
+}
+
+int main()
+{
+    const int xndim = 2;
+    const int nhu = 4;
+    const int yndim = 1;
+
+    // create FFNN
+    auto * ffnn = new FeedForwardNeuralNetwork(xndim + 1, nhu + 1, yndim + 1);
+    ffnn->connectFFNN();
+    ffnn->assignVariationalParameters();
+    const int npar = ffnn->getNVariationalParameters();
+
+    // the target is a network of the same shape, with known betas
+    auto * ffnn_target = new FeedForwardNeuralNetwork(ffnn);
+    ffnn_target->addSubstrates(true, true, false, false, false);
+    mt19937_64 rgen;
+    rgen.seed(7777);
+    ffnn_target->randomizeBetas(rgen);
+
+    const int ntraining = 60;
+    const int nvalidation = 30;
+    const int ntesting = 30;
+    const int ndata = ntraining + nvalidation + ntesting;
+    NNTrainingData tdata = {ndata, ntraining, nvalidation, xndim, yndim, nullptr, nullptr, nullptr, nullptr, nullptr};
+    NNTrainingConfig tconfig = {0.001, 0.5, 0.5, 30, 3};
+    tdata.allocate(true, true);
+
+    uniform_real_distribution<double> rd(-2., 2.);
+    for (int i = 0; i < ndata; ++i) {
+        for (int j = 0; j < xndim; ++j) {
+            tdata.x[i][j] = rd(rgen);
+        }
+        ffnn_target->setInput(tdata.x[i]);
+        ffnn_target->FFPropagate();
+        tdata.y[i][0] = ffnn_target->getOutput(0) + 0.05*rd(rgen); // noisy, so that the validation stops early
+        tdata.w[i][0] = 1.;
+        for (int k = 0; k < xndim; ++k) {
+            tdata.yd1[i][0][k] = ffnn_target->getFirstDerivative(0, k);
+            tdata.yd2[i][0][k] = ffnn_target->getSecondDerivative(0, k);
+        }
+    }
+
+    // setup the workspace like NNTrainerGSL::findFit
+    training_workspace tws;
+    tws.copyDatConf(tdata, tconfig);
+    ffnn->addSubstrates(true, true, false, false, false);
+    auto * ffnn_vderiv = new FeedForwardNeuralNetwork(ffnn);
+    ffnn_vderiv->addSubstrates(true, true, true, true, true);
+    tws.ffnn = ffnn;
+    tws.ffnn_vderiv = ffnn_vderiv;
+
+    vector<gsl_vector *> betas_iter(7); // betas of a few "iterations"
+    for (auto &betas : betas_iter) {
+        betas = gsl_vector_alloc(npar);
+        for (int i = 0; i < npar; ++i) {
+            gsl_vector_set(betas, i, rd(rgen));
+        }
+    }
+    for (const int nreplicas : {0, 2}) {
+        tws.createReplicas(nreplicas + 1);
+        for (const bool flag_r : {false, true}) {
+            for (const bool flag_d : {false, true}) {
+                validate_residuals(tws, betas_iter[0], flag_r, flag_d);
+            }
+        }
+        for (const int vali_interval : {1, 2, 3}) {
+            validate_scheduler(tws, betas_iter, vali_interval);
+        }
+        tws.deleteReplicas();
+    }
+    for (auto &betas : betas_iter) {
+        gsl_vector_free(betas);
+    }
+    delete ffnn_vderiv;
+
+    // fits with the different validation schedules reduce the testing residual, and are reproducible
+    vector<double> initial_betas(npar), fit(npar), fit2(npar);
+    for (int i = 0; i < npar; ++i) {
+        initial_betas[i] = ffnn_target->getVariationalParameter(i) + 0.3*rd(rgen);
+    }
+    ffnn->setVariationalParameter(initial_betas.data());
+    NNTrainerGSL trainer(tdata, tconfig);
+    const double resi_start = trainer.computeResidual(ffnn);
+
+    bool flag_throws = false;
+    try {
+        trainer.setValidationInterval(0);
+    }
+    catch (const std::invalid_argument &) {
+        flag_throws = true;
+    }
+    assert(flag_throws);
+    assert(trainer.getValidationInterval() == 1 && !trainer.hasAsyncValidation());
+
+    for (const bool flag_normal_eq : {false, true}) {
+        trainer.setNormalEquationMode(flag_normal_eq);
+        for (const int vali_interval : {1, 3}) {
+            for (const bool flag_async : {false, true}) {
+                trainer.setValidationInterval(vali_interval, flag_async);
+                assert(trainer.getValidationInterval() == vali_interval && trainer.hasAsyncValidation() == flag_async);
+                assert(run_fit(trainer, ffnn, initial_betas, fit) < resi_start);
+                run_fit(trainer, ffnn, initial_betas, fit2);
+                assert(fit == fit2);
+            }
+        }
+    }
+
+    delete ffnn_target;
+    delete ffnn;
+    tdata.deallocate();
+
+    return 0;
+}
@@ -0,0 +1,168 @@
+#include <cassert>
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "qnets/poly/FeedForwardNeuralNetwork.hpp"
+#include "qnets/poly/train/NNTrainerGSL.hpp"
+
+#ifdef OPENMP
+#include <omp.h>
+#endif
+
+using namespace std;
+using namespace nn_trainer_details; // to access hidden NNTrainer helpers
+
+// Check the single-pass reductions of NNTrainer (column statistics and testing residual) against naive references
+
+// naive two-pass reference of the column statistics
+void validate_stats(const column_stats &stats, const double * const * array, const int ifirst, const int ilast, const int ncols, const double TINY = 1.e-12)
+{
+    const int n = ilast - ifirst;
+    assert(stats.n == n);
+    for (int j = 0; j < ncols; ++j) {
+        double mean = 0., lbound = array[ifirst][j], ubound = array[ifirst][j];
+        for (int i = ifirst; i < ilast; ++i) {
+            mean += array[i][j];
+            lbound = min(lbound, array[i][j]);
+            ubound = max(ubound, array[i][j]);
+        }
+        mean /= n;
+        double var = 0.;
+        for (int i = ifirst; i < ilast; ++i) {
+            var += pow(array[i][j] - mean, 2);
+        }
+        assert(fabs(stats.mean[j] - mean) <= TINY*(1. + fabs(mean)));
+        assert(stats.lbound[j] == lbound && stats.ubound[j] == ubound);
+        if (n > 1) {
+            const double sigma = sqrt(var/(n - 1));
+            assert(fabs(stats.sigma(j) - sigma) <= TINY*(1. + sigma));
+        }
+    }
+}
+
+// naive reference of NNTrainer::computeResidual
+double naive_residual(FeedForwardNeuralNetwork * ffnn, const NNTrainingData &tdata, const NNTrainingConfig &tconfig, const bool flag_r, const bool flag_d)
+{
+    const int npar = ffnn->getNVariationalParameters();
+    const int offset = tdata.ntraining + tdata.nvalidation;
+    const double scale = 1./(tdata.ndata - offset);
+    double resi = 0.;
+    if (flag_r) {
+        for (int i = 0; i < npar; ++i) {
+            resi += tconfig.lambda_r*tconfig.lambda_r/npar*pow(ffnn->getBeta(i), 2);
+        }
+    }
+    for (int i = offset; i < tdata.ndata; ++i) {
+        ffnn->setInput(tdata.x[i]);
+        ffnn->FFPropagate();
+        for (int j = 0; j < tdata.yndim; ++j) {
+            resi += scale*pow(tdata.w[i][j]*(ffnn->getOutput(j) - tdata.y[i][j]), 2);
+            for (int k = 0; k < tdata.xndim && flag_d; ++k) {
+                resi += scale*tconfig.lambda_d1*tconfig.lambda_d1/tdata.xndim*pow(tdata.w[i][j]*(ffnn->getFirstDerivative(j, k) - tdata.yd1[i][j][k]), 2);
+                resi += scale*tconfig.lambda_d2*tconfig.lambda_d2/tdata.xndim*pow(tdata.w[i][j]*(ffnn->getSecondDerivative(j, k) - tdata.yd2[i][j][k]), 2);
+            }
+        }
+    }
+    return sqrt(resi);
+}
+
+int main()
+{
+    const int xndim = 3;
+    const int yndim = 2;
+    const int ntraining = 100;
+    const int nvalidation = 50;
+    const int ntesting = 3*residual_min_chunks*reduction_chunk + 17; // enough chunks for 3 threads
+    const int ndata = ntraining + nvalidation + ntesting;
+
+    mt19937_64 rgen;
+    rgen.seed(3141);
+    uniform_real_distribution<double> rd(-1., 1.);
+
+    NNTrainingData tdata = {ndata, ntraining, nvalidation, xndim, yndim, nullptr, nullptr, nullptr, nullptr, nullptr};
+    NNTrainingConfig tconfig = {0.01, 0.3, 0.2, 1, 1};
+    tdata.allocate(true, true);
+    for (int i = 0; i < ndata; ++i) {
+        for (int k = 0; k < xndim; ++k) {
+            tdata.x[i][k] = 1.e6 + (k + 1.)*rd(rgen); // large offset, where the naive one-pass variance would fail
+        }
+        for (int j = 0; j < yndim; ++j) {
+            tdata.y[i][j] = rd(rgen);
+            tdata.w[i][j] = 1. + 0.5*rd(rgen);
+            for (int k = 0; k < xndim; ++k) {
+                tdata.yd1[i][j][k] = rd(rgen);
+                tdata.yd2[i][j][k] = rd(rgen);
+            }
+        }
+    }
+
+    // column statistics over different ranges (below, at and above the chunk size)
+    for (const int n : {1, 2, 7, reduction_chunk, reduction_chunk + 1, ndata - 3}) {
+        validate_stats(computeColumnStats(tdata.x, 3, 3 + n, xndim), tdata.x, 3, 3 + n, xndim, 1.e-9);
+        validate_stats(computeColumnStats(tdata.y, 0, n, yndim), tdata.y, 0, n, yndim);
+    }
+
+    // merging partial statistics
+    column_stats part1(yndim), part2(yndim), empty(yndim);
+    for (int i = 0; i < 10; ++i) {
+        part1.add(tdata.y[i]);
+    }
+    for (int i = 10; i < 30; ++i) {
+        part2.add(tdata.y[i]);
+    }
+    part1.merge(empty);
+    part1.merge(part2);
+    validate_stats(part1, tdata.y, 0, 30, yndim);
+
+    // the normalization set by NNTrainer
+    auto * ffnn = new FeedForwardNeuralNetwork(xndim + 1, 5, yndim + 1);
+    ffnn->connectFFNN();
+    ffnn->assignVariationalParameters();
+    ffnn->addSubstrates(true, true, false, false, false);
+    ffnn->randomizeBetas(rgen);
+    auto * ffnn_ref = new FeedForwardNeuralNetwork(ffnn);
+
+    NNTrainerGSL trainer(tdata, tconfig);
+    trainer.setNormalization(ffnn);
+    const column_stats xstats = computeColumnStats(tdata.x, 0, ndata, xndim);
+    validate_stats(xstats, tdata.x, 0, ndata, xndim, 1.e-9);
+    for (int k = 0; k < xndim; ++k) {
+        assert(ffnn->getInputLayer()->getInputUnit(k)->getInputMu() == xstats.mean[k]);
+        assert(ffnn->getInputLayer()->getInputUnit(k)->getInputSigma() == xstats.sigma(k));
+        ffnn_ref->getInputLayer()->getInputUnit(k)->setInputMu(xstats.mean[k]);
+        ffnn_ref->getInputLayer()->getInputUnit(k)->setInputSigma(xstats.sigma(k));
+    }
+    const column_stats ystats = computeColumnStats(tdata.y, 0, ndata, yndim);
+    for (int j = 0; j < yndim; ++j) {
+        ffnn_ref->getOutputLayer()->getOutputNNUnit(j)->setOutputBounds(ystats.lbound[j], ystats.ubound[j]);
+        assert(ffnn->getOutputLayer()->getOutputNNUnit(j)->getOutputMu() == ffnn_ref->getOutputLayer()->getOutputNNUnit(j)->getOutputMu());
+        assert(ffnn->getOutputLayer()->getOutputNNUnit(j)->getOutputSigma() == ffnn_ref->getOutputLayer()->getOutputNNUnit(j)->getOutputSigma());
+    }
+
+    // testing residual against the naive reference, and reproducible for any number of threads
+    for (const bool flag_r : {false, true}) {
+        for (const bool flag_d : {false, true}) {
+            const double resi = trainer.computeResidual(ffnn, flag_r, flag_d);
+            const double resi_ref = naive_residual(ffnn, tdata, tconfig, flag_r, flag_d);
+            assert(fabs(resi - resi_ref) <= 1.e-12*resi_ref);
+#ifdef OPENMP
+            const int nthreads_max = omp_get_max_threads();
+            for (const int nthreads : {1, 2, 3}) {
+                omp_set_num_threads(nthreads);
+                assert(trainer.computeResidual(ffnn, flag_r, flag_d) == resi);
+                const column_stats xstats_th = computeColumnStats(tdata.x, 0, ndata, xndim);
+                assert(xstats_th.mean == xstats.mean && xstats_th.m2 == xstats.m2);
+            }
+            omp_set_num_threads(nthreads_max);
+#endif
+        }
+    }
+
+    delete ffnn_ref;
+    delete ffnn;
+    tdata.deallocate();
+
+    return 0;
+}
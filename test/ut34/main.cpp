@@ -0,0 +1,112 @@
+#include <cassert>
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "qnets/poly/FeedForwardNeuralNetwork.hpp"
+
+// Check the array overloads of the variational and cross derivative getters against the per-index getters,
+// for nets where the number of variational parameters differs from the number of inputs and betas
+
+using namespace std;
+
+const double GUARD = -12345.; // entries beyond the variational parameters must stay untouched
+
+// rows of nvp (+1 guard) values
+vector<vector<double>> makeRows(const int nrows, const int nvp)
+{
+    return vector<vector<double>>(nrows, vector<double>(nvp + 1, GUARD));
+}
+
+vector<double *> rowPtrs(vector<vector<double>> &rows)
+{
+    vector<double *> ptrs;
+    for (auto &row : rows) { ptrs.push_back(row.data()); }
+    return ptrs;
+}
+
+void checkRow(const vector<double> &row, FeedForwardNeuralNetwork * ffnn, const int i, const int id, const int type)
+{   // type 0: vd1, 1: d1vd1, 2: d2vd1
+    const int nvp = ffnn->getNVariationalParameters();
+    for (int iv = 0; iv < nvp; ++iv) {
+        const double ref = type == 0 ? ffnn->getVariationalFirstDerivative(i, iv)
+                                     : (type == 1 ? ffnn->getCrossFirstDerivative(i, id, iv) : ffnn->getCrossSecondDerivative(i, id, iv));
+        assert(row[iv] == ref);
+    }
+    assert(row[nvp] == GUARD);
+}
+
+void checkArrayGetters(FeedForwardNeuralNetwork * ffnn)
+{
+    const int nin = ffnn->getNInput(), nout = ffnn->getNOutput(), nvp = ffnn->getNVariationalParameters();
+
+    // variational first derivative
+    for (int i = 0; i < nout; ++i) {
+        auto rows = makeRows(1, nvp);
+        ffnn->getVariationalFirstDerivative(i, rows[0].data());
+        checkRow(rows[0], ffnn, i, 0, 0);
+    }
+    auto vd1 = makeRows(nout, nvp);
+    auto vd1_ptrs = rowPtrs(vd1);
+    ffnn->getVariationalFirstDerivative(vd1_ptrs.data());
+    for (int i = 0; i < nout; ++i) { checkRow(vd1[i], ffnn, i, 0, 0); }
+
+    // cross first and second derivatives
+    for (int type = 1; type <= 2; ++type) {
+        vector<vector<vector<double>>> all(nout);
+        vector<vector<double *>> all_ptrs(nout);
+        vector<double **> all_pptrs(nout);
+        for (int i = 0; i < nout; ++i) {
+            all[i] = makeRows(nin, nvp);
+            all_ptrs[i] = rowPtrs(all[i]);
+            all_pptrs[i] = all_ptrs[i].data();
+
+            auto rows = makeRows(nin, nvp);
+            auto ptrs = rowPtrs(rows);
+            if (type == 1) { ffnn->getCrossFirstDerivative(i, ptrs.data()); }
+            else { ffnn->getCrossSecondDerivative(i, ptrs.data()); }
+            for (int id = 0; id < nin; ++id) {
+                checkRow(rows[id], ffnn, i, id, type);
+                auto row = makeRows(1, nvp);
+                if (type == 1) { ffnn->getCrossFirstDerivative(i, id, row[0].data()); }
+                else { ffnn->getCrossSecondDerivative(i, id, row[0].data()); }
+                checkRow(row[0], ffnn, i, id, type);
+            }
+        }
+        if (type == 1) { ffnn->getCrossFirstDerivative(all_pptrs.data()); }
+        else { ffnn->getCrossSecondDerivative(all_pptrs.data()); }
+        for (int i = 0; i < nout; ++i) {
+            for (int id = 0; id < nin; ++id) { checkRow(all[i][id], ffnn, i, id, type); }
+        }
+    }
+}
+
+int main()
+{
+    // random generator with fixed seed for generating the beta, in order to eliminate randomness of results in the unittest
+    mt19937_64 rgen;
+    rgen.seed(18984687);
+    uniform_real_distribution<double> rd(-1., 1.);
+    const double x[2] = {0.3, -0.8};
+
+    for (const int starting_layer : {0, 2}) { // all betas (nvp > ninput) or only the output layer's (nvp < nbeta)
+        auto * ffnn = new FeedForwardNeuralNetwork(3, 5, 3);
+        ffnn->pushHiddenLayer(4);
+        ffnn->connectFFNN();
+        ffnn->randomizeBetas(rgen);
+        ffnn->assignVariationalParameters(starting_layer);
+        ffnn->addCrossSecondDerivativeSubstrate();
+        const int nvp = ffnn->getNVariationalParameters();
+        assert(nvp != ffnn->getNInput());
+        assert(starting_layer == 0 ? nvp == ffnn->getNBeta() : nvp < ffnn->getNBeta());
+
+        ffnn->setInput(x);
+        ffnn->FFPropagate();
+        checkArrayGetters(ffnn);
+
+        delete ffnn;
+    }
+
+    return 0;
+}